@@ -34,12 +34,19 @@
 #include "progresstilecallback.h"
 
 // appleseed.renderer headers.
+#include "renderer/api/aov.h"
 #include "renderer/api/frame.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
 #include "foundation/image/imageattributes.h"
+#include "foundation/image/progressiveexrimagefilewriter.h"
+#include "foundation/image/tile.h"
 #include "foundation/platform/thread.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
 
 // Boost headers.
 #include "boost/filesystem/operations.hpp"
@@ -51,6 +58,7 @@
 // Standard headers.
 #include <cstddef>
 #include <ctime>
+#include <vector>
 
 using namespace foundation;
 using namespace renderer;
@@ -64,6 +72,10 @@ namespace cli {
 //
 // ContinuousSavingTileCallback.
 //
+// OpenEXR output files are written tile by tile as tiles are rendered, with one
+// additional part per AOV. Other formats, and frames whose tiles are rendered
+// more than once, are saved by rewriting the whole image after every tile.
+//
 
 namespace
 {
@@ -74,6 +86,8 @@ namespace
         ContinuousSavingTileCallback(const string& output_path, Logger& logger)
           : ProgressTileCallback(logger)
           , m_output_path(output_path)
+          , m_streaming(lower_case(m_output_path.extension().string()) == ".exr")
+          , m_written_tile_count(0)
         {
             boost::mt19937 rng(static_cast<uint32_t>(time(0)));
             const uuids::uuid u = uuids::basic_random_generator<boost::mt19937>(&rng)();
@@ -84,9 +98,13 @@ namespace
         }
 
       private:
-        boost::mutex        m_mutex;
-        bf::path            m_output_path;
-        bf::path            m_tmp_output_path;
+        boost::mutex                    m_mutex;
+        bf::path                        m_output_path;
+        bf::path                        m_tmp_output_path;
+        bool                            m_streaming;
+        ProgressiveEXRImageFileWriter   m_writer;
+        vector<bool>                    m_written_tiles;
+        size_t                          m_written_tile_count;
 
         virtual void do_post_render_tile(
             const Frame*    frame,
@@ -95,9 +113,100 @@ namespace
         {
             boost::mutex::scoped_lock lock(m_mutex);
             ProgressTileCallback::do_post_render_tile(frame, tile_x, tile_y);
+
+            if (m_streaming)
+            {
+                try
+                {
+                    if (stream_tile(frame, tile_x, tile_y))
+                        return;
+                }
+                catch (const Exception& e)
+                {
+                    LOG_WARNING(
+                        m_logger,
+                        "failed to write tile (" FMT_SIZE_T ", " FMT_SIZE_T ") to %s: %s; "
+                        "falling back to saving the whole image after every tile.",
+                        tile_x,
+                        tile_y,
+                        m_output_path.string().c_str(),
+                        e.what());
+                }
+
+                stop_streaming();
+            }
+
             frame->write_main_image(m_tmp_output_path.string().c_str());
             bf::rename(m_tmp_output_path, m_output_path);
         }
+
+        // Write a tile of the main image and the corresponding tiles of the AOV images.
+        // Return false if the tile cannot be streamed to the output file.
+        bool stream_tile(
+            const Frame*    frame,
+            const size_t    tile_x,
+            const size_t    tile_y)
+        {
+            const Image& image = frame->image();
+            const ImageStack& aov_images = frame->aov_images();
+            const CanvasProperties& props = image.properties();
+
+            if (!m_writer.is_open())
+            {
+                if (m_written_tile_count > 0)
+                {
+                    // The file was completed already and a tile is being rendered again.
+                    return false;
+                }
+
+                m_writer.add_part("beauty", props, ImageAttributes::create_default_attributes());
+
+                for (size_t i = 0; i < aov_images.size(); ++i)
+                {
+                    m_writer.add_part(
+                        aov_images.get_name(i),
+                        aov_images.get_image(i).properties());
+                }
+
+                m_writer.open(m_output_path.string().c_str());
+                m_written_tiles.assign(props.m_tile_count, false);
+            }
+
+            // Tiles can only be written once to the output file.
+            const size_t tile_index = tile_y * props.m_tile_count_x + tile_x;
+            if (m_written_tiles[tile_index])
+                return false;
+
+            Tile tile(image.tile(tile_x, tile_y));
+            frame->transform_to_output_color_space(tile);
+            m_writer.write_tile(tile, tile_x, tile_y);
+
+            // Note: AOVs are always in the linear color space.
+            for (size_t i = 0; i < aov_images.size(); ++i)
+                m_writer.write_tile(aov_images.get_image(i).tile(tile_x, tile_y), tile_x, tile_y, i + 1);
+
+            m_written_tiles[tile_index] = true;
+
+            // Finalize the file as soon as all tiles have been written.
+            if (++m_written_tile_count == props.m_tile_count)
+                m_writer.close();
+
+            return true;
+        }
+
+        void stop_streaming()
+        {
+            m_streaming = false;
+
+            try
+            {
+                m_writer.close();
+            }
+            catch (const Exception&)
+            {
+                // The whole image will be written again anyway.
+            }
+        }
     };
 }
 
@@ -151,6 +151,16 @@ namespace
                     send_tile(*frame, tx, ty);
         }
 
+        virtual void post_update_tile(
+            const Frame*            frame,
+            const size_t            tile_x,
+            const size_t            tile_y) APPLESEED_OVERRIDE
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            send_header(*frame);
+            send_tile(*frame, tile_x, tile_y);
+        }
+
       private:
         static FILE* open_pipe(const char* command)
         {
@@ -592,6 +592,9 @@ namespace
             "rendering finished in %s.",
             pretty_time(seconds, 3).c_str());
 
+        // Rendering threads are done: the frame can be written using the same thread budget.
+        const size_t thread_count = get_rendering_thread_count(params);
+
         // Archive the frame to disk.
         char* archive_path = 0;
         if (params.get_optional<bool>("autosave", true))
@@ -605,15 +608,16 @@ namespace
             LOG_INFO(g_logger, "archiving frame to disk...");
             project->get_frame()->archive(
                 autosave_path.string().c_str(),
-                &archive_path);
+                &archive_path,
+                thread_count);
         }
 
         // Write the frame to disk.
         if (g_cl.m_output.is_set() && !g_cl.m_continuous_saving.is_set())
         {
             LOG_INFO(g_logger, "writing frame to disk...");
-            project->get_frame()->write_main_image(g_cl.m_output.value().c_str());
-            project->get_frame()->write_aov_images(g_cl.m_output.value().c_str());
+            project->get_frame()->write_main_image(g_cl.m_output.value().c_str(), thread_count);
+            project->get_frame()->write_aov_images(g_cl.m_output.value().c_str(), thread_count);
         }
         else
         {
@@ -624,10 +628,10 @@ namespace
             if (!output_filename.empty())
             {
                 LOG_INFO(g_logger, "writing frame to disk...");
-                frame->write_main_image(output_filename.c_str());
+                frame->write_main_image(output_filename.c_str(), thread_count);
 
                 if (frame->get_parameters().get_optional<bool>("output_aovs", false))
-                    frame->write_aov_images(output_filename.c_str());
+                    frame->write_aov_images(output_filename.c_str(), thread_count);
             }
         }
 
@@ -72,6 +72,16 @@ namespace
         frame->transform_to_output_color_space(*image);
     }
 
+    bool write_main_image(const Frame* frame, const char* file_path)
+    {
+        return frame->write_main_image(file_path);
+    }
+
+    bool write_aov_images(const Frame* frame, const char* file_path)
+    {
+        return frame->write_aov_images(file_path);
+    }
+
     bpy::object archive_frame(const Frame* frame, const char* directory)
     {
         char* output = 0;
@@ -147,8 +157,8 @@ void bind_frame()
         .def("transform_image_to_output_color_space", transform_image_to_output_color_space)
 
         .def("clear_main_image", &Frame::clear_main_image)
-        .def("write_main_image", &Frame::write_main_image)
-        .def("write_aov_images", &Frame::write_aov_images)
+        .def("write_main_image", write_main_image)
+        .def("write_aov_images", write_aov_images)
         .def("archive", archive_frame)
         ;
 }
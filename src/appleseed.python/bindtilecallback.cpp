@@ -95,6 +95,21 @@ namespace
         void default_post_render(const Frame* frame)
         {
         }
+
+        virtual void post_update_tile(const Frame* frame, const size_t tile_x, const size_t tile_y) APPLESEED_OVERRIDE
+        {
+            // Lock Python's global interpreter lock (GIL),
+            // it was released in MasterRenderer.render.
+            ScopedGILLock lock;
+
+            if (bpy::override f = this->get_override("post_update_tile"))
+                f(bpy::ptr(frame), tile_x, tile_y);
+        }
+
+        void default_post_update_tile(const Frame* frame, const size_t tile_x, const size_t tile_y)
+        {
+            ITileCallback::post_update_tile(frame, tile_x, tile_y);
+        }
     };
 }
 
@@ -104,5 +119,6 @@ void bind_tile_callback()
         .def("pre_render", &ITileCallback::pre_render, &ITileCallbackWrapper::default_pre_render)
         .def("post_render_tile", &ITileCallback::post_render_tile, &ITileCallbackWrapper::default_post_render_tile)
         .def("post_render", &ITileCallback::post_render, &ITileCallbackWrapper::default_post_render)
+        .def("post_update_tile", &ITileCallback::post_update_tile, &ITileCallbackWrapper::default_post_update_tile)
         ;
 }
@@ -102,6 +102,16 @@ namespace
             emit signal_update();
         }
 
+        virtual void post_update_tile(
+            const Frame*    frame,
+            const size_t    tile_x,
+            const size_t    tile_y) APPLESEED_OVERRIDE
+        {
+            assert(m_render_widget);
+            m_render_widget->blit_tile(*frame, tile_x, tile_y);
+            emit signal_update();
+        }
+
       signals:
         void signal_update();
 
@@ -324,7 +324,11 @@ void RenderingManager::archive_frame_to_disk()
           bf::path(Application::get_root_path())
         / "images" / "autosave";
 
-    m_project->get_frame()->archive(autosave_path.string().c_str());
+    // Rendering has ended: reuse the rendering thread budget.
+    m_project->get_frame()->archive(
+        autosave_path.string().c_str(),
+        0,
+        get_rendering_thread_count(m_params));
 }
 
 void RenderingManager::run_scheduled_actions()
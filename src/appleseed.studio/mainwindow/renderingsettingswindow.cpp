@@ -605,6 +605,7 @@ namespace
             QComboBox* combobox = create_combobox("engine");
             combobox->addItem("Distribution Ray Tracer", "drt");
             combobox->addItem("Unidirectional Path Tracer", "pt");
+            combobox->addItem("Bidirectional Path Tracer", "bdpt");
             combobox->addItem("Stochastic Progressive Photon Mapping", "sppm");
             construct(config, combobox);
         }
@@ -712,14 +713,19 @@ namespace
             groupbox->setLayout(sublayout);
 
             sublayout->addWidget(create_checkbox("lighting_components.ibl", "Image-Based Lighting"));
+            sublayout->addWidget(create_checkbox("lighting_components.irradiance_cache", "Irradiance Cache"));
 
             create_bounce_settings_group(layout, "drt");
             create_drt_advanced_settings(layout);
 
-            create_direct_link("lighting_components.ibl",     "drt.enable_ibl");
-            create_direct_link("drt.bounces.rr_start_bounce", "drt.rr_min_path_length");
-            create_direct_link("advanced.dl.light_samples",   "drt.dl_light_samples");
-            create_direct_link("advanced.ibl.env_samples",    "drt.ibl_env_samples");
+            create_direct_link("lighting_components.ibl",                "drt.enable_ibl");
+            create_direct_link("lighting_components.irradiance_cache",   "drt.enable_irradiance_cache");
+            create_direct_link("drt.bounces.rr_start_bounce",            "drt.rr_min_path_length");
+            create_direct_link("advanced.dl.light_samples",              "drt.dl_light_samples");
+            create_direct_link("advanced.ibl.env_samples",               "drt.ibl_env_samples");
+            create_direct_link("advanced.irradiance_cache.max_error",    "drt.irradiance_cache_max_error");
+            create_direct_link("advanced.irradiance_cache.grid_spacing", "drt.irradiance_cache_grid_spacing");
+            create_direct_link("advanced.irradiance_cache.samples",      "drt.irradiance_cache_samples");
 
             load_directly_linked_values(config);
 
@@ -744,6 +750,7 @@ namespace
 
             create_drt_advanced_dl_settings(layout);
             create_drt_advanced_ibl_settings(layout);
+            create_drt_advanced_irradiance_cache_settings(layout);
         }
 
         void create_drt_advanced_dl_settings(QVBoxLayout* parent)
@@ -773,6 +780,19 @@ namespace
 
             sublayout->addLayout(create_form_layout("Environment Samples:", create_double_input("advanced.ibl.env_samples", 0.0, 1000000.0, 3, 1.0)));
         }
+
+        void create_drt_advanced_irradiance_cache_settings(QVBoxLayout* parent)
+        {
+            QGroupBox* groupbox = new QGroupBox("Irradiance Cache");
+            parent->addWidget(groupbox);
+
+            QFormLayout* layout = create_form_layout();
+            groupbox->setLayout(layout);
+
+            layout->addRow("Max Error:", create_double_input("advanced.irradiance_cache.max_error", 0.01, 1.0, 2, 0.05));
+            layout->addRow("Grid Spacing:", create_integer_input("advanced.irradiance_cache.grid_spacing", 1, 1024, 1));
+            layout->addRow("Samples:", create_integer_input("advanced.irradiance_cache.samples", 1, 1000000, 1));
+        }
     };
 
     //
@@ -888,6 +908,48 @@ namespace
         }
     };
 
+    //
+    // Bidirectional Path Tracer panel.
+    //
+
+    class BidirectionalPathTracerPanel
+      : public LightingEnginePanel
+    {
+      public:
+        BidirectionalPathTracerPanel(const Configuration& config, QWidget* parent = 0)
+          : LightingEnginePanel("Bidirectional Path Tracer", parent)
+        {
+            fold();
+
+            QVBoxLayout* layout = new QVBoxLayout();
+            container()->setLayout(layout);
+
+            QGroupBox* groupbox = new QGroupBox("Components");
+            layout->addWidget(groupbox);
+
+            QVBoxLayout* sublayout = new QVBoxLayout();
+            groupbox->setLayout(sublayout);
+
+            sublayout->addWidget(create_checkbox("lighting_components.ibl", "Image-Based Lighting"));
+
+            create_bounce_settings_group(layout, "bdpt");
+
+            create_direct_link("lighting_components.ibl",      "bdpt.enable_ibl");
+            create_direct_link("bdpt.bounces.rr_start_bounce", "bdpt.rr_min_path_length");
+
+            load_directly_linked_values(config);
+
+            load_bounce_settings(config, "bdpt", "bdpt.max_path_length");
+        }
+
+        virtual void save_config(Configuration& config) const APPLESEED_OVERRIDE
+        {
+            save_directly_linked_values(config);
+
+            save_bounce_settings(config, "bdpt", "bdpt.max_path_length");
+        }
+    };
+
     //
     // Stochastic Progressive Photon Mapping panel.
     //
@@ -1233,7 +1295,10 @@ void RenderingSettingsWindow::create_panels(const Configuration& config)
     m_panels.push_back(new UnidirectionalPathTracerPanel(config));
 
     if (!interactive)
+    {
+        m_panels.push_back(new BidirectionalPathTracerPanel(config));
         m_panels.push_back(new SPPMPanel(config));
+    }
 
     m_panels.push_back(new SystemPanel(config));
 }
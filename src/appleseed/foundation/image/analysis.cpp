@@ -118,6 +118,18 @@ double compute_average_luminance(const Image& image)
         : 0.0;
 }
 
+double compute_average_luminance(const Tile& tile)
+{
+    double accumulated_luminance = 0.0;
+    size_t relevant_pixel_count = 0;
+
+    accumulate_luminance(tile, accumulated_luminance, relevant_pixel_count);
+
+    return relevant_pixel_count > 0
+        ? accumulated_luminance / relevant_pixel_count
+        : 0.0;
+}
+
 bool are_images_compatible(const Image& image1, const Image& image2)
 {
     const CanvasProperties& props1 = image1.properties();
@@ -38,6 +38,7 @@
 
 // Forward declarations.
 namespace foundation    { class Image; }
+namespace foundation    { class Tile; }
 
 namespace foundation
 {
@@ -50,6 +51,10 @@ namespace foundation
 // Pixels containing NaN values are skipped.
 APPLESEED_DLLSYMBOL double compute_average_luminance(const Image& image);
 
+// Compute the average Rec. 709 relative luminance of a linear RGB tile.
+// Pixels containing NaN values are skipped.
+APPLESEED_DLLSYMBOL double compute_average_luminance(const Tile& tile);
+
 
 //
 // Image comparisons.
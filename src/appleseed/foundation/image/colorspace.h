@@ -244,6 +244,12 @@ Color<T, 3> ciexyz_to_linear_rgb(const Color<T, 3>& xyz);
 template <typename T>
 Color<T, 3> linear_rgb_to_ciexyz(const Color<T, 3>& linear_rgb);
 
+#ifdef APPLESEED_USE_SSE
+// Variant of the above function operating on the first three components of a SIMD vector.
+// The fourth component of the result is set to zero.
+inline __m128 linear_rgb_to_ciexyz(const __m128 linear_rgb);
+#endif
+
 
 //
 // CIE XYZ <-> CIE xyY transformations.
@@ -304,6 +310,10 @@ inline __m128 faster_linear_rgb_to_srgb(const __m128 linear_rgb);
 Color3f faster_linear_rgb_to_srgb(const Color3f& linear_rgb);
 Color3f faster_srgb_to_linear_rgb(const Color3f& srgb);
 
+// Exact conversion of all 8-bit sRGB-encoded values to the linear RGB color space.
+// Allows 8-bit sRGB images to be kept encoded in memory and decoded on the fly.
+APPLESEED_DLLSYMBOL extern const float SRGBUInt8ToLinearRGB[256];
+
 
 //
 // Compute the relative luminance of a linear RGB triplet as defined
@@ -363,6 +373,15 @@ void daylight_ciexy_to_spectrum(
     const T                     y,
     SpectrumType&               spectrum);
 
+// Compute the weights of the basis vectors DaylightS1 and DaylightS2 for the CIE xy
+// chromaticity of a D series (daylight) illuminant. DaylightS0 has unit weight.
+template <typename T>
+void daylight_ciexy_to_basis_weights(
+    const T                     x,
+    const T                     y,
+    T&                          m1,
+    T&                          m2);
+
 
 //
 // Linear RGB to spectrum transformation.
@@ -608,6 +627,25 @@ inline Color<T, 3> linear_rgb_to_ciexyz(const Color<T, 3>& linear_rgb)
             T(0.0));
 }
 
+#ifdef APPLESEED_USE_SSE
+
+inline __m128 linear_rgb_to_ciexyz(const __m128 linear_rgb)
+{
+    // Broadcast the R, G and B components.
+    const __m128 r = _mm_shuffle_ps(linear_rgb, linear_rgb, _MM_SHUFFLE(0, 0, 0, 0));
+    const __m128 g = _mm_shuffle_ps(linear_rgb, linear_rgb, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 b = _mm_shuffle_ps(linear_rgb, linear_rgb, _MM_SHUFFLE(2, 2, 2, 2));
+
+    // Multiply by the columns of the transformation matrix.
+    __m128 xyz = _mm_mul_ps(r, _mm_set_ps(0.0f, 0.019334f, 0.212671f, 0.412453f));
+    xyz = _mm_add_ps(xyz, _mm_mul_ps(g, _mm_set_ps(0.0f, 0.119193f, 0.715160f, 0.357580f)));
+    xyz = _mm_add_ps(xyz, _mm_mul_ps(b, _mm_set_ps(0.0f, 0.950227f, 0.072169f, 0.180423f)));
+
+    return _mm_max_ps(xyz, _mm_setzero_ps());
+}
+
+#endif
+
 
 //
 // CIE XYZ <-> CIE xyY transformations implementation.
@@ -894,15 +932,26 @@ void ciexyz_illuminance_to_spectrum(
 // Convert the CIE xy chromaticity of a D series (daylight) illuminant to a spectrum.
 //
 
+template <typename T>
+inline void daylight_ciexy_to_basis_weights(
+    const T                     x,
+    const T                     y,
+    T&                          m1,
+    T&                          m2)
+{
+    const T rcp_m = T(1.0) / (T(0.0241) + T(0.2562) * x - T(0.7341) * y);
+    m1 = (T(-1.3515) - T(1.7703) * x + T(5.9114) * y) * rcp_m;
+    m2 = (T(0.0300) - T(31.4424) * x + T(30.0717) * y) * rcp_m;
+}
+
 template <>
 inline void daylight_ciexy_to_spectrum<float, RegularSpectrum31f>(
     const float                 x,
     const float                 y,
     RegularSpectrum31f&         spectrum)
 {
-    const float rcp_m = 1.0f / (0.0241f + 0.2562f * x - 0.7341f * y);
-    const float m1 = (-1.3515f - 1.7703f * x + 5.9114f * y) * rcp_m;
-    const float m2 = (0.0300f - 31.4424f * x + 30.0717f * y) * rcp_m;
+    float m1, m2;
+    daylight_ciexy_to_basis_weights(x, y, m1, m2);
 
     spectrum = DaylightS0;
 
@@ -125,9 +125,23 @@ class FilteredTile
         const float         y,
         const float*        values);
 
+    // Same as add() but without atomic updates. The caller must guarantee that
+    // no other thread accesses the pixels affected by the sample concurrently.
+    void add_exclusive(
+        const float         x,
+        const float         y,
+        const float*        values);
+
   protected:
     const AABB2u            m_crop_window;
     const Filter2f&         m_filter;
+
+  private:
+    template <bool AtomicUpdates>
+    void do_add(
+        const float         x,
+        const float         y,
+        const float*        values);
 };
 
 
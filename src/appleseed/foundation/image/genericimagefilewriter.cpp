@@ -34,6 +34,7 @@
 #include "foundation/core/exceptions/exceptionunsupportedfileformat.h"
 #include "foundation/image/exrimagefilewriter.h"
 #include "foundation/image/pngimagefilewriter.h"
+#include "foundation/image/tiffimagefilewriter.h"
 #include "foundation/utility/string.h"
 
 // Boost headers.
@@ -70,6 +71,11 @@ void GenericImageFileWriter::write(
         PNGImageFileWriter writer;
         writer.write(filename, image, image_attributes);
     }
+    else if (extension == ".tif" || extension == ".tiff")
+    {
+        TIFFImageFileWriter writer;
+        writer.write(filename, image, image_attributes);
+    }
     else
     {
         throw ExceptionUnsupportedFileFormat(filename);
@@ -34,6 +34,7 @@
 #include "foundation/core/exceptions/exceptionioerror.h"
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/exceptionunsupportedimageformat.h"
+#include "foundation/image/imageattributes.h"
 #include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
 
@@ -197,7 +198,18 @@ void GenericProgressiveImageFileReader::read_image_attributes(
 {
     assert(is_open());
 
-    // todo: implement.
+    // Only string attributes are retrieved for now.
+    const OIIO::ImageSpec& spec = impl->m_input->spec();
+    for (size_t i = 0; i < spec.extra_attribs.size(); ++i)
+    {
+        const OIIO::ParamValue& attr = spec.extra_attribs[i];
+
+        if (attr.type() == OIIO::TypeDesc::STRING && attr.nvalues() == 1)
+        {
+            const char* value = *static_cast<const char* const*>(attr.data());
+            attrs.insert(attr.name().c_str(), value);
+        }
+    }
 }
 
 Tile* GenericProgressiveImageFileReader::read_tile(
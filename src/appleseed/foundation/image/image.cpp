@@ -35,6 +35,7 @@
 #include "foundation/platform/types.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -135,20 +136,28 @@ Image::Image(
 
             for (size_t py = 0; py < tile_height; ++py)
             {
-                for (size_t px = 0; px < tile_width; ++px)
+                // Convert runs of pixels that are contiguous in the source image
+                // so that vectorized conversion kernels can be used.
+                size_t px = 0;
+                while (px < tile_width)
                 {
                     const size_t ix = tx * m_props.m_tile_width + px;
                     const size_t iy = ty * m_props.m_tile_height + py;
                     const uint8* source_pixel = source.pixel(ix, iy);
 
+                    const size_t source_tile_end = (ix / source_props.m_tile_width + 1) * source_props.m_tile_width;
+                    const size_t run_length = min(tile_width - px, source_tile_end - ix);
+
                     Pixel::convert(
                         source_props.m_pixel_format,
                         source_pixel,
-                        source_pixel + source_props.m_pixel_size,
+                        source_pixel + run_length * source_props.m_pixel_size,
                         1,
                         m_props.m_pixel_format,
                         tile->pixel(px, py),
                         1);
+
+                    px += run_length;
                 }
             }
         }
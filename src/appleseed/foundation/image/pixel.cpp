@@ -30,6 +30,12 @@
 // Interface header.
 #include "pixel.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+
+// Standard headers.
+#include <cstring>
+
 namespace foundation
 {
 
@@ -50,6 +56,49 @@ const char* pixel_format_name(const PixelFormat pixel_format)
     return "";
 }
 
+namespace
+{
+#ifdef APPLESEED_USE_SSE42
+
+    // Shuffle four-channel uint8 pixels using SSSE3 byte shuffles, four pixels at a time.
+    // Return the number of pixels that were shuffled.
+    size_t shuffle_uint8_rgba(
+        const uint8*        src,
+        const size_t        pixel_count,
+        const size_t        dest_channels,
+        uint8*              dest,
+        const size_t*       shuffle_table)
+    {
+        // Build the byte shuffling mask for a group of four pixels.
+        APPLESEED_SIMD4_ALIGN uint8 mask[16];
+        memset(mask, 0x80, sizeof(mask));
+        for (size_t p = 0; p < 4; ++p)
+        {
+            size_t d = 0;
+            for (size_t c = 0; c < 4; ++c)
+            {
+                if (shuffle_table[c] != Pixel::SkipChannel)
+                    mask[p * dest_channels + d++] = static_cast<uint8>(p * 4 + shuffle_table[c]);
+            }
+        }
+        const __m128i shuffle_mask = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+
+        // Each group writes 16 bytes but only advances by 4 * dest_channels bytes,
+        // so stop while the full store still fits in the destination.
+        size_t i = 0;
+        while (i + 4 <= pixel_count && (pixel_count - i) * dest_channels >= 16)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * dest_channels), _mm_shuffle_epi8(v, shuffle_mask));
+            i += 4;
+        }
+
+        return i;
+    }
+
+#endif
+}
+
 void Pixel::convert_and_shuffle(
     const PixelFormat   src_format,
     const size_t        src_channels,
@@ -64,6 +113,30 @@ void Pixel::convert_and_shuffle(
     const size_t src_channel_size = size(src_format);
     const size_t dest_channel_size = size(dest_format);
 
+#ifdef APPLESEED_USE_SSE42
+    // Fast path for the common case of shuffling RGBA uint8 pixels.
+    if (src_format == PixelFormatUInt8 &&
+        dest_format == PixelFormatUInt8 &&
+        src_channels == 4 &&
+        dest_channels > 0)
+    {
+        const size_t pixel_count =
+            (reinterpret_cast<const uint8*>(src_end) - reinterpret_cast<const uint8*>(src_begin)) / 4;
+
+        const size_t shuffled_count =
+            shuffle_uint8_rgba(
+                reinterpret_cast<const uint8*>(src_begin),
+                pixel_count,
+                dest_channels,
+                reinterpret_cast<uint8*>(dest),
+                shuffle_table);
+
+        // Let the generic code below handle the remaining pixels.
+        src_begin = reinterpret_cast<const uint8*>(src_begin) + shuffled_count * 4;
+        dest = reinterpret_cast<uint8*>(dest) + shuffled_count * dest_channels;
+    }
+#endif
+
     // Loop over all entries in the channel shuffling table.
     size_t dest_channel_offset = 0;
     for (size_t i = 0; i < src_channels; ++i)
@@ -38,6 +38,10 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+
 // OpenEXR headers.
 #include "foundation/platform/exrheaderguards.h"
 BEGIN_EXR_INCLUDES
@@ -73,6 +77,84 @@ enum PixelFormat
 APPLESEED_DLLSYMBOL const char* pixel_format_name(const PixelFormat pixel_format);
 
 
+//
+// Compile-time properties of pixel formats.
+//
+// PixelFormatTraits<Format>::ComponentType is the type used to store one channel
+// in a given pixel format, and to_float() converts a stored value to a 32-bit
+// floating-point value with the same rules as Pixel::convert_from_format().
+//
+
+template <PixelFormat Format>
+struct PixelFormatTraits;
+
+template <>
+struct PixelFormatTraits<PixelFormatUInt8>
+{
+    typedef uint8 ComponentType;
+
+    static float to_float(const ComponentType value)
+    {
+        return static_cast<float>(value) * (1.0f / 255);
+    }
+};
+
+template <>
+struct PixelFormatTraits<PixelFormatUInt16>
+{
+    typedef uint16 ComponentType;
+
+    static float to_float(const ComponentType value)
+    {
+        return static_cast<float>(value) * (1.0f / 65535);
+    }
+};
+
+template <>
+struct PixelFormatTraits<PixelFormatUInt32>
+{
+    typedef uint32 ComponentType;
+
+    static float to_float(const ComponentType value)
+    {
+        return static_cast<float>(value) * (1.0f / 4294967295UL);
+    }
+};
+
+template <>
+struct PixelFormatTraits<PixelFormatHalf>
+{
+    typedef half ComponentType;
+
+    static float to_float(const ComponentType value)
+    {
+        return static_cast<float>(value);
+    }
+};
+
+template <>
+struct PixelFormatTraits<PixelFormatFloat>
+{
+    typedef float ComponentType;
+
+    static float to_float(const ComponentType value)
+    {
+        return value;
+    }
+};
+
+template <>
+struct PixelFormatTraits<PixelFormatDouble>
+{
+    typedef double ComponentType;
+
+    static float to_float(const ComponentType value)
+    {
+        return static_cast<float>(value);
+    }
+};
+
+
 //
 // Pixel class, providing types and functions related to pixels.
 //
@@ -168,9 +250,144 @@ class Pixel
         const size_t        src_channels,   // number of source channels
         const size_t*       shuffle_table); // channel shuffling table
 
+    //
+    // The read_rgba() method reads a single pixel stored in a pixel format known at
+    // compile time and expands it to four 32-bit floating-point values. It is meant
+    // for hot paths such as texture lookups where the per-value format dispatch of
+    // convert_from_format() would dominate. Single-channel pixels are replicated to
+    // RGB, and alpha is set to 1 for pixels without an alpha channel.
+    //
+
+    template <PixelFormat Format>
+    static void read_rgba(
+        const uint8*        src,            // source pixel
+        const size_t        src_channels,   // number of source channels (1, 3 or 4)
+        float               dest[4]);       // destination RGBA values
+
 };
 
 
+//
+// SIMD kernels used by the Pixel class to convert contiguous ranges of values.
+//
+// Each kernel converts the largest prefix of the range that fits its vector width
+// and returns the number of values it converted; the caller converts the rest with
+// the scalar code. Results are identical to the ones of the scalar code, except
+// for float -> half conversions of NaN values which may produce a different NaN.
+//
+
+namespace impl
+{
+#ifdef APPLESEED_USE_SSE
+
+    // Lossless uint8 -> float conversion, 16 values at a time.
+    inline size_t convert_uint8_to_float(
+        const uint8*            src,
+        const size_t            count,
+        float*                  dest)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale = _mm_set1_ps(1.0f / 255);
+
+        const size_t simd_count = count & ~static_cast<size_t>(15);
+
+        for (size_t i = 0; i < simd_count; i += 16)
+        {
+            const __m128i v8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i lo16 = _mm_unpacklo_epi8(v8, zero);
+            const __m128i hi16 = _mm_unpackhi_epi8(v8, zero);
+
+            _mm_storeu_ps(dest + i +  0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo16, zero)), scale));
+            _mm_storeu_ps(dest + i +  4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo16, zero)), scale));
+            _mm_storeu_ps(dest + i +  8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi16, zero)), scale));
+            _mm_storeu_ps(dest + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi16, zero)), scale));
+        }
+
+        return simd_count;
+    }
+
+    // Lossy float -> uint8 conversion with clamping, 16 values at a time.
+    inline size_t convert_float_to_uint8(
+        const float*            src,
+        const size_t            count,
+        uint8*                  dest)
+    {
+        const __m128 scale = _mm_set1_ps(256.0f);
+        const __m128 lo = _mm_setzero_ps();
+        const __m128 hi = _mm_set1_ps(255.0f);
+
+        const size_t simd_count = count & ~static_cast<size_t>(15);
+
+        for (size_t i = 0; i < simd_count; i += 16)
+        {
+            // Scale, clamp and truncate. Values are in [0, 255] so packing with saturation is exact.
+            const __m128i v0 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i +  0), scale), lo), hi));
+            const __m128i v1 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i +  4), scale), lo), hi));
+            const __m128i v2 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i +  8), scale), lo), hi));
+            const __m128i v3 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 12), scale), lo), hi));
+
+            const __m128i v01 = _mm_packs_epi32(v0, v1);
+            const __m128i v23 = _mm_packs_epi32(v2, v3);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(v01, v23));
+        }
+
+        return simd_count;
+    }
+
+#else
+
+    inline size_t convert_uint8_to_float(const uint8*, const size_t, float*) { return 0; }
+    inline size_t convert_float_to_uint8(const float*, const size_t, uint8*) { return 0; }
+
+#endif
+
+    // F16C instructions are enabled alongside AVX2.
+#ifdef APPLESEED_USE_AVX2
+
+    // Lossless half -> float conversion, 8 values at a time.
+    inline size_t convert_half_to_float(
+        const half*             src,
+        const size_t            count,
+        float*                  dest)
+    {
+        const size_t simd_count = count & ~static_cast<size_t>(7);
+
+        for (size_t i = 0; i < simd_count; i += 8)
+        {
+            const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm256_storeu_ps(dest + i, _mm256_cvtph_ps(h));
+        }
+
+        return simd_count;
+    }
+
+    // Lossy float -> half conversion (round to nearest even), 8 values at a time.
+    inline size_t convert_float_to_half(
+        const float*            src,
+        const size_t            count,
+        half*                   dest)
+    {
+        const size_t simd_count = count & ~static_cast<size_t>(7);
+
+        for (size_t i = 0; i < simd_count; i += 8)
+        {
+            const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), h);
+        }
+
+        return simd_count;
+    }
+
+#else
+
+    inline size_t convert_half_to_float(const half*, const size_t, float*) { return 0; }
+    inline size_t convert_float_to_half(const float*, const size_t, half*) { return 0; }
+
+#endif
+}
+
+
 //
 // Pixel class implementation.
 //
@@ -253,7 +470,14 @@ inline void Pixel::convert_to_format<uint8>(
       case PixelFormatFloat:                // lossless uint8 -> float
         {
             float* typed_dest = reinterpret_cast<float*>(dest);
-            for (const uint8* it = src_begin; it < src_end; it += src_stride)
+            const uint8* it = src_begin;
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                const size_t n = impl::convert_uint8_to_float(it, src_end - it, typed_dest);
+                it += n;
+                typed_dest += n;
+            }
+            for (; it < src_end; it += src_stride)
             {
                 *typed_dest = static_cast<float>(*it) * (1.0f / 255);
                 typed_dest += dest_stride;
@@ -511,7 +735,14 @@ inline void Pixel::convert_to_format<half>(
       case PixelFormatFloat:                // lossless half -> float
         {
             float* typed_dest = reinterpret_cast<float*>(dest);
-            for (const half* it = src_begin; it < src_end; it += src_stride)
+            const half* it = src_begin;
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                const size_t n = impl::convert_half_to_float(it, src_end - it, typed_dest);
+                it += n;
+                typed_dest += n;
+            }
+            for (; it < src_end; it += src_stride)
             {
                 *typed_dest = static_cast<float>(*it);
                 typed_dest += dest_stride;
@@ -551,9 +782,15 @@ inline void Pixel::convert_to_format<float>(
     {
       case PixelFormatUInt8:                // lossy float -> uint8
         {
-            // todo: optimize this case using SSE?
             uint8* typed_dest = reinterpret_cast<uint8*>(dest);
-            for (const float* it = src_begin; it < src_end; it += src_stride)
+            const float* it = src_begin;
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                const size_t n = impl::convert_float_to_uint8(it, src_end - it, typed_dest);
+                it += n;
+                typed_dest += n;
+            }
+            for (; it < src_end; it += src_stride)
             {
                 const float val = clamp(*it * 256.0f, 0.0f, 255.0f);
                 *typed_dest = truncate<uint8>(val);
@@ -589,7 +826,14 @@ inline void Pixel::convert_to_format<float>(
       case PixelFormatHalf:                 // lossy float -> half
         {
             half* typed_dest = reinterpret_cast<half*>(dest);
-            for (const float* it = src_begin; it < src_end; it += src_stride)
+            const float* it = src_begin;
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                const size_t n = impl::convert_float_to_half(it, src_end - it, typed_dest);
+                it += n;
+                typed_dest += n;
+            }
+            for (; it < src_end; it += src_stride)
             {
                 *typed_dest = static_cast<half>(*it);
                 typed_dest += dest_stride;
@@ -774,6 +1018,12 @@ inline void Pixel::convert_from_format<uint8>(
       case PixelFormatFloat:                // lossy float -> uint8
         {
             const float* it = reinterpret_cast<const float*>(src_begin);
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                const size_t n = impl::convert_float_to_uint8(it, reinterpret_cast<const float*>(src_end) - it, dest);
+                it += n;
+                dest += n;
+            }
             for (; it < reinterpret_cast<const float*>(src_end); it += src_stride)
             {
                 const float val = clamp(*it * 256.0f, 0.0f, 255.0f);
@@ -993,6 +1243,12 @@ inline void Pixel::convert_from_format<float>(
       case PixelFormatUInt8:                // lossless uint8 -> float
         {
             const uint8* it = reinterpret_cast<const uint8*>(src_begin);
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                const size_t n = impl::convert_uint8_to_float(it, reinterpret_cast<const uint8*>(src_end) - it, dest);
+                it += n;
+                dest += n;
+            }
             for (; it < reinterpret_cast<const uint8*>(src_end); it += src_stride)
             {
                 *dest = static_cast<float>(*it) * (1.0f / 255);
@@ -1026,6 +1282,12 @@ inline void Pixel::convert_from_format<float>(
       case PixelFormatHalf:                 // lossless half -> float
         {
             const half* it = reinterpret_cast<const half*>(src_begin);
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                const size_t n = impl::convert_half_to_float(it, reinterpret_cast<const half*>(src_end) - it, dest);
+                it += n;
+                dest += n;
+            }
             for (; it < reinterpret_cast<const half*>(src_end); it += src_stride)
             {
                 *dest = static_cast<float>(*it);
@@ -1224,6 +1486,45 @@ inline void Pixel::convert(
     }
 }
 
+template <PixelFormat Format>
+inline void Pixel::read_rgba(
+    const uint8*            src,
+    const size_t            src_channels,
+    float                   dest[4])
+{
+    typedef PixelFormatTraits<Format> Traits;
+    typedef typename Traits::ComponentType ComponentType;
+
+    assert(src);
+    assert(dest);
+
+    const ComponentType* typed_src = reinterpret_cast<const ComponentType*>(src);
+
+    switch (src_channels)
+    {
+      case 1:
+        dest[0] = dest[1] = dest[2] = Traits::to_float(typed_src[0]);
+        dest[3] = 1.0f;
+        break;
+
+      case 3:
+        dest[0] = Traits::to_float(typed_src[0]);
+        dest[1] = Traits::to_float(typed_src[1]);
+        dest[2] = Traits::to_float(typed_src[2]);
+        dest[3] = 1.0f;
+        break;
+
+      case 4:
+        dest[0] = Traits::to_float(typed_src[0]);
+        dest[1] = Traits::to_float(typed_src[1]);
+        dest[2] = Traits::to_float(typed_src[2]);
+        dest[3] = Traits::to_float(typed_src[3]);
+        break;
+
+      assert_otherwise;
+    }
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_IMAGE_PIXEL_H
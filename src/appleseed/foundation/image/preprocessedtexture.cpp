@@ -0,0 +1,124 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "preprocessedtexture.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/image/imageattributes.h"
+#include "foundation/utility/siphash.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+namespace foundation
+{
+
+namespace
+{
+    // The hash is stored in the image description (the "comment" attribute of
+    // appleseed's image file writers) since this is the only free-form metadata
+    // that both the OpenEXR and the TIFF formats carry through OpenImageIO.
+    const char* const SourceHashPrefix = "appleseed:source_hash=";
+}
+
+void set_preprocessed_texture_source_hash(
+    ImageAttributes&        attributes,
+    const uint64            hash)
+{
+    attributes.insert("comment", SourceHashPrefix + to_string(hash));
+}
+
+bool get_preprocessed_texture_source_hash(
+    const ImageAttributes&  attributes,
+    uint64&                 hash)
+{
+    try
+    {
+        if (attributes.exist("ImageDescription"))
+        {
+            const string description = attributes.get<string>("ImageDescription");
+            const size_t prefix_length = strlen(SourceHashPrefix);
+
+            if (description.compare(0, prefix_length, SourceHashPrefix) == 0)
+            {
+                hash = from_string<uint64>(description.substr(prefix_length));
+                return true;
+            }
+        }
+
+        if (attributes.exist(PreprocessedTextureSourceHashAttribute))
+        {
+            hash = attributes.get<uint64>(PreprocessedTextureSourceHashAttribute);
+            return true;
+        }
+    }
+    catch (const ExceptionStringConversionError&)
+    {
+    }
+
+    return false;
+}
+
+uint64 compute_file_content_hash(const char* filepath)
+{
+    ifstream file(filepath, ios::in | ios::binary);
+
+    if (!file.is_open())
+        throw ExceptionIOError("could not open file", filepath);
+
+    // Hash the file by blocks, chaining the hash of the previous blocks into the key.
+    const size_t BlockSize = 64 * 1024;
+    char block[BlockSize];
+    uint64 hash = 0;
+    uint64 offset = 0;
+
+    while (file)
+    {
+        file.read(block, BlockSize);
+
+        const size_t count = static_cast<size_t>(file.gcount());
+        if (count == 0)
+            break;
+
+        hash = siphash24(block, count, hash, offset);
+        offset += count;
+    }
+
+    if (file.bad())
+        throw ExceptionIOError("could not read file", filepath);
+
+    return hash;
+}
+
+}   // namespace foundation
@@ -0,0 +1,103 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_IMAGE_PREPROCESSEDTEXTURE_H
+#define APPLESEED_FOUNDATION_IMAGE_PREPROCESSEDTEXTURE_H
+
+// appleseed.foundation headers.
+#include "foundation/image/pixel.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Forward declarations.
+namespace foundation    { class ImageAttributes; }
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+namespace foundation
+{
+
+//
+// Preprocessed textures are tiled image files produced offline (by the maketexture
+// tool) from arbitrary texture files. 8-bit and 16-bit textures are stored as tiled
+// TIFF files, all other textures as tiled OpenEXR files. Preprocessed textures are
+// stored next to their source file and carry the content hash of the source file
+// so that they can be picked up in place of the source file for as long as the
+// source file has not changed.
+//
+
+// Name of the image attribute holding the content hash of the source file in
+// preprocessed textures written by earlier versions of maketexture.
+const char* const PreprocessedTextureSourceHashAttribute = "appleseed:source_hash";
+
+// Default tile size of preprocessed textures, in pixels.
+const size_t PreprocessedTextureTileSize = 64;
+
+// Return the path to the preprocessed version of a given texture file,
+// given the pixel format of the preprocessed texture.
+std::string get_preprocessed_texture_path(
+    const std::string&  filepath,
+    const PixelFormat   pixel_format);
+
+// Record the content hash of the source file into the attributes of a preprocessed texture.
+APPLESEED_DLLSYMBOL void set_preprocessed_texture_source_hash(
+    ImageAttributes&    attributes,
+    const uint64        hash);
+
+// Retrieve the content hash of the source file from the attributes of a preprocessed
+// texture, as read back by an image file reader. Return false if there is none.
+APPLESEED_DLLSYMBOL bool get_preprocessed_texture_source_hash(
+    const ImageAttributes&  attributes,
+    uint64&                 hash);
+
+// Compute a hash of the content of a file.
+// Throws a foundation::ExceptionIOError exception if the file cannot be read.
+APPLESEED_DLLSYMBOL uint64 compute_file_content_hash(const char* filepath);
+
+
+//
+// Implementation.
+//
+
+inline std::string get_preprocessed_texture_path(
+    const std::string&  filepath,
+    const PixelFormat   pixel_format)
+{
+    return
+        pixel_format == PixelFormatUInt8 || pixel_format == PixelFormatUInt16
+            ? filepath + ".tiled.tif"
+            : filepath + ".tiled.exr";
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_IMAGE_PREPROCESSEDTEXTURE_H
@@ -0,0 +1,270 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "progressiveexrimagefilewriter.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/exceptionunsupportedimageformat.h"
+#include "foundation/image/exrutils.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/thread.h"
+
+// OpenEXR headers.
+#include "foundation/platform/exrheaderguards.h"
+BEGIN_EXR_INCLUDES
+#include "OpenEXR/IexBaseExc.h"
+#include "OpenEXR/ImathBox.h"
+#include "OpenEXR/ImfChannelList.h"
+#include "OpenEXR/ImfFrameBuffer.h"
+#include "OpenEXR/ImfHeader.h"
+#include "OpenEXR/ImfLineOrder.h"
+#include "OpenEXR/ImfMultiPartOutputFile.h"
+#include "OpenEXR/ImfPartType.h"
+#include "OpenEXR/ImfPixelType.h"
+#include "OpenEXR/ImfTileDescription.h"
+#include "OpenEXR/ImfTiledOutputPart.h"
+END_EXR_INCLUDES
+
+// Standard headers.
+#include <cassert>
+#include <memory>
+#include <vector>
+
+using namespace Iex;
+using namespace Imath;
+using namespace Imf;
+using namespace std;
+
+namespace foundation
+{
+
+//
+// ProgressiveEXRImageFileWriter class implementation.
+//
+
+namespace
+{
+    const char* ChannelName[] = { "R", "G", "B", "A" };
+
+    struct Part
+    {
+        CanvasProperties    m_props;
+        PixelType           m_pixel_type;
+    };
+}
+
+struct ProgressiveEXRImageFileWriter::Impl
+{
+    vector<Header>                  m_headers;
+    vector<Part>                    m_parts;
+    auto_ptr<MultiPartOutputFile>   m_file;
+    boost::mutex                    m_mutex;
+};
+
+ProgressiveEXRImageFileWriter::ProgressiveEXRImageFileWriter()
+  : impl(new Impl())
+{
+}
+
+ProgressiveEXRImageFileWriter::~ProgressiveEXRImageFileWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const ExceptionIOError&)
+    {
+        // Destructors must not throw.
+    }
+
+    delete impl;
+}
+
+void ProgressiveEXRImageFileWriter::add_part(
+    const char*             part_name,
+    const CanvasProperties& props,
+    const ImageAttributes&  image_attributes)
+{
+    assert(part_name);
+    assert(!is_open());
+
+    // todo: lift this limitation.
+    assert(props.m_channel_count <= 4);
+
+    Part part;
+    part.m_props = props;
+
+    // Figure out the pixel type, based on the pixel format of the image.
+    switch (props.m_pixel_format)
+    {
+      case PixelFormatUInt32: part.m_pixel_type = UINT; break;
+      case PixelFormatHalf: part.m_pixel_type = HALF; break;
+      case PixelFormatFloat: part.m_pixel_type = FLOAT; break;
+      default: throw ExceptionUnsupportedImageFormat();
+    }
+
+    // Construct TileDescription object.
+    const TileDescription tile_desc(
+        static_cast<unsigned int>(props.m_tile_width),
+        static_cast<unsigned int>(props.m_tile_height),
+        ONE_LEVEL);
+
+    // Construct ChannelList object.
+    ChannelList channels;
+    for (size_t c = 0; c < props.m_channel_count; ++c)
+        channels.insert(ChannelName[c], Channel(part.m_pixel_type));
+
+    // Construct Header object. Tiles are stored in the order they are written.
+    Header header(
+        static_cast<int>(props.m_canvas_width),
+        static_cast<int>(props.m_canvas_height));
+    header.setTileDescription(tile_desc);
+    header.channels() = channels;
+    header.lineOrder() = RANDOM_Y;
+    header.setName(part_name);
+    header.setType(TILEDIMAGE);
+
+    // Add image attributes to the Header object.
+    add_attributes(image_attributes, header);
+
+    impl->m_headers.push_back(header);
+    impl->m_parts.push_back(part);
+}
+
+size_t ProgressiveEXRImageFileWriter::get_part_count() const
+{
+    return impl->m_parts.size();
+}
+
+void ProgressiveEXRImageFileWriter::open(const char* filename)
+{
+    assert(filename);
+    assert(!is_open());
+    assert(!impl->m_headers.empty());
+
+    initialize_openexr();
+
+    try
+    {
+        // A file with a single part is written as a regular single-part file.
+        impl->m_file.reset(
+            new MultiPartOutputFile(
+                filename,
+                &impl->m_headers[0],
+                static_cast<int>(impl->m_headers.size()),
+                true));     // don't fail if parts have different shared attributes
+    }
+    catch (const BaseExc& e)
+    {
+        // I/O error.
+        throw ExceptionIOError(e.what());
+    }
+}
+
+bool ProgressiveEXRImageFileWriter::is_open() const
+{
+    return impl->m_file.get() != 0;
+}
+
+void ProgressiveEXRImageFileWriter::write_tile(
+    const Tile&             tile,
+    const size_t            tile_x,
+    const size_t            tile_y,
+    const size_t            part_index)
+{
+    assert(is_open());
+    assert(part_index < impl->m_parts.size());
+
+    const Part& part = impl->m_parts[part_index];
+
+    assert(tile.get_pixel_format() == part.m_props.m_pixel_format);
+    assert(tile.get_channel_count() == part.m_props.m_channel_count);
+    assert(tile_x < part.m_props.m_tile_count_x);
+    assert(tile_y < part.m_props.m_tile_count_y);
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    try
+    {
+        TiledOutputPart file(*impl->m_file, static_cast<int>(part_index));
+
+        const int ix              = static_cast<int>(tile_x);
+        const int iy              = static_cast<int>(tile_y);
+        const Box2i range         = file.dataWindowForTile(ix, iy);
+        const size_t channel_size = Pixel::size(tile.get_pixel_format());
+        const size_t stride_x     = channel_size * part.m_props.m_channel_count;
+        const size_t stride_y     = stride_x * tile.get_width();
+        const size_t tile_origin  = range.min.x * stride_x + range.min.y * stride_y;
+        const char* tile_base     = reinterpret_cast<const char*>(tile.pixel(0, 0)) - tile_origin;
+
+        // Construct FrameBuffer object.
+        FrameBuffer framebuffer;
+        for (size_t c = 0; c < part.m_props.m_channel_count; ++c)
+        {
+            const char* base = tile_base + c * channel_size;
+            framebuffer.insert(
+                ChannelName[c],
+                Slice(
+                    part.m_pixel_type,
+                    const_cast<char*>(base),
+                    stride_x,
+                    stride_y));
+        }
+
+        // Write tile.
+        file.setFrameBuffer(framebuffer);
+        file.writeTile(ix, iy);
+    }
+    catch (const BaseExc& e)
+    {
+        // I/O error.
+        throw ExceptionIOError(e.what());
+    }
+}
+
+void ProgressiveEXRImageFileWriter::close()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    try
+    {
+        // The file is finalized when the MultiPartOutputFile object is destroyed.
+        impl->m_file.reset();
+    }
+    catch (const BaseExc& e)
+    {
+        // I/O error.
+        throw ExceptionIOError(e.what());
+    }
+}
+
+}   // namespace foundation
@@ -0,0 +1,106 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_IMAGE_PROGRESSIVEEXRIMAGEFILEWRITER_H
+#define APPLESEED_FOUNDATION_IMAGE_PROGRESSIVEEXRIMAGEFILEWRITER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/imageattributes.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class CanvasProperties; }
+namespace foundation    { class Tile; }
+
+namespace foundation
+{
+
+//
+// An OpenEXR image file writer that writes tiles as soon as they are available.
+//
+// The file may contain several parts (for instance the beauty image followed by
+// one part per AOV). All parts must be declared before the file is opened. Tiles
+// may then be written in any order and from any thread; they are stored in the
+// file in the order they are written, so neither this class nor OpenEXR keeps
+// them in memory.
+//
+// Each tile must be written exactly once. The file is complete once all tiles of
+// all parts have been written, but it is valid as soon as it is closed.
+//
+
+class APPLESEED_DLLSYMBOL ProgressiveEXRImageFileWriter
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    ProgressiveEXRImageFileWriter();
+
+    // Destructor, closes the file if it is still open.
+    ~ProgressiveEXRImageFileWriter();
+
+    // Declare a part of the file. Parts are numbered in declaration order.
+    // The pixel format of the part must be UInt32, Half or Float.
+    void add_part(
+        const char*             part_name,
+        const CanvasProperties& props,
+        const ImageAttributes&  image_attributes = ImageAttributes());
+
+    // Return the number of declared parts.
+    size_t get_part_count() const;
+
+    // Open the file for writing.
+    void open(const char* filename);
+
+    // Return true if the file is open.
+    bool is_open() const;
+
+    // Write a tile of a given part. The pixel format and the number of channels
+    // of the tile must match the ones of the part. This method is thread-safe.
+    void write_tile(
+        const Tile&             tile,
+        const size_t            tile_x,
+        const size_t            tile_y,
+        const size_t            part_index = 0);
+
+    // Close the file.
+    void close();
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_IMAGE_PROGRESSIVEEXRIMAGEFILEWRITER_H
@@ -0,0 +1,195 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "tiffimagefilewriter.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/exceptionunsupportedimageformat.h"
+#include "foundation/image/icanvas.h"
+#include "foundation/image/imageattributes.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/string.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/oiioheaderguards.h"
+BEGIN_OIIO_INCLUDES
+#include "OpenImageIO/imageio.h"
+END_OIIO_INCLUDES
+
+// Standard headers.
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// TIFFImageFileWriter class implementation.
+//
+
+namespace
+{
+    OIIO::TypeDesc get_oiio_type(const PixelFormat pixel_format)
+    {
+        switch (pixel_format)
+        {
+          case PixelFormatUInt8: return OIIO::TypeDesc::UINT8;
+          case PixelFormatUInt16: return OIIO::TypeDesc::UINT16;
+          case PixelFormatUInt32: return OIIO::TypeDesc::UINT32;
+          case PixelFormatHalf: return OIIO::TypeDesc::HALF;
+          case PixelFormatFloat: return OIIO::TypeDesc::FLOAT;
+          case PixelFormatDouble: return OIIO::TypeDesc::DOUBLE;
+          default: throw ExceptionUnsupportedImageFormat();
+        }
+    }
+
+    void add_attributes(
+        const ImageAttributes&  image_attributes,
+        OIIO::ImageSpec&        spec)
+    {
+        for (const_each<ImageAttributes> i = image_attributes; i; ++i)
+        {
+            // Fetch the name and the value of the attribute.
+            const string attr_name = i->key();
+            const string attr_value = i->value<string>();
+
+            if (attr_name == "dpi")
+            {
+                const float dpi = from_string<float>(attr_value);
+                spec.attribute("XResolution", dpi);
+                spec.attribute("YResolution", dpi);
+                spec.attribute("ResolutionUnit", "in");
+            }
+
+            else if (attr_name == "author")
+                spec.attribute("Artist", attr_value);
+
+            else if (attr_name == "comment")
+                spec.attribute("ImageDescription", attr_value);
+
+            else if (attr_name == "creation_time")
+                spec.attribute("DateTime", attr_value);
+        }
+    }
+}
+
+void TIFFImageFileWriter::write(
+    const char*             filename,
+    const ICanvas&          image,
+    const ImageAttributes&  image_attributes)
+{
+    const CanvasProperties& props = image.properties();
+
+    OIIO::ImageSpec spec(
+        static_cast<int>(props.m_canvas_width),
+        static_cast<int>(props.m_canvas_height),
+        static_cast<int>(props.m_channel_count),
+        get_oiio_type(props.m_pixel_format));
+    spec.tile_width = static_cast<int>(props.m_tile_width);
+    spec.tile_height = static_cast<int>(props.m_tile_height);
+    spec.tile_depth = 1;
+    spec.attribute("compression", "zip");
+
+    add_attributes(image_attributes, spec);
+
+    OIIO::ImageOutput* output = OIIO::ImageOutput::create(filename);
+
+    if (output == 0)
+        throw ExceptionIOError(OIIO::geterror().c_str());
+
+    if (!output->open(filename, spec))
+    {
+        const string error = output->geterror();
+        delete output;
+        throw ExceptionIOError(error.c_str());
+    }
+
+    // Tiles on the right and bottom edges of the image may be smaller than the nominal
+    // tile size, but OpenImageIO always expects full tiles: pad them into this buffer.
+    const size_t row_size = props.m_tile_width * props.m_pixel_size;
+    vector<uint8> padded_tile(props.m_tile_height * row_size, 0);
+
+    bool success = true;
+
+    for (size_t y = 0; success && y < props.m_tile_count_y; ++y)
+    {
+        for (size_t x = 0; success && x < props.m_tile_count_x; ++x)
+        {
+            const Tile& tile = image.tile(x, y);
+            const void* data = tile.get_storage();
+
+            if (tile.get_width() != props.m_tile_width ||
+                tile.get_height() != props.m_tile_height)
+            {
+                const size_t tile_row_size = tile.get_width() * props.m_pixel_size;
+
+                for (size_t py = 0; py < tile.get_height(); ++py)
+                {
+                    memcpy(
+                        &padded_tile[py * row_size],
+                        tile.get_storage() + py * tile_row_size,
+                        tile_row_size);
+                }
+
+                data = &padded_tile[0];
+            }
+
+            success =
+                output->write_tile(
+                    static_cast<int>(x * props.m_tile_width),
+                    static_cast<int>(y * props.m_tile_height),
+                    0,
+                    spec.format,
+                    data);
+        }
+    }
+
+    if (success)
+        success = output->close();
+
+    if (!success)
+    {
+        const string error = output->geterror();
+        delete output;
+        throw ExceptionIOError(error.c_str());
+    }
+
+    delete output;
+}
+
+}   // namespace foundation
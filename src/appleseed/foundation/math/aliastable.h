@@ -0,0 +1,251 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_ALIASTABLE_H
+#define APPLESEED_FOUNDATION_MATH_ALIASTABLE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// Alias table for sampling a discrete distribution in constant time.
+//
+// The interface mirrors the one of foundation::CDF so that both are interchangeable.
+// Sampling only costs two memory accesses regardless of the number of items, but
+// the mapping from x to items is not monotonic: use foundation::CDF when samples
+// must be warped in order (e.g. to preserve the stratification of x across items).
+//
+// References:
+//
+//   A. J. Walker, An Efficient Method for Generating Discrete Random Variables
+//   with General Distributions, ACM TOMS, 1977.
+//
+//   M. D. Vose, A Linear Algorithm for Generating Random Numbers with a Given
+//   Distribution, IEEE TSE, 1991.
+//
+
+template <typename Item, typename Weight>
+class AliasTable
+  : public NonCopyable
+{
+  public:
+    typedef std::pair<Item, Weight> ItemWeightPair;
+
+    // Constructor.
+    AliasTable();
+
+    // Return true if the table is empty.
+    bool empty() const;
+
+    // Return true if the table has at least one item with a positive weight.
+    bool valid() const;
+
+    // Return the sum of the weight of all inserted items.
+    Weight weight() const;
+
+    // Remove all items from the table.
+    void clear();
+
+    // Allocate memory for a given number of items.
+    void reserve(const size_t count);
+
+    // Insert an item with a given non-negative weight.
+    void insert(const Item& item, const Weight weight);
+
+    // Access the i'th item, in insertion order.
+    const ItemWeightPair& operator[](const size_t i) const;
+
+    // Prepare the table for sampling.
+    // This method must be called once and only once before sample() is called.
+    void prepare();
+
+    // Sample the table. x is in [0,1).
+    const ItemWeightPair& sample(const Weight x) const;
+
+  private:
+    struct Bin
+    {
+        Weight  m_threshold;            // probability to return the bin's own item
+        uint32  m_alias;                // item returned otherwise
+    };
+
+    typedef std::vector<ItemWeightPair> ItemVector;
+    typedef std::vector<Bin> BinVector;
+
+    ItemVector          m_items;
+    Weight              m_weight_sum;
+    BinVector           m_bins;
+};
+
+
+//
+// AliasTable class implementation.
+//
+
+template <typename Item, typename Weight>
+inline AliasTable<Item, Weight>::AliasTable()
+  : m_weight_sum(0.0)
+{
+}
+
+template <typename Item, typename Weight>
+inline bool AliasTable<Item, Weight>::empty() const
+{
+    return m_items.empty();
+}
+
+template <typename Item, typename Weight>
+inline bool AliasTable<Item, Weight>::valid() const
+{
+    return m_weight_sum > Weight(0.0);
+}
+
+template <typename Item, typename Weight>
+inline Weight AliasTable<Item, Weight>::weight() const
+{
+    return m_weight_sum;
+}
+
+template <typename Item, typename Weight>
+inline void AliasTable<Item, Weight>::clear()
+{
+    m_items.clear();
+    m_weight_sum = Weight(0.0);
+    m_bins.clear();
+}
+
+template <typename Item, typename Weight>
+inline void AliasTable<Item, Weight>::reserve(const size_t count)
+{
+    m_items.reserve(count);
+}
+
+template <typename Item, typename Weight>
+inline void AliasTable<Item, Weight>::insert(const Item& item, const Weight weight)
+{
+    assert(weight >= Weight(0.0));
+    m_items.push_back(std::make_pair(item, weight));
+    m_weight_sum += weight;
+}
+
+template <typename Item, typename Weight>
+inline const std::pair<Item, Weight>& AliasTable<Item, Weight>::operator[](const size_t i) const
+{
+    assert(i < m_items.size());
+    return m_items[i];
+}
+
+template <typename Item, typename Weight>
+void AliasTable<Item, Weight>::prepare()
+{
+    assert(valid());
+
+    const size_t item_count = m_items.size();
+    assert(item_count <= 0xFFFFFFFFUL);
+
+    // Normalize weights so that they add up to 1.0.
+    const Weight rcp_weight_sum = Weight(1.0) / m_weight_sum;
+    for (size_t i = 0; i < item_count; ++i)
+        m_items[i].second *= rcp_weight_sum;
+
+    // Scale probabilities so that they average to 1.0 and split items into
+    // underfull and overfull bins. Use double precision to limit the drift
+    // accumulated while redistributing probabilities.
+    std::vector<double> scaled(item_count);
+    std::vector<size_t> small, large;
+    size_t max_item = 0;
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        scaled[i] = static_cast<double>(m_items[i].second) * item_count;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+        if (m_items[i].second > m_items[max_item].second)
+            max_item = i;
+    }
+
+    // Fill each underfull bin with probability taken from an overfull one (Vose's method).
+    m_bins.resize(item_count);
+    while (!small.empty() && !large.empty())
+    {
+        const size_t s = small.back();
+        const size_t l = large.back();
+        small.pop_back();
+
+        m_bins[s].m_threshold = static_cast<Weight>(std::max(scaled[s], 0.0));
+        m_bins[s].m_alias = static_cast<uint32>(l);
+
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Remaining bins are full, up to numerical errors. Never let an item with
+    // zero weight be selected because of these errors.
+    small.insert(small.end(), large.begin(), large.end());
+    for (size_t i = 0, e = small.size(); i < e; ++i)
+    {
+        const size_t b = small[i];
+        const bool positive = m_items[b].second > Weight(0.0);
+        m_bins[b].m_threshold = positive ? Weight(1.0) : Weight(0.0);
+        m_bins[b].m_alias = static_cast<uint32>(positive ? b : max_item);
+    }
+}
+
+template <typename Item, typename Weight>
+inline const std::pair<Item, Weight>& AliasTable<Item, Weight>::sample(const Weight x) const
+{
+    assert(!m_bins.empty());
+    assert(x >= Weight(0.0));
+    assert(x < Weight(1.0));
+
+    // Select a bin, then reuse the fractional part of x to choose between its two items.
+    const size_t bin_count = m_bins.size();
+    const double scaled_x = static_cast<double>(x) * bin_count;
+    const size_t i = std::min(static_cast<size_t>(scaled_x), bin_count - 1);
+    const Weight y = static_cast<Weight>(scaled_x - i);
+
+    const Bin& bin = m_bins[i];
+    return m_items[y < bin.m_threshold ? i : bin.m_alias];
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_ALIASTABLE_H
@@ -0,0 +1,107 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "bluenoise.h"
+
+namespace foundation
+{
+
+//
+// 64x64 blue-noise mask (see the GenerateBlueNoiseTile test case in test_bluenoise.cpp).
+//
+
+const uint16 BlueNoiseTile[BlueNoiseTileSize * BlueNoiseTileSize] =
+{
+    2853,  312,  839, 2129, 1120, 3873, 1901, 3396, 1094, 1742,  531, 2128, 1458,  265, 2451, 3738,  913, 2694, 1720, 3363,  895, 2633,  469, 3909, 1996, 2883, 2209, 3783,   63, 1215, 2091,  299, 3717, 1932,  217, 3180, 3981,  339, 1860, 3200, 1351,  359, 2255, 3695, 1123, 4041, 1339, 3169, 3870,  701, 2310, 1194, 3279, 1553,  966, 2885, 1669, 2639,  125, 1445, 3892, 1119, 3344,  765,
+    1227, 3712, 1542, 3452, 2777,  475, 1417, 2231,  197, 2963, 2379, 3632, 2759, 1856,  708, 2102, 2972, 1413,  602, 2521, 3860, 1774, 2988, 1506,  813, 3476,  524, 2667, 1879, 2469, 3896, 2698, 3070,  613, 1374, 2485,  725, 2197, 3667,  549, 1013, 2926, 3435, 1504,  593, 2902, 2208,  952, 2537, 1418, 3574,   50, 2787, 2206,  209, 3544, 1250, 3227, 3743, 2454,  366, 2793, 1632, 2280,
+    3015, 1972,   31, 2329,  693, 3220, 2503, 3586,  799, 3998, 1238,   58,  953, 3477, 1298, 3276,  109, 3801, 3168,  288, 1354,  667, 3615,  107, 2555, 1725, 1274, 3642,  871, 3358,  687, 1137, 1582, 2283, 3816, 2799, 1199, 3440, 1514, 2658, 4014, 1825,   19, 2524, 1951, 3479,  121, 3727, 1826,  480, 2049, 3014,  779, 1853, 3946, 2361,  440, 1911,  682, 2144,  949, 3606,  557, 3976,
+     973, 3304, 2688, 1269, 4055, 1695,  269, 1167, 2720, 1602, 3312, 2028, 3088, 3889,  446, 2569, 1785, 1113, 2245, 1909, 3453, 2414, 2112, 1200, 3984, 2945,  348, 3111, 1481,  271, 1792, 3207,  131, 3423,  944, 1815,   68, 2939,  914,  223, 2295, 3174, 1264, 3847,  827, 2709, 1581,  398, 3268, 2670, 3803, 1089, 3409, 1359,  563, 3126, 1025, 2841, 3422, 1592, 3134, 2567, 1894,  231,
+    2480,  642, 1754, 3563,  945, 2111, 3051, 3789, 1963,  375, 2594,  635, 1370, 1726, 2288,  856, 3515, 2765,  698, 3993,  995, 2814,  448, 3162, 1906,  990, 2362, 2006, 4075, 2580, 2187, 3842, 2743, 1966,  479, 3151, 3911, 2017, 2456, 3364, 1642,  739, 2113,  424, 3302, 1162, 2287, 2976, 1224,  689, 1628,  310, 2462, 3677, 2707, 1702, 3846,   20, 1220, 4058,  273, 1173, 3411, 1497,
+    2094, 3930,  374, 2888,  152, 2596, 1473,  654, 3395, 1031, 3843, 2199, 2806,  257, 2980, 4046, 1461,  234, 3064, 1575,    2, 3315, 1658,  770, 3767,  162, 3521,  665, 1121, 2910,  546,  896, 1266, 3681, 2549, 1318, 1597,  655, 3696, 1191,  327, 3922, 2592, 2989, 1783, 3753,  555, 3590, 2089, 3916, 2314, 3206, 1956,  130,  841, 2165, 1424, 2332, 2629, 1964,  611, 2294, 2880, 3758,
+    1081, 3037, 1411, 1994, 3318, 3704,  410, 2315, 2830, 1738,  150, 3516,  911, 3284, 1196,  562, 1948, 2410, 3665, 2088, 2587, 1251, 3599, 2167, 2535, 1512, 2785, 1709, 3226,   23, 3534, 1684, 2343,  343,  800, 3548, 2261,  394, 3081, 1857, 2862, 3550, 1026, 1499,  143, 2473,  959, 1733,   62, 2749,  936, 1464, 4039, 1214, 2918, 3345,  404, 3637,  879, 2937, 3485, 1400,  773,   88,
+    1715, 3519,  823, 2365, 1176, 1771,  922, 3907, 1306, 3125, 2445, 1453, 1877, 3780, 2155, 2733, 3346,  435, 1160,  731, 3879,  368, 2895,  523, 1041, 3428,  403, 3914, 2430, 1439, 2043, 2991, 4008, 3239, 1899, 2887, 1063, 4077, 2623,  787, 1425, 2027,  566, 3234, 2169, 4066, 2842, 3339, 1407, 3509,  434, 3002,  617, 2531, 3585, 1823,  696, 3072, 1692,  224, 3850, 1852, 3258, 2673,
+    2227,  494, 2627, 3874,  586, 2788, 3209, 2019,  275,  786, 4026,  554, 2617,   30,  776, 1352, 3841, 1699, 2779, 3178, 1474, 2317, 1810, 4033, 3138, 2029, 1255, 2192,  933, 3733,  660, 1130,  168, 1496, 2656,  280, 3415, 1668,   38, 2282, 3430,  264, 2455, 3669,  753, 1228,  274, 2015,  707, 2427, 1888, 3761, 2136, 1578,  251, 1082, 2432, 3989, 1314, 2205,  997, 2471,  329, 3705,
+    1282, 3289,  208, 1646, 3444,   13, 2461, 1515, 3566, 2267, 1182, 2961, 3475, 1643, 3187, 2460,  199,  964, 3593, 1941,  171, 3349,  843, 1386,   65, 2665,  719, 3074,  237, 2534, 3429, 2805, 2200,  916, 3750,  681, 1346, 2046, 3223, 1092, 3760, 2731, 1319, 1866, 2931, 1657, 2546, 3122, 3957, 1132, 2792,  113,  972, 3110, 3887, 2727, 2044,   78, 3329, 2760,  498, 3080, 1539,  883,
+    3857, 1908, 3097, 1348, 2175, 4086, 1097,  630, 2735, 3253, 1915,  353, 2194, 1024, 3972, 1903, 2994, 2196,  565, 2553, 1102, 3809, 2784, 2443, 3644, 1762, 3859, 1503, 3301, 1861,  471, 1663, 3875, 2477, 1841, 3007, 2306, 3852,  624, 2948, 1735,  844, 3952,  100, 3384,  502, 3739,  974,  346, 1705, 3310, 1381, 3558, 2301,  491, 1287, 2993,  824, 1577, 3582, 1183, 4044, 2085, 2848,
+     622, 2479, 1008, 2706,  730, 1891, 3038, 3721,  139, 1662,  890, 3638, 1396, 2859,  656,  365, 3412, 1245, 4088, 3090, 1580,  454, 2007,  631, 1158,  380, 2832, 2347, 1058, 4052, 1340, 3163,  378, 1273,   96, 3321, 1009,  249, 2457, 1384,  401, 2164, 3131, 1125, 2418, 2076, 1380, 2813, 2327, 3678,  629, 2526, 1867,  792, 1703, 3469, 3824, 1922,  408, 2340, 1802,  714, 3325,   51,
+    1666, 3596,  400, 3821, 3314,  294, 1559, 2234, 1300, 3867, 2488, 3156,  165, 3748, 2387, 1522, 2664, 1756,   55,  832, 2293, 3572, 2952, 1655, 3167, 3517, 2058,  103,  666, 2601, 2124,  877, 3482, 2628, 3691, 1527, 2795, 3547, 1796, 4030, 3299, 2593,  596, 1617, 3855,  818, 3504,   18, 1919, 1295, 3046,  372, 4087, 3199, 2466,  289, 1001, 2578, 3219, 3774,  181, 2626, 1258, 2378,
+     819, 3010, 2069, 1284, 2344, 2858,  860, 3379, 2682,  510, 1982,  742, 2712, 1750, 1168, 3538,  763, 3784, 2849, 1974, 3247, 1184,  116, 4001, 2252,  939, 1362, 3357, 2953, 3623,  178, 2872, 1780,  706, 2183,  495, 2012,  816, 2681, 1146,  157, 1887, 3533, 2960,  326, 2641, 1736, 3140, 3926,  861, 2716, 2053, 1144,   98, 1387, 2932, 2109,  573, 1438, 1085, 3000, 3545, 1939, 3941,
+    1143, 3461,  220, 1710,  601, 3628, 1836,  215, 1067, 3483, 1508, 4051, 2158,  460, 3201, 1995,  259, 2416, 1398, 3650,  318, 2603, 1488,  729, 2687,  415, 3833, 1639, 1958, 1134, 1511, 2376, 3854, 1111, 3034, 3994, 1315, 3230,  441, 2256, 3675, 1465,  935, 2285, 1341, 3343,  525, 1109, 2172,  245, 3608, 1557, 3408, 2647, 3791, 1812, 3352, 4025, 2812, 2202,  836, 1546,  477, 2876,
+    2274, 1480, 2559, 4012, 3214, 1151, 2540, 3949, 2996, 2289,   32, 1139, 3062,  923, 3849, 2791, 1065, 3273,  506,  991, 1772, 3880, 2157, 3285, 1820, 3073, 2498,  797,  340, 3970, 3119,  504, 3308,  213, 1660, 2323,   33, 3778, 1640, 2992,  746, 2780, 3830,   81, 2047, 4060, 2467, 2950, 1494, 3237, 2397,  533,  929, 2219,  466,  802, 1202,   15, 1678,  345, 3811, 2441, 3348,  119,
+    3726,  556, 2896,  928, 2117,  367, 1469, 2026,  754, 1724, 2845, 3672, 2436, 1440,  153, 2278, 1544, 3997, 2142, 3076, 2775,  425,  878, 3685,  185, 1108, 2093, 3594, 2772, 2248,  891, 2064, 1389, 2564, 3426,  868, 2927, 2509, 1059, 3413, 2032,  465, 2520, 3120, 1019,  659, 1631,  357, 3802,  774, 1840, 3987, 2846, 1731, 3507, 3012, 2345, 2686, 3497, 3148, 1858,  620, 1312, 2000,
+     985, 3272, 1898,   47, 3084, 3679, 2739,  499, 3742, 3335,  389, 1605,  609, 3288, 1835, 3597,  334, 2636,  722, 1588, 3436, 2452, 1368, 2857, 1571, 4068,  486, 1343, 3269,   10, 1686, 3737, 2810,  679, 1973, 3635, 1484,  595, 1923,  202, 3967, 1188, 1671, 3437, 1904, 2826, 3535, 2268, 1055, 2766,   59, 1301, 3149,  200, 1449, 3934, 1869,  603, 1363,  907, 2547, 3011, 4065, 2748,
+    2374, 1595, 3866, 1239, 2422, 1697, 1007, 3173, 1325, 2481,  971, 2104, 2657, 3901,  829, 2951, 1316, 1931, 3731,   25, 1147, 1943, 3567,  569, 2346, 3188, 2651, 1847,  700, 2440, 3525, 1057,  255, 4091, 1237,  309, 2171, 3884, 2767, 1388, 3152, 2381,  762,  287, 3751, 1257,  124, 3102, 1975, 3486, 2486, 3663, 2105, 1103, 2570,  369, 1010, 3662, 2119, 3893,  138, 1110, 1665,  278,
+    3490,  436, 2713,  710, 3470,  281, 4072, 2150,  179, 1842, 3963, 3077,   92, 1195, 2337,  452, 3474, 1021, 3194, 2335, 4024,  291, 3068, 1083, 1790,   91, 3458, 1034, 3935, 2867, 1369, 3137, 2405, 1730, 2990, 2608, 3246,  909, 3489,  522, 2163, 3646, 2802, 1426, 2609, 2162,  902, 3939, 1401,  592, 1611,  898,  476, 3810, 3341, 2214, 2838, 3193,  438, 1745, 3377, 2217, 3619,  831,
+    3127, 1422, 2223, 3030, 1969, 1391, 2893,  795, 2672, 3495,  539, 1410, 3647, 1961, 3231, 1624, 2717, 2152,  512, 1451, 2729,  772, 2212, 3796, 2815,  783, 1507, 2233,  236, 2001,  443,  788, 2132, 3405,  561, 1074, 1630,  134, 2431, 1747,  993,   74, 1862, 3988,  501, 3319, 1741, 2645,  263, 2986, 3323, 2284, 2817, 1926,  691, 1676,  172, 1491, 2394, 2721, 1262,  588, 2819, 1883,
+    1087, 3942,  122,  996, 3792,  528, 2395, 3407, 1561, 1077, 2869, 2281,  889, 2757,  684, 4079,  112, 3629,  880, 3026, 1723, 3380, 1307,  427, 2057, 3626, 2533, 3763, 3043, 1636, 3442, 3817, 1519,  148, 3917, 2016, 3643, 3061, 1293, 4042, 2891, 3397, 1153, 3099,  828, 2411,  405, 3668, 1175, 1882, 4020,  306, 1476, 3233, 1180, 4076, 3451, 1126, 3798,  750, 3058, 3986,  240, 2463,
+     515, 1755, 3334, 2561, 1589, 3117, 1164,   12, 2013, 3710,  293, 1808, 3389,  238, 1360, 2449, 1099, 1782, 2541, 3764,  151, 2459, 3927, 1651, 3297, 1011,  351, 1246,  600, 2644, 1004, 2450, 2943, 1276, 2700,  744, 2271,  456, 2648,  683, 2096,  364, 2536, 1562, 1987, 3839, 1448, 2829, 2153,  726, 2560, 1003, 3735,   76, 2655, 2292,  505, 2978, 2014,   34, 1618, 2063, 1379, 3713,
+    2193, 2786,  747, 2039,  270, 3488, 1795, 3950, 3017,  755, 2407, 4003, 1551, 2955, 3790, 2116, 3431, 3096,  358, 1243, 1989,  981,  618, 2650,  114, 2899, 1851, 3203, 2176, 3985,   57, 1925,  657, 3252, 1737, 3441, 1206, 3804, 1924, 3298, 1366, 3815,  648, 3614,  129, 2983,  968, 3392,    4, 3600, 1355, 2912, 2184, 1717, 3128,  866, 1855, 2583,  956, 3514, 3250, 2632,  804, 3085,
+    1521, 3460, 1218, 4021, 2737,  869, 2239,  591, 2605, 1353, 3216, 1131,  590, 1957,  901,  437, 1520,  675, 3966, 2240, 3560, 2889, 3196, 1342, 2333, 4050, 1432, 3496,  867, 1560, 3106, 1140, 3765,  442, 2367,  248, 2907, 1593,   21,  937, 2956, 1707, 2203, 2715, 1259, 2108,  584, 1681, 2352, 3067, 1807,  444, 3421,  606, 1305, 3648,  204, 3940, 1415, 2259,  455, 1072, 3576,   97,
+    3877,  316, 2313,  536, 1446, 3720, 2890, 1533,  313, 3620, 2045,  108, 2691, 3557, 3210, 2505, 2929, 1929, 2763,  806, 1487,  241, 1806, 3456,  812, 2033,  521, 2487,  262, 2742, 3666, 2092, 2568, 1485, 4054, 2004,  865, 3542, 2599, 3943, 2360,  192, 3511,  821, 3259, 4082, 2542, 3686, 1045,  332, 3975,  906, 2489, 3900, 2054, 2774, 1573, 3165,  623, 3699, 1789, 2389, 2877, 1950,
+    1016, 3045, 1680, 3270, 2491,  170, 1061, 3381, 1850,  947, 2820, 3865, 2330, 1696, 1236,  187, 3752, 1328,   17, 3328, 2625, 3777, 2185,  361, 3671, 1122, 3035, 3770, 1186, 1799,  702,  290, 3499,  784, 2776, 1161, 3094,  462, 2079, 1105,  580, 3161, 1157, 1585,  412, 1831,  211, 3150, 1467, 2671, 1991, 3241, 1590,  120, 1066, 3510,  420, 2356, 1179, 2917,  279, 4059, 1296,  644,
+    2066, 2660, 3806,  814, 1938, 3092, 2151, 3931, 2442, 3160,  538, 1431,  859,  344, 4038, 2174,  943, 3522, 2336, 1760, 1044,  568, 1233, 2949, 2446, 1746,   72, 2099, 2865, 3354, 2391, 1350, 3166, 1845,  141, 3661, 2412, 1719, 3265, 1443, 3639, 1791, 2754, 3799, 2291, 2868, 1327,  738, 2226, 3776,  643, 1252, 2756, 2270, 3055,  712, 2600, 1729, 3424, 2098,  854, 1565, 3356, 2499,
+     474, 1403,   26, 1204, 3454,  484, 1373,  736,   70, 1619, 3744, 1985, 3425, 3066, 2719,  578, 1616, 2975,  421, 4022, 3147, 2522, 3878, 1583,  718, 3228, 3933,  766, 1530,  426, 4017, 2930,  965, 2305, 3322, 1402,  625, 3982,  163, 2875, 2476,  295, 2072,  647, 3191,  963, 3903, 3439, 1713,   84, 3027, 3518,  349, 3838, 1437, 1912, 4029,  958,   73, 3797, 2638, 3105,  191, 3772,
+    3184, 3543, 2843, 2216, 4085, 1758, 2974, 3549, 2675, 1201, 2276,  407, 2502, 1333, 1865, 3286, 2415, 1163, 1990,  769, 1523,  104, 1962, 3406,  307, 2677, 1335, 2298, 3633, 1023, 1936,   44, 1690, 3902,  383, 2048, 2734, 1030, 2254,  741, 3845,  954, 3400, 1456,   48, 2566, 2060,  453, 2816, 2384, 1118, 1767, 2087,  872, 3290,  196, 2874, 3190, 1385, 1889,  581, 2229, 1211, 1803,
+    2147,  980, 1691,  672, 2620,  180, 2322,  984, 1940, 3311, 2946, 1036, 3834,   46,  838, 3920,  268, 3410, 3718, 2800, 2265, 3613,  817, 2782, 1133, 1907, 3473,  218, 3113, 2702, 2244, 3687,  663, 2579, 1219, 3013, 3749, 1634, 3484, 1955, 1330, 2947, 2425, 3978, 1884, 3562, 1532, 1187, 3333,  807, 4040, 2613,  574, 3706, 2464, 1234, 2180,  621, 2483, 3609, 1076, 3971, 2798,  735,
+    2591,  244, 3840, 3324, 1078, 1498, 3709,  560, 3995,  296,  758, 3487, 1765, 2915, 2211, 1427, 2654,  677, 1673,  198, 1192, 3042, 1397, 2182, 4073,  559, 2550,  908, 1604,  576, 1254, 2822, 3251, 1554, 3553,  858,  115, 2510,  503, 3063,  230, 1711,  473, 1159,  715, 2925,  242, 3755, 2130, 1599,  305, 3211, 1408, 2855, 1748,  381, 3861, 1645, 3351,  362, 2995,  128, 1603, 3723,
+    1441, 3087, 2353,  445, 2916, 2101, 3224, 2781, 1685, 1375, 2121, 2612, 1256,  542, 3657, 3108, 1088, 2141, 3208, 2574, 3953,  492, 3464,  228, 2936, 1694, 3756, 2086, 3278, 3954, 1827,  250, 1032, 2370,  488, 1984, 1466, 3306, 1181, 4032, 2286, 3271, 3689, 2708, 2243, 3240,  897, 2484,  540, 2871, 3561, 2218,  101, 1050, 3580, 3109,  892, 2794, 1197, 2126, 1777, 2421, 3291,  514,
+    3578, 1169, 1953, 1615, 3955,  764, 1247,  233, 2357, 3636, 3171,  177, 4071, 2398, 1623,  154, 1878, 3881,  360, 1486,  931, 2018, 1644, 2393, 1015, 3170,    7, 1286, 2363,  350, 3005, 3480, 2059, 4092, 3121, 2661, 3864, 2177,  805, 2678, 1450,  924, 1947,  126, 1323, 1649, 4009, 1897, 3164, 1310,  932, 1817, 3924, 2382,  610, 1952, 2320,    6, 3741,  733, 3569, 1281,  870, 2036,
+      67, 2773,  661, 3465,  111, 2595, 1873, 3433,  925, 2701,  637, 1112, 1910, 3242,  915, 3498, 2823,  847, 3462, 2434, 3004, 3782, 2704,  749, 3682, 1493, 2714,  737, 3556, 1060, 2557, 1442,  794,   80, 1704,  989,  304, 2923, 1788,   11, 3634,  567, 2987, 3868, 3387,  384, 2722, 1128,   24, 3781, 2679,  481, 3050, 1570, 3359, 1294, 4027, 1591, 2490, 3089,  468, 2668, 2957, 4047,
+    2201,  955, 3179, 2420, 1367, 3641, 3009,  509, 3932, 1946, 1529, 3736, 2878,  330, 1332, 2512,  535, 2257, 1260, 1822,  638,   66, 1240, 3373,  297, 2154, 4006, 1886, 2882, 1653,  517, 3773, 2328, 2879, 3653, 1364, 3434,  634, 3805, 3212, 2077, 2558, 1568, 1051, 2341, 2023,  628, 3536, 2359, 1614, 2061, 3403,  873, 2565,  210, 2750,  520, 3472,  938, 1920, 3894, 1538,  301, 1716,
+    3347, 1429, 3869,  354, 2123, 1006, 1594, 2299, 1217,   77, 3098, 2470,  570, 2125, 3820, 1661, 3607, 3031,  302, 4053, 3261, 2166, 2904, 1849, 2497, 1116,  571, 3336,  252, 3888, 2145, 3181, 1212, 1885,  416, 2577, 2038, 2426, 1535,  969, 1280, 3438,  190, 2804,  789, 3728, 2920, 1501, 3245,  703, 4095,  285, 1434, 1977, 3828, 1104, 2210, 2905, 1404,  145, 2230, 1022, 3502, 2514,
+     519, 2979, 1800,  881, 2901, 4064,  214, 3309, 2769, 2090, 3584,  970, 1787, 3338, 2755,   35, 1014, 2030, 1555, 2619, 1052, 1471, 3598,  414, 3837, 3082, 1600, 2339, 1317, 2652,  941,  167, 3601,  662, 3264, 3990, 1142,  184, 2761, 3079,  355, 2264, 4062, 1714, 3204,  267, 1854, 1018,  183, 2610, 1213, 2321, 2881, 3478,  716, 3123, 1781,  311, 3232, 3702, 2624, 3054,  713, 1235,
+    3707,  206, 2643, 3541,  552, 2516, 1846,  780, 3848,  530, 1412,  276, 4013, 1138,  724, 2406, 3919, 3229,  785, 3652,  193, 2453,  695, 1728,  904, 2726,   86, 3714,  782, 3036, 1959, 1502, 2752, 2396, 1587,  830, 3003, 1732, 3912,  760, 3532, 1848,  597, 1101, 2504, 1337, 3974, 2225, 3630, 3032, 1698, 3697, 1054,   61, 2458, 1479, 3654,  801, 2078, 1117,  461, 1769, 3961, 2025,
+    1621, 2307, 1145, 2040, 1478, 3368, 1171, 3159, 1567, 2402, 3398, 2998, 2266, 1524, 3143, 1914, 1378,  260, 2246, 2941, 1868, 3883, 3107, 2195, 3382, 1291, 2021, 3195, 1752,  300, 3375, 4045, 1064, 3116,   36, 2148, 3610,  529, 2002, 2372, 1423, 2690, 3023, 3655, 2114, 3353,  500, 2724,  751, 1992,  347,  646, 3257, 1844, 3977,  382, 2300, 2740, 4070, 1607, 3443, 2417,   37, 2864,
+    3455,  734, 3980, 3069,   85, 3715, 2074,  342, 2637,  992, 1928,  690, 2659,  159, 3793,  532, 3450, 2801, 1189,  598, 3463,  986, 1358,  142, 4019,  607, 2523, 1000, 3898, 2435,  674, 2188,  409, 1793, 3853, 1309, 2669, 1069, 3388,   95, 3757,  942,  388, 1556,  110,  903, 2982, 1635, 1289, 3370, 3956, 2575, 2137, 1261, 2831,  967, 3326, 1299,  161, 2964,  767, 1382, 3244,  977,
+    1436, 2718,  449, 1764,  962, 2444,  639, 2919, 3540,    9, 3925, 1283, 3520, 2068, 2771, 1084, 2448, 1770, 4016, 1606, 2576,  447, 2821, 2366, 1633, 2954, 3555,  439, 1525, 2852, 1349, 3658, 2597,  791, 3448, 2358,  284, 3129, 1601, 2884, 1230, 2190, 3296, 2554, 3923, 1874, 2423, 3807,   39, 2316,  934, 1452, 3132,  490, 3592, 1701, 2008,  594, 2530, 1870, 3745, 2138,  543, 2501,
+     144, 3769, 2168, 3282, 2807, 1376, 4011, 1712, 1221, 2215, 2860, 1700,  356,  876, 1574, 3659,  338,  853, 3006,   94, 2134, 3295, 1824, 3734,  315, 1154, 1864, 2277, 3459,  884,  212, 1905, 3263, 1483, 2856,  577, 1839, 4034,  748, 2513,  518, 3871, 1682,  778, 1223, 3512,  428, 1056, 3095, 1763, 2903,  186, 3876,  840, 2602,  118, 3858, 3103, 3528, 1093,  282, 2730, 3936, 1913,
+    2935, 1079, 1569,  688, 3822,  286, 2258, 3260,  820, 3664,  537, 3313, 2573, 4094, 3075, 2186, 3266, 1967, 3523, 1399, 3827, 1177,  626, 3041,  919, 2666, 3818,   45, 3078, 2100, 3968, 2967, 1075,  140, 2083, 1012, 3500, 1357, 2106, 3602, 1896, 3047,  205, 2728, 3155, 2249, 1475, 2634, 3447,  669, 3725, 2041, 1629, 2309, 3446, 1394, 2221,  905, 1536, 2312, 3292,  835, 1232, 3579,
+    2342,  333, 3537, 2478, 1937, 1048, 3025,  423, 2024, 1420, 2383, 1042, 1893, 1372,  652,   52, 1249, 2676,  429, 2399,  893, 2736, 3571, 1534, 2081, 3221, 1371,  709, 1687, 1203, 2539,  619, 1659, 3588, 3913, 3065, 2606,   71, 2984,  376,  917, 1416, 3467, 2065,  320,  694, 3965, 1918,  266, 1326, 2532, 1040, 2835,  322, 1149, 3008,  526, 2844,  201, 3983, 1775, 3022,  411, 1638,
+     888, 3104, 1297, 2764,   49, 3618, 1609, 2604, 3800,  123, 3144, 3872,  235, 2958, 2400, 3724, 1727, 3910,  697, 3202, 1740,  399, 2338,  175, 4080,  463, 2377, 3350, 2744, 3683,  387, 3402, 2170, 2494,  363, 1576,  692, 2311, 3836, 1248, 2797, 2428, 4081, 1106, 1766, 3280, 2892,  885, 3621, 2189, 3366,  548, 3786, 3274, 1934, 4028, 1677, 3581, 2515,  651, 1347, 2118, 2563, 3376,
+    1983, 4023, 1734,  589, 3172, 2319, 1205,  627, 3378, 1572, 2745,  826, 2133, 3401, 1070, 2851,  845, 2232, 1545, 2825, 3979, 1980, 3374, 1244, 2589,  834, 1804, 3906,  247,  948, 1968, 1345, 2863,  798, 1222, 1997, 3416, 1046, 1722, 3342, 1988,  649,   27, 2308, 3645, 1361,  393, 2437, 1641, 2962,   83, 1818, 1428,  705, 2492,   60,  940, 2095, 1178, 3118, 3617,    1, 3863,  572,
+    1174,  277, 2207, 3759,  875, 1814, 4056, 2928,  998, 2262,  458, 1778, 3651, 1495,  324, 1949, 3330,  222, 3539, 1193,   69, 1027, 2873, 1656, 3612, 2965, 1107, 2149, 1517, 2439, 3053, 4057,    3, 3708, 3182, 2758, 4010,  478, 2630,  243, 3693, 3153, 1622, 2908,  842, 2607, 2037, 3779, 1080,  633, 4069, 2584, 3176, 2140, 1100, 3674, 2751, 3360,  397, 1830, 2703, 1035, 1513, 2897,
+    2508, 3491, 2809, 1455, 3332,  352, 2529,  164, 1971, 3904, 3071, 1170, 2646,  582, 3787, 2548, 1308, 3040,  605, 2581, 2135, 3680,  723,  432, 2062,   89, 3293,  541, 2811, 3527,  645, 1610, 1096, 2302, 1801,  203, 1392, 2120, 3020,  811, 1435, 2493,  999, 3418,  516, 3992,  166, 2828, 1468, 3275, 2003,  920,  377, 3882, 2966, 1749,  585, 1470, 3825, 2331,  756, 3236, 2251, 3719,
+     825, 1654,  127, 1062, 2631, 2131, 1526, 3583, 1302,  670, 3508,   42, 2290, 3024, 1674,  745, 3991, 2369, 1784, 3808, 1390, 3243, 2375, 3057, 3915, 1454, 2401, 3711, 1272,  149, 1875, 3277, 2711,  483, 3493,  921, 2528, 3591, 1210, 3948, 1916,  370, 3862, 2160, 1757, 1271, 3157, 1863,  433, 2390, 3640, 1268, 2732, 1563,  232, 2304, 3248, 2590,  136, 1275, 4089,  253, 1876,  431,
+    3213, 2073, 3029, 3905,  720, 3716,  511, 3218, 2803, 2424, 1447, 1944, 4048,  976, 3481,  147, 2020, 1020,  272, 2808,  848,  341, 1813, 1267,  927, 2699, 1832,  810, 2985, 2275, 3832,  863, 2042, 3938, 1552, 3083,  553, 1739,  169, 2303, 3197, 2789, 1231,  133, 3254, 2373,  680, 3577,  988, 2900,  155, 1743, 3427,  653, 3565, 1209,  857, 1880, 3529, 2997, 1672, 2790, 3471, 1331,
+    3999,  545, 2419, 1321, 1927, 2969, 1141, 1834,  918,  328, 3365, 2725,  470, 1334, 2213, 2662, 3215, 3670, 1626, 3112, 2050, 4043, 2640, 3432,  507, 3570,  239, 4031, 1627,  379, 2611, 1433,  219, 2913, 1156, 2242, 3819, 2783, 3390,  979,  527, 1579, 3604, 2552,  912, 3729, 1543, 2621, 2082, 3964,  775, 2247, 3028, 2496, 1993, 3960, 2839,  459, 2198, 1005,  575, 2127,  910, 2571,
+    1798, 1002, 3624,  371, 3399,   22, 2710, 3958, 2191, 3698, 1679,  808, 3186, 1809, 2959,  851,  402, 1278, 2507,  650, 3391, 1068,   16, 1586, 2273, 3154, 1198, 2110, 3369, 1017, 3564, 3141, 2385,  721, 3457,  105, 1998,  685, 1518, 2598, 3775, 2115,  658, 3019, 1978,  390, 2938,    8, 1190, 3205, 1482, 3703,  314,  946, 1509,   43, 3367, 1421, 3788, 2482, 3249, 1489, 3740,   56,
+    2854, 1505, 3145, 2173, 1613, 2475,  761, 1540,  221, 3021, 1207, 2143, 3559,  102, 3947, 1541, 3530, 1930, 3890,  176, 1500, 2348, 2971, 3660, 1954,  740, 2866, 2519,  640, 1945, 1279,  472, 3732, 1837, 2635, 1406, 3238, 1090, 4067, 1902,   41, 3300, 1136, 1688, 4037, 1313, 2279, 3829, 1773,  544, 2684, 1970, 1241, 3835, 3130, 2178, 2615,  752, 1786,  158, 3573,  450, 3059, 2296,
+    3831,  226, 2614,  850, 4074, 1225, 3603, 3281, 2404,  676, 3928,  413, 2556, 1037, 2364,  547, 2824, 2260, 1127, 2683, 3701, 1872,  781, 1324,  386, 3886, 1537,   79, 3091, 3908, 2693, 2159, 1584, 1038, 3969,  395, 2840, 2351,  308, 2977, 1356, 2326, 2836,  254, 3385,  583, 3158,  809, 3526, 2350,  189, 3414,  587, 2545, 1753,  430, 1152, 4036, 3049, 1329, 2689, 1986, 1165,  673,
+    2052, 1311, 3554,  558, 1881, 3033,  482, 1979, 1322, 2680, 1859, 2921, 1459, 3766, 1981, 3136,  951,  319, 3294,  717, 3139,  418, 3973, 2697, 3317, 2386,  960, 3589, 1744,  337,  886, 3383,   53, 3048, 2220,  864, 3676, 1693, 3355,  837, 3684,  513, 3899,  887, 2204, 2663, 1900, 1490, 2818, 1124, 4063, 2944, 1405, 3256,  849, 3524, 2870, 2051,  317, 2349,  950, 3895, 1721, 3394,
+     930, 2942, 1652, 3225, 2368,  137, 2778,  926, 3730,   75, 3492,  732, 3283,  335, 1290, 3494, 1596, 4061, 1828, 1344, 2146, 2500, 1049, 1761,  229, 1999, 3177, 1253, 2237, 2973, 1414, 3771, 2429,  641, 3531, 1477, 2080,  550, 1270, 2685, 2011, 1528, 2582, 1811, 3595, 1071,  182, 3305,  391, 2070,  699, 1708, 2241,   99, 3885, 2371, 1558,  671, 3222, 3649,  579, 2909,  117, 2562,
+     485, 2228,  303, 3814,  983, 1472, 3891, 2238, 3133, 1531, 1029, 2222, 1759, 2468,  768, 2692,   28, 2380, 2898, 3622,  156, 1550, 3468, 3060,  852, 3747,  551, 2585, 4002,  678, 2056, 2861, 1129, 1871, 2616,  160, 3115, 3951, 2408,  135, 3466, 1039, 3217,   87, 1444, 2911, 3996, 2438, 3700, 1377, 2588, 3768,  987, 2762, 1921,  283, 1033, 3754, 1821, 1457, 2224, 3320, 1547, 4007,
+    3175, 3627, 1216, 2495, 1965, 3503,  668, 1718,  323, 2527, 3962, 2847,  195, 3851, 3056, 2055, 3692, 1148,  496,  899, 2642, 3826,  599, 2181, 1395, 2770, 1647,  132, 1086, 3316,  207, 1670,  457, 4049, 3340, 1208, 2753,  978, 1794, 3795, 2850,  451, 2250, 3823,  727, 2161,  508, 1675,  855, 3189,  173, 3386,  487, 3101, 1303, 3362, 2518, 2981,   14, 2741, 1098,  422, 2075, 1277,
+    2674, 1689,  704, 2837,  227, 3093, 2618, 1150, 3393, 1890,  493, 1263, 3361, 1516, 1047,  419, 1664, 3327, 2103, 3192, 1779, 1166, 2906,   40, 4090, 2297, 3506, 2922, 1895, 2403, 3813, 3124, 2544,  777, 1564,  373, 1960, 3404,  325, 1409,  815, 1892, 3016, 1185, 3420, 1838, 3135, 1226, 2272, 2834, 1768, 1114, 2179, 1620, 4015,  417, 2031, 1338, 3937,  796, 3505, 2465, 3690,  757,
+    1933,   54, 3371, 3918, 1304, 1797,  464, 4035, 2894,  882, 3605, 2139,  711, 2723, 2325, 3959,  803, 2517, 1393, 4004,  336, 2334, 3337, 1843, 1028,  396, 1288,  771, 3694, 1463,  894, 1242, 3575, 2107, 3039, 2355, 3746,  636, 2236, 3146, 2551, 3616, 1566, 2447,  298, 2738, 3856,   29, 3625,  632, 3921, 2474, 3546,  728, 2622,  957, 3611,  564, 2324, 1917, 2924, 1637,  246, 3044,
+    3812, 1053, 2388, 2035,  790, 3287, 2253, 1510,    0, 2392, 3100, 1648, 3722,   90, 3183, 1829, 3501,  216, 3001,  686, 2746, 1492,  793, 3656, 2705, 3114, 2034, 3262,  261, 2747, 2235,  406, 1816,    5, 3897,  900, 1336, 2968, 1683, 4083, 1172,  194,  614, 3944,  994, 1460,  759, 2506, 1548, 2097,  321, 1383, 2933,   93, 1819, 3198, 2796, 1612, 3307,  292, 1265, 4078,  961, 2269,
+     534, 3185, 1365,  392, 3587, 2543,  982, 3673, 2005, 1320,  331, 2586, 1135, 2010,  608, 1229, 2827, 2022, 1095, 3551, 1942, 3794,  258, 2472, 1625,  664, 3945, 2433, 1751,  604, 4018, 2914, 3303, 1430, 2768,  489, 2572, 3552,   82,  743, 2071, 3331, 2886, 1935, 3255, 2354, 3568, 2970, 1073, 3449, 3086,  874, 2009, 3762, 1285, 2263,  256, 1155, 3688, 2538,  612, 3235, 2653, 1462,
+    1833, 2511, 4005, 2934, 1667,  146, 2999,  615, 2695, 3844, 3267,  833, 4084, 2940, 3417, 1598,  385, 3929, 2318,   64, 1292, 3142, 2156, 1115, 3372,  188, 1419,  975, 3018, 3445, 1549,  822, 2413, 1043, 3513, 2067, 1608, 1091, 2833, 2409, 3785, 1650,  846, 2649,  174, 1776,  497, 1976,  225, 2696, 1706, 4093,  467, 2525, 3419,  616, 4000, 2084,  862, 3052, 1805, 2122,  106, 3631
+};
+
+}   // namespace foundation
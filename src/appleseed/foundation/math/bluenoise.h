@@ -0,0 +1,94 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BLUENOISE_H
+#define APPLESEED_FOUNDATION_MATH_BLUENOISE_H
+
+// appleseed.foundation headers.
+#include "foundation/math/hash.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// A tileable blue-noise mask, used to distribute Monte Carlo errors as blue noise
+// in screen space by rotating per-pixel sample sequences.
+//
+// The mask contains every rank in [0, BlueNoiseTileSize^2) exactly once and was
+// generated with the void-and-cluster algorithm (Gaussian energy, sigma = 1.5).
+//
+// References:
+//
+//   Ulichney, The void-and-cluster method for dither array generation
+//   http://cv.ulichney.com/papers/1993-void-cluster.pdf
+//
+//   Georgiev and Fajardo, Blue-noise Dithered Sampling
+//   https://www.arnoldrenderer.com/research/dither_abstract.pdf
+//
+
+const size_t BlueNoiseTileSize = 64;
+const size_t BlueNoiseTileMask = BlueNoiseTileSize - 1;
+
+extern const uint16 BlueNoiseTile[BlueNoiseTileSize * BlueNoiseTileSize];
+
+// Return the value in [0,1) of the blue-noise mask at a given pixel. The mask is
+// toroidally shifted by a pseudo-random amount that depends on a given dimension,
+// such that the values of different dimensions of a pixel are uncorrelated while
+// each dimension is blue noise across pixels.
+template <typename T>
+T blue_noise(
+    const size_t    x,
+    const size_t    y,
+    const size_t    dimension);
+
+
+//
+// Implementation.
+//
+
+template <typename T>
+inline T blue_noise(
+    const size_t    x,
+    const size_t    y,
+    const size_t    dimension)
+{
+    const uint32 shift = hash_uint32(static_cast<uint32>(dimension));
+    const size_t sx = (x + shift) & BlueNoiseTileMask;
+    const size_t sy = (y + (shift >> 16)) & BlueNoiseTileMask;
+    const uint16 rank = BlueNoiseTile[sy * BlueNoiseTileSize + sx];
+
+    return (static_cast<T>(rank) + T(0.5)) * (T(1.0) / (BlueNoiseTileSize * BlueNoiseTileSize));
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BLUENOISE_H
@@ -38,6 +38,8 @@
 #include "foundation/math/permutation.h"
 #include "foundation/math/split.h"
 #include "foundation/math/vector.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/stopwatch.h"
 
 // Standard headers.
@@ -50,6 +52,18 @@
 namespace foundation {
 namespace knn {
 
+//
+// Tree nodes are laid out in depth-first order, with the two children of an interior node
+// stored next to each other. Since leaves hold at most one point, a subtree built from n > 0
+// points always has 2n - 1 nodes. The location of every subtree in the node array is thus
+// known as soon as its points are known, which allows subtrees to be built concurrently.
+//
+// When given a job queue, the builder splits the top levels of the tree with data-parallel
+// bounding box computations and partitions, then builds the remaining subtrees in parallel.
+// The job queue must be serviced by worker threads. The resulting tree is identical to the
+// one built on a single thread, except for the order of coincident points.
+//
+
 template <typename T, size_t N>
 class Builder
   : public NonCopyable
@@ -70,11 +84,24 @@ class Builder
         const VectorType            points[],
         const size_t                count);
 
+    // Like build() but construction is spread over the threads servicing a job queue.
+    template <typename Timer>
+    void build(
+        const VectorType            points[],
+        const size_t                count,
+        JobQueue&                   job_queue);
+
     // Like build() but the points will be moved into the tree rather than copied.
     template <typename Timer>
     void build_move_points(
         std::vector<VectorType>&    points);
 
+    // Like build_move_points() but construction is spread over the threads servicing a job queue.
+    template <typename Timer>
+    void build_move_points(
+        std::vector<VectorType>&    points,
+        JobQueue&                   job_queue);
+
     // Return the construction time.
     double get_build_time() const;
 
@@ -83,6 +110,13 @@ class Builder
     typedef AABB<T, N> BboxType;
     typedef Split<T> SplitType;
 
+    enum
+    {
+        ChunkSize = 64 * 1024,          // number of points processed by a data-parallel job
+        MinSubtreeSize = 16 * 1024,     // minimum number of points of a subtree built by a single job
+        SubtreeCount = 256              // approximate number of subtrees built in parallel
+    };
+
     struct PartitionPredicate
     {
         typedef std::vector<VectorType> PointVector;
@@ -98,17 +132,91 @@ class Builder
             const size_t            index) const;
     };
 
-    TreeType&   m_tree;
-    double      m_build_time;
+    // A range of points and the location of the corresponding subtree in the node array.
+    struct Range
+    {
+        size_t                      m_node_index;
+        size_t                      m_child_node_index;
+        size_t                      m_begin;
+        size_t                      m_end;
+        BboxType                    m_bbox;             // bounding box of the points, if known
+
+        Range(
+            const size_t            node_index,
+            const size_t            child_node_index,
+            const size_t            begin,
+            const size_t            end);
+    };
+
+    // A contiguous chunk of a range of points being split in parallel.
+    struct Chunk
+    {
+        size_t                      m_range;
+        size_t                      m_begin;
+        size_t                      m_end;
+        BboxType                    m_bbox;
+        size_t                      m_left_count;
+        size_t                      m_left_offset;
+        size_t                      m_right_offset;
+        BboxType                    m_left_bbox;
+        BboxType                    m_right_bbox;
+    };
+
+    enum ChunkPhase { ComputeBbox, CountLeft, Scatter, CopyBack };
+
+    class ChunkJob;
+    class SubtreeJob;
+    class ReorderJob;
+
+    TreeType&                       m_tree;
+    double                          m_build_time;
+    std::vector<size_t>             m_temp_indices;
+    std::vector<Range>              m_ranges;
+    std::vector<SplitType>          m_splits;
+    std::vector<Chunk>              m_chunks;
+
+    void initialize(
+        std::vector<VectorType>&    points);
 
     void partition(
         const size_t                parent_node_index,
+        const size_t                child_node_index,
+        const size_t                begin,
+        const size_t                end) const;
+
+    void make_interior_node(
+        const size_t                node_index,
+        const size_t                child_node_index,
+        const SplitType&            split,
         const size_t                begin,
         const size_t                end) const;
 
     BboxType compute_bbox(
         const size_t                begin,
         const size_t                end) const;
+
+    void parallel_partition(
+        JobQueue&                   job_queue);
+
+    void parallel_split_ranges(
+        JobQueue&                   job_queue,
+        std::vector<Range>&         child_ranges);
+
+    void run_chunk_jobs(
+        JobQueue&                   job_queue,
+        const ChunkPhase            phase);
+
+    void process_chunk(
+        const size_t                chunk_index,
+        const ChunkPhase            phase);
+
+    void parallel_reorder(
+        JobQueue&                   job_queue);
+
+    void reorder_points(
+        std::vector<VectorType>&    points,
+        const size_t                begin,
+        const size_t                end) const;
 };
 
 typedef Builder<float, 2>  Builder2f;
@@ -121,6 +229,88 @@ typedef Builder<double, 3> Builder3d;
 // Implementation.
 //
 
+template <typename T, size_t N>
+class Builder<T, N>::ChunkJob
+  : public IJob
+{
+  public:
+    ChunkJob(
+        Builder&                    builder,
+        const size_t                chunk_index,
+        const ChunkPhase            phase)
+      : m_builder(builder)
+      , m_chunk_index(chunk_index)
+      , m_phase(phase)
+    {
+    }
+
+    virtual void execute(const size_t thread_index)
+    {
+        m_builder.process_chunk(m_chunk_index, m_phase);
+    }
+
+  private:
+    Builder&                        m_builder;
+    const size_t                    m_chunk_index;
+    const ChunkPhase                m_phase;
+};
+
+template <typename T, size_t N>
+class Builder<T, N>::SubtreeJob
+  : public IJob
+{
+  public:
+    SubtreeJob(
+        const Builder&              builder,
+        const Range&                range)
+      : m_builder(builder)
+      , m_range(range)
+    {
+    }
+
+    virtual void execute(const size_t thread_index)
+    {
+        m_builder.partition(
+            m_range.m_node_index,
+            m_range.m_child_node_index,
+            m_range.m_begin,
+            m_range.m_end);
+    }
+
+  private:
+    const Builder&                  m_builder;
+    const Range                     m_range;
+};
+
+template <typename T, size_t N>
+class Builder<T, N>::ReorderJob
+  : public IJob
+{
+  public:
+    ReorderJob(
+        const Builder&              builder,
+        std::vector<VectorType>&    points,
+        const size_t                begin,
+        const size_t                end)
+      : m_builder(builder)
+      , m_points(points)
+      , m_begin(begin)
+      , m_end(end)
+    {
+    }
+
+    virtual void execute(const size_t thread_index)
+    {
+        m_builder.reorder_points(m_points, m_begin, m_end);
+    }
+
+  private:
+    const Builder&                  m_builder;
+    std::vector<VectorType>&        m_points;
+    const size_t                    m_begin;
+    const size_t                    m_end;
+};
+
 template <typename T, size_t N>
 inline Builder<T, N>::Builder(TreeType& tree)
   : m_tree(tree)
@@ -145,6 +335,24 @@ void Builder<T, N>::build(
     build_move_points<Timer>(vec);
 }
 
+template <typename T, size_t N>
+template <typename Timer>
+void Builder<T, N>::build(
+    const VectorType            points[],
+    const size_t                count,
+    JobQueue&                   job_queue)
+{
+    std::vector<VectorType> vec(count);
+
+    if (count > 0)
+    {
+        assert(points);
+        std::memcpy(&vec[0], points, count * sizeof(VectorType));
+    }
+
+    build_move_points<Timer>(vec, job_queue);
+}
+
 template <typename T, size_t N>
 template <typename Timer>
 void Builder<T, N>::build_move_points(
@@ -155,20 +363,9 @@ void Builder<T, N>::build_move_points(
 
     const size_t count = points.size();
 
-    if (count > 0)
-    {
-        m_tree.m_points.swap(points);
-
-        m_tree.m_indices.resize(count);
-
-        for (size_t i = 0; i < count; ++i)
-            m_tree.m_indices[i] = i;
-    }
+    initialize(points);
 
-    m_tree.m_nodes.reserve(count * 2 + 1);
-    m_tree.m_nodes.push_back(NodeType());
-
-    partition(0, 0, count);
+    partition(0, 1, 0, count);
 
     if (count > 0)
     {
@@ -185,6 +382,45 @@ void Builder<T, N>::build_move_points(
     m_build_time = stopwatch.get_seconds();
 }
 
+template <typename T, size_t N>
+template <typename Timer>
+void Builder<T, N>::build_move_points(
+    std::vector<VectorType>&    points,
+    JobQueue&                   job_queue)
+{
+    Stopwatch<Timer> stopwatch;
+    stopwatch.start();
+
+    const size_t count = points.size();
+
+    initialize(points);
+
+    if (count <= MinSubtreeSize)
+    {
+        // Not worth the synchronization overhead.
+        partition(0, 1, 0, count);
+
+        if (count > 0)
+        {
+            std::vector<VectorType> temp(count);
+
+            small_item_reorder(
+                &m_tree.m_points[0],
+                &temp[0],
+                &m_tree.m_indices[0],
+                count);
+        }
+    }
+    else
+    {
+        parallel_partition(job_queue);
+        parallel_reorder(job_queue);
+    }
+
+    stopwatch.measure();
+    m_build_time = stopwatch.get_seconds();
+}
+
 template <typename T, size_t N>
 inline double Builder<T, N>::get_build_time() const
 {
@@ -207,9 +443,43 @@ inline bool Builder<T, N>::PartitionPredicate::operator()(
     return m_points[index][m_split.m_dimension] < m_split.m_abscissa;
 }
 
+template <typename T, size_t N>
+inline Builder<T, N>::Range::Range(
+    const size_t                node_index,
+    const size_t                child_node_index,
+    const size_t                begin,
+    const size_t                end)
+  : m_node_index(node_index)
+  , m_child_node_index(child_node_index)
+  , m_begin(begin)
+  , m_end(end)
+{
+    m_bbox.invalidate();
+}
+
+template <typename T, size_t N>
+void Builder<T, N>::initialize(
+    std::vector<VectorType>&    points)
+{
+    const size_t count = points.size();
+
+    if (count > 0)
+    {
+        m_tree.m_points.swap(points);
+
+        m_tree.m_indices.resize(count);
+
+        for (size_t i = 0; i < count; ++i)
+            m_tree.m_indices[i] = i;
+    }
+
+    m_tree.m_nodes.assign(count > 0 ? 2 * count - 1 : 1, NodeType());
+}
+
 template <typename T, size_t N>
 void Builder<T, N>::partition(
     const size_t                parent_node_index,
+    const size_t                child_node_index,
     const size_t                begin,
     const size_t                end) const
 {
@@ -244,25 +514,35 @@ void Builder<T, N>::partition(
         if (pivot == begin || pivot == end)
             pivot = (begin + end) / 2;
 
-        const size_t left_node_index = m_tree.m_nodes.size();
-        const size_t right_node_index = left_node_index + 1;
+        make_interior_node(parent_node_index, child_node_index, split, begin, end);
 
-        m_tree.m_nodes.push_back(NodeType());
-        m_tree.m_nodes.push_back(NodeType());
+        // The descendants of the left child come right after the two children,
+        // followed by the descendants of the right child.
+        const size_t left_node_index = child_node_index;
+        const size_t right_node_index = child_node_index + 1;
 
-        NodeType& parent_node = m_tree.m_nodes[parent_node_index];
-        parent_node.make_interior();
-        parent_node.set_split_dim(split.m_dimension);
-        parent_node.set_split_abs(split.m_abscissa);
-        parent_node.set_child_node_index(left_node_index);
-        parent_node.set_point_index(begin);
-        parent_node.set_point_count(count);
-
-        partition(left_node_index, begin, pivot);
-        partition(right_node_index, pivot, end);
+        partition(left_node_index, child_node_index + 2, begin, pivot);
+        partition(right_node_index, child_node_index + 2 * (pivot - begin), pivot, end);
     }
 }
 
+template <typename T, size_t N>
+inline void Builder<T, N>::make_interior_node(
+    const size_t                node_index,
+    const size_t                child_node_index,
+    const SplitType&            split,
+    const size_t                begin,
+    const size_t                end) const
+{
+    NodeType& node = m_tree.m_nodes[node_index];
+    node.make_interior();
+    node.set_split_dim(split.m_dimension);
+    node.set_split_abs(split.m_abscissa);
+    node.set_child_node_index(child_node_index);
+    node.set_point_index(begin);
+    node.set_point_count(end - begin);
+}
+
 template <typename T, size_t N>
 inline typename Builder<T, N>::BboxType Builder<T, N>::compute_bbox(
     const size_t                begin,
@@ -280,6 +560,297 @@ inline typename Builder<T, N>::BboxType Builder<T, N>::compute_bbox(
     return bbox;
 }
 
+template <typename T, size_t N>
+void Builder<T, N>::parallel_partition(
+    JobQueue&                   job_queue)
+{
+    const size_t count = m_tree.m_points.size();
+    const size_t max_subtree_size = std::max<size_t>(count / SubtreeCount, MinSubtreeSize);
+
+    m_temp_indices.resize(count);
+
+    // Split the top levels of the tree, one level at a time.
+    std::vector<Range> ranges(1, Range(0, 1, 0, count));
+    std::vector<Range> subtrees;
+    std::vector<Range> child_ranges;
+
+    while (!ranges.empty())
+    {
+        m_ranges.clear();
+
+        for (size_t i = 0, e = ranges.size(); i < e; ++i)
+        {
+            const Range& range = ranges[i];
+            if (range.m_end - range.m_begin <= max_subtree_size)
+                subtrees.push_back(range);
+            else m_ranges.push_back(range);
+        }
+
+        child_ranges.clear();
+        parallel_split_ranges(job_queue, child_ranges);
+        ranges.swap(child_ranges);
+    }
+
+    std::vector<size_t>().swap(m_temp_indices);
+
+    // Build the remaining subtrees in parallel.
+    std::vector<SubtreeJob*> jobs;
+    jobs.reserve(subtrees.size());
+
+    for (size_t i = 0, e = subtrees.size(); i < e; ++i)
+    {
+        jobs.push_back(new SubtreeJob(*this, subtrees[i]));
+        job_queue.schedule(jobs.back(), false);
+    }
+
+    job_queue.wait_until_completion();
+
+    for (size_t i = 0, e = jobs.size(); i < e; ++i)
+        delete jobs[i];
+}
+
+template <typename T, size_t N>
+void Builder<T, N>::parallel_split_ranges(
+    JobQueue&                   job_queue,
+    std::vector<Range>&         child_ranges)
+{
+    if (m_ranges.empty())
+        return;
+
+    // Cut all ranges into chunks.
+    m_chunks.clear();
+
+    for (size_t i = 0, e = m_ranges.size(); i < e; ++i)
+    {
+        for (size_t begin = m_ranges[i].m_begin; begin < m_ranges[i].m_end; begin += ChunkSize)
+        {
+            Chunk chunk;
+            chunk.m_range = i;
+            chunk.m_begin = begin;
+            chunk.m_end = std::min<size_t>(begin + ChunkSize, m_ranges[i].m_end);
+            m_chunks.push_back(chunk);
+        }
+    }
+
+    // Compute the bounding box of the ranges that were not produced by a previous split.
+    if (!m_ranges[0].m_bbox.is_valid())
+    {
+        run_chunk_jobs(job_queue, ComputeBbox);
+
+        for (size_t i = 0, e = m_chunks.size(); i < e; ++i)
+            m_ranges[m_chunks[i].m_range].m_bbox.insert(m_chunks[i].m_bbox);
+    }
+
+    // Choose the splitting planes.
+    m_splits.resize(m_ranges.size());
+
+    for (size_t i = 0, e = m_ranges.size(); i < e; ++i)
+        m_splits[i] = SplitType::middle(m_ranges[i].m_bbox);
+
+    // Count the points on the left side of the splitting planes.
+    run_chunk_jobs(job_queue, CountLeft);
+
+    std::vector<size_t> left_counts(m_ranges.size(), 0);
+
+    for (size_t i = 0, e = m_chunks.size(); i < e; ++i)
+        left_counts[m_chunks[i].m_range] += m_chunks[i].m_left_count;
+
+    // Compute where each chunk must move its points.
+    std::vector<size_t> left_offsets(m_ranges.size());
+    std::vector<size_t> right_offsets(m_ranges.size());
+
+    for (size_t i = 0, e = m_ranges.size(); i < e; ++i)
+    {
+        left_offsets[i] = m_ranges[i].m_begin;
+        right_offsets[i] = m_ranges[i].m_begin + left_counts[i];
+    }
+
+    for (size_t i = 0, e = m_chunks.size(); i < e; ++i)
+    {
+        Chunk& chunk = m_chunks[i];
+        chunk.m_left_offset = left_offsets[chunk.m_range];
+        chunk.m_right_offset = right_offsets[chunk.m_range];
+        left_offsets[chunk.m_range] += chunk.m_left_count;
+        right_offsets[chunk.m_range] += chunk.m_end - chunk.m_begin - chunk.m_left_count;
+    }
+
+    // Partition the points.
+    run_chunk_jobs(job_queue, Scatter);
+    run_chunk_jobs(job_queue, CopyBack);
+
+    std::vector<BboxType> left_bboxes(m_ranges.size());
+    std::vector<BboxType> right_bboxes(m_ranges.size());
+
+    for (size_t i = 0, e = m_ranges.size(); i < e; ++i)
+    {
+        left_bboxes[i].invalidate();
+        right_bboxes[i].invalidate();
+    }
+
+    for (size_t i = 0, e = m_chunks.size(); i < e; ++i)
+    {
+        const Chunk& chunk = m_chunks[i];
+        left_bboxes[chunk.m_range].insert(chunk.m_left_bbox);
+        right_bboxes[chunk.m_range].insert(chunk.m_right_bbox);
+    }
+
+    // Create the interior nodes and the ranges of their children.
+    for (size_t i = 0, e = m_ranges.size(); i < e; ++i)
+    {
+        const Range& range = m_ranges[i];
+
+        // See partition() for the treatment of coincident points.
+        size_t pivot = range.m_begin + left_counts[i];
+        if (pivot == range.m_begin || pivot == range.m_end)
+        {
+            pivot = (range.m_begin + range.m_end) / 2;
+            left_bboxes[i] = right_bboxes[i] = range.m_bbox;
+        }
+
+        make_interior_node(
+            range.m_node_index,
+            range.m_child_node_index,
+            m_splits[i],
+            range.m_begin,
+            range.m_end);
+
+        child_ranges.push_back(
+            Range(
+                range.m_child_node_index,
+                range.m_child_node_index + 2,
+                range.m_begin,
+                pivot));
+        child_ranges.back().m_bbox = left_bboxes[i];
+
+        child_ranges.push_back(
+            Range(
+                range.m_child_node_index + 1,
+                range.m_child_node_index + 2 * (pivot - range.m_begin),
+                pivot,
+                range.m_end));
+        child_ranges.back().m_bbox = right_bboxes[i];
+    }
+}
+
+template <typename T, size_t N>
+void Builder<T, N>::run_chunk_jobs(
+    JobQueue&                   job_queue,
+    const ChunkPhase            phase)
+{
+    std::vector<ChunkJob*> jobs;
+    jobs.reserve(m_chunks.size());
+
+    for (size_t i = 0, e = m_chunks.size(); i < e; ++i)
+    {
+        jobs.push_back(new ChunkJob(*this, i, phase));
+        job_queue.schedule(jobs.back(), false);
+    }
+
+    job_queue.wait_until_completion();
+
+    for (size_t i = 0, e = jobs.size(); i < e; ++i)
+        delete jobs[i];
+}
+
+template <typename T, size_t N>
+void Builder<T, N>::process_chunk(
+    const size_t                chunk_index,
+    const ChunkPhase            phase)
+{
+    Chunk& chunk = m_chunks[chunk_index];
+
+    switch (phase)
+    {
+      case ComputeBbox:
+        chunk.m_bbox = compute_bbox(chunk.m_begin, chunk.m_end);
+        break;
+
+      case CountLeft:
+        {
+            const PartitionPredicate pred(m_tree.m_points, m_splits[chunk.m_range]);
+            size_t left_count = 0;
+
+            for (size_t i = chunk.m_begin; i < chunk.m_end; ++i)
+            {
+                if (pred(m_tree.m_indices[i]))
+                    ++left_count;
+            }
+
+            chunk.m_left_count = left_count;
+        }
+        break;
+
+      case Scatter:
+        {
+            // The bounding boxes of both sides are computed along the way
+            // so that the next level of the tree doesn't need to.
+            const PartitionPredicate pred(m_tree.m_points, m_splits[chunk.m_range]);
+            size_t left = chunk.m_left_offset;
+            size_t right = chunk.m_right_offset;
+            chunk.m_left_bbox.invalidate();
+            chunk.m_right_bbox.invalidate();
+
+            for (size_t i = chunk.m_begin; i < chunk.m_end; ++i)
+            {
+                const size_t index = m_tree.m_indices[i];
+
+                if (pred(index))
+                {
+                    m_temp_indices[left++] = index;
+                    chunk.m_left_bbox.insert(m_tree.m_points[index]);
+                }
+                else
+                {
+                    m_temp_indices[right++] = index;
+                    chunk.m_right_bbox.insert(m_tree.m_points[index]);
+                }
+            }
+        }
+        break;
+
+      case CopyBack:
+        std::memcpy(
+            &m_tree.m_indices[chunk.m_begin],
+            &m_temp_indices[chunk.m_begin],
+            (chunk.m_end - chunk.m_begin) * sizeof(size_t));
+        break;
+    }
+}
+
+template <typename T, size_t N>
+void Builder<T, N>::parallel_reorder(
+    JobQueue&                   job_queue)
+{
+    const size_t count = m_tree.m_points.size();
+    std::vector<VectorType> temp(count);
+
+    std::vector<ReorderJob*> jobs;
+    jobs.reserve(count / ChunkSize + 1);
+
+    for (size_t begin = 0; begin < count; begin += ChunkSize)
+    {
+        jobs.push_back(new ReorderJob(*this, temp, begin, std::min<size_t>(begin + ChunkSize, count)));
+        job_queue.schedule(jobs.back(), false);
+    }
+
+    job_queue.wait_until_completion();
+
+    for (size_t i = 0, e = jobs.size(); i < e; ++i)
+        delete jobs[i];
+
+    m_tree.m_points.swap(temp);
+}
+
+template <typename T, size_t N>
+inline void Builder<T, N>::reorder_points(
+    std::vector<VectorType>&    points,
+    const size_t                begin,
+    const size_t                end) const
+{
+    for (size_t i = begin; i < end; ++i)
+        points[i] = m_tree.m_points[m_tree.m_indices[i]];
+}
+
 }       // namespace knn
 }       // namespace foundation
 
@@ -0,0 +1,422 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_KNN_KNN_HASHGRID_H
+#define APPLESEED_FOUNDATION_MATH_KNN_KNN_HASHGRID_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/hash.h"
+#include "foundation/math/knn/knn_answer.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace foundation {
+namespace knn {
+
+//
+// A hashed uniform grid for fixed-radius nearest neighbor queries.
+//
+// Points are bucketed by the hash of the grid cell they belong to. Building the
+// grid is a linear-time counting sort of the points by bucket; the points of a
+// bucket end up contiguous in memory. A query visits the buckets of the cells
+// overlapped by the search sphere, which is 2^N cells at most when the search
+// radius does not exceed half the cell size. Smaller cells cull more points but
+// visiting more buckets costs more cache misses than testing the extra points.
+//
+// Like knn::Tree, the grid reorders the points it stores and query answers refer
+// to points using internal indices that must be transformed using remap().
+//
+// Reference:
+//
+//   Optimized Spatial Hashing for Collision Detection of Deformable Objects
+//   http://www.beosil.com/download/CollisionDetectionHashing_VMV03.pdf
+//
+
+template <typename T, size_t N>
+class HashGrid
+  : public NonCopyable
+{
+  public:
+    typedef T ValueType;
+    static const size_t Dimension = N;
+
+    typedef Vector<T, N> VectorType;
+    typedef Answer<T> AnswerType;
+
+    // Constructor, builds an empty grid.
+    HashGrid();
+
+    // Build the grid. The content of the input vector is moved into the grid.
+    // Queries are fastest when the cell size is about twice the search radius.
+    void build_move_points(
+        std::vector<VectorType>&    points,
+        const ValueType             cell_size);
+
+    // Return true if the grid does not contain any point.
+    bool empty() const;
+
+    // Transform an internal index to a user-data index.
+    size_t remap(const size_t i) const;
+
+    // Return the i'th point, where i is an internal index.
+    const VectorType& get_point(const size_t i) const;
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
+    // Find the points within a given distance of a query point. If there are more
+    // such points than the answer can hold, only the closest ones are returned.
+    void query(
+        const VectorType&           query_point,
+        const ValueType             query_max_square_distance,
+        AnswerType&                 answer) const;
+
+  private:
+    // Maximum number of cells a query can visit without allocating memory.
+    enum { MaxQueryCellCount = 64 };
+
+    VectorType                      m_origin;
+    ValueType                       m_cell_size;
+    ValueType                       m_rcp_cell_size;
+    uint32                          m_bucket_mask;
+    std::vector<VectorType>         m_points;
+    std::vector<size_t>             m_indices;
+    std::vector<uint32>             m_bucket_offsets;
+
+    int32 cell_coordinate(const ValueType x, const size_t dim) const;
+
+    uint32 bucket_index(const int32 cell[N]) const;
+
+    void linear_query(
+        const VectorType&           query_point,
+        const ValueType             query_max_square_distance,
+        AnswerType&                 answer) const;
+
+    static void insert(
+        AnswerType&                 answer,
+        const size_t                max_answer_size,
+        const size_t                index,
+        const ValueType             square_dist,
+        ValueType&                  max_square_dist);
+};
+
+typedef HashGrid<float, 2>  HashGrid2f;
+typedef HashGrid<double, 2> HashGrid2d;
+typedef HashGrid<float, 3>  HashGrid3f;
+typedef HashGrid<double, 3> HashGrid3d;
+
+
+//
+// Implementation.
+//
+
+template <typename T, size_t N>
+HashGrid<T, N>::HashGrid()
+  : m_origin(VectorType(ValueType(0.0)))
+  , m_cell_size(ValueType(1.0))
+  , m_rcp_cell_size(ValueType(1.0))
+  , m_bucket_mask(0)
+  , m_bucket_offsets(2, 0)
+{
+}
+
+template <typename T, size_t N>
+void HashGrid<T, N>::build_move_points(
+    std::vector<VectorType>&        points,
+    const ValueType                 cell_size)
+{
+    assert(cell_size > ValueType(0.0));
+
+    const size_t point_count = points.size();
+
+    m_points.clear();
+    m_indices.clear();
+
+    // Use about one bucket per point.
+    const uint32 bucket_count = next_pow2<uint32>(static_cast<uint32>(std::max<size_t>(point_count, 1)));
+    m_bucket_mask = bucket_count - 1;
+    m_bucket_offsets.assign(bucket_count + 1, 0);
+
+    if (point_count == 0)
+    {
+        points.clear();
+        return;
+    }
+
+    // Anchor the grid at the lower corner of the points to keep cell coordinates small.
+    m_origin = points[0];
+    for (size_t i = 1; i < point_count; ++i)
+    {
+        for (size_t d = 0; d < N; ++d)
+            m_origin[d] = std::min(m_origin[d], points[i][d]);
+    }
+
+    m_cell_size = cell_size;
+    m_rcp_cell_size = ValueType(1.0) / cell_size;
+
+    // Compute the bucket of each point and count the points in each bucket.
+    std::vector<uint32> point_buckets(point_count);
+    for (size_t i = 0; i < point_count; ++i)
+    {
+        int32 cell[N];
+        for (size_t d = 0; d < N; ++d)
+            cell[d] = cell_coordinate(points[i][d], d);
+
+        const uint32 bucket = bucket_index(cell);
+        point_buckets[i] = bucket;
+        ++m_bucket_offsets[bucket + 1];
+    }
+
+    // Compute the index of the first point of each bucket.
+    for (uint32 i = 0; i < bucket_count; ++i)
+        m_bucket_offsets[i + 1] += m_bucket_offsets[i];
+
+    // Scatter the points to their buckets.
+    std::vector<uint32> cursors(m_bucket_offsets.begin(), m_bucket_offsets.end() - 1);
+    m_points.resize(point_count);
+    m_indices.resize(point_count);
+    for (size_t i = 0; i < point_count; ++i)
+    {
+        const uint32 dest = cursors[point_buckets[i]]++;
+        m_points[dest] = points[i];
+        m_indices[dest] = i;
+    }
+
+    points.clear();
+}
+
+template <typename T, size_t N>
+inline bool HashGrid<T, N>::empty() const
+{
+    return m_points.empty();
+}
+
+template <typename T, size_t N>
+inline size_t HashGrid<T, N>::remap(const size_t i) const
+{
+    assert(i < m_indices.size());
+    return m_indices[i];
+}
+
+template <typename T, size_t N>
+inline const typename HashGrid<T, N>::VectorType& HashGrid<T, N>::get_point(const size_t i) const
+{
+    assert(i < m_points.size());
+    return m_points[i];
+}
+
+template <typename T, size_t N>
+size_t HashGrid<T, N>::get_memory_size() const
+{
+    return
+          sizeof(*this)
+        + m_points.capacity() * sizeof(VectorType)
+        + m_indices.capacity() * sizeof(size_t)
+        + m_bucket_offsets.capacity() * sizeof(uint32);
+}
+
+template <typename T, size_t N>
+void HashGrid<T, N>::query(
+    const VectorType&               query_point,
+    const ValueType                 query_max_square_distance,
+    AnswerType&                     answer) const
+{
+    answer.clear();
+
+    if (m_points.empty())
+        return;
+
+    // Compute the range of cells overlapped by the search sphere.
+    const ValueType radius = std::sqrt(query_max_square_distance);
+    const size_t point_count = m_points.size();
+    int32 cell_min[N], cell_max[N];
+    size_t cell_count = 1;
+    for (size_t d = 0; d < N; ++d)
+    {
+        cell_min[d] = cell_coordinate(query_point[d] - radius, d);
+        cell_max[d] = cell_coordinate(query_point[d] + radius, d);
+        cell_count *= static_cast<size_t>(cell_max[d] - cell_min[d] + 1);
+        if (cell_count > point_count)
+            break;
+    }
+
+    // The search sphere is much larger than the cells: scanning all points is cheaper.
+    if (cell_count > point_count)
+    {
+        linear_query(query_point, query_max_square_distance, answer);
+        return;
+    }
+
+    // Collect the buckets of these cells.
+    uint32 local_buckets[MaxQueryCellCount];
+    std::vector<uint32> allocated_buckets;
+    uint32* buckets = local_buckets;
+    if (cell_count > MaxQueryCellCount)
+    {
+        allocated_buckets.resize(cell_count);
+        buckets = &allocated_buckets[0];
+    }
+
+    size_t bucket_count = 0;
+
+    int32 cell[N];
+    for (size_t d = 0; d < N; ++d)
+        cell[d] = cell_min[d];
+
+    while (true)
+    {
+        // Skip cells that do not intersect the search sphere.
+        ValueType cell_square_dist(0.0);
+        for (size_t d = 0; d < N; ++d)
+        {
+            const ValueType cell_lo = m_origin[d] + cell[d] * m_cell_size;
+            const ValueType cell_hi = cell_lo + m_cell_size;
+            if (query_point[d] < cell_lo)
+                cell_square_dist += square(cell_lo - query_point[d]);
+            else if (query_point[d] > cell_hi)
+                cell_square_dist += square(query_point[d] - cell_hi);
+        }
+
+        if (cell_square_dist <= query_max_square_distance)
+            buckets[bucket_count++] = bucket_index(cell);
+
+        size_t d = 0;
+        while (d < N && cell[d] == cell_max[d])
+        {
+            cell[d] = cell_min[d];
+            ++d;
+        }
+
+        if (d == N)
+            break;
+
+        ++cell[d];
+    }
+
+    // Distinct cells may share a bucket, and each bucket must be visited only once.
+    std::sort(buckets, buckets + bucket_count);
+    bucket_count = std::unique(buckets, buckets + bucket_count) - buckets;
+
+    // Collect the points of these buckets that are within the search sphere.
+    const VectorType* APPLESEED_RESTRICT points = &m_points.front();
+    const size_t max_answer_size = answer.m_max_size;
+    ValueType max_square_dist = query_max_square_distance;
+
+    for (size_t i = 0; i < bucket_count; ++i)
+    {
+        const uint32 begin = m_bucket_offsets[buckets[i]];
+        const uint32 end = m_bucket_offsets[buckets[i] + 1];
+
+        for (uint32 j = begin; j < end; ++j)
+        {
+            const ValueType square_dist = square_distance(points[j], query_point);
+
+            if (square_dist <= max_square_dist)
+                insert(answer, max_answer_size, j, square_dist, max_square_dist);
+        }
+    }
+}
+
+template <typename T, size_t N>
+inline int32 HashGrid<T, N>::cell_coordinate(const ValueType x, const size_t dim) const
+{
+    return static_cast<int32>(std::floor((x - m_origin[dim]) * m_rcp_cell_size));
+}
+
+template <typename T, size_t N>
+inline uint32 HashGrid<T, N>::bucket_index(const int32 cell[N]) const
+{
+    uint32 h = 0;
+
+    for (size_t d = 0; d < N; ++d)
+        h = hash_uint32(h + static_cast<uint32>(cell[d]));
+
+    return h & m_bucket_mask;
+}
+
+template <typename T, size_t N>
+void HashGrid<T, N>::linear_query(
+    const VectorType&               query_point,
+    const ValueType                 query_max_square_distance,
+    AnswerType&                     answer) const
+{
+    const VectorType* APPLESEED_RESTRICT points = &m_points.front();
+    const size_t point_count = m_points.size();
+    const size_t max_answer_size = answer.m_max_size;
+    ValueType max_square_dist = query_max_square_distance;
+
+    for (size_t i = 0; i < point_count; ++i)
+    {
+        const ValueType square_dist = square_distance(points[i], query_point);
+
+        if (square_dist <= max_square_dist)
+            insert(answer, max_answer_size, i, square_dist, max_square_dist);
+    }
+}
+
+template <typename T, size_t N>
+inline void HashGrid<T, N>::insert(
+    AnswerType&                     answer,
+    const size_t                    max_answer_size,
+    const size_t                    index,
+    const ValueType                 square_dist,
+    ValueType&                      max_square_dist)
+{
+    if (answer.m_size < max_answer_size)
+    {
+        // Fill up the answer like an array.
+        answer.array_insert(index, square_dist);
+
+        // Once the answer is full, transform it into a heap and only accept closer points.
+        if (answer.m_size == max_answer_size)
+        {
+            answer.make_heap();
+            max_square_dist = answer.top().m_square_dist;
+        }
+    }
+    else if (square_dist < max_square_dist)
+    {
+        answer.heap_insert(index, square_dist);
+        max_square_dist = answer.top().m_square_dist;
+    }
+}
+
+}       // namespace knn
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_KNN_KNN_HASHGRID_H
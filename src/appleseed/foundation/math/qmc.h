@@ -56,7 +56,6 @@ namespace foundation
 //   implement specializations of Halton and Hammersley sequences generators for bases (2,3).
 //   implement incremental radical inverse (for successive input values).
 //   implement vectorized radical inverse functions with SSE2.
-//   implement Sobol sequence generator.
 //
 
 
@@ -0,0 +1,387 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_SAMPLING_HIERARCHICALIMAGEIMPORTANCESAMPLER_H
+#define APPLESEED_FOUNDATION_MATH_SAMPLING_HIERARCHICALIMAGEIMPORTANCESAMPLER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/job/iabortswitch.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// Importance sampler for images based on a pyramid of importance values.
+//
+// Level 0 of the pyramid holds the importance of each pixel; each texel of a coarser
+// level holds the sum of the (up to) 2x2 texels it covers in the finer level. Sampling
+// starts at the 1x1 top level and refines the choice one level at a time, selecting
+// a row of children with s[1] and a column of children with s[0]. Contrary to
+// foundation::ImageImportanceSampler, no payload is stored: only one scalar per pixel
+// (plus a third of that for the coarser levels) is kept in memory.
+//
+// The ImageSampler type must conform to the following prototype:
+//
+//   class ImageSampler
+//   {
+//     public:
+//       void sample(
+//           const size_t   x,
+//           const size_t   y,
+//           Importance&    importance);
+//   };
+//
+
+template <typename Importance>
+class HierarchicalImageImportanceSampler
+  : public NonCopyable
+{
+  public:
+    typedef Vector<Importance, 2> Vector2Type;
+
+    // Constructor.
+    HierarchicalImageImportanceSampler(
+        const size_t        width,
+        const size_t        height);
+
+    // Return the dimensions of the image.
+    size_t get_width() const;
+    size_t get_height() const;
+
+    // Resample the image and rebuild the pyramid.
+    template <typename ImageSampler>
+    void rebuild(
+        ImageSampler&       sampler,
+        IAbortSwitch*       abort_switch = 0);
+
+    // Resample a single row of the image. Distinct rows may be resampled concurrently,
+    // using distinct samplers. rebuild_levels() must be called once all rows are done.
+    template <typename ImageSampler>
+    void rebuild_row(
+        const size_t        y,
+        ImageSampler&       sampler);
+
+    // Direct access to the importance of the pixels, in row-major order.
+    // rebuild_levels() must be called after the values have been modified.
+    Importance* get_importances();
+    const Importance* get_importances() const;
+
+    // Rebuild the coarse levels of the pyramid from the importance of the pixels.
+    void rebuild_levels();
+
+    // Sample the image and return the coordinates of the chosen pixel
+    // and its probability density.
+    void sample(
+        const Vector2Type&  s,
+        size_t&             x,
+        size_t&             y,
+        Importance&         probability) const;
+
+    // Return the probability density of a given pixel.
+    Importance get_pdf(
+        const size_t        x,
+        const size_t        y) const;
+
+  private:
+    struct Level
+    {
+        size_t                      m_width;
+        size_t                      m_height;
+        std::vector<Importance>     m_values;
+
+        Importance get(const size_t x, const size_t y) const;
+    };
+
+    const size_t            m_width;
+    const size_t            m_height;
+    const Importance        m_rcp_pixel_count;
+
+    std::vector<Level>      m_levels;
+    bool                    m_valid;
+
+    // Choose between two children given their importance and rescale s to [0,1).
+    static size_t choose(
+        double&             s,
+        const Importance    a,
+        const Importance    b);
+};
+
+
+//
+// HierarchicalImageImportanceSampler class implementation.
+//
+
+template <typename Importance>
+inline Importance HierarchicalImageImportanceSampler<Importance>::Level::get(
+    const size_t            x,
+    const size_t            y) const
+{
+    return x < m_width && y < m_height ? m_values[y * m_width + x] : Importance(0.0);
+}
+
+template <typename Importance>
+HierarchicalImageImportanceSampler<Importance>::HierarchicalImageImportanceSampler(
+    const size_t            width,
+    const size_t            height)
+  : m_width(width)
+  , m_height(height)
+  , m_rcp_pixel_count(Importance(1.0) / (width * height))
+  , m_valid(false)
+{
+    assert(width > 0);
+    assert(height > 0);
+
+    size_t level_width = width;
+    size_t level_height = height;
+
+    while (true)
+    {
+        m_levels.push_back(Level());
+
+        Level& level = m_levels.back();
+        level.m_width = level_width;
+        level.m_height = level_height;
+        level.m_values.resize(level_width * level_height, Importance(0.0));
+
+        if (level_width == 1 && level_height == 1)
+            break;
+
+        level_width = (level_width + 1) / 2;
+        level_height = (level_height + 1) / 2;
+    }
+}
+
+template <typename Importance>
+inline size_t HierarchicalImageImportanceSampler<Importance>::get_width() const
+{
+    return m_width;
+}
+
+template <typename Importance>
+inline size_t HierarchicalImageImportanceSampler<Importance>::get_height() const
+{
+    return m_height;
+}
+
+template <typename Importance>
+template <typename ImageSampler>
+void HierarchicalImageImportanceSampler<Importance>::rebuild(
+    ImageSampler&           sampler,
+    IAbortSwitch*           abort_switch)
+{
+    m_valid = false;
+
+    for (size_t y = 0; y < m_height; ++y)
+    {
+        if (is_aborted(abort_switch))
+            return;
+
+        rebuild_row(y, sampler);
+    }
+
+    rebuild_levels();
+}
+
+template <typename Importance>
+template <typename ImageSampler>
+void HierarchicalImageImportanceSampler<Importance>::rebuild_row(
+    const size_t            y,
+    ImageSampler&           sampler)
+{
+    assert(y < m_height);
+
+    Importance* row = &m_levels[0].m_values[y * m_width];
+
+    for (size_t x = 0; x < m_width; ++x)
+    {
+        Importance importance;
+        sampler.sample(x, y, importance);
+
+        assert(importance >= Importance(0.0));
+        row[x] = importance;
+    }
+}
+
+template <typename Importance>
+inline Importance* HierarchicalImageImportanceSampler<Importance>::get_importances()
+{
+    return &m_levels[0].m_values[0];
+}
+
+template <typename Importance>
+inline const Importance* HierarchicalImageImportanceSampler<Importance>::get_importances() const
+{
+    return &m_levels[0].m_values[0];
+}
+
+template <typename Importance>
+void HierarchicalImageImportanceSampler<Importance>::rebuild_levels()
+{
+    for (size_t i = 1; i < m_levels.size(); ++i)
+    {
+        const Level& child = m_levels[i - 1];
+        Level& parent = m_levels[i];
+
+        for (size_t y = 0; y < parent.m_height; ++y)
+        {
+            for (size_t x = 0; x < parent.m_width; ++x)
+            {
+                // Same order of operations as in sample() and get_pdf().
+                const Importance top = child.get(2 * x, 2 * y) + child.get(2 * x + 1, 2 * y);
+                const Importance bottom = child.get(2 * x, 2 * y + 1) + child.get(2 * x + 1, 2 * y + 1);
+                parent.m_values[y * parent.m_width + x] = top + bottom;
+            }
+        }
+    }
+
+    m_valid = m_levels.back().m_values[0] > Importance(0.0);
+}
+
+template <typename Importance>
+inline size_t HierarchicalImageImportanceSampler<Importance>::choose(
+    double&                 s,
+    const Importance        a,
+    const Importance        b)
+{
+    assert(s >= 0.0 && s < 1.0);
+
+    const double p = static_cast<double>(a) / (static_cast<double>(a) + b);
+
+    size_t result;
+
+    if (s < p)
+    {
+        s /= p;
+        result = 0;
+    }
+    else
+    {
+        s = (s - p) / (1.0 - p);
+        result = 1;
+    }
+
+    s = std::min(s, 1.0 - std::numeric_limits<double>::epsilon());
+
+    return result;
+}
+
+template <typename Importance>
+inline void HierarchicalImageImportanceSampler<Importance>::sample(
+    const Vector2Type&      s,
+    size_t&                 x,
+    size_t&                 y,
+    Importance&             probability) const
+{
+    if (m_valid)
+    {
+        double sx = static_cast<double>(s[0]);
+        double sy = static_cast<double>(s[1]);
+
+        x = 0;
+        y = 0;
+        probability = Importance(1.0);
+
+        for (size_t i = m_levels.size() - 1; i > 0; --i)
+        {
+            const Level& child = m_levels[i - 1];
+            const size_t cx = 2 * x;
+            const size_t cy = 2 * y;
+
+            // Select a row of children.
+            const Importance top = child.get(cx, cy) + child.get(cx + 1, cy);
+            const Importance bottom = child.get(cx, cy + 1) + child.get(cx + 1, cy + 1);
+            y = cy + choose(sy, top, bottom);
+
+            // Select a child within this row.
+            const Importance left = child.get(cx, y);
+            const Importance right = child.get(cx + 1, y);
+            x = cx + choose(sx, left, right);
+
+            probability *= child.get(x, y) / (top + bottom);
+        }
+
+        assert(x < m_width);
+        assert(y < m_height);
+    }
+    else
+    {
+        // Uniform random sampling.
+        x = truncate<size_t>(s[0] * m_width);
+        y = truncate<size_t>(s[1] * m_height);
+
+        probability = m_rcp_pixel_count;
+    }
+
+    assert(probability > Importance(0.0));
+}
+
+template <typename Importance>
+inline Importance HierarchicalImageImportanceSampler<Importance>::get_pdf(
+    const size_t            x,
+    const size_t            y) const
+{
+    assert(x < m_width);
+    assert(y < m_height);
+
+    if (!m_valid)
+        return m_rcp_pixel_count;
+
+    Importance probability(1.0);
+
+    for (size_t i = m_levels.size() - 1; i > 0; --i)
+    {
+        const Level& child = m_levels[i - 1];
+        const Importance value = child.get(x >> (i - 1), y >> (i - 1));
+
+        if (value == Importance(0.0))
+            return Importance(0.0);
+
+        const size_t cx = 2 * (x >> i);
+        const size_t cy = 2 * (y >> i);
+        const Importance top = child.get(cx, cy) + child.get(cx + 1, cy);
+        const Importance bottom = child.get(cx, cy + 1) + child.get(cx + 1, cy + 1);
+
+        probability *= value / (top + bottom);
+    }
+
+    return probability;
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_SAMPLING_HIERARCHICALIMAGEIMPORTANCESAMPLER_H
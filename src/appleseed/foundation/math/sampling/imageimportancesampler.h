@@ -35,12 +35,13 @@
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/image.h"
-#include "foundation/math/cdf.h"
+#include "foundation/math/aliastable.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/job/iabortswitch.h"
 
 // Standard headers.
+#include <cassert>
 #include <cstddef>
 #include <utility>
 
@@ -76,12 +77,23 @@ class ImageImportanceSampler
     // Destructor.
     ~ImageImportanceSampler();
 
-    // Resample the image and rebuild the CDFs.
+    // Resample the image and rebuild the alias tables.
     template <typename ImageSampler>
     void rebuild(
         ImageSampler&       sampler,
         IAbortSwitch*       abort_switch = 0);
 
+    // Resample a single row of the image and rebuild its alias table.
+    // Distinct rows may be rebuilt concurrently, using distinct samplers.
+    // rebuild_rows_table() must be called once all rows have been rebuilt.
+    template <typename ImageSampler>
+    void rebuild_row(
+        const size_t        y,
+        ImageSampler&       sampler);
+
+    // Rebuild the alias table used to select rows.
+    void rebuild_rows_table();
+
     // Sample the image and return the coordinates of the chosen pixel
     // and its probability density.
     void sample(
@@ -105,15 +117,15 @@ class ImageImportanceSampler
         const size_t        y) const;
 
   private:
-    typedef CDF<size_t, Importance> RowCDF;
-    typedef CDF<Payload, Importance> ColCDF;
+    typedef AliasTable<size_t, Importance> RowTable;
+    typedef AliasTable<Payload, Importance> ColTable;
 
     const size_t            m_width;
     const size_t            m_height;
     const Importance        m_rcp_pixel_count;
 
-    ColCDF*                 m_cols_cdf;
-    RowCDF                  m_rows_cdf;
+    ColTable*               m_cols_tables;
+    RowTable                m_rows_table;
 };
 
 
@@ -147,13 +159,13 @@ ImageImportanceSampler<Payload, Importance>::ImageImportanceSampler(
   , m_height(height)
   , m_rcp_pixel_count(Importance(1.0) / (width * height))
 {
-    m_cols_cdf = new ColCDF[m_height];
+    m_cols_tables = new ColTable[m_height];
 }
 
 template <typename Payload, typename Importance>
 ImageImportanceSampler<Payload, Importance>::~ImageImportanceSampler()
 {
-    delete [] m_cols_cdf;
+    delete [] m_cols_tables;
 }
 
 template <typename Payload, typename Importance>
@@ -162,38 +174,57 @@ void ImageImportanceSampler<Payload, Importance>::rebuild(
     ImageSampler&           sampler,
     IAbortSwitch*           abort_switch)
 {
-    m_rows_cdf.clear();
-    m_rows_cdf.reserve(m_height);
+    m_rows_table.clear();
 
     for (size_t y = 0, ye = m_height; y < ye; ++y)
     {
         if (is_aborted(abort_switch))
-        {
-            m_rows_cdf.clear();
-            break;
-        }
+            return;
 
-        m_cols_cdf[y].clear();
-        m_cols_cdf[y].reserve(m_width);
+        rebuild_row(y, sampler);
+    }
 
-        for (size_t x = 0, xe = m_width; x < xe; ++x)
-        {
-            Payload payload;
-            Importance importance;
+    rebuild_rows_table();
+}
+
+template <typename Payload, typename Importance>
+template <typename ImageSampler>
+void ImageImportanceSampler<Payload, Importance>::rebuild_row(
+    const size_t            y,
+    ImageSampler&           sampler)
+{
+    assert(y < m_height);
 
-            sampler.sample(x, y, payload, importance);
+    ColTable& cols_table = m_cols_tables[y];
 
-            m_cols_cdf[y].insert(payload, importance);
-        }
+    cols_table.clear();
+    cols_table.reserve(m_width);
+
+    for (size_t x = 0, xe = m_width; x < xe; ++x)
+    {
+        Payload payload;
+        Importance importance;
 
-        if (m_cols_cdf[y].valid())
-            m_cols_cdf[y].prepare();
+        sampler.sample(x, y, payload, importance);
 
-        m_rows_cdf.insert(y, m_cols_cdf[y].weight());
+        cols_table.insert(payload, importance);
     }
 
-    if (m_rows_cdf.valid())
-        m_rows_cdf.prepare();
+    if (cols_table.valid())
+        cols_table.prepare();
+}
+
+template <typename Payload, typename Importance>
+void ImageImportanceSampler<Payload, Importance>::rebuild_rows_table()
+{
+    m_rows_table.clear();
+    m_rows_table.reserve(m_height);
+
+    for (size_t y = 0, ye = m_height; y < ye; ++y)
+        m_rows_table.insert(y, m_cols_tables[y].weight());
+
+    if (m_rows_table.valid())
+        m_rows_table.prepare();
 }
 
 template <typename Payload, typename Importance>
@@ -203,17 +234,17 @@ inline void ImageImportanceSampler<Payload, Importance>::sample(
     size_t&                 y,
     Importance&             probability) const
 {
-    if (m_rows_cdf.valid())
+    if (m_rows_table.valid())
     {
         // Select a row.
-        const typename RowCDF::ItemWeightPair& row = m_rows_cdf.sample(s[1]);
+        const typename RowTable::ItemWeightPair& row = m_rows_table.sample(s[1]);
         assert(row.second != Importance(0.0));
         y = row.first;
 
         // Select a column within this row.
-        const typename ColCDF::ItemWeightPair& col = m_cols_cdf[y].sample(s[0]);
+        const typename ColTable::ItemWeightPair& col = m_cols_tables[y].sample(s[0]);
         assert(col.second != Importance(0.0));
-        x = &col - &m_cols_cdf[y][0];
+        x = &col - &m_cols_tables[y][0];
 
         probability = row.second * col.second;
     }
@@ -237,17 +268,17 @@ inline void ImageImportanceSampler<Payload, Importance>::sample(
     Payload&                payload,
     Importance&             probability) const
 {
-    if (m_rows_cdf.valid())
+    if (m_rows_table.valid())
     {
         // Select a row.
-        const typename RowCDF::ItemWeightPair& row = m_rows_cdf.sample(s[1]);
+        const typename RowTable::ItemWeightPair& row = m_rows_table.sample(s[1]);
         assert(row.second != Importance(0.0));
         y = row.first;
 
         // Select a column within this row.
-        const typename ColCDF::ItemWeightPair& col = m_cols_cdf[y].sample(s[0]);
+        const typename ColTable::ItemWeightPair& col = m_cols_tables[y].sample(s[0]);
         assert(col.second != Importance(0.0));
-        x = &col - &m_cols_cdf[y][0];
+        x = &col - &m_cols_tables[y][0];
 
         payload = col.first;
         probability = row.second * col.second;
@@ -258,7 +289,7 @@ inline void ImageImportanceSampler<Payload, Importance>::sample(
         x = truncate<size_t>(s[0] * m_width);
         y = truncate<size_t>(s[1] * m_height);
 
-        payload = m_cols_cdf[y][x].first;
+        payload = m_cols_tables[y][x].first;
         probability = m_rcp_pixel_count;
     }
 
@@ -270,12 +301,12 @@ inline Importance ImageImportanceSampler<Payload, Importance>::get_pdf(
     const size_t            x,
     const size_t            y) const
 {
-    if (m_rows_cdf.valid())
+    if (m_rows_table.valid())
     {
-        if (m_cols_cdf[y].valid())
+        if (m_cols_tables[y].valid())
         {
-            const typename RowCDF::ItemWeightPair& row = m_rows_cdf[y];
-            const typename ColCDF::ItemWeightPair& col = m_cols_cdf[y][x];
+            const typename RowTable::ItemWeightPair& row = m_rows_table[y];
+            const typename ColTable::ItemWeightPair& col = m_cols_tables[y][x];
             return row.second * col.second;
         }
         else
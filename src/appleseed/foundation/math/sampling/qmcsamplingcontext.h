@@ -31,11 +31,16 @@
 #define APPLESEED_FOUNDATION_MATH_SAMPLING_QMCSAMPLINGCONTEXT_H
 
 // appleseed.foundation headers.
+#include "foundation/math/bluenoise.h"
+#include "foundation/math/hash.h"
 #include "foundation/math/permutation.h"
 #include "foundation/math/primes.h"
 #include "foundation/math/qmc.h"
 #include "foundation/math/rng/distribution.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/sobol.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/test/helpers.h"
 
 // Standard headers.
@@ -59,11 +64,18 @@ namespace foundation
 //   - Cranley-Patterson rotation
 //   - Monte Carlo padding
 //
-// Reference:
+// or, alternatively, on Owen-scrambled Sobol sequences padded by reseeding the
+// scrambling of every child context (see foundation/math/sobol.h), optionally
+// shared by all pixels and decorrelated by blue-noise rotations.
+//
+// References:
 //
 //   Kollig and Keller, Efficient Multidimensional Sampling
 //   www.uni-kl.de/AG-Heinrich/EMS.pdf
 //
+//   Georgiev and Fajardo, Blue-noise Dithered Sampling
+//   https://www.arnoldrenderer.com/research/dither_abstract.pdf
+//
 
 template <typename RNG>
 class QMCSamplingContext
@@ -72,10 +84,16 @@ class QMCSamplingContext
     // Random number generator type.
     typedef RNG RNGType;
 
-    // This sampler can operate in two modes:
+    // This sampler can operate in four modes:
     //   1. In QMC mode, it uses possibly patent-encumbered techniques.
     //   2. In RNG mode, it works like RNGSamplingContext and sticks to random sampling.
-    enum Mode { QMCMode, RNGMode };
+    //   3. In Sobol mode, it uses Owen-scrambled Sobol sequences seeded by the initial
+    //      instance number, i.e. by pixel when the instance number is a pixel hash.
+    //   4. In blue-noise mode, it uses the same Owen-scrambled Sobol sequences for all
+    //      the pixels set with set_pixel() and rotates them by blue-noise offsets, which
+    //      distributes the error as blue noise in screen space at low sample counts.
+    //      Sampling contexts without a pixel behave like in Sobol mode.
+    enum Mode { QMCMode, RNGMode, SobolMode, BlueNoiseMode };
 
     // Construct a sampling context of dimension 0. It cannot be used
     // directly; only child contexts obtained by splitting can.
@@ -110,6 +128,13 @@ class QMCSamplingContext
     // Set the instance number.
     void set_instance(const size_t instance);
 
+    // In blue-noise mode, set the pixel of this sampling context and the seed shared
+    // by all pixels (typically varying from pass to pass). No effect in other modes.
+    void set_pixel(
+        const size_t    x,
+        const size_t    y,
+        const uint32    seed);
+
     // Return the next sample in [0,1)^N.
     // Works for scalars and foundation::Vector<>.
     template <typename T> T next2();
@@ -140,6 +165,12 @@ class QMCSamplingContext
     size_t      m_instance;
     VectorType  m_offset;
 
+    size_t      m_first_instance;   // instance number of the first Sobol point
+    uint32      m_first_index;      // index of the first Sobol point
+    uint32      m_seed;             // Sobol scrambling seed
+    size_t      m_pixel_x;          // blue-noise mask coordinates
+    size_t      m_pixel_y;
+
     // Cranley-Patterson rotation.
     template <typename T>
     static T rotate(T x, const T offset);
@@ -150,10 +181,17 @@ class QMCSamplingContext
         const size_t    base_dimension,
         const size_t    base_instance,
         const size_t    dimension,
-        const size_t    sample_count);
+        const size_t    sample_count,
+        const uint32    first_index,
+        const uint32    seed,
+        const size_t    pixel_x,
+        const size_t    pixel_y);
 
     void compute_offset();
 
+    uint32 compute_child_first_index(const size_t sample_count) const;
+    uint32 compute_child_seed(const size_t base_dimension) const;
+
     template <typename T> struct Tag {};
 
     template <typename T> T next2(Tag<T>);
@@ -177,6 +215,11 @@ inline QMCSamplingContext<RNG>::QMCSamplingContext(
   , m_sample_count(0)
   , m_instance(0)
   , m_offset(0.0)
+  , m_first_instance(0)
+  , m_first_index(0)
+  , m_seed(0)
+  , m_pixel_x(0)
+  , m_pixel_y(0)
 {
 }
 
@@ -195,6 +238,11 @@ inline QMCSamplingContext<RNG>::QMCSamplingContext(
   , m_sample_count(sample_count)
   , m_instance(instance)
   , m_offset(0.0)
+  , m_first_instance(instance)
+  , m_first_index(0)
+  , m_seed(hash_uint32(static_cast<uint32>(instance)))
+  , m_pixel_x(0)
+  , m_pixel_y(0)
 {
     assert(dimension <= VectorType::Dimension);
 }
@@ -206,7 +254,11 @@ inline QMCSamplingContext<RNG>::QMCSamplingContext(
     const size_t        base_dimension,
     const size_t        base_instance,
     const size_t        dimension,
-    const size_t        sample_count)
+    const size_t        sample_count,
+    const uint32        first_index,
+    const uint32        seed,
+    const size_t        pixel_x,
+    const size_t        pixel_y)
   : m_rng(rng)
   , m_mode(mode)
   , m_base_dimension(base_dimension)
@@ -214,10 +266,15 @@ inline QMCSamplingContext<RNG>::QMCSamplingContext(
   , m_dimension(dimension)
   , m_sample_count(sample_count)
   , m_instance(0)
+  , m_first_instance(0)
+  , m_first_index(first_index)
+  , m_seed(seed)
+  , m_pixel_x(pixel_x)
+  , m_pixel_y(pixel_y)
 {
     assert(dimension <= VectorType::Dimension);
 
-    if (m_mode == QMCMode)
+    if (m_mode == QMCMode || m_mode == BlueNoiseMode)
         compute_offset();
 }
 
@@ -232,6 +289,11 @@ QMCSamplingContext<RNG>::operator=(const QMCSamplingContext& rhs)
     m_sample_count = rhs.m_sample_count;
     m_instance = rhs.m_instance;
     m_offset = rhs.m_offset;
+    m_first_instance = rhs.m_first_instance;
+    m_first_index = rhs.m_first_index;
+    m_seed = rhs.m_seed;
+    m_pixel_x = rhs.m_pixel_x;
+    m_pixel_y = rhs.m_pixel_y;
 
     return *this;
 }
@@ -248,7 +310,15 @@ inline QMCSamplingContext<RNG> QMCSamplingContext<RNG>::split(
             m_base_dimension + m_dimension,         // dimension allocation
             m_base_instance + m_instance,           // decorrelation by generalization
             dimension,
-            sample_count);
+            sample_count,
+            m_mode == SobolMode || m_mode == BlueNoiseMode
+                ? compute_child_first_index(sample_count)
+                : 0,
+            m_mode == SobolMode || m_mode == BlueNoiseMode
+                ? compute_child_seed(m_base_dimension + m_dimension)
+                : 0,
+            m_pixel_x,
+            m_pixel_y);
 }
 
 template <typename RNG>
@@ -259,13 +329,20 @@ inline void QMCSamplingContext<RNG>::split_in_place(
     assert(m_sample_count == 0 || m_instance == m_sample_count);    // can't split in the middle of a sequence
     assert(dimension <= VectorType::Dimension);
 
+    if (m_mode == SobolMode || m_mode == BlueNoiseMode)
+    {
+        m_first_index = compute_child_first_index(sample_count);
+        m_seed = compute_child_seed(m_base_dimension + m_dimension);
+    }
+
     m_base_dimension += m_dimension;                // dimension allocation
     m_base_instance += m_instance;                  // decorrelation by generalization
     m_dimension = dimension;
     m_sample_count = sample_count;
     m_instance = 0;
+    m_first_instance = 0;
 
-    if (m_mode == QMCMode)
+    if (m_mode == QMCMode || m_mode == BlueNoiseMode)
         compute_offset();
 }
 
@@ -275,6 +352,24 @@ inline void QMCSamplingContext<RNG>::set_instance(const size_t instance)
     m_instance = instance;
 }
 
+template <typename RNG>
+inline void QMCSamplingContext<RNG>::set_pixel(
+    const size_t        x,
+    const size_t        y,
+    const uint32        seed)
+{
+    if (m_mode == BlueNoiseMode)
+    {
+        m_pixel_x = x & BlueNoiseTileMask;
+        m_pixel_y = y & BlueNoiseTileMask;
+        m_seed = seed;
+        m_first_instance = m_instance;
+        m_first_index = 0;
+
+        compute_offset();
+    }
+}
+
 template <typename RNG>
 template <typename T>
 inline T QMCSamplingContext<RNG>::next2()
@@ -311,6 +406,14 @@ inline T QMCSamplingContext<RNG>::rotate(T x, const T offset)
 template <typename RNG>
 inline void QMCSamplingContext<RNG>::compute_offset()
 {
+    if (m_mode == BlueNoiseMode)
+    {
+        for (size_t i = 0, d = m_base_dimension; i < m_dimension; ++i, ++d)
+            m_offset[i] = blue_noise<double>(m_pixel_x, m_pixel_y, d);
+
+        return;
+    }
+
     for (size_t i = 0, d = m_base_dimension; i < m_dimension; ++i, ++d)
     {
         if (d < FaurePermutationTableSize)
@@ -331,6 +434,39 @@ inline void QMCSamplingContext<RNG>::compute_offset()
     }
 }
 
+template <typename RNG>
+inline uint32 QMCSamplingContext<RNG>::compute_child_first_index(const size_t sample_count) const
+{
+    // Sobol index of the current sample of this context, i.e. of the last one returned.
+    const uint32 drawn = static_cast<uint32>(m_instance - m_first_instance);
+    const uint32 index = drawn > 0 ? m_first_index + drawn - 1 : m_first_index;
+
+    // The child sequences of successive samples of this context are consecutive,
+    // power-of-two aligned ranges of the same sequence. The child samples of all
+    // the samples of a pixel are thus stratified, and so are the samples of each
+    // child sequence. Child sequences of unknown length get a large range.
+    const uint32 stride =
+        sample_count > 0
+            ? next_pow2(static_cast<uint32>(sample_count))
+            : 1UL << 16;
+
+    return index * stride;
+}
+
+template <typename RNG>
+inline uint32 QMCSamplingContext<RNG>::compute_child_seed(const size_t base_dimension) const
+{
+    // Each dimension allocation gets its own scrambling, which replaces Monte Carlo
+    // padding in Sobol and blue-noise modes. The scrambling also shuffles point
+    // indices, so that child sequences are decorrelated from their parents. It only
+    // depends on the seed of the root context, so that in blue-noise mode all pixels
+    // share the same child sequences.
+    return
+        mix_uint32(
+            m_seed,
+            static_cast<uint32>(base_dimension));
+}
+
 template <typename RNG>
 template <typename T>
 inline T QMCSamplingContext<RNG>::next2(Tag<T>)
@@ -370,6 +506,25 @@ inline Vector<T, N> QMCSamplingContext<RNG>::next2(Tag<Vector<T, N> >)
             }
         }
     }
+    else if (m_mode == SobolMode || m_mode == BlueNoiseMode)
+    {
+        T values[4];
+        owen_scrambled_sobol4(
+            m_first_index + static_cast<uint32>(m_instance - m_first_instance),
+            m_seed,
+            values);
+
+        if (m_mode == BlueNoiseMode)
+        {
+            for (size_t i = 0; i < N; ++i)
+                v[i] = rotate(values[i], static_cast<T>(m_offset[i]));
+        }
+        else
+        {
+            for (size_t i = 0; i < N; ++i)
+                v[i] = values[i];
+        }
+    }
     else
     {
         for (size_t i = 0; i < N; ++i)
@@ -0,0 +1,78 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sobol.h"
+
+namespace foundation
+{
+
+//
+// Generator matrices of the first four dimensions of the Sobol sequence.
+//
+// Dimension 0 is the van der Corput sequence; dimensions 1 to 3 use the primitive
+// polynomials and initial direction numbers of Joe and Kuo (new-joe-kuo-6.21201).
+//
+
+const uint32 SobolMatrices[32][SobolDimensionCount] =
+{
+    { 0x80000000, 0x80000000, 0x80000000, 0x80000000 },
+    { 0x40000000, 0xC0000000, 0xC0000000, 0xC0000000 },
+    { 0x20000000, 0xA0000000, 0x60000000, 0x20000000 },
+    { 0x10000000, 0xF0000000, 0x90000000, 0x50000000 },
+    { 0x08000000, 0x88000000, 0xE8000000, 0xF8000000 },
+    { 0x04000000, 0xCC000000, 0x5C000000, 0x74000000 },
+    { 0x02000000, 0xAA000000, 0x8E000000, 0xA2000000 },
+    { 0x01000000, 0xFF000000, 0xC5000000, 0x93000000 },
+    { 0x00800000, 0x80800000, 0x68800000, 0xD8800000 },
+    { 0x00400000, 0xC0C00000, 0x9CC00000, 0x25400000 },
+    { 0x00200000, 0xA0A00000, 0xEE600000, 0x59E00000 },
+    { 0x00100000, 0xF0F00000, 0x55900000, 0xE6D00000 },
+    { 0x00080000, 0x88880000, 0x80680000, 0x78080000 },
+    { 0x00040000, 0xCCCC0000, 0xC09C0000, 0xB40C0000 },
+    { 0x00020000, 0xAAAA0000, 0x60EE0000, 0x82020000 },
+    { 0x00010000, 0xFFFF0000, 0x90550000, 0xC3050000 },
+    { 0x00008000, 0x80008000, 0xE8808000, 0x208F8000 },
+    { 0x00004000, 0xC000C000, 0x5CC0C000, 0x51474000 },
+    { 0x00002000, 0xA000A000, 0x8E606000, 0xFBEA2000 },
+    { 0x00001000, 0xF000F000, 0xC5909000, 0x75D93000 },
+    { 0x00000800, 0x88008800, 0x6868E800, 0xA0858800 },
+    { 0x00000400, 0xCC00CC00, 0x9C9C5C00, 0x914E5400 },
+    { 0x00000200, 0xAA00AA00, 0xEEEE8E00, 0xDBE79E00 },
+    { 0x00000100, 0xFF00FF00, 0x5555C500, 0x25DB6D00 },
+    { 0x00000080, 0x80808080, 0x8000E880, 0x58800080 },
+    { 0x00000040, 0xC0C0C0C0, 0xC0005CC0, 0xE54000C0 },
+    { 0x00000020, 0xA0A0A0A0, 0x60008E60, 0x79E00020 },
+    { 0x00000010, 0xF0F0F0F0, 0x9000C590, 0xB6D00050 },
+    { 0x00000008, 0x88888888, 0xE8006868, 0x800800F8 },
+    { 0x00000004, 0xCCCCCCCC, 0x5C009C9C, 0xC00C0074 },
+    { 0x00000002, 0xAAAAAAAA, 0x8E00EEEE, 0x200200A2 },
+    { 0x00000001, 0xFFFFFFFF, 0xC5005555, 0x50050093 }
+};
+
+}   // namespace foundation
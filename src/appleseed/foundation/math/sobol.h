@@ -0,0 +1,309 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_SOBOL_H
+#define APPLESEED_FOUNDATION_MATH_SOBOL_H
+
+// appleseed.foundation headers.
+#include "foundation/math/hash.h"
+#include "foundation/platform/types.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// Owen-scrambled Sobol sequence.
+//
+// The first four dimensions of the Sobol sequence are scrambled with a hash-based
+// approximation of Owen's nested uniform scrambling. The index of the point is
+// shuffled in the same way, so that different seeds produce statistically
+// independent sequences that each retain the stratification of the Sobol sequence
+// over aligned, power-of-two sized ranges of indices.
+//
+// References:
+//
+//   Joe and Kuo, Constructing Sobol sequences with better two-dimensional projections
+//   https://web.maths.unsw.edu.au/~fkuo/sobol/
+//
+//   Laine and Karras, Stratified Sampling for Stochastic Transparency
+//   https://research.nvidia.com/publication/stratified-sampling-stochastic-transparency
+//
+//   Burley, Practical Hash-based Owen Scrambling
+//   http://www.jcgt.org/published/0009/04/01/
+//
+
+// Number of dimensions for which generator matrices are available.
+const size_t SobolDimensionCount = 4;
+
+// Generator matrices, stored bit-major: SobolMatrices[i][d] is the direction number
+// of dimension d for bit i of the point index.
+extern const uint32 SobolMatrices[32][SobolDimensionCount];
+
+// Reverse the bits of a 32-bit integer.
+uint32 reverse_bits(uint32 value);
+
+// Hash-based permutation that only propagates bits from low to high.
+uint32 laine_karras_permutation(
+    uint32              value,
+    const uint32        seed);
+
+// Approximate Owen scrambling of the bits of a 32-bit integer.
+uint32 nested_uniform_scramble(
+    const uint32        value,
+    const uint32        seed);
+
+// Return a given dimension of a given point of the (unscrambled) Sobol sequence.
+uint32 sobol_uint32(
+    const size_t        dimension,
+    uint32              index);
+
+// Return a given dimension of a given point of the Owen-scrambled Sobol sequence.
+// The return value is in the interval [0, 1).
+template <typename T>
+T owen_scrambled_sobol(
+    const size_t        dimension,
+    const uint32        index,
+    const uint32        seed);
+
+// Return the four dimensions of a given point of the Owen-scrambled Sobol sequence.
+// All four dimensions are generated at once using SSE when available. The results
+// are identical to the ones returned by owen_scrambled_sobol().
+template <typename T>
+void owen_scrambled_sobol4(
+    const uint32        index,
+    const uint32        seed,
+    T                   values[4]);
+
+
+//
+// Implementation.
+//
+
+namespace sobol_impl
+{
+    // Map a 32-bit integer to [0, 1).
+    template <typename T> T to_unit_interval(const uint32 value);
+
+    template <>
+    inline float to_unit_interval(const uint32 value)
+    {
+        // Keep only the 24 bits that fit in the mantissa, otherwise we could round up to 1.0.
+        return static_cast<float>(value >> 8) * (1.0f / 16777216.0f);
+    }
+
+    template <>
+    inline double to_unit_interval(const uint32 value)
+    {
+        return static_cast<double>(value) * (1.0 / 4294967296.0);
+    }
+
+    inline uint32 shuffle_seed(const uint32 seed)
+    {
+        return mix_uint32(seed, 0);
+    }
+
+    inline uint32 dimension_seed(const uint32 seed, const size_t dimension)
+    {
+        return mix_uint32(seed, static_cast<uint32>(dimension + 1));
+    }
+
+#ifdef APPLESEED_USE_SSE
+
+    inline __m128i mullo_epi32(const __m128i a, const __m128i b)
+    {
+#ifdef APPLESEED_USE_SSE42
+        return _mm_mullo_epi32(a, b);
+#else
+        // SSE2 only has a 32x32->64 multiply of the even lanes.
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return
+            _mm_unpacklo_epi32(
+                _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+
+    inline __m128i reverse_bits(__m128i v)
+    {
+        const __m128i m8 = _mm_set1_epi32(0x00FF00FF);
+        const __m128i m4 = _mm_set1_epi32(0x0F0F0F0F);
+        const __m128i m2 = _mm_set1_epi32(0x33333333);
+        const __m128i m1 = _mm_set1_epi32(0x55555555);
+
+        v = _mm_or_si128(_mm_srli_epi32(v, 16), _mm_slli_epi32(v, 16));
+        v = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 8), m8), _mm_slli_epi32(_mm_and_si128(v, m8), 8));
+        v = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 4), m4), _mm_slli_epi32(_mm_and_si128(v, m4), 4));
+        v = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 2), m2), _mm_slli_epi32(_mm_and_si128(v, m2), 2));
+        v = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 1), m1), _mm_slli_epi32(_mm_and_si128(v, m1), 1));
+
+        return v;
+    }
+
+    inline __m128i laine_karras_permutation(__m128i v, const __m128i seed)
+    {
+        v = _mm_add_epi32(v, seed);
+        v = _mm_xor_si128(v, mullo_epi32(v, _mm_set1_epi32(0x6C50B47C)));
+        v = _mm_xor_si128(v, mullo_epi32(v, _mm_set1_epi32(0xB82F1E52)));
+        v = _mm_xor_si128(v, mullo_epi32(v, _mm_set1_epi32(0xC7AFE638)));
+        v = _mm_xor_si128(v, mullo_epi32(v, _mm_set1_epi32(0x8D22F6E6)));
+        return v;
+    }
+
+#endif
+}
+
+inline uint32 reverse_bits(uint32 value)
+{
+    value = (value >> 16) | (value << 16);                                              // 16-bit swap
+    value = ((value & 0xFF00FF00UL) >> 8) | ((value & 0x00FF00FFUL) << 8);              // 8-bit swap
+    value = ((value & 0xF0F0F0F0UL) >> 4) | ((value & 0x0F0F0F0FUL) << 4);              // 4-bit swap
+    value = ((value & 0xCCCCCCCCUL) >> 2) | ((value & 0x33333333UL) << 2);              // 2-bit swap
+    value = ((value & 0xAAAAAAAAUL) >> 1) | ((value & 0x55555555UL) << 1);              // 1-bit swap
+    return value;
+}
+
+inline uint32 laine_karras_permutation(
+    uint32              value,
+    const uint32        seed)
+{
+    value += seed;
+    value ^= value * 0x6C50B47CUL;
+    value ^= value * 0xB82F1E52UL;
+    value ^= value * 0xC7AFE638UL;
+    value ^= value * 0x8D22F6E6UL;
+    return value;
+}
+
+inline uint32 nested_uniform_scramble(
+    const uint32        value,
+    const uint32        seed)
+{
+    return reverse_bits(laine_karras_permutation(reverse_bits(value), seed));
+}
+
+inline uint32 sobol_uint32(
+    const size_t        dimension,
+    uint32              index)
+{
+    assert(dimension < SobolDimensionCount);
+
+    uint32 result = 0;
+
+    for (size_t i = 0; index; index >>= 1, ++i)
+    {
+        if (index & 1)
+            result ^= SobolMatrices[i][dimension];
+    }
+
+    return result;
+}
+
+template <typename T>
+inline T owen_scrambled_sobol(
+    const size_t        dimension,
+    const uint32        index,
+    const uint32        seed)
+{
+    const uint32 shuffled_index = nested_uniform_scramble(index, sobol_impl::shuffle_seed(seed));
+
+    return
+        sobol_impl::to_unit_interval<T>(
+            nested_uniform_scramble(
+                sobol_uint32(dimension, shuffled_index),
+                sobol_impl::dimension_seed(seed, dimension)));
+}
+
+template <typename T>
+inline void owen_scrambled_sobol4(
+    const uint32        index,
+    const uint32        seed,
+    T                   values[4])
+{
+    uint32 shuffled_index = nested_uniform_scramble(index, sobol_impl::shuffle_seed(seed));
+
+#ifdef APPLESEED_USE_SSE
+
+    __m128i x = _mm_setzero_si128();
+
+    for (size_t i = 0; shuffled_index; shuffled_index >>= 1, ++i)
+    {
+        if (shuffled_index & 1)
+            x = _mm_xor_si128(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(SobolMatrices[i])));
+    }
+
+    const __m128i dimension_seeds =
+        _mm_set_epi32(
+            static_cast<int>(sobol_impl::dimension_seed(seed, 3)),
+            static_cast<int>(sobol_impl::dimension_seed(seed, 2)),
+            static_cast<int>(sobol_impl::dimension_seed(seed, 1)),
+            static_cast<int>(sobol_impl::dimension_seed(seed, 0)));
+
+    x = sobol_impl::reverse_bits(x);
+    x = sobol_impl::laine_karras_permutation(x, dimension_seeds);
+    x = sobol_impl::reverse_bits(x);
+
+    M128Fields fields;
+    _mm_storeu_si128(&fields.m128i, x);
+
+    for (size_t d = 0; d < 4; ++d)
+        values[d] = sobol_impl::to_unit_interval<T>(fields.u32[d]);
+
+#else
+
+    uint32 x[4] = { 0, 0, 0, 0 };
+
+    for (size_t i = 0; shuffled_index; shuffled_index >>= 1, ++i)
+    {
+        if (shuffled_index & 1)
+        {
+            for (size_t d = 0; d < 4; ++d)
+                x[d] ^= SobolMatrices[i][d];
+        }
+    }
+
+    for (size_t d = 0; d < 4; ++d)
+    {
+        values[d] =
+            sobol_impl::to_unit_interval<T>(
+                nested_uniform_scramble(x[d], sobol_impl::dimension_seed(seed, d)));
+    }
+
+#endif
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_SOBOL_H
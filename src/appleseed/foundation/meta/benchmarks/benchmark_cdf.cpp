@@ -28,9 +28,11 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/math/aliastable.h"
 #include "foundation/math/cdf.h"
 #include "foundation/math/rng/distribution.h"
 #include "foundation/math/rng/xorshift.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/benchmark.h"
 
 // Standard headers.
@@ -161,3 +163,111 @@ BENCHMARK_SUITE(Foundation_Math_CDF_Linear_Search)
             m_x += sample_cdf_linear_search(m_weights, rand_double2(m_rng));
     }
 }
+
+BENCHMARK_SUITE(Foundation_Math_CDF_vs_AliasTable)
+{
+    // Single precision weights, as used by the renderer. With large item counts,
+    // binary searches in the CDF are dominated by cache misses while the alias
+    // table only performs two memory accesses per sample.
+
+    template <typename Sampler>
+    struct FixtureBase
+    {
+        Sampler     m_sampler;
+        Xorshift    m_rng;
+        float       m_x;
+
+        explicit FixtureBase(const size_t size)
+          : m_x(0.0f)
+        {
+            m_sampler.reserve(size);
+
+            for (size_t i = 0; i < size; ++i)
+                m_sampler.insert(static_cast<uint32>(i), rand_float1(m_rng));
+
+            assert(m_sampler.valid());
+
+            m_sampler.prepare();
+        }
+    };
+
+    template <size_t Size>
+    struct CDFFixture
+      : public FixtureBase<CDF<uint32, float> >
+    {
+        CDFFixture()
+          : FixtureBase<CDF<uint32, float> >(Size)
+        {
+        }
+    };
+
+    template <size_t Size>
+    struct AliasTableFixture
+      : public FixtureBase<AliasTable<uint32, float> >
+    {
+        AliasTableFixture()
+          : FixtureBase<AliasTable<uint32, float> >(Size)
+        {
+        }
+    };
+
+    BENCHMARK_CASE_F(CDF_1000Items, CDFFixture<1000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_sampler.sample(rand_float2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(AliasTable_1000Items, AliasTableFixture<1000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_sampler.sample(rand_float2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(CDF_10000Items, CDFFixture<10000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_sampler.sample(rand_float2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(AliasTable_10000Items, AliasTableFixture<10000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_sampler.sample(rand_float2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(CDF_100000Items, CDFFixture<100000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_sampler.sample(rand_float2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(AliasTable_100000Items, AliasTableFixture<100000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_sampler.sample(rand_float2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(CDF_1000000Items, CDFFixture<1000000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_sampler.sample(rand_float2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(AliasTable_1000000Items, AliasTableFixture<1000000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_sampler.sample(rand_float2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(CDF_10000000Items, CDFFixture<10000000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_sampler.sample(rand_float2(m_rng)).second;
+    }
+
+    BENCHMARK_CASE_F(AliasTable_10000000Items, AliasTableFixture<10000000>)
+    {
+        for (size_t i = 0; i < 100; ++i)
+            m_x += m_sampler.sample(rand_float2(m_rng)).second;
+    }
+}
@@ -38,6 +38,7 @@
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/benchmark.h"
 #include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/log.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/string.h"
@@ -93,6 +94,128 @@ BENCHMARK_SUITE(Foundation_Math_Knn_Answer)
     BENCHMARK_CASE_F(Sort_K500, Fixture<500>)               { m_answer.sort(); }
 }
 
+BENCHMARK_SUITE(Foundation_Math_Knn_Builder)
+{
+    const size_t PointCount = 1000 * 1000;
+
+    template <size_t ThreadCount>
+    struct Fixture
+    {
+        vector<Vector3f>    m_points;
+        knn::Tree3f         m_tree;
+        Logger              m_logger;
+        JobQueue            m_job_queue;
+        JobManager          m_job_manager;
+
+        Fixture()
+          : m_points(PointCount)
+          , m_job_manager(m_logger, m_job_queue, ThreadCount, JobManager::KeepRunningOnEmptyQueue)
+        {
+            Xorshift rng;
+
+            for (size_t i = 0; i < PointCount; ++i)
+                m_points[i] = Vector3f(rand_float1(rng), rand_float1(rng), rand_float1(rng));
+
+            m_job_manager.start();
+        }
+
+        void build()
+        {
+            knn::Builder3f builder(m_tree);
+            builder.build<DefaultWallclockTimer>(&m_points[0], m_points.size());
+        }
+
+        void parallel_build()
+        {
+            knn::Builder3f builder(m_tree);
+            builder.build<DefaultWallclockTimer>(&m_points[0], m_points.size(), m_job_queue);
+        }
+    };
+
+    BENCHMARK_CASE_F(Build_1MPoints, Fixture<1>)                        { build(); }
+    BENCHMARK_CASE_F(ParallelBuild_1MPoints_1Thread, Fixture<1>)        { parallel_build(); }
+    BENCHMARK_CASE_F(ParallelBuild_1MPoints_2Threads, Fixture<2>)       { parallel_build(); }
+    BENCHMARK_CASE_F(ParallelBuild_1MPoints_4Threads, Fixture<4>)       { parallel_build(); }
+    BENCHMARK_CASE_F(ParallelBuild_1MPoints_8Threads, Fixture<8>)       { parallel_build(); }
+}
+
+BENCHMARK_SUITE(Foundation_Math_Knn_HashGrid)
+{
+    // Uniformly distributed points with about 50 points within the search radius of any point.
+    const size_t PointCount = 1000 * 1000;
+    const size_t QueryCount = 1000;
+    const float SearchRadius = 0.0229f;
+
+    template <size_t AnswerSize>
+    struct Fixture
+    {
+        vector<Vector3f>    m_points;
+        vector<Vector3f>    m_query_points;
+        knn::Tree3f         m_tree;
+        knn::HashGrid3f     m_grid;
+        knn::Answer<float>  m_answer;
+        size_t              m_accumulator;
+
+        Fixture()
+          : m_points(PointCount)
+          , m_query_points(QueryCount)
+          , m_answer(AnswerSize)
+          , m_accumulator(0)
+        {
+            Xorshift rng;
+
+            for (size_t i = 0; i < PointCount; ++i)
+                m_points[i] = Vector3f(rand_float1(rng), rand_float1(rng), rand_float1(rng));
+
+            for (size_t i = 0; i < QueryCount; ++i)
+                m_query_points[i] = Vector3f(rand_float1(rng), rand_float1(rng), rand_float1(rng));
+
+            build_tree();
+            build_grid();
+        }
+
+        void build_tree()
+        {
+            knn::Builder3f builder(m_tree);
+            builder.build<DefaultWallclockTimer>(&m_points[0], m_points.size());
+        }
+
+        void build_grid()
+        {
+            vector<Vector3f> points(m_points);
+            m_grid.build_move_points(points, 2.0f * SearchRadius);
+        }
+
+        void query_tree()
+        {
+            const knn::Query3f query(m_tree, m_answer);
+
+            for (size_t i = 0; i < QueryCount; ++i)
+            {
+                query.run(m_query_points[i], SearchRadius * SearchRadius);
+                m_accumulator += m_answer.size();
+            }
+        }
+
+        void query_grid()
+        {
+            for (size_t i = 0; i < QueryCount; ++i)
+            {
+                m_grid.query(m_query_points[i], SearchRadius * SearchRadius, m_answer);
+                m_accumulator += m_answer.size();
+            }
+        }
+    };
+
+    BENCHMARK_CASE_F(BuildTree_1MPoints, Fixture<1>)        { build_tree(); }
+    BENCHMARK_CASE_F(BuildHashGrid_1MPoints, Fixture<1>)    { build_grid(); }
+
+    BENCHMARK_CASE_F(QueryTree_K20, Fixture<20>)            { query_tree(); }
+    BENCHMARK_CASE_F(QueryHashGrid_K20, Fixture<20>)        { query_grid(); }
+    BENCHMARK_CASE_F(QueryTree_K100, Fixture<100>)          { query_tree(); }
+    BENCHMARK_CASE_F(QueryHashGrid_K100, Fixture<100>)      { query_grid(); }
+}
+
 BENCHMARK_SUITE(Foundation_Math_Knn_Query)
 {
     namespace
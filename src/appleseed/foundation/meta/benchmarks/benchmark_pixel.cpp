@@ -0,0 +1,136 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/image/pixel.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/benchmark.h"
+
+// OpenEXR headers.
+#include "foundation/platform/exrheaderguards.h"
+BEGIN_EXR_INCLUDES
+#include "OpenEXR/half.h"
+END_EXR_INCLUDES
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+BENCHMARK_SUITE(Foundation_Image_Pixel)
+{
+    // Number of values in a 64x64 RGBA tile.
+    const size_t ValueCount = 64 * 64 * 4;
+
+    struct Fixture
+    {
+        float   m_float[ValueCount];
+        half    m_half[ValueCount];
+        uint8   m_uint8[ValueCount];
+
+        Fixture()
+        {
+            for (size_t i = 0; i < ValueCount; ++i)
+            {
+                m_float[i] = static_cast<float>(i % 1024) / 1023.0f;
+                m_half[i] = m_float[i];
+                m_uint8[i] = static_cast<uint8>(i);
+            }
+        }
+    };
+
+    // Converting one value at a time bypasses the vectorized kernels and
+    // provides a reference point for the scalar code path.
+    template <typename T>
+    void convert_one_by_one(
+        const T*            src,
+        const PixelFormat   dest_format,
+        void*               dest)
+    {
+        uint8* typed_dest = reinterpret_cast<uint8*>(dest);
+        const size_t dest_size = Pixel::size(dest_format);
+
+        for (size_t i = 0; i < ValueCount; ++i)
+            Pixel::convert_to_format(src + i, src + i + 1, 1, dest_format, typed_dest + i * dest_size, 1);
+    }
+
+    BENCHMARK_CASE_F(ConvertFloatToUInt8_Scalar, Fixture)
+    {
+        convert_one_by_one(m_float, PixelFormatUInt8, m_uint8);
+    }
+
+    BENCHMARK_CASE_F(ConvertFloatToUInt8, Fixture)
+    {
+        Pixel::convert_to_format(m_float, m_float + ValueCount, 1, PixelFormatUInt8, m_uint8, 1);
+    }
+
+    BENCHMARK_CASE_F(ConvertUInt8ToFloat_Scalar, Fixture)
+    {
+        convert_one_by_one(m_uint8, PixelFormatFloat, m_float);
+    }
+
+    BENCHMARK_CASE_F(ConvertUInt8ToFloat, Fixture)
+    {
+        Pixel::convert_to_format(m_uint8, m_uint8 + ValueCount, 1, PixelFormatFloat, m_float, 1);
+    }
+
+    BENCHMARK_CASE_F(ConvertFloatToHalf_Scalar, Fixture)
+    {
+        convert_one_by_one(m_float, PixelFormatHalf, m_half);
+    }
+
+    BENCHMARK_CASE_F(ConvertFloatToHalf, Fixture)
+    {
+        Pixel::convert_to_format(m_float, m_float + ValueCount, 1, PixelFormatHalf, m_half, 1);
+    }
+
+    BENCHMARK_CASE_F(ConvertHalfToFloat_Scalar, Fixture)
+    {
+        convert_one_by_one(m_half, PixelFormatFloat, m_float);
+    }
+
+    BENCHMARK_CASE_F(ConvertHalfToFloat, Fixture)
+    {
+        Pixel::convert_to_format(m_half, m_half + ValueCount, 1, PixelFormatFloat, m_float, 1);
+    }
+
+    BENCHMARK_CASE_F(ShuffleUInt8RGBAToBGRA, Fixture)
+    {
+        const size_t shuffle_table[4] = { 2, 1, 0, 3 };
+
+        Pixel::convert_and_shuffle(
+            PixelFormatUInt8,
+            4,
+            m_uint8,
+            m_uint8 + ValueCount,
+            PixelFormatUInt8,
+            4,
+            m_float,            // used as scratch storage
+            shuffle_table);
+    }
+}
@@ -0,0 +1,97 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/hash.h"
+#include "foundation/math/qmc.h"
+#include "foundation/math/sobol.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/benchmark.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+BENCHMARK_SUITE(Foundation_Math_Sobol)
+{
+    struct Fixture
+    {
+        uint32  m_seed;
+        double  m_x;
+
+        Fixture()
+          : m_seed(hash_uint32(1234567))
+          , m_x(0.0)
+        {
+        }
+    };
+
+    BENCHMARK_CASE_F(SobolUInt32_4Dimensions, Fixture)
+    {
+        uint32 x = 0;
+
+        for (uint32 i = 0; i < 64; ++i)
+        {
+            for (size_t d = 0; d < 4; ++d)
+                x ^= sobol_uint32(d, i);
+        }
+
+        m_x += x;
+    }
+
+    BENCHMARK_CASE_F(OwenScrambledSobol_4Dimensions, Fixture)
+    {
+        for (uint32 i = 0; i < 64; ++i)
+        {
+            for (size_t d = 0; d < 4; ++d)
+                m_x += owen_scrambled_sobol<double>(d, i, m_seed);
+        }
+    }
+
+    BENCHMARK_CASE_F(OwenScrambledSobol4, Fixture)
+    {
+        for (uint32 i = 0; i < 64; ++i)
+        {
+            double values[4];
+            owen_scrambled_sobol4(i, m_seed, values);
+            m_x += values[0] + values[1] + values[2] + values[3];
+        }
+    }
+
+    BENCHMARK_CASE_F(Halton_4Dimensions, Fixture)
+    {
+        for (size_t i = 0; i < 64; ++i)
+        {
+            m_x += radical_inverse_base2<double>(i);
+
+            for (size_t d = 1; d < 4; ++d)
+                m_x += fast_radical_inverse<double>(d, i);
+        }
+    }
+}
@@ -0,0 +1,186 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/aliastable.h"
+#include "foundation/math/fp.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/xorshift.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_AliasTable)
+{
+    typedef foundation::AliasTable<int, double> AliasTable;
+
+    TEST_CASE(Empty_GivenTableInInitialState_ReturnsTrue)
+    {
+        AliasTable table;
+
+        EXPECT_TRUE(table.empty());
+    }
+
+    TEST_CASE(Valid_GivenTableInInitialState_ReturnsFalse)
+    {
+        AliasTable table;
+
+        EXPECT_FALSE(table.valid());
+    }
+
+    TEST_CASE(Valid_GivenTableWithOneItemWithZeroWeight_ReturnsFalse)
+    {
+        AliasTable table;
+        table.insert(1, 0.0);
+
+        EXPECT_FALSE(table.valid());
+    }
+
+    TEST_CASE(Clear_GivenTableWithOneItem_MakesTableEmptyAndInvalid)
+    {
+        AliasTable table;
+        table.insert(1, 0.5);
+        table.clear();
+
+        EXPECT_TRUE(table.empty());
+        EXPECT_FALSE(table.valid());
+    }
+
+    TEST_CASE(Sample_GivenTableWithOneItemWithPositiveWeight_ReturnsItem)
+    {
+        AliasTable table;
+        table.insert(1, 0.5);
+        table.prepare();
+
+        const AliasTable::ItemWeightPair result = table.sample(0.5);
+
+        EXPECT_EQ(1, result.first);
+        EXPECT_FEQ(1.0, result.second);
+    }
+
+    struct Fixture
+    {
+        AliasTable m_table;
+
+        Fixture()
+        {
+            m_table.insert(1, 0.4);
+            m_table.insert(2, 1.6);
+            m_table.prepare();
+        }
+    };
+
+    TEST_CASE_F(OperatorBracket_ReturnsItemsInInsertionOrderWithNormalizedWeights, Fixture)
+    {
+        EXPECT_EQ(1, m_table[0].first);
+        EXPECT_FEQ(0.2, m_table[0].second);
+        EXPECT_EQ(2, m_table[1].first);
+        EXPECT_FEQ(0.8, m_table[1].second);
+    }
+
+    TEST_CASE_F(Sample_GivenInputOneUlpBeforeOne_ReturnsValidItem, Fixture)
+    {
+        const double almost_one = shift(1.0, -1);
+        const AliasTable::ItemWeightPair result = m_table.sample(almost_one);
+
+        EXPECT_TRUE(result.first == 1 || result.first == 2);
+    }
+
+    TEST_CASE_F(Sample_GivenUniformInputs_ReturnsItemsProportionallyToTheirWeights, Fixture)
+    {
+        const size_t SampleCount = 1000;
+        size_t count = 0;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const double x = (i + 0.5) / SampleCount;
+            if (m_table.sample(x).first == 1)
+                ++count;
+        }
+
+        EXPECT_EQ(200, count);
+    }
+
+    TEST_CASE(Sample_GivenItemsWithZeroWeight_NeverReturnsThem)
+    {
+        AliasTable table;
+        table.insert(0, 0.0);
+        table.insert(1, 0.1);
+        table.insert(2, 0.0);
+        table.insert(3, 0.7);
+        table.insert(4, 0.0);
+        table.prepare();
+
+        const size_t SampleCount = 1000;
+        size_t counts[5] = { 0, 0, 0, 0, 0 };
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const AliasTable::ItemWeightPair result = table.sample((i + 0.5) / SampleCount);
+            EXPECT_GT(0.0, result.second);
+            ++counts[result.first];
+        }
+
+        EXPECT_EQ(0, counts[0]);
+        EXPECT_EQ(0, counts[2]);
+        EXPECT_EQ(0, counts[4]);
+        EXPECT_EQ(125, counts[1]);
+        EXPECT_EQ(875, counts[3]);
+    }
+
+    TEST_CASE(Sample_GivenRandomWeights_MatchesDistribution)
+    {
+        const size_t ItemCount = 100;
+        const size_t SampleCount = 100 * 1000;
+
+        Xorshift rng;
+        foundation::AliasTable<size_t, float> table;
+
+        for (size_t i = 0; i < ItemCount; ++i)
+            table.insert(i, i % 7 == 0 ? 0.0f : rand_float1(rng));
+
+        table.prepare();
+
+        vector<size_t> counts(ItemCount, 0);
+
+        for (size_t i = 0; i < SampleCount; ++i)
+            ++counts[table.sample(static_cast<float>((i + 0.5) / SampleCount)).first];
+
+        for (size_t i = 0; i < ItemCount; ++i)
+        {
+            const double expected = table[i].second * SampleCount;
+            EXPECT_LT(5.0, abs(counts[i] - expected));
+        }
+    }
+}
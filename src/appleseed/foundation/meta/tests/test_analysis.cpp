@@ -119,4 +119,15 @@ TEST_SUITE(Foundation_Image_Analysis)
 
         EXPECT_FEQ(1.0, rmsd);
     }
+
+    TEST_CASE(ComputeAverageLuminance_GivenTileFilledWithOnesAndOnePixelSetToSNaN_ReturnsOne)
+    {
+        Tile tile(2, 2, 4, PixelFormatFloat);
+        tile.clear(Color4f(1.0f));
+        tile.set_pixel(1, 1, Color4f(FP<float>::snan()));
+
+        const double average_luminance = compute_average_luminance(tile);
+
+        EXPECT_FEQ_EPS(1.0, average_luminance, 1.0e-6);
+    }
 }
@@ -0,0 +1,267 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/bluenoise.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_BlueNoise)
+{
+    TEST_CASE(BlueNoiseTile_ContainsEveryRankExactlyOnce)
+    {
+        const size_t PixelCount = BlueNoiseTileSize * BlueNoiseTileSize;
+
+        vector<bool> seen(PixelCount, false);
+
+        for (size_t i = 0; i < PixelCount; ++i)
+        {
+            ASSERT_LT(PixelCount, BlueNoiseTile[i]);
+            EXPECT_FALSE(seen[BlueNoiseTile[i]]);
+            seen[BlueNoiseTile[i]] = true;
+        }
+    }
+
+    // Return the variance of the blue-noise values of a given dimension, filtered with a 3x3 box filter.
+    double compute_low_pass_variance(const size_t dimension)
+    {
+        const size_t N = BlueNoiseTileSize;
+
+        double sum = 0.0;
+        double sum_squares = 0.0;
+
+        for (size_t y = 0; y < N; ++y)
+        {
+            for (size_t x = 0; x < N; ++x)
+            {
+                double value = 0.0;
+
+                for (size_t dy = 0; dy < 3; ++dy)
+                {
+                    for (size_t dx = 0; dx < 3; ++dx)
+                        value += blue_noise<double>(x + N - 1 + dx, y + N - 1 + dy, dimension);
+                }
+
+                value /= 9.0;
+                sum += value;
+                sum_squares += value * value;
+            }
+        }
+
+        const double mean = sum / (N * N);
+        return sum_squares / (N * N) - mean * mean;
+    }
+
+    TEST_CASE(BlueNoise_HasLittleLowFrequencyEnergy)
+    {
+        // The variance of box-filtered white noise would be 1/12/9 ~ 0.0093.
+        for (size_t d = 0; d < 8; ++d)
+            EXPECT_LT(0.004, compute_low_pass_variance(d));
+    }
+
+    TEST_CASE(BlueNoise_DifferentDimensionsOfAPixelAreUncorrelated)
+    {
+        const size_t N = BlueNoiseTileSize;
+
+        double covariance = 0.0;
+
+        for (size_t y = 0; y < N; ++y)
+        {
+            for (size_t x = 0; x < N; ++x)
+            {
+                covariance +=
+                    (blue_noise<double>(x, y, 0) - 0.5) *
+                    (blue_noise<double>(x, y, 1) - 0.5);
+            }
+        }
+
+        covariance /= N * N;
+
+        // Correlation coefficient below 0.1.
+        EXPECT_LT(0.1 / 12.0, abs(covariance));
+    }
+
+#if 0
+
+    //
+    // Generate BlueNoiseTile with the void-and-cluster algorithm.
+    //
+
+    const size_t TileSize = BlueNoiseTileSize;
+    const size_t TilePixelCount = TileSize * TileSize;
+    const double Sigma = 1.5;
+
+    struct VoidAndCluster
+    {
+        vector<double>  m_kernel;
+        vector<bool>    m_pattern;
+        vector<double>  m_energy;
+
+        VoidAndCluster()
+          : m_kernel(TilePixelCount)
+          , m_pattern(TilePixelCount, false)
+          , m_energy(TilePixelCount, 0.0)
+        {
+            for (size_t y = 0; y < TileSize; ++y)
+            {
+                for (size_t x = 0; x < TileSize; ++x)
+                    m_kernel[y * TileSize + x] = exp(-double(x * x + y * y) / (2.0 * Sigma * Sigma));
+            }
+        }
+
+        void toggle(const size_t p, const bool value)
+        {
+            const int px = static_cast<int>(p % TileSize);
+            const int py = static_cast<int>(p / TileSize);
+            const double sign = value ? +1.0 : -1.0;
+
+            m_pattern[p] = value;
+
+            // Update the energy of all pixels, with toroidal distances.
+            for (size_t q = 0; q < TilePixelCount; ++q)
+            {
+                int dx = abs(static_cast<int>(q % TileSize) - px);
+                int dy = abs(static_cast<int>(q / TileSize) - py);
+                if (dx > static_cast<int>(TileSize / 2)) dx = static_cast<int>(TileSize) - dx;
+                if (dy > static_cast<int>(TileSize / 2)) dy = static_cast<int>(TileSize) - dy;
+                m_energy[q] += sign * m_kernel[dy * TileSize + dx];
+            }
+        }
+
+        size_t find_tightest_cluster() const
+        {
+            size_t best = TilePixelCount;
+
+            for (size_t q = 0; q < TilePixelCount; ++q)
+            {
+                if (m_pattern[q] && (best == TilePixelCount || m_energy[q] > m_energy[best]))
+                    best = q;
+            }
+
+            return best;
+        }
+
+        size_t find_largest_void() const
+        {
+            size_t best = TilePixelCount;
+
+            for (size_t q = 0; q < TilePixelCount; ++q)
+            {
+                if (!m_pattern[q] && (best == TilePixelCount || m_energy[q] < m_energy[best]))
+                    best = q;
+            }
+
+            return best;
+        }
+    };
+
+    TEST_CASE(GenerateBlueNoiseTile)
+    {
+        VoidAndCluster vac;
+
+        // Initial binary pattern: 10% of randomly placed points.
+        uint32 state = 12345;
+        size_t ones = 0;
+        while (ones < TilePixelCount / 10)
+        {
+            state = state * 1664525UL + 1013904223UL;
+            const size_t p = (state >> 8) % TilePixelCount;
+            if (!vac.m_pattern[p])
+            {
+                vac.toggle(p, true);
+                ++ones;
+            }
+        }
+
+        // Move points from tightest clusters to largest voids until convergence.
+        while (true)
+        {
+            const size_t cluster = vac.find_tightest_cluster();
+            vac.toggle(cluster, false);
+
+            const size_t hole = vac.find_largest_void();
+            vac.toggle(hole, true);
+
+            if (hole == cluster)
+                break;
+        }
+
+        vector<size_t> ranks(TilePixelCount);
+
+        // Phase 1: rank the points of the initial pattern.
+        {
+            VoidAndCluster copy(vac);
+
+            for (size_t r = ones; r > 0; --r)
+            {
+                const size_t cluster = copy.find_tightest_cluster();
+                copy.toggle(cluster, false);
+                ranks[cluster] = r - 1;
+            }
+        }
+
+        // Phase 2: fill the largest voids.
+        for (size_t r = ones; r < TilePixelCount; ++r)
+        {
+            const size_t hole = vac.find_largest_void();
+            vac.toggle(hole, true);
+            ranks[hole] = r;
+        }
+
+        FILE* file = fopen("unit tests/outputs/test_bluenoise_tile.txt", "wt");
+        ASSERT_NEQ(0, file);
+
+        for (size_t y = 0; y < TileSize; ++y)
+        {
+            fprintf(file, "   ");
+
+            for (size_t x = 0; x < TileSize; ++x)
+            {
+                const bool last = y == TileSize - 1 && x == TileSize - 1;
+                fprintf(file, " %4u%s", static_cast<unsigned int>(ranks[y * TileSize + x]), last ? "" : ",");
+            }
+
+            fprintf(file, "\n");
+        }
+
+        fclose(file);
+    }
+
+#endif
+}
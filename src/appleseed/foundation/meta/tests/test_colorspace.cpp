@@ -112,6 +112,22 @@ TEST_SUITE(Foundation_Image_ColorSpace)
             1.0e-5);
     }
 
+#ifdef APPLESEED_USE_SSE
+
+    TEST_CASE(TestLinearRGBToCIEXYZConversion_SSE)
+    {
+        APPLESEED_SIMD4_ALIGN float values[4] = { 0.44452748f, 0.83687690f, 0.09645611f, 1.0f };
+        _mm_store_ps(values, linear_rgb_to_ciexyz(_mm_load_ps(values)));
+
+        EXPECT_FEQ_EPS(
+            Color3f(0.5f, 0.7f, 0.2f),
+            Color3f(values[0], values[1], values[2]),
+            1.0e-5f);
+        EXPECT_EQ(0.0f, values[3]);
+    }
+
+#endif
+
     TEST_CASE(TestCIEXYZToCIExyYConversion)
     {
         const Color3d ciexyz(0.5, 0.7, 0.2);
@@ -178,6 +194,15 @@ TEST_SUITE(Foundation_Image_ColorSpace)
             1.0e-5f);
     }
 
+    TEST_CASE(SRGBUInt8ToLinearRGB_MatchesExactConversion)
+    {
+        for (size_t i = 0; i < 256; ++i)
+        {
+            const float expected = srgb_to_linear_rgb(static_cast<float>(i) / 255.0f);
+            EXPECT_FEQ_EPS(expected, SRGBUInt8ToLinearRGB[i], 1.0e-6f);
+        }
+    }
+
     static RegularSpectrum31f get_white_spectrum()
     {
         // The white color from the Cornell Box scene.
@@ -0,0 +1,190 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/qmc.h"
+#include "foundation/math/sampling/hierarchicalimageimportancesampler.h"
+#include "foundation/math/sampling/imageimportancesampler.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_Sampling_HierarchicalImageImportanceSampler)
+{
+    // Pixels of the first column and of every third row are black.
+    class PatternSampler
+    {
+      public:
+        struct Payload {};
+
+        void sample(const size_t x, const size_t y, float& importance) const
+        {
+            importance = x == 0 || y % 3 == 0 ? 0.0f : static_cast<float>(1 + x * y);
+        }
+
+        void sample(const size_t x, const size_t y, Payload& payload, float& importance) const
+        {
+            sample(x, y, importance);
+        }
+    };
+
+    struct UniformBlackImageSampler
+    {
+        void sample(const size_t x, const size_t y, float& importance) const
+        {
+            importance = 0.0f;
+        }
+    };
+
+    const size_t Width = 7;
+    const size_t Height = 5;
+
+    TEST_CASE(GetPDF_ReturnsSameProbabilityAsSample)
+    {
+        HierarchicalImageImportanceSampler<float> importance_sampler(Width, Height);
+        PatternSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        const size_t SampleCount = 256;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const size_t Bases[1] = { 2 };
+            const Vector2f s = hammersley_sequence<float, 2>(Bases, SampleCount, i);
+
+            size_t x, y;
+            float prob_xy;
+            importance_sampler.sample(s, x, y, prob_xy);
+
+            ASSERT_LT(Width, x);
+            ASSERT_LT(Height, y);
+            EXPECT_GT(0.0f, prob_xy);
+            EXPECT_EQ(prob_xy, importance_sampler.get_pdf(x, y));
+        }
+    }
+
+    TEST_CASE(GetPDF_ReturnsSameProbabilityAsImageImportanceSampler)
+    {
+        HierarchicalImageImportanceSampler<float> importance_sampler(Width, Height);
+        ImageImportanceSampler<PatternSampler::Payload, float> reference_sampler(Width, Height);
+        PatternSampler sampler;
+        importance_sampler.rebuild(sampler);
+        reference_sampler.rebuild(sampler);
+
+        float sum = 0.0f;
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                const float pdf = importance_sampler.get_pdf(x, y);
+                EXPECT_FEQ(reference_sampler.get_pdf(x, y), pdf);
+                sum += pdf;
+            }
+        }
+
+        EXPECT_FEQ(1.0f, sum);
+    }
+
+    TEST_CASE(Sample_ReturnsPixelsProportionallyToImportance)
+    {
+        HierarchicalImageImportanceSampler<float> importance_sampler(Width, Height);
+        PatternSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        const size_t SampleCount = 64 * 1024;
+        vector<size_t> histogram(Width * Height, 0);
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const size_t Bases[1] = { 2 };
+            const Vector2f s = hammersley_sequence<float, 2>(Bases, SampleCount, i);
+
+            size_t x, y;
+            float prob_xy;
+            importance_sampler.sample(s, x, y, prob_xy);
+
+            ++histogram[y * Width + x];
+        }
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                const float frequency = static_cast<float>(histogram[y * Width + x]) / SampleCount;
+                EXPECT_FEQ_EPS(importance_sampler.get_pdf(x, y), frequency, 1.0e-2f);
+            }
+        }
+    }
+
+    TEST_CASE(Sample_GivenUniformBlackImage)
+    {
+        HierarchicalImageImportanceSampler<float> importance_sampler(2, 2);
+        UniformBlackImageSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        size_t x, y;
+        float prob_xy;
+        importance_sampler.sample(Vector2f(0.0f, 0.0f), x, y, prob_xy);
+
+        EXPECT_EQ(0, x);
+        EXPECT_EQ(0, y);
+        EXPECT_EQ(0.25f, prob_xy);
+    }
+
+    TEST_CASE(GetPDF_GivenUniformBlackImage)
+    {
+        HierarchicalImageImportanceSampler<float> importance_sampler(2, 2);
+        UniformBlackImageSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        EXPECT_EQ(0.25f, importance_sampler.get_pdf(1, 1));
+    }
+
+    TEST_CASE(RebuildLevels_AfterModifyingImportances_UpdatesProbabilities)
+    {
+        HierarchicalImageImportanceSampler<float> importance_sampler(3, 1);
+        importance_sampler.get_importances()[2] = 1.0f;
+        importance_sampler.rebuild_levels();
+
+        size_t x, y;
+        float prob_xy;
+        importance_sampler.sample(Vector2f(0.5f, 0.5f), x, y, prob_xy);
+
+        EXPECT_EQ(2, x);
+        EXPECT_EQ(0, y);
+        EXPECT_EQ(1.0f, prob_xy);
+        EXPECT_EQ(0.0f, importance_sampler.get_pdf(0, 0));
+    }
+}
@@ -37,6 +37,8 @@
 #include "foundation/math/vector.h"
 #include "foundation/platform/timers.h"
 #include "foundation/utility/iostreamop.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
@@ -141,6 +143,55 @@ TEST_SUITE(Foundation_Math_Knn_Builder)
         knn::Builder3d builder(tree);
         builder.build<DefaultWallclockTimer>(points, PointCount);
     }
+
+    TEST_CASE(Build_GivenJobQueue_BuildsSameTreeAsSingleThreadedBuild)
+    {
+        // Enough points for the top levels of the tree to be split in parallel.
+        const size_t PointCount = 100 * 1000;
+
+        MersenneTwister rng;
+        vector<Vector3d> points(PointCount);
+
+        for (size_t i = 0; i < PointCount; ++i)
+            points[i] = rand_vector1<Vector3d>(rng);
+
+        knn::Tree3d expected_tree;
+        knn::Builder3d expected_builder(expected_tree);
+        expected_builder.build<DefaultWallclockTimer>(&points[0], PointCount);
+
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 4, JobManager::KeepRunningOnEmptyQueue);
+        job_manager.start();
+
+        knn::Tree3d tree;
+        knn::Builder3d builder(tree);
+        builder.build<DefaultWallclockTimer>(&points[0], PointCount, job_queue);
+
+        job_manager.stop();
+
+        ASSERT_EQ(expected_tree.m_nodes.size(), tree.m_nodes.size());
+
+        for (size_t i = 0; i < tree.m_nodes.size(); ++i)
+        {
+            const knn::Tree3d::NodeType& expected_node = expected_tree.m_nodes[i];
+            const knn::Tree3d::NodeType& node = tree.m_nodes[i];
+
+            ASSERT_EQ(expected_node.is_leaf(), node.is_leaf());
+            ASSERT_EQ(expected_node.get_point_index(), node.get_point_index());
+            ASSERT_EQ(expected_node.get_point_count(), node.get_point_count());
+
+            if (node.is_interior())
+            {
+                ASSERT_EQ(expected_node.get_child_node_index(), node.get_child_node_index());
+                ASSERT_EQ(expected_node.get_split_dim(), node.get_split_dim());
+                ASSERT_EQ(expected_node.get_split_abs(), node.get_split_abs());
+            }
+        }
+
+        EXPECT_TRUE(expected_tree.m_points == tree.m_points);
+        EXPECT_TRUE(expected_tree.m_indices == tree.m_indices);
+    }
 }
 
 TEST_SUITE(Foundation_Math_Knn_Answer)
@@ -444,3 +495,120 @@ TEST_SUITE(Foundation_Math_Knn_Query)
         EXPECT_TRUE(do_results_match_naive_algorithm(points, AnswerSize, QueryCount, rng));
     }
 }
+
+TEST_SUITE(Foundation_Math_Knn_HashGrid)
+{
+    TEST_CASE(Empty_GivenDefaultConstructedGrid_ReturnsTrue)
+    {
+        knn::HashGrid3d grid;
+
+        EXPECT_TRUE(grid.empty());
+    }
+
+    TEST_CASE(Query_GivenEmptyGrid_ReturnsEmptyAnswer)
+    {
+        vector<Vector3d> points;
+
+        knn::HashGrid3d grid;
+        grid.build_move_points(points, 0.1);
+
+        knn::Answer<double> answer(10);
+        grid.query(Vector3d(0.0), 1.0, answer);
+
+        EXPECT_TRUE(answer.empty());
+    }
+
+    struct SortPointByDistancePredicate
+    {
+        const vector<Vector3d>&     m_points;
+        const Vector3d&             m_q;
+
+        SortPointByDistancePredicate(
+            const vector<Vector3d>& points,
+            const Vector3d&         q)
+          : m_points(points)
+          , m_q(q)
+        {
+        }
+
+        bool operator()(const size_t lhs, const size_t rhs) const
+        {
+            return
+                square_distance(m_q, m_points[lhs]) <
+                square_distance(m_q, m_points[rhs]);
+        }
+    };
+
+    bool do_results_match_naive_algorithm(
+        const size_t                point_count,
+        const double                cell_size,
+        const double                query_max_square_distance,
+        const size_t                answer_size,
+        const size_t                query_count)
+    {
+        MersenneTwister rng;
+
+        vector<Vector3d> points;
+        points.reserve(point_count);
+
+        for (size_t i = 0; i < point_count; ++i)
+            points.push_back(rand_vector1<Vector3d>(rng));
+
+        vector<Vector3d> grid_points(points);
+
+        knn::HashGrid3d grid;
+        grid.build_move_points(grid_points, cell_size);
+
+        knn::Answer<double> answer(answer_size);
+
+        vector<size_t> ref_answer(point_count);
+
+        for (size_t i = 0; i < query_count; ++i)
+        {
+            const Vector3d q = rand_vector1<Vector3d>(rng);
+
+            // Find the points within the search distance, closest first.
+            ref_answer.clear();
+            for (size_t j = 0; j < point_count; ++j)
+            {
+                if (square_distance(points[j], q) <= query_max_square_distance)
+                    ref_answer.push_back(j);
+            }
+            sort(ref_answer.begin(), ref_answer.end(), SortPointByDistancePredicate(points, q));
+
+            grid.query(q, query_max_square_distance, answer);
+            answer.sort();
+
+            if (answer.size() != min(ref_answer.size(), answer_size))
+                return false;
+
+            for (size_t j = 0; j < answer.size(); ++j)
+            {
+                if (grid.remap(answer.get(j).m_index) != ref_answer[j])
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    TEST_CASE(Query_GivenSearchRadiusEqualToCellSize_ReturnsIdenticalResultsAsNaiveAlgorithm)
+    {
+        EXPECT_TRUE(do_results_match_naive_algorithm(10000, 0.05, square(0.05), 20, 1000));
+    }
+
+    TEST_CASE(Query_GivenSearchRadiusSmallerThanCellSize_ReturnsIdenticalResultsAsNaiveAlgorithm)
+    {
+        EXPECT_TRUE(do_results_match_naive_algorithm(10000, 0.1, square(0.03), 20, 1000));
+    }
+
+    TEST_CASE(Query_GivenSearchRadiusLargerThanCellSize_ReturnsIdenticalResultsAsNaiveAlgorithm)
+    {
+        EXPECT_TRUE(do_results_match_naive_algorithm(10000, 0.02, square(0.07), 20, 200));
+    }
+
+    TEST_CASE(Query_GivenSearchRadiusMuchLargerThanCellSize_ReturnsIdenticalResultsAsNaiveAlgorithm)
+    {
+        EXPECT_TRUE(do_results_match_naive_algorithm(1000, 0.01, square(0.2), 20, 100));
+    }
+}
@@ -38,6 +38,9 @@ BEGIN_EXR_INCLUDES
 #include "OpenEXR/half.h"
 END_EXR_INCLUDES
 
+// Standard headers.
+#include <cstddef>
+
 using namespace foundation;
 
 TEST_SUITE(Foundation_Image_Pixel)
@@ -101,4 +104,148 @@ TEST_SUITE(Foundation_Image_Pixel)
 
         EXPECT_EQ(4294967295UL, output);
     }
+
+    // Convert values one at a time, which always takes the scalar code path.
+    template <typename T>
+    void convert_one_by_one(
+        const T*            src,
+        const size_t        count,
+        const PixelFormat   dest_format,
+        uint8*              dest)
+    {
+        const size_t dest_size = Pixel::size(dest_format);
+
+        for (size_t i = 0; i < count; ++i)
+            Pixel::convert_to_format(src + i, src + i + 1, 1, dest_format, dest + i * dest_size, 1);
+    }
+
+    const size_t ValueCount = 37;
+
+    void make_float_values(float values[ValueCount])
+    {
+        for (size_t i = 0; i < ValueCount; ++i)
+            values[i] = static_cast<float>(i) * 0.037f - 0.2f;
+    }
+
+    TEST_CASE(ConvertToFormat_FloatToUInt8_ContiguousRange_MatchesScalarConversion)
+    {
+        float input[ValueCount];
+        make_float_values(input);
+
+        uint8 expected[ValueCount];
+        convert_one_by_one(input, ValueCount, PixelFormatUInt8, expected);
+
+        uint8 output[ValueCount];
+        Pixel::convert_to_format(input, input + ValueCount, 1, PixelFormatUInt8, output, 1);
+
+        EXPECT_SEQUENCE_EQ(ValueCount, expected, output);
+    }
+
+    TEST_CASE(ConvertToFormat_UInt8ToFloat_ContiguousRange_MatchesScalarConversion)
+    {
+        uint8 input[ValueCount];
+        for (size_t i = 0; i < ValueCount; ++i)
+            input[i] = static_cast<uint8>(i * 7);
+
+        float expected[ValueCount];
+        convert_one_by_one(input, ValueCount, PixelFormatFloat, reinterpret_cast<uint8*>(expected));
+
+        float output[ValueCount];
+        Pixel::convert_to_format(input, input + ValueCount, 1, PixelFormatFloat, output, 1);
+
+        EXPECT_SEQUENCE_EQ(ValueCount, expected, output);
+    }
+
+    TEST_CASE(ConvertToFormat_FloatToHalfAndBack_ContiguousRange_MatchesScalarConversion)
+    {
+        float input[ValueCount];
+        make_float_values(input);
+
+        half expected_half[ValueCount];
+        convert_one_by_one(input, ValueCount, PixelFormatHalf, reinterpret_cast<uint8*>(expected_half));
+
+        half output_half[ValueCount];
+        Pixel::convert_to_format(input, input + ValueCount, 1, PixelFormatHalf, output_half, 1);
+
+        float expected[ValueCount];
+        convert_one_by_one(expected_half, ValueCount, PixelFormatFloat, reinterpret_cast<uint8*>(expected));
+
+        float output[ValueCount];
+        Pixel::convert_to_format(output_half, output_half + ValueCount, 1, PixelFormatFloat, output, 1);
+
+        EXPECT_SEQUENCE_EQ(ValueCount, expected, output);
+    }
+
+    TEST_CASE(ConvertAndShuffle_UInt8RGBAToBGR)
+    {
+        const size_t PixelCount = 11;
+
+        uint8 input[PixelCount * 4];
+        for (size_t i = 0; i < PixelCount * 4; ++i)
+            input[i] = static_cast<uint8>(i);
+
+        const size_t shuffle_table[4] = { 2, 1, 0, Pixel::SkipChannel };
+
+        uint8 output[PixelCount * 3];
+        Pixel::convert_and_shuffle(
+            PixelFormatUInt8,
+            4,
+            input,
+            input + PixelCount * 4,
+            PixelFormatUInt8,
+            3,
+            output,
+            shuffle_table);
+
+        uint8 expected[PixelCount * 3];
+        for (size_t i = 0; i < PixelCount; ++i)
+        {
+            expected[i * 3 + 0] = input[i * 4 + 2];
+            expected[i * 3 + 1] = input[i * 4 + 1];
+            expected[i * 3 + 2] = input[i * 4 + 0];
+        }
+
+        EXPECT_SEQUENCE_EQ(PixelCount * 3, expected, output);
+    }
+
+    TEST_CASE(ReadRGBA_UInt8ThreeChannels_SetsAlphaToOne)
+    {
+        const uint8 input[3] = { 0, 51, 255 };
+
+        float output[4];
+        Pixel::read_rgba<PixelFormatUInt8>(input, 3, output);
+
+        EXPECT_EQ(0.0f, output[0]);
+        EXPECT_FEQ(0.2f, output[1]);
+        EXPECT_EQ(1.0f, output[2]);
+        EXPECT_EQ(1.0f, output[3]);
+    }
+
+    TEST_CASE(ReadRGBA_FloatSingleChannel_ReplicatesChannel)
+    {
+        const float input = 0.5f;
+
+        float output[4];
+        Pixel::read_rgba<PixelFormatFloat>(
+            reinterpret_cast<const uint8*>(&input), 1, output);
+
+        EXPECT_EQ(0.5f, output[0]);
+        EXPECT_EQ(0.5f, output[1]);
+        EXPECT_EQ(0.5f, output[2]);
+        EXPECT_EQ(1.0f, output[3]);
+    }
+
+    TEST_CASE(ReadRGBA_HalfFourChannels)
+    {
+        const half input[4] = { 0.25f, 0.5f, 0.75f, 1.0f };
+
+        float output[4];
+        Pixel::read_rgba<PixelFormatHalf>(
+            reinterpret_cast<const uint8*>(input), 4, output);
+
+        EXPECT_EQ(0.25f, output[0]);
+        EXPECT_EQ(0.5f, output[1]);
+        EXPECT_EQ(0.75f, output[2]);
+        EXPECT_EQ(1.0f, output[3]);
+    }
 }
@@ -0,0 +1,120 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/image/imageattributes.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/preprocessedtexture.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <fstream>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Image_PreprocessedTexture)
+{
+    const char* Filename = "unit tests/outputs/test_preprocessedtexture.tmp";
+
+    void write_file(const string& content)
+    {
+        ofstream file(Filename, ios::out | ios::binary | ios::trunc);
+        file << content;
+    }
+
+    TEST_CASE(GetPreprocessedTexturePath_Given8BitPixelFormat_AppendsTIFFSuffixToSourcePath)
+    {
+        EXPECT_EQ(
+            "textures/wood.png.tiled.tif",
+            get_preprocessed_texture_path("textures/wood.png", PixelFormatUInt8));
+    }
+
+    TEST_CASE(GetPreprocessedTexturePath_GivenFloatPixelFormat_AppendsEXRSuffixToSourcePath)
+    {
+        EXPECT_EQ(
+            "textures/wood.hdr.tiled.exr",
+            get_preprocessed_texture_path("textures/wood.hdr", PixelFormatFloat));
+    }
+
+    TEST_CASE(GetPreprocessedTextureSourceHash_GivenHashReadBackAsImageDescription_ReturnsHash)
+    {
+        ImageAttributes written_attributes;
+        set_preprocessed_texture_source_hash(written_attributes, 12345678901234ULL);
+
+        // Image file readers return the "comment" attribute as "ImageDescription".
+        ImageAttributes read_attributes;
+        read_attributes.insert("ImageDescription", written_attributes.get<string>("comment"));
+
+        uint64 hash;
+        ASSERT_TRUE(get_preprocessed_texture_source_hash(read_attributes, hash));
+        EXPECT_EQ(12345678901234ULL, hash);
+    }
+
+    TEST_CASE(GetPreprocessedTextureSourceHash_GivenUnrelatedImageDescription_ReturnsFalse)
+    {
+        ImageAttributes attributes;
+        attributes.insert("ImageDescription", "some image");
+
+        uint64 hash;
+        EXPECT_FALSE(get_preprocessed_texture_source_hash(attributes, hash));
+    }
+
+    TEST_CASE(ComputeFileContentHash_GivenSameContent_ReturnsSameHash)
+    {
+        write_file("some texture content");
+        const uint64 hash1 = compute_file_content_hash(Filename);
+
+        write_file("some texture content");
+        const uint64 hash2 = compute_file_content_hash(Filename);
+
+        EXPECT_EQ(hash1, hash2);
+    }
+
+    TEST_CASE(ComputeFileContentHash_GivenDifferentContent_ReturnsDifferentHashes)
+    {
+        write_file("some texture content");
+        const uint64 hash1 = compute_file_content_hash(Filename);
+
+        write_file("some texture content, modified");
+        const uint64 hash2 = compute_file_content_hash(Filename);
+
+        EXPECT_NEQ(hash1, hash2);
+    }
+
+    TEST_CASE(ComputeFileContentHash_GivenMissingFile_ThrowsExceptionIOError)
+    {
+        EXPECT_EXCEPTION(ExceptionIOError,
+        {
+            compute_file_content_hash("unit tests/inputs/this file does not exist");
+        });
+    }
+}
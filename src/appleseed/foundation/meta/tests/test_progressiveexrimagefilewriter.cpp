@@ -0,0 +1,94 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/genericprogressiveimagefilereader.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/progressiveexrimagefilewriter.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Image_ProgressiveEXRImageFileWriter)
+{
+    TEST_CASE(WriteTile_TilesWrittenOutOfOrder_WritesAllTiles)
+    {
+        const char* Filename = "unit tests/outputs/test_progressiveexrimagefilewriter.exr";
+
+        // 3x2 tiles, the rightmost and bottom tiles are partial.
+        const CanvasProperties props(40, 24, 16, 16, 4, PixelFormatFloat);
+
+        ProgressiveEXRImageFileWriter writer;
+        writer.add_part("beauty", props);
+        writer.open(Filename);
+
+        for (size_t i = props.m_tile_count; i > 0; --i)
+        {
+            const size_t tile_x = (i - 1) % props.m_tile_count_x;
+            const size_t tile_y = (i - 1) / props.m_tile_count_x;
+
+            Tile tile(
+                props.get_tile_width(tile_x),
+                props.get_tile_height(tile_y),
+                props.m_channel_count,
+                props.m_pixel_format);
+            tile.clear(Color4f(static_cast<float>(i)));
+
+            writer.write_tile(tile, tile_x, tile_y);
+        }
+
+        writer.close();
+
+        GenericProgressiveImageFileReader reader;
+        reader.open(Filename);
+
+        for (size_t i = 0; i < props.m_tile_count; ++i)
+        {
+            const size_t tile_x = i % props.m_tile_count_x;
+            const size_t tile_y = i / props.m_tile_count_x;
+
+            auto_ptr<Tile> tile(reader.read_tile(tile_x, tile_y));
+
+            EXPECT_EQ(props.get_tile_width(tile_x), tile->get_width());
+            EXPECT_EQ(props.get_tile_height(tile_y), tile->get_height());
+
+            Color4f c;
+            tile->get_pixel(tile->get_pixel_count() - 1, c);
+            EXPECT_EQ(Color4f(static_cast<float>(i + 1)), c);
+        }
+    }
+}
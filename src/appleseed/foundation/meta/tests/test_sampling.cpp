@@ -108,6 +108,116 @@ TEST_SUITE(Foundation_Math_Sampling_QMCSamplingContext)
         EXPECT_EQ(4, child_child_context.m_dimension);
         EXPECT_EQ(0, child_child_context.m_instance);
     }
+
+    TEST_CASE(TestSplitting_SobolMode_ChildSequencesAreStratifiedAndDecorrelated)
+    {
+        const size_t SampleCount = 16;
+
+        RNG rng;
+        SamplingContext context(rng, SamplingContext::SobolMode, 2, 0, 7);
+
+        vector<Vector2d> first_samples;
+
+        for (size_t p = 0; p < 2; ++p)
+        {
+            context.next2<Vector2d>();
+
+            SamplingContext child_context = context.split(2, SampleCount);
+
+            vector<size_t> x_strata(SampleCount, 0);
+            vector<size_t> y_strata(SampleCount, 0);
+
+            for (size_t i = 0; i < SampleCount; ++i)
+            {
+                const Vector2d s = child_context.next2<Vector2d>();
+
+                if (i == 0)
+                    first_samples.push_back(s);
+
+                ++x_strata[static_cast<size_t>(s.x * SampleCount)];
+                ++y_strata[static_cast<size_t>(s.y * SampleCount)];
+            }
+
+            for (size_t i = 0; i < SampleCount; ++i)
+            {
+                EXPECT_EQ(1, x_strata[i]);
+                EXPECT_EQ(1, y_strata[i]);
+            }
+        }
+
+        EXPECT_NEQ(first_samples[0], first_samples[1]);
+    }
+
+    TEST_CASE(TestSplitting_SobolMode_ChildSamplesOfSuccessiveSamplesAreStratified)
+    {
+        const size_t SampleCount = 16;
+
+        RNG rng;
+        SamplingContext context(rng, SamplingContext::SobolMode, 2, 0, 7);
+
+        vector<size_t> x_strata(SampleCount, 0);
+        vector<size_t> y_strata(SampleCount, 0);
+        vector<size_t> grandchild_x_strata(SampleCount, 0);
+        vector<size_t> grandchild_y_strata(SampleCount, 0);
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            context.next2<Vector2d>();
+
+            // Split the way sample renderers do, with a single sample per child context.
+            SamplingContext child_context = context.split(2, 1);
+            const Vector2d s = child_context.next2<Vector2d>();
+
+            ++x_strata[static_cast<size_t>(s.x * SampleCount)];
+            ++y_strata[static_cast<size_t>(s.y * SampleCount)];
+
+            child_context.split_in_place(2, 1);
+            const Vector2d t = child_context.next2<Vector2d>();
+
+            ++grandchild_x_strata[static_cast<size_t>(t.x * SampleCount)];
+            ++grandchild_y_strata[static_cast<size_t>(t.y * SampleCount)];
+        }
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            EXPECT_EQ(1, x_strata[i]);
+            EXPECT_EQ(1, y_strata[i]);
+            EXPECT_EQ(1, grandchild_x_strata[i]);
+            EXPECT_EQ(1, grandchild_y_strata[i]);
+        }
+    }
+
+    TEST_CASE(TestSplitting_BlueNoiseMode_PixelsShareRotatedChildSequences)
+    {
+        RNG rng;
+        SamplingContext context1(rng, SamplingContext::BlueNoiseMode, 2, 0, 7);
+        SamplingContext context2(rng, SamplingContext::BlueNoiseMode, 2, 0, 13);
+        context1.set_pixel(3, 5, 42);
+        context2.set_pixel(10, 20, 42);
+
+        context1.next2<Vector2d>();
+        context2.next2<Vector2d>();
+
+        SamplingContext child_context1 = context1.split(2, 16);
+        SamplingContext child_context2 = context2.split(2, 16);
+
+        // Child sequences only differ by a per-pixel toroidal shift.
+        Vector2d expected_shift(0.0);
+
+        for (size_t i = 0; i < 16; ++i)
+        {
+            const Vector2d s1 = child_context1.next2<Vector2d>();
+            const Vector2d s2 = child_context2.next2<Vector2d>();
+
+            Vector2d shift = s1 - s2;
+            if (shift.x < 0.0) shift.x += 1.0;
+            if (shift.y < 0.0) shift.y += 1.0;
+
+            if (i == 0)
+                expected_shift = shift;
+            else EXPECT_FEQ_EPS(expected_shift, shift, 1.0e-9);
+        }
+    }
 }
 
 TEST_SUITE(Foundation_Math_Sampling_QMCSamplingContext_DirectIlluminationSimulation)
@@ -0,0 +1,295 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/hash.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/qmcsamplingcontext.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/sobol.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/gnuplotfile.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_Sobol)
+{
+    TEST_CASE(ReverseBits)
+    {
+        EXPECT_EQ(0x00000000UL, reverse_bits(0x00000000UL));
+        EXPECT_EQ(0x80000000UL, reverse_bits(0x00000001UL));
+        EXPECT_EQ(0x00000001UL, reverse_bits(0x80000000UL));
+        EXPECT_EQ(0x1E6A2C48UL, reverse_bits(0x12345678UL));
+    }
+
+    TEST_CASE(SobolUInt32_Dimension0_IsVanDerCorputSequence)
+    {
+        EXPECT_EQ(0x00000000UL, sobol_uint32(0, 0));
+        EXPECT_EQ(0x80000000UL, sobol_uint32(0, 1));
+        EXPECT_EQ(0x40000000UL, sobol_uint32(0, 2));
+        EXPECT_EQ(0xC0000000UL, sobol_uint32(0, 3));
+        EXPECT_EQ(0x20000000UL, sobol_uint32(0, 4));
+    }
+
+    TEST_CASE(SobolUInt32_Dimension1)
+    {
+        EXPECT_EQ(0x00000000UL, sobol_uint32(1, 0));
+        EXPECT_EQ(0x80000000UL, sobol_uint32(1, 1));
+        EXPECT_EQ(0x40000000UL, sobol_uint32(1, 2));
+        EXPECT_EQ(0xC0000000UL, sobol_uint32(1, 3));
+        EXPECT_EQ(0xA0000000UL, sobol_uint32(1, 4));
+        EXPECT_EQ(0x20000000UL, sobol_uint32(1, 5));
+    }
+
+    TEST_CASE(NestedUniformScramble_IsBijectionOverAlignedRanges)
+    {
+        // Scrambling must map the aligned range [0, 256) << 24 onto itself.
+        vector<bool> hit(256, false);
+
+        for (uint32 i = 0; i < 256; ++i)
+        {
+            const uint32 x = nested_uniform_scramble(i << 24, 0x2A5F3C1DUL);
+            EXPECT_EQ(0, x & 0x00FFFFFFUL);
+            hit[x >> 24] = true;
+        }
+
+        for (size_t i = 0; i < 256; ++i)
+            EXPECT_TRUE(hit[i]);
+    }
+
+    TEST_CASE(OwenScrambledSobol4_MatchesOwenScrambledSobol)
+    {
+        for (uint32 i = 0; i < 1000; ++i)
+        {
+            const uint32 seed = hash_uint32(i);
+
+            double values[4];
+            owen_scrambled_sobol4(i, seed, values);
+
+            for (size_t d = 0; d < 4; ++d)
+                EXPECT_EQ(owen_scrambled_sobol<double>(d, i, seed), values[d]);
+        }
+    }
+
+    TEST_CASE(OwenScrambledSobol4_Float_ReturnsValuesInUnitInterval)
+    {
+        for (uint32 i = 0; i < 1000; ++i)
+        {
+            float values[4];
+            owen_scrambled_sobol4(i, 0xFFFFFFFFUL - i, values);
+
+            for (size_t d = 0; d < 4; ++d)
+            {
+                EXPECT_TRUE(values[d] >= 0.0f);
+                EXPECT_TRUE(values[d] < 1.0f);
+            }
+        }
+    }
+
+    // Return true if the first 2^m points of dimensions (d0, d1) form a (0,m,2)-net in base 2.
+    bool is_02_net(
+        const size_t    m,
+        const size_t    d0,
+        const size_t    d1,
+        const uint32    seed)
+    {
+        const size_t n = size_t(1) << m;
+
+        for (size_t k = 0; k <= m; ++k)
+        {
+            // Elementary intervals of size 2^-k by 2^-(m-k).
+            vector<size_t> counts(n, 0);
+
+            for (uint32 i = 0; i < n; ++i)
+            {
+                const size_t x = static_cast<size_t>(owen_scrambled_sobol<double>(d0, i, seed) * (size_t(1) << k));
+                const size_t y = static_cast<size_t>(owen_scrambled_sobol<double>(d1, i, seed) * (size_t(1) << (m - k)));
+                ++counts[(y << k) + x];
+            }
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (counts[i] != 1)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    TEST_CASE(OwenScrambledSobol_FirstTwoDimensions_Form02Nets)
+    {
+        for (uint32 seed = 0; seed < 8; ++seed)
+        {
+            EXPECT_TRUE(is_02_net(4, 0, 1, hash_uint32(seed)));
+            EXPECT_TRUE(is_02_net(8, 0, 1, hash_uint32(seed)));
+        }
+    }
+
+    TEST_CASE(OwenScrambledSobol_LastTwoDimensions_Form02Nets)
+    {
+        for (uint32 seed = 0; seed < 8; ++seed)
+        {
+            EXPECT_TRUE(is_02_net(4, 2, 3, hash_uint32(seed)));
+            EXPECT_TRUE(is_02_net(8, 2, 3, hash_uint32(seed)));
+        }
+    }
+
+    //
+    // Convergence of the sampling modes of QMCSamplingContext.
+    //
+    // Each integrand is estimated independently for a number of "pixels" (initial
+    // instance numbers, as computed by the uniform pixel renderer) and the RMS error
+    // is plotted against the number of samples per pixel.
+    //
+
+    typedef MersenneTwister RNG;
+    typedef QMCSamplingContext<RNG> SamplingContext;
+
+    const size_t PixelCount = 64;
+    const size_t MaxSampleCountLog2 = 10;
+
+    // Smooth integrand over [0,1)^4.
+    double smooth_integrand(const Vector4d& s)
+    {
+        return 16.0 * s[0] * s[1] * s[2] * s[3];
+    }
+
+    // Discontinuous integrand over [0,1)^2 (an edge crossing a pixel).
+    double disk_integrand(const Vector4d& s)
+    {
+        return s[0] * s[0] + s[1] * s[1] < 1.0 ? 4.0 / Pi<double>() : 0.0;
+    }
+
+    // Discontinuous integrand over [0,1)^4 (e.g. pixel, lens and light samples).
+    double shadow_integrand(const Vector4d& s)
+    {
+        return s[0] + s[1] + s[2] + s[3] < 2.0 ? 2.0 : 0.0;
+    }
+
+    // Return the RMS error of the estimates (the exact value of all integrands is 1).
+    vector<Vector2d> compute_rms_errors(
+        const SamplingContext::Mode mode,
+        double                      (*integrand)(const Vector4d&))
+    {
+        vector<Vector2d> errors;
+
+        for (size_t k = 0; k <= MaxSampleCountLog2; ++k)
+        {
+            const size_t sample_count = size_t(1) << k;
+            double sum_squared_errors = 0.0;
+
+            for (size_t p = 0; p < PixelCount; ++p)
+            {
+                RNG rng(static_cast<uint32>(p));
+                SamplingContext context(rng, mode, 4, 0, hash_uint32(static_cast<uint32>(p)));
+
+                double sum = 0.0;
+
+                for (size_t i = 0; i < sample_count; ++i)
+                    sum += integrand(context.next2<Vector4d>());
+
+                sum_squared_errors += square(sum / sample_count - 1.0);
+            }
+
+            errors.push_back(
+                Vector2d(
+                    static_cast<double>(sample_count),
+                    sqrt(sum_squared_errors / PixelCount)));
+        }
+
+        return errors;
+    }
+
+    void plot_rms_errors(
+        const string&               name,
+        double                      (*integrand)(const Vector4d&),
+        vector<Vector2d>&           sobol_errors,
+        vector<Vector2d>&           rng_errors)
+    {
+        rng_errors = compute_rms_errors(SamplingContext::RNGMode, integrand);
+        sobol_errors = compute_rms_errors(SamplingContext::SobolMode, integrand);
+        const vector<Vector2d> qmc_errors = compute_rms_errors(SamplingContext::QMCMode, integrand);
+
+        GnuplotFile plotfile;
+        plotfile.set_title("RMS Error (" + name + ")");
+        plotfile.set_xlabel("Samples");
+        plotfile.set_ylabel("RMS Error");
+        plotfile.set_logscale_x();
+        plotfile.set_logscale_y();
+        plotfile
+            .new_plot()
+            .set_points(rng_errors)
+            .set_title("RNG")
+            .set_color("blue");
+        plotfile
+            .new_plot()
+            .set_points(qmc_errors)
+            .set_title("QMC")
+            .set_color("red");
+        plotfile
+            .new_plot()
+            .set_points(sobol_errors)
+            .set_title("Sobol")
+            .set_color("green");
+        plotfile.write("unit tests/outputs/test_sobol_convergence_" + name + ".gnuplot");
+    }
+
+    TEST_CASE(PlotConvergence_SmoothIntegrand)
+    {
+        vector<Vector2d> sobol_errors, rng_errors;
+        plot_rms_errors("smooth", smooth_integrand, sobol_errors, rng_errors);
+
+        EXPECT_LT(rng_errors.back().y, sobol_errors.back().y);
+    }
+
+    TEST_CASE(PlotConvergence_DiskIntegrand)
+    {
+        vector<Vector2d> sobol_errors, rng_errors;
+        plot_rms_errors("disk", disk_integrand, sobol_errors, rng_errors);
+
+        EXPECT_LT(rng_errors.back().y, sobol_errors.back().y);
+    }
+
+    TEST_CASE(PlotConvergence_ShadowIntegrand)
+    {
+        vector<Vector2d> sobol_errors, rng_errors;
+        plot_rms_errors("shadow", shadow_integrand, sobol_errors, rng_errors);
+
+        EXPECT_LT(rng_errors.back().y, sobol_errors.back().y);
+    }
+}
@@ -70,10 +70,19 @@ uint32 atomic_cas(
     const uint32        expected_value,
     const uint32        new_value);
 
+uint64 atomic_cas(
+    volatile uint64*    ptr,
+    const uint64        expected_value,
+    const uint64        new_value);
+
 void atomic_add(
     volatile float*     ptr,
     const float         operand);
 
+void atomic_add(
+    volatile double*    ptr,
+    const double        operand);
+
 
 //
 // Implementation.
@@ -118,6 +127,25 @@ APPLESEED_FORCE_INLINE uint32 atomic_cas(
 #endif
 }
 
+APPLESEED_FORCE_INLINE uint64 atomic_cas(
+    volatile uint64*    ptr,
+    const uint64        expected_value,
+    const uint64        new_value)
+{
+#if defined _WIN32
+    return
+        static_cast<uint64>(
+            InterlockedCompareExchange64(
+                reinterpret_cast<volatile LONGLONG*>(ptr),
+                static_cast<LONGLONG>(new_value),
+                static_cast<LONGLONG>(expected_value)));
+#elif defined __GNUC__
+    return __sync_val_compare_and_swap(ptr, expected_value, new_value);
+#else
+    #error Unsupported platform.
+#endif
+}
+
 APPLESEED_FORCE_INLINE void atomic_add(
     volatile float*     ptr,
     const float         operand)
@@ -138,6 +166,26 @@ APPLESEED_FORCE_INLINE void atomic_add(
     }
 }
 
+APPLESEED_FORCE_INLINE void atomic_add(
+    volatile double*    ptr,
+    const double        operand)
+{
+    assert(is_aligned(ptr, 8));
+
+    volatile uint64* iptr = reinterpret_cast<volatile uint64*>(ptr);
+    uint64 expected = *iptr;
+
+    while (true)
+    {
+        const double value = binary_cast<double>(expected);
+        const uint64 new_value = binary_cast<uint64>(value + operand);
+        const uint64 actual = atomic_cas(iptr, expected, new_value);
+        if (actual == expected)
+            return;
+        expected = actual;
+    }
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_PLATFORM_ATOMIC_H
@@ -0,0 +1,1098 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "bdptlightingengine.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/aov/spectrumstack.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/lighting/imagebasedlighting.h"
+#include "renderer/kernel/lighting/lightsampler.h"
+#include "renderer/kernel/lighting/pathtracer.h"
+#include "renderer/kernel/lighting/pathvertex.h"
+#include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/tracer.h"
+#include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/edf/edf.h"
+#include "renderer/modeling/environment/environment.h"
+#include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/input/inputevaluator.h"
+#include "renderer/modeling/light/light.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/basis.h"
+#include "foundation/math/mis.h"
+#include "foundation/math/population.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Forward declarations.
+namespace renderer  { class PixelContext; }
+namespace renderer  { class TextureCache; }
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    //
+    // Bidirectional Path Tracing (BDPT) lighting engine.
+    //
+    // For every camera subpath, a light subpath is started from a point on an emitting
+    // triangle. Each vertex of the camera subpath is then connected with a shadow ray to
+    // the origin and to the stored vertices of the light subpath, and paths generated by
+    // the different techniques are combined with the power heuristic.
+    //
+    // MIS weights are computed with the recursive formulation of Georgiev: two partial
+    // sums are updated at every vertex of both subpaths, so that a connection only needs
+    // to know the two vertices it joins.
+    //
+    // Since lighting is computed one pixel at a time, light subpaths are never connected
+    // to the camera, and this technique is excluded from MIS weights. Non-physical lights
+    // and the environment don't start light subpaths: they are only reached by next event
+    // estimation and, for the environment, by extending camera subpaths. Light subpaths
+    // stop at surfaces without BSDF and at surfaces scattering light below the surface,
+    // and camera vertices found after subsurface scattering only collect emitted light.
+    //
+    // References:
+    //
+    //   Robust Monte Carlo Methods for Light Transport Simulation
+    //   http://graphics.stanford.edu/papers/veach_thesis/
+    //
+    //   Implementing Vertex Connection and Merging
+    //   http://www.iliyan.com/publications/ImplementingVCM
+    //
+
+    // Power heuristic (beta = 2) applied to a single density or density ratio.
+    inline float mis2(const float x)
+    {
+        return x * x;
+    }
+
+    // Scattering modes of the techniques that connect two vertices.
+    const int ConnectionModes = ScatteringMode::Diffuse | ScatteringMode::Glossy;
+
+    // A vertex of a subpath, kept after the path tracer has moved on.
+    struct SubpathVertex
+    {
+        Vector3d                m_point;
+        Vector3d                m_geometric_normal;         // world space, facing the previous vertex of the subpath
+        Basis3d                 m_shading_basis;
+        Vector3d                m_outgoing;                 // world space, toward the previous vertex of the subpath
+        const BSDF*             m_bsdf;
+        const void*             m_bsdf_data;                // null if the BSDF is purely specular
+        Spectrum                m_throughput;               // flux reaching this vertex (light subpaths only)
+        size_t                  m_path_length;              // number of segments from the origin of the subpath
+        float                   m_dvcm;                     // partial MIS weights (dVCM and dVC in Georgiev's notes)
+        float                   m_dvc;
+
+        void set(const PathVertex& vertex, const void* bsdf_data)
+        {
+            m_point = vertex.get_point();
+            m_geometric_normal = vertex.get_geometric_normal();
+            m_shading_basis = vertex.get_shading_basis();
+            m_outgoing = vertex.m_outgoing.get_value();
+            m_bsdf = vertex.m_bsdf;
+            m_bsdf_data = bsdf_data;
+        }
+
+        // Compute the probability density, in solid angle, of scattering toward the previous
+        // vertex of the subpath when arriving from a given direction.
+        float evaluate_reverse_pdf(const Vector3d& next) const
+        {
+            if (m_bsdf_data == 0)
+                return 0.0f;
+
+            return
+                m_bsdf->evaluate_pdf(
+                    m_bsdf_data,
+                    Vector3f(m_geometric_normal),
+                    Basis3f(m_shading_basis),
+                    Vector3f(next),
+                    Vector3f(m_outgoing),
+                    ConnectionModes);
+        }
+    };
+
+    // Partial MIS weights of the subpath ending at the current vertex.
+    struct SubpathMIS
+    {
+        float                   m_dvcm;
+        float                   m_dvc;
+
+        SubpathMIS()
+          : m_dvcm(0.0f)
+          , m_dvc(0.0f)
+        {
+        }
+
+        // Account for the segment going from a stored vertex to the current vertex,
+        // optionally preceded by a scattering event at the stored vertex.
+        void extend(
+            const SubpathVertex&    prev,
+            const PathVertex&       vertex,
+            const bool              scattered)
+        {
+            Vector3d direction = vertex.get_point() - prev.m_point;
+            const double square_distance = square_norm(direction);
+            direction /= sqrt(square_distance);
+
+            if (scattered)
+            {
+                const float cos_out =
+                    static_cast<float>(abs(dot(direction, prev.m_shading_basis.get_normal())));
+
+                if (vertex.m_prev_mode == ScatteringMode::Specular)
+                {
+                    m_dvcm = 0.0f;
+                    m_dvc *= mis2(cos_out);
+                }
+                else
+                {
+                    const float pdf_fwd = vertex.m_prev_prob;
+                    const float pdf_rev = prev.evaluate_reverse_pdf(direction);
+                    m_dvc = mis2(cos_out / pdf_fwd) * (m_dvc * mis2(pdf_rev) + m_dvcm);
+                    m_dvcm = mis2(1.0f / pdf_fwd);
+                }
+            }
+
+            // Avoid infinite weights at grazing angles.
+            const float cos_in = max(static_cast<float>(abs(vertex.m_cos_on)), 1.0e-6f);
+            const float rcp_mis_cos_in = 1.0f / mis2(cos_in);
+
+            m_dvcm *= mis2(static_cast<float>(square_distance)) * rcp_mis_cos_in;
+            m_dvc *= rcp_mis_cos_in;
+        }
+    };
+
+    class BDPTLightingEngine
+      : public ILightingEngine
+    {
+      public:
+        struct Parameters
+        {
+            const bool      m_enable_ibl;                   // is image-based lighting enabled?
+
+            const size_t    m_max_path_length;              // maximum path length, ~0 for unlimited
+            const size_t    m_rr_min_path_length;           // minimum path length before Russian Roulette kicks in, ~0 for unlimited
+
+            explicit Parameters(const ParamArray& params)
+              : m_enable_ibl(params.get_optional<bool>("enable_ibl", true))
+              , m_max_path_length(nz(params.get_optional<size_t>("max_path_length", 0)))
+              , m_rr_min_path_length(nz(params.get_optional<size_t>("rr_min_path_length", 6)))
+            {
+            }
+
+            static size_t nz(const size_t x)
+            {
+                return x == 0 ? ~0 : x;
+            }
+
+            void print() const
+            {
+                RENDERER_LOG_INFO(
+                    "bidirectional path tracing settings:\n"
+                    "  ibl              %s\n"
+                    "  max path length  %s\n"
+                    "  rr min path len. %s",
+                    m_enable_ibl ? "on" : "off",
+                    m_max_path_length == size_t(~0) ? "infinite" : pretty_uint(m_max_path_length).c_str(),
+                    m_rr_min_path_length == size_t(~0) ? "infinite" : pretty_uint(m_rr_min_path_length).c_str());
+            }
+        };
+
+        BDPTLightingEngine(
+            const LightSampler&     light_sampler,
+            const ParamArray&       params)
+          : m_params(params)
+          , m_light_sampler(light_sampler)
+          , m_light_edf(0)
+          , m_light_vertex_count(0)
+          , m_path_count(0)
+        {
+        }
+
+        ~BDPTLightingEngine()
+        {
+            for (size_t i = 0; i < m_light_vertex_input_evaluators.size(); ++i)
+                delete m_light_vertex_input_evaluators[i];
+        }
+
+        virtual void release() APPLESEED_OVERRIDE
+        {
+            delete this;
+        }
+
+        virtual void compute_lighting(
+            SamplingContext&        sampling_context,
+            const PixelContext&     pixel_context,
+            const ShadingContext&   shading_context,
+            const ShadingPoint&     shading_point,
+            Spectrum&               radiance,               // output radiance, in W.sr^-1.m^-2
+            SpectrumStack&          aovs) APPLESEED_OVERRIDE
+        {
+            // Input values of stored vertices must survive the path tracers, allocate them once.
+            if (m_light_input_evaluator.get() == 0)
+            {
+                TextureCache& texture_cache = shading_context.get_texture_cache();
+                m_light_input_evaluator.reset(new InputEvaluator(texture_cache));
+                m_camera_input_evaluator.reset(new InputEvaluator(texture_cache));
+                for (size_t i = 0; i < MaxLightVertexCount; ++i)
+                    m_light_vertex_input_evaluators.push_back(new InputEvaluator(texture_cache));
+            }
+
+            // Trace a light subpath and store its vertices.
+            const size_t light_path_length =
+                trace_light_subpath(
+                    sampling_context,
+                    shading_context,
+                    shading_point.get_time());
+
+            // Trace a camera subpath and connect each of its vertices to the light subpath.
+            CameraPathVisitor path_visitor(
+                *this,
+                sampling_context,
+                shading_context,
+                shading_point.get_scene(),
+                radiance,
+                aovs);
+
+            PathTracer<CameraPathVisitor, false> path_tracer(   // false = not adjoint
+                path_visitor,
+                m_params.m_rr_min_path_length,
+                m_params.m_max_path_length,
+                shading_context.get_max_iterations());
+
+            const size_t camera_path_length =
+                path_tracer.trace(
+                    sampling_context,
+                    shading_context,
+                    shading_point);
+
+            // Update statistics.
+            ++m_path_count;
+            m_light_path_length.insert(light_path_length);
+            m_camera_path_length.insert(camera_path_length);
+        }
+
+        virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
+        {
+            Statistics stats;
+            stats.insert("path count", m_path_count);
+            stats.insert("light path length", m_light_path_length);
+            stats.insert("camera path length", m_camera_path_length);
+
+            return StatisticsVector::make("bidirectional path tracing statistics", stats);
+        }
+
+      private:
+        // Maximum number of stored vertices of a light subpath, not counting its origin.
+        enum { MaxLightVertexCount = 16 };
+
+        const Parameters            m_params;
+        const LightSampler&         m_light_sampler;
+
+        // Origin of the light subpath, on an emitting triangle.
+        const EDF*                  m_light_edf;            // null if there is no light subpath
+        const void*                 m_light_edf_data;
+        Vector3d                    m_light_point;
+        Vector3d                    m_light_geometric_normal;
+        Basis3d                     m_light_shading_basis;
+        float                       m_light_prob;           // probability density of the origin, in area measure
+
+        // Vertices of the light subpath, in order of increasing path length.
+        SubpathVertex               m_light_vertices[MaxLightVertexCount];
+        size_t                      m_light_vertex_count;
+
+        auto_ptr<InputEvaluator>    m_light_input_evaluator;
+        auto_ptr<InputEvaluator>    m_camera_input_evaluator;
+        vector<InputEvaluator*>     m_light_vertex_input_evaluators;
+
+        uint64                      m_path_count;
+        Population<uint64>          m_light_path_length;
+        Population<uint64>          m_camera_path_length;
+
+        size_t trace_light_subpath(
+            SamplingContext&        sampling_context,
+            const ShadingContext&   shading_context,
+            const ShadingRay::Time& time)
+        {
+            m_light_edf = 0;
+            m_light_vertex_count = 0;
+
+            // Connecting to the light requires at least two path segments.
+            if (m_light_sampler.get_emitting_triangle_count() == 0 || m_params.m_max_path_length < 2)
+                return 0;
+
+            // Sample the emitting triangles.
+            sampling_context.split_in_place(3, 1);
+            LightSample light_sample;
+            m_light_sampler.sample_emitting_triangles(
+                time,
+                sampling_context.next2<Vector3f>(),
+                light_sample);
+
+            // Make sure the geometric normal of the light is on the same side as the shading normal.
+            light_sample.m_geometric_normal =
+                flip_to_same_hemisphere(
+                    light_sample.m_geometric_normal,
+                    light_sample.m_shading_normal);
+
+            const Material* material = light_sample.m_triangle->m_material;
+            const Material::RenderData& material_data = material->get_render_data();
+            const EDF* edf = material_data.m_edf;
+
+            // Build a shading point on the light source.
+            ShadingPoint light_shading_point;
+            light_sample.make_shading_point(
+                light_shading_point,
+                light_sample.m_shading_normal,
+                shading_context.get_intersector());
+
+            if (material_data.m_shader_group)
+            {
+                shading_context.execute_osl_emission(
+                    *material_data.m_shader_group,
+                    light_shading_point);
+            }
+
+            // Evaluate the EDF inputs.
+            edf->evaluate_inputs(*m_light_input_evaluator, light_shading_point);
+
+            // Store the origin of the light subpath.
+            m_light_edf = edf;
+            m_light_edf_data = m_light_input_evaluator->data();
+            m_light_point = light_sample.m_point;
+            m_light_geometric_normal = light_sample.m_geometric_normal;
+            m_light_shading_basis = Basis3d(light_sample.m_shading_normal);
+            m_light_prob = light_sample.m_probability;
+
+            // Connecting to light vertices requires at least three path segments.
+            if (m_params.m_max_path_length < 3)
+                return 1;
+
+            // Sample the EDF.
+            sampling_context.split_in_place(2, 1);
+            Vector3f emission_direction;
+            Spectrum edf_value;
+            float edf_prob;
+            edf->sample(
+                sampling_context,
+                m_light_edf_data,
+                Vector3f(m_light_geometric_normal),
+                Basis3f(m_light_shading_basis),
+                sampling_context.next2<Vector2f>(),
+                emission_direction,
+                edf_value,
+                edf_prob);
+            if (edf_prob == 0.0f)
+                return 1;
+
+            // Compute the initial particle weight.
+            const float cos_emission = dot(emission_direction, Vector3f(light_sample.m_shading_normal));
+            Spectrum initial_flux = edf_value;
+            initial_flux *= cos_emission / (m_light_prob * edf_prob);
+
+            // Make a shading point that will be used to avoid self-intersections with the light sample.
+            ShadingPoint parent_shading_point;
+            light_sample.make_shading_point(
+                parent_shading_point,
+                Vector3d(emission_direction),
+                shading_context.get_intersector());
+
+            // Build the light ray.
+            const ShadingRay light_ray(
+                light_sample.m_point,
+                Vector3d(emission_direction),
+                time,
+                VisibilityFlags::LightRay,
+                0);
+
+            // Trace the light subpath. Connections to the camera subpath add at least two
+            // segments to the path, and the number of stored vertices is bounded.
+            LightPathVisitor path_visitor(
+                *this,
+                shading_context,
+                initial_flux,
+                edf_prob,
+                cos_emission);
+            PathTracer<LightPathVisitor, true> path_tracer(     // true = adjoint
+                path_visitor,
+                m_params.m_rr_min_path_length,
+                min<size_t>(m_params.m_max_path_length - 2, MaxLightVertexCount),
+                shading_context.get_max_iterations(),
+                edf->get_light_near_start());                   // don't illuminate points closer than the light near start value
+
+            return
+                path_tracer.trace(
+                    sampling_context,
+                    shading_context,
+                    light_ray,
+                    &parent_shading_point) + 1;
+        }
+
+        struct LightPathVisitor
+        {
+            BDPTLightingEngine&         m_engine;
+            const ShadingContext&       m_shading_context;
+            const Spectrum&             m_initial_flux;
+            SubpathVertex               m_prev;
+            SubpathMIS                  m_mis;
+            bool                        m_terminated;
+
+            LightPathVisitor(
+                BDPTLightingEngine&     engine,
+                const ShadingContext&   shading_context,
+                const Spectrum&         initial_flux,
+                const float             edf_prob,
+                const float             cos_emission)
+              : m_engine(engine)
+              , m_shading_context(shading_context)
+              , m_initial_flux(initial_flux)
+              , m_terminated(false)
+            {
+                m_prev.m_point = engine.m_light_point;
+
+                m_mis.m_dvcm = mis2(1.0f / edf_prob);
+                m_mis.m_dvc = mis2(cos_emission / (engine.m_light_prob * edf_prob));
+            }
+
+            bool accept_scattering(
+                const ScatteringMode::Mode  prev_mode,
+                const ScatteringMode::Mode  next_mode) const
+            {
+                assert(next_mode != ScatteringMode::Absorption);
+                return !m_terminated;
+            }
+
+            void visit_vertex(const PathVertex& vertex)
+            {
+                // Update the MIS weights; the emission event is accounted for at construction.
+                m_mis.extend(m_prev, vertex, vertex.m_path_length > 1);
+
+                // Stop at surfaces without BSDF and at subsurface scattering events.
+                if (vertex.m_bsdf == 0)
+                {
+                    m_terminated = true;
+                    return;
+                }
+
+                // Vertices with a purely specular BSDF can't be connected to.
+                if (vertex.m_bsdf->is_purely_specular())
+                {
+                    m_prev.set(vertex, 0);
+                    return;
+                }
+
+                // The path tracer reuses its storage, keep our own copy of the BSDF inputs.
+                assert(m_engine.m_light_vertex_count < MaxLightVertexCount);
+                InputEvaluator& input_evaluator =
+                    *m_engine.m_light_vertex_input_evaluators[m_engine.m_light_vertex_count];
+                vertex.m_bsdf->evaluate_inputs(
+                    m_shading_context,
+                    input_evaluator,
+                    *vertex.m_shading_point);
+
+                // Store the vertex.
+                SubpathVertex& light_vertex = m_engine.m_light_vertices[m_engine.m_light_vertex_count++];
+                light_vertex.set(vertex, input_evaluator.data());
+                light_vertex.m_throughput = m_initial_flux;
+                light_vertex.m_throughput *= vertex.m_throughput;
+                light_vertex.m_path_length = vertex.m_path_length;
+                light_vertex.m_dvcm = m_mis.m_dvcm;
+                light_vertex.m_dvc = m_mis.m_dvc;
+
+                m_prev = light_vertex;
+            }
+
+            void visit_environment(const PathVertex& vertex)
+            {
+                // The particle escapes.
+            }
+        };
+
+        struct CameraPathVisitor
+        {
+            const Parameters&           m_params;
+            const LightSampler&         m_light_sampler;
+            const BDPTLightingEngine&   m_engine;
+            SamplingContext&            m_sampling_context;
+            const ShadingContext&       m_shading_context;
+            TextureCache&               m_texture_cache;
+            InputEvaluator&             m_prev_input_evaluator;
+            const EnvironmentEDF*       m_env_edf;
+            Spectrum&                   m_path_radiance;
+            SpectrumStack&              m_path_aovs;
+            SubpathVertex               m_prev;
+            SubpathMIS                  m_mis;
+            bool                        m_subsurface;       // has the path gone through subsurface scattering?
+
+            CameraPathVisitor(
+                const BDPTLightingEngine&   engine,
+                SamplingContext&            sampling_context,
+                const ShadingContext&       shading_context,
+                const Scene&                scene,
+                Spectrum&                   path_radiance,
+                SpectrumStack&              path_aovs)
+              : m_params(engine.m_params)
+              , m_light_sampler(engine.m_light_sampler)
+              , m_engine(engine)
+              , m_sampling_context(sampling_context)
+              , m_shading_context(shading_context)
+              , m_texture_cache(shading_context.get_texture_cache())
+              , m_prev_input_evaluator(*engine.m_camera_input_evaluator)
+              , m_env_edf(scene.get_environment()->get_environment_edf())
+              , m_path_radiance(path_radiance)
+              , m_path_aovs(path_aovs)
+              , m_subsurface(false)
+            {
+            }
+
+            bool accept_scattering(
+                const ScatteringMode::Mode  prev_mode,
+                const ScatteringMode::Mode  next_mode) const
+            {
+                assert(next_mode != ScatteringMode::Absorption);
+                return true;
+            }
+
+            void visit_vertex(const PathVertex& vertex)
+            {
+                // Update the MIS weights. Light subpaths are not connected to the camera,
+                // so the weights stay null at the first vertex.
+                if (vertex.m_path_length > 1 && !m_subsurface)
+                    m_mis.extend(m_prev, vertex, true);
+
+                Spectrum vertex_radiance(0.0f);
+                SpectrumStack vertex_aovs(m_path_aovs.size(), 0.0f);
+
+                // Emitted light.
+                if (vertex.m_edf && vertex.m_cos_on > 0.0)
+                {
+                    add_emitted_light_contribution(
+                        vertex,
+                        vertex_radiance,
+                        vertex_aovs);
+                }
+
+                if (vertex.m_bsdf == 0)
+                {
+                    // Vertices found after subsurface scattering only collect emitted light.
+                    if (vertex.m_bssrdf)
+                        m_subsurface = true;
+                }
+                else if (!m_subsurface)
+                {
+                    // Connect this vertex to the lights and to the light subpath.
+                    if (!vertex.m_bsdf->is_purely_specular() &&
+                        vertex.m_path_length < m_params.m_max_path_length)
+                    {
+                        add_connection_contributions(
+                            vertex,
+                            vertex_radiance,
+                            vertex_aovs);
+                    }
+
+                    // Keep this vertex to update the MIS weights at the next vertex.
+                    if (vertex.m_bsdf->is_purely_specular())
+                        m_prev.set(vertex, 0);
+                    else
+                    {
+                        vertex.m_bsdf->evaluate_inputs(
+                            m_shading_context,
+                            m_prev_input_evaluator,
+                            *vertex.m_shading_point);
+                        m_prev.set(vertex, m_prev_input_evaluator.data());
+                    }
+                }
+
+                // Update the path radiance.
+                vertex_radiance *= vertex.m_throughput;
+                m_path_radiance += vertex_radiance;
+                vertex_aovs *= vertex.m_throughput;
+                m_path_aovs += vertex_aovs;
+            }
+
+            void add_connection_contributions(
+                const PathVertex&       vertex,
+                Spectrum&               vertex_radiance,
+                SpectrumStack&          vertex_aovs)
+            {
+                // Origin of the light subpath.
+                if (m_engine.m_light_edf)
+                {
+                    add_light_origin_contribution(
+                        vertex,
+                        vertex_radiance,
+                        vertex_aovs);
+                }
+
+                // Vertices of the light subpath.
+                for (size_t i = 0; i < m_engine.m_light_vertex_count; ++i)
+                {
+                    const SubpathVertex& light_vertex = m_engine.m_light_vertices[i];
+
+                    if (vertex.m_path_length + light_vertex.m_path_length >= m_params.m_max_path_length)
+                        break;
+
+                    add_light_vertex_contribution(
+                        vertex,
+                        light_vertex,
+                        vertex_radiance,
+                        vertex_aovs);
+                }
+
+                // Non-physical lights.
+                if (m_light_sampler.get_non_physical_light_count() > 0)
+                {
+                    add_non_physical_light_contribution(
+                        vertex,
+                        vertex_radiance,
+                        vertex_aovs);
+                }
+
+                // Image-based lighting.
+                if (m_params.m_enable_ibl && m_env_edf)
+                {
+                    Spectrum ibl_radiance;
+                    compute_ibl_environment_sampling(
+                        m_sampling_context,
+                        m_shading_context,
+                        *m_env_edf,
+                        *vertex.m_shading_point,
+                        vertex.m_outgoing,
+                        *vertex.m_bsdf,
+                        vertex.m_bsdf_data,
+                        ConnectionModes,
+                        1,                      // BSDF samples: extending the camera subpath
+                        1,                      // environment samples
+                        ibl_radiance);
+
+                    vertex_radiance += ibl_radiance;
+                    vertex_aovs.add(m_env_edf->get_render_layer_index(), ibl_radiance);
+                }
+            }
+
+            void add_light_origin_contribution(
+                const PathVertex&       vertex,
+                Spectrum&               vertex_radiance,
+                SpectrumStack&          vertex_aovs)
+            {
+                Vector3d incoming = m_engine.m_light_point - vertex.get_point();
+                const double square_distance = square_norm(incoming);
+                if (square_distance == 0.0)
+                    return;
+                incoming /= sqrt(square_distance);
+
+                // Cull light samples that are behind the light.
+                const double cos_light = -dot(incoming, m_engine.m_light_shading_basis.get_normal());
+                if (cos_light <= 0.0)
+                    return;
+
+                // Evaluate the EDF.
+                Spectrum edf_value;
+                float edf_prob;
+                m_engine.m_light_edf->evaluate(
+                    m_engine.m_light_edf_data,
+                    Vector3f(m_engine.m_light_geometric_normal),
+                    Basis3f(m_engine.m_light_shading_basis),
+                    -Vector3f(incoming),
+                    edf_value,
+                    edf_prob);
+                if (edf_prob == 0.0f)
+                    return;
+
+                // Evaluate the BSDF.
+                Spectrum bsdf_value;
+                const float bsdf_prob =
+                    vertex.m_bsdf->evaluate(
+                        vertex.m_bsdf_data,
+                        false,                  // not adjoint
+                        true,                   // multiply by |cos(incoming, normal)|
+                        Vector3f(vertex.get_geometric_normal()),
+                        Basis3f(vertex.get_shading_basis()),
+                        Vector3f(vertex.m_outgoing.get_value()),
+                        Vector3f(incoming),
+                        ConnectionModes,
+                        bsdf_value);
+                if (bsdf_prob == 0.0f)
+                    return;
+
+                // Compute the transmission factor between the light sample and the shading point.
+                const float transmission =
+                    m_shading_context.get_tracer().trace_between(
+                        *vertex.m_shading_point,
+                        m_engine.m_light_point,
+                        VisibilityFlags::ShadowRay);
+
+                // Discard occluded samples.
+                if (transmission == 0.0f)
+                    return;
+
+                // Compute the MIS weight against hitting the light by extending the camera
+                // subpath and against connecting to longer light subpaths.
+                const float cos_camera = static_cast<float>(abs(dot(incoming, vertex.get_shading_normal())));
+                const float rcp_square_distance = static_cast<float>(1.0 / square_distance);
+                const float light_prob_w = m_engine.m_light_prob / (static_cast<float>(cos_light) * rcp_square_distance);
+                const float w_light = mis2(bsdf_prob / light_prob_w);
+                const float w_camera =
+                      mis2(edf_prob * cos_camera * rcp_square_distance)
+                    * (m_mis.m_dvcm + m_mis.m_dvc * mis2(evaluate_reverse_pdf(vertex, incoming)));
+                const float mis_weight = 1.0f / (w_light + 1.0f + w_camera);
+
+                // Add the contribution of this sample to the illumination.
+                edf_value *= bsdf_value;
+                edf_value *= transmission * mis_weight / light_prob_w;
+                vertex_radiance += edf_value;
+                vertex_aovs.add(m_engine.m_light_edf->get_render_layer_index(), edf_value);
+            }
+
+            void add_light_vertex_contribution(
+                const PathVertex&       vertex,
+                const SubpathVertex&    light_vertex,
+                Spectrum&               vertex_radiance,
+                SpectrumStack&          vertex_aovs)
+            {
+                Vector3d incoming = light_vertex.m_point - vertex.get_point();
+                const double square_distance = square_norm(incoming);
+                if (square_distance == 0.0)
+                    return;
+                incoming /= sqrt(square_distance);
+
+                // Evaluate the BSDF at the camera vertex.
+                Spectrum camera_bsdf_value;
+                const float camera_bsdf_prob =
+                    vertex.m_bsdf->evaluate(
+                        vertex.m_bsdf_data,
+                        false,                  // not adjoint
+                        true,                   // multiply by |cos(incoming, normal)|
+                        Vector3f(vertex.get_geometric_normal()),
+                        Basis3f(vertex.get_shading_basis()),
+                        Vector3f(vertex.m_outgoing.get_value()),
+                        Vector3f(incoming),
+                        ConnectionModes,
+                        camera_bsdf_value);
+                if (camera_bsdf_prob == 0.0f)
+                    return;
+
+                // Evaluate the BSDF at the light vertex.
+                Spectrum light_bsdf_value;
+                const float light_bsdf_prob =
+                    light_vertex.m_bsdf->evaluate(
+                        light_vertex.m_bsdf_data,
+                        true,                   // adjoint
+                        true,                   // multiply by |cos(incoming, normal)|
+                        Vector3f(light_vertex.m_geometric_normal),
+                        Basis3f(light_vertex.m_shading_basis),
+                        Vector3f(light_vertex.m_outgoing),      // outgoing (toward the light)
+                        -Vector3f(incoming),                    // incoming (toward the camera)
+                        ConnectionModes,
+                        light_bsdf_value);
+                if (light_bsdf_prob == 0.0f)
+                    return;
+
+                // Compute the transmission factor between the two vertices.
+                const float transmission =
+                    m_shading_context.get_tracer().trace_between(
+                        *vertex.m_shading_point,
+                        light_vertex.m_point,
+                        VisibilityFlags::ShadowRay);
+
+                // Discard occluded connections.
+                if (transmission == 0.0f)
+                    return;
+
+                // Compute the MIS weight against all other ways of sampling this path.
+                const float cos_camera = static_cast<float>(abs(dot(incoming, vertex.get_shading_normal())));
+                const float cos_light = static_cast<float>(abs(dot(incoming, light_vertex.m_shading_basis.get_normal())));
+                const float rcp_square_distance = static_cast<float>(1.0 / square_distance);
+                const float w_light =
+                      mis2(camera_bsdf_prob * cos_light * rcp_square_distance)
+                    * (light_vertex.m_dvcm + light_vertex.m_dvc * mis2(light_vertex.evaluate_reverse_pdf(-incoming)));
+                const float w_camera =
+                      mis2(light_bsdf_prob * cos_camera * rcp_square_distance)
+                    * (m_mis.m_dvcm + m_mis.m_dvc * mis2(evaluate_reverse_pdf(vertex, incoming)));
+                const float mis_weight = 1.0f / (w_light + 1.0f + w_camera);
+
+                // Add the contribution of this connection to the illumination.
+                Spectrum contribution = light_vertex.m_throughput;
+                contribution *= camera_bsdf_value;
+                contribution *= light_bsdf_value;
+                contribution *= transmission * mis_weight * rcp_square_distance;
+                vertex_radiance += contribution;
+                vertex_aovs.add(m_engine.m_light_edf->get_render_layer_index(), contribution);
+            }
+
+            void add_non_physical_light_contribution(
+                const PathVertex&       vertex,
+                Spectrum&               vertex_radiance,
+                SpectrumStack&          vertex_aovs)
+            {
+                // Sample the non-physical lights.
+                m_sampling_context.split_in_place(3, 1);
+                LightSample light_sample;
+                m_light_sampler.sample_non_physical_lights(
+                    vertex.get_time(),
+                    m_sampling_context.next2<Vector3f>(),
+                    light_sample);
+
+                const Light* light = light_sample.m_light;
+
+                // No contribution if this light does not cast indirect light.
+                if (vertex.m_path_length > 1 && !(light->get_flags() & Light::CastIndirectLight))
+                    return;
+
+                // Evaluate the light.
+                InputEvaluator input_evaluator(m_texture_cache);
+                Vector3d emission_position, emission_direction;
+                Spectrum light_value;
+                light->evaluate(
+                    input_evaluator,
+                    light_sample.m_light_transform,
+                    vertex.get_point(),
+                    emission_position,
+                    emission_direction,
+                    light_value);
+
+                // Compute the transmission factor between the light sample and the shading point.
+                const float transmission =
+                    m_shading_context.get_tracer().trace_between(
+                        *vertex.m_shading_point,
+                        emission_position,
+                        VisibilityFlags::ShadowRay);
+
+                // Discard occluded samples.
+                if (transmission == 0.0f)
+                    return;
+
+                // Evaluate the BSDF.
+                Spectrum bsdf_value;
+                const float bsdf_prob =
+                    vertex.m_bsdf->evaluate(
+                        vertex.m_bsdf_data,
+                        false,                  // not adjoint
+                        true,                   // multiply by |cos(incoming, normal)|
+                        Vector3f(vertex.get_geometric_normal()),
+                        Basis3f(vertex.get_shading_basis()),
+                        Vector3f(vertex.m_outgoing.get_value()),
+                        -Vector3f(emission_direction),
+                        ConnectionModes,
+                        bsdf_value);
+                if (bsdf_prob == 0.0f)
+                    return;
+
+                // Non-physical lights can only be reached this way, no MIS is needed.
+                const float attenuation = light->compute_distance_attenuation(vertex.get_point(), emission_position);
+                light_value *= transmission * attenuation / light_sample.m_probability;
+                light_value *= bsdf_value;
+                vertex_radiance += light_value;
+                vertex_aovs.add(light->get_render_layer_index(), light_value);
+            }
+
+            void add_emitted_light_contribution(
+                const PathVertex&       vertex,
+                Spectrum&               vertex_radiance,
+                SpectrumStack&          vertex_aovs)
+            {
+                // No radiance if we're too close to the light.
+                if (vertex.m_shading_point->get_distance() < vertex.m_edf->get_light_near_start())
+                    return;
+
+                if (const ShaderGroup* sg = vertex.get_material()->get_render_data().m_shader_group)
+                    m_shading_context.execute_osl_emission(*sg, *vertex.m_shading_point);
+
+                // Evaluate the EDF inputs.
+                InputEvaluator input_evaluator(m_texture_cache);
+                vertex.m_edf->evaluate_inputs(input_evaluator, *vertex.m_shading_point);
+
+                // Compute the emitted radiance and the probability density of the emission direction.
+                Spectrum emitted_radiance;
+                float edf_prob;
+                vertex.m_edf->evaluate(
+                    input_evaluator.data(),
+                    Vector3f(vertex.get_geometric_normal()),
+                    Basis3f(vertex.get_shading_basis()),
+                    Vector3f(vertex.m_outgoing.get_value()),
+                    emitted_radiance,
+                    edf_prob);
+
+                // Compute the MIS weight against connecting to light subpaths. Light subpaths
+                // are not connected to the camera, and after subsurface scattering this is the
+                // only way to find light sources.
+                if (vertex.m_path_length > 1 && !m_subsurface)
+                {
+                    const float light_prob = m_light_sampler.evaluate_emitting_triangle_pdf(*vertex.m_shading_point);
+                    const float w_camera =
+                          mis2(light_prob) * m_mis.m_dvcm
+                        + mis2(light_prob * edf_prob) * m_mis.m_dvc;
+                    emitted_radiance *= 1.0f / (1.0f + w_camera);
+                }
+
+                // Add the emitted light contribution.
+                vertex_radiance += emitted_radiance;
+                vertex_aovs.add(vertex.m_edf->get_render_layer_index(), emitted_radiance);
+            }
+
+            void visit_environment(const PathVertex& vertex)
+            {
+                assert(vertex.m_prev_mode != ScatteringMode::Absorption);
+
+                // Can't look up the environment if there's no environment EDF.
+                if (m_env_edf == 0)
+                    return;
+
+                // When IBL is disabled, only specular reflections should contribute here.
+                if (!m_params.m_enable_ibl && vertex.m_prev_mode != ScatteringMode::Specular)
+                    return;
+
+                // Evaluate the environment EDF.
+                InputEvaluator input_evaluator(m_texture_cache);
+                Spectrum env_radiance;
+                float env_prob;
+                m_env_edf->evaluate(
+                    m_shading_context,
+                    input_evaluator,
+                    -Vector3f(vertex.m_outgoing.get_value()),
+                    env_radiance,
+                    env_prob);
+
+                // This may happen for points of the environment map with infinite components,
+                // which are then excluded from importance sampling and thus have zero weight.
+                if (env_prob == 0.0)
+                    return;
+
+                // Multiple importance sampling against environment sampling at the previous vertex.
+                if (vertex.m_prev_mode != ScatteringMode::Specular && !m_subsurface)
+                {
+                    assert(vertex.m_prev_prob > 0.0f);
+                    const float mis_weight =
+                        mis_power2(
+                            vertex.m_prev_prob,
+                            env_prob);
+                    env_radiance *= mis_weight;
+                }
+
+                // Update the path radiance.
+                env_radiance *= vertex.m_throughput;
+                m_path_radiance += env_radiance;
+                m_path_aovs.add(m_env_edf->get_render_layer_index(), env_radiance);
+            }
+
+            // Compute the probability density, in solid angle, of scattering toward the previous
+            // camera vertex when arriving at a given vertex from a given direction.
+            static float evaluate_reverse_pdf(
+                const PathVertex&       vertex,
+                const Vector3d&         incoming)
+            {
+                return
+                    vertex.m_bsdf->evaluate_pdf(
+                        vertex.m_bsdf_data,
+                        Vector3f(vertex.get_geometric_normal()),
+                        Basis3f(vertex.get_shading_basis()),
+                        Vector3f(incoming),
+                        Vector3f(vertex.m_outgoing.get_value()),
+                        ConnectionModes);
+            }
+        };
+    };
+}
+
+
+//
+// BDPTLightingEngineFactory class implementation.
+//
+
+BDPTLightingEngineFactory::BDPTLightingEngineFactory(
+    const LightSampler& light_sampler,
+    const ParamArray&   params)
+  : m_light_sampler(light_sampler)
+  , m_params(params)
+{
+    BDPTLightingEngine::Parameters(params).print();
+}
+
+void BDPTLightingEngineFactory::release()
+{
+    delete this;
+}
+
+ILightingEngine* BDPTLightingEngineFactory::create()
+{
+    return new BDPTLightingEngine(m_light_sampler, m_params);
+}
+
+Dictionary BDPTLightingEngineFactory::get_params_metadata()
+{
+    Dictionary metadata;
+    add_common_params_metadata(metadata, false);
+
+    metadata.dictionaries().insert(
+        "max_path_length",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "8")
+            .insert("unlimited", "true")
+            .insert("min", "1")
+            .insert("label", "Max Path Length")
+            .insert("help", "Maximum ray trace depth"));
+
+    metadata.dictionaries().insert(
+        "rr_min_path_length",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "6")
+            .insert("min", "1")
+            .insert("help", "Consider pruning low contribution paths starting with this bounce"));
+
+    return metadata;
+}
+
+}   // namespace renderer
@@ -226,7 +226,7 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
             const Vector3f s = sampling_context.next2<Vector3f>();
 
             LightSample sample;
-            m_light_sampler.sample_emitting_triangles(m_time, s, sample);
+            m_light_sampler.sample_emitting_triangles(m_time, m_point, s, sample);
 
             add_emitting_triangle_sample_contribution(
                 sample,
@@ -373,6 +373,7 @@ bool DirectLightingIntegrator::compute_incoming_radiance(
     LightSample sample;
     m_light_sampler.sample(
         m_time,
+        m_point,
         sampling_context.next2<Vector3f>(),
         sample);
 
@@ -621,6 +622,7 @@ void DirectLightingIntegrator::take_single_light_sample(
     LightSample sample;
     m_light_sampler.sample(
         m_time,
+        m_point,
         sampling_context.next2<Vector3f>(),
         sample);
 
@@ -35,7 +35,9 @@
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/aov/spectrumstack.h"
 #include "renderer/kernel/lighting/directlightingintegrator.h"
+#include "renderer/kernel/lighting/drt/drtpasscallback.h"
 #include "renderer/kernel/lighting/imagebasedlighting.h"
+#include "renderer/kernel/lighting/irradiancecache.h"
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
@@ -50,6 +52,7 @@
 #include "renderer/utility/stochasticcast.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/basis.h"
 #include "foundation/math/mis.h"
 #include "foundation/math/population.h"
 #include "foundation/math/vector.h"
@@ -141,9 +144,11 @@ namespace
 
         DRTLightingEngine(
             const LightSampler&     light_sampler,
-            const ParamArray&       params)
+            const ParamArray&       params,
+            DRTPassCallback*        pass_callback)
           : m_params(params)
           , m_light_sampler(light_sampler)
+          , m_pass_callback(pass_callback)
           , m_path_count(0)
         {
         }
@@ -164,6 +169,7 @@ namespace
             PathVisitor path_visitor(
                 m_params,
                 m_light_sampler,
+                m_pass_callback,
                 sampling_context,
                 shading_context,
                 shading_point.get_scene(),
@@ -199,6 +205,7 @@ namespace
       private:
         const Parameters        m_params;
         const LightSampler&     m_light_sampler;
+        DRTPassCallback*        m_pass_callback;
 
         uint64                  m_path_count;
         Population<uint64>      m_path_length;
@@ -207,6 +214,7 @@ namespace
         {
             const Parameters&           m_params;
             const LightSampler&         m_light_sampler;
+            DRTPassCallback*            m_pass_callback;
             SamplingContext&            m_sampling_context;
             const ShadingContext&       m_shading_context;
             TextureCache&               m_texture_cache;
@@ -217,6 +225,7 @@ namespace
             PathVisitor(
                 const Parameters&       params,
                 const LightSampler&     light_sampler,
+                DRTPassCallback*        pass_callback,
                 SamplingContext&        sampling_context,
                 const ShadingContext&   shading_context,
                 const Scene&            scene,
@@ -224,6 +233,7 @@ namespace
                 SpectrumStack&          path_aovs)
               : m_params(params)
               , m_light_sampler(light_sampler)
+              , m_pass_callback(pass_callback)
               , m_sampling_context(sampling_context)
               , m_shading_context(shading_context)
               , m_texture_cache(shading_context.get_texture_cache())
@@ -267,6 +277,15 @@ namespace
                             vertex_radiance,
                             vertex_aovs);
                     }
+
+                    // Indirect diffuse lighting.
+                    if (m_pass_callback)
+                    {
+                        add_irradiance_cache_contribution(
+                            vertex,
+                            vertex_radiance,
+                            vertex_aovs);
+                    }
                 }
 
                 // Emitted light.
@@ -371,6 +390,59 @@ namespace
                 vertex_aovs.add(m_env_edf->get_render_layer_index(), ibl_radiance);
             }
 
+            void add_irradiance_cache_contribution(
+                const PathVertex&       vertex,
+                Spectrum&               vertex_radiance,
+                SpectrumStack&          vertex_aovs)
+            {
+                // Use the shading normal on the side of the outgoing direction.
+                Vector3d normal = vertex.get_shading_normal();
+                if (dot(normal, vertex.m_outgoing.get_value()) < 0.0)
+                    normal = -normal;
+
+                // Interpolate the irradiance from the cache, or compute it on the fly
+                // and store it where the cache has no valid record.
+                Spectrum irradiance;
+                SpectrumStack aov_irradiance(vertex_aovs.size());
+                if (!m_pass_callback->lookup_irradiance(vertex.get_point(), normal, irradiance, aov_irradiance))
+                {
+                    IrradianceRecord record;
+                    m_pass_callback->compute_irradiance_record(
+                        vertex.m_sampling_context,
+                        m_shading_context,
+                        *vertex.m_shading_point,
+                        normal,
+                        vertex_aovs.size(),
+                        record);
+                    m_pass_callback->insert_irradiance_record(record);
+                    irradiance = record.m_irradiance;
+                    for (size_t i = 0; i < aov_irradiance.size(); ++i)
+                        aov_irradiance[i] = record.m_aov_irradiance[i];
+                }
+
+                // Reflect the irradiance off the diffuse components of the BSDF.
+                Spectrum bsdf_value;
+                const float bsdf_prob =
+                    vertex.m_bsdf->evaluate(
+                        vertex.m_bsdf_data,
+                        false,                  // not adjoint
+                        false,                  // do not multiply by |cos(incoming, normal)|
+                        Vector3f(vertex.get_geometric_normal()),
+                        Basis3f(vertex.get_shading_basis()),
+                        Vector3f(vertex.m_outgoing.get_value()),
+                        Vector3f(normal),
+                        ScatteringMode::Diffuse,
+                        bsdf_value);
+                if (bsdf_prob == 0.0f)
+                    return;
+
+                aov_irradiance *= bsdf_value;
+                vertex_aovs += aov_irradiance;
+
+                bsdf_value *= irradiance;
+                vertex_radiance += bsdf_value;
+            }
+
             void add_emitted_light_contribution(
                 const PathVertex&       vertex,
                 Spectrum&               vertex_radiance,
@@ -454,10 +526,12 @@ namespace
 //
 
 DRTLightingEngineFactory::DRTLightingEngineFactory(
-    const LightSampler& light_sampler,
-    const ParamArray&   params)
+    const LightSampler&     light_sampler,
+    const ParamArray&       params,
+    DRTPassCallback*        pass_callback)
   : m_light_sampler(light_sampler)
   , m_params(params)
+  , m_pass_callback(pass_callback)
 {
     DRTLightingEngine::Parameters(params).print();
 }
@@ -469,7 +543,7 @@ void DRTLightingEngineFactory::release()
 
 ILightingEngine* DRTLightingEngineFactory::create()
 {
-    return new DRTLightingEngine(m_light_sampler, m_params);
+    return new DRTLightingEngine(m_light_sampler, m_params, m_pass_callback);
 }
 
 Dictionary DRTLightingEngineFactory::get_params_metadata()
@@ -495,6 +569,42 @@ Dictionary DRTLightingEngineFactory::get_params_metadata()
             .insert("min", "1")
             .insert("help", "Consider pruning low contribution paths starting with this bounce"));
 
+    metadata.dictionaries().insert(
+        "enable_irradiance_cache",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Irradiance Cache")
+            .insert("help", "Add one bounce of diffuse indirect lighting interpolated from a cache built before rendering"));
+
+    metadata.dictionaries().insert(
+        "irradiance_cache_max_error",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.2")
+            .insert("min", "0.01")
+            .insert("max", "1.0")
+            .insert("label", "Irradiance Cache Max Error")
+            .insert("help", "Maximum error of interpolated irradiance; lower values compute more records"));
+
+    metadata.dictionaries().insert(
+        "irradiance_cache_grid_spacing",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "16")
+            .insert("min", "1")
+            .insert("label", "Irradiance Cache Grid Spacing")
+            .insert("help", "Spacing in pixels of the coarsest grid of irradiance records"));
+
+    metadata.dictionaries().insert(
+        "irradiance_cache_samples",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "256")
+            .insert("min", "1")
+            .insert("label", "Irradiance Cache Samples")
+            .insert("help", "Number of rays traced to compute each irradiance record"));
+
     return metadata;
 }
 
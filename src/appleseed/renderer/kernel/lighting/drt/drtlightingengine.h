@@ -39,6 +39,7 @@
 
 // Forward declarations.
 namespace foundation    { class Dictionary; }
+namespace renderer      { class DRTPassCallback; }
 namespace renderer      { class LightSampler; }
 
 namespace renderer
@@ -54,8 +55,9 @@ class DRTLightingEngineFactory
   public:
     // Constructor.
     DRTLightingEngineFactory(
-        const LightSampler& light_sampler,
-        const ParamArray&   params);
+        const LightSampler&     light_sampler,
+        const ParamArray&       params,
+        DRTPassCallback*        pass_callback = 0);     // optional, enables the irradiance cache
 
     // Delete this instance.
     virtual void release() APPLESEED_OVERRIDE;
@@ -69,6 +71,7 @@ class DRTLightingEngineFactory
   private:
     const LightSampler&     m_light_sampler;
     ParamArray              m_params;
+    DRTPassCallback*        m_pass_callback;
 };
 
 }       // namespace renderer
@@ -0,0 +1,725 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "drtpasscallback.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/aov/imagestack.h"
+#include "renderer/kernel/aov/spectrumstack.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/lighting/directlightingintegrator.h"
+#include "renderer/kernel/lighting/imagebasedlighting.h"
+#include "renderer/kernel/lighting/pathtracer.h"
+#include "renderer/kernel/lighting/pathvertex.h"
+#include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/tracer.h"
+#include "renderer/kernel/shading/oslshadergroupexec.h"
+#include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/environment/environment.h"
+#include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/settingsparsing.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/basis.h"
+#include "foundation/math/dual.h"
+#include "foundation/math/hash.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/memory.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    //
+    // Computes the radiance reflected toward the gathering point by the surface hit by a
+    // gathering ray, taking only direct lighting into account.
+    //
+
+    struct GatherVisitor
+    {
+        const LightSampler&         m_light_sampler;
+        const ShadingContext&       m_shading_context;
+        const EnvironmentEDF*       m_env_edf;
+        Spectrum&                   m_radiance;
+        SpectrumStack&              m_aovs;
+        double&                     m_distance;
+
+        GatherVisitor(
+            const LightSampler&     light_sampler,
+            const ShadingContext&   shading_context,
+            const EnvironmentEDF*   env_edf,
+            Spectrum&               radiance,
+            SpectrumStack&          aovs,
+            double&                 distance)
+          : m_light_sampler(light_sampler)
+          , m_shading_context(shading_context)
+          , m_env_edf(env_edf)
+          , m_radiance(radiance)
+          , m_aovs(aovs)
+          , m_distance(distance)
+        {
+        }
+
+        bool accept_scattering(
+            const ScatteringMode::Mode  prev_mode,
+            const ScatteringMode::Mode  next_mode) const
+        {
+            return true;
+        }
+
+        void visit_vertex(const PathVertex& vertex)
+        {
+            m_distance = vertex.m_shading_point->get_distance();
+
+            if (vertex.m_bsdf == 0)
+                return;
+
+            // Direct lighting.
+            Spectrum vertex_radiance;
+            SpectrumStack vertex_aovs(m_aovs.size());
+            const DirectLightingIntegrator integrator(
+                m_shading_context,
+                m_light_sampler,
+                vertex,
+                ScatteringMode::All,
+                ScatteringMode::All,
+                1,
+                1,
+                true);              // computing indirect lighting
+            integrator.compute_outgoing_radiance_combined_sampling_low_variance(
+                vertex.m_sampling_context,
+                vertex.m_outgoing,
+                vertex_radiance,
+                vertex_aovs);
+
+            // Image-based lighting.
+            if (m_env_edf)
+            {
+                Spectrum ibl_radiance;
+                compute_ibl(
+                    vertex.m_sampling_context,
+                    m_shading_context,
+                    *m_env_edf,
+                    *vertex.m_shading_point,
+                    vertex.m_outgoing,
+                    *vertex.m_bsdf,
+                    vertex.m_bsdf_data,
+                    ScatteringMode::All,
+                    ScatteringMode::All,
+                    1,
+                    1,
+                    ibl_radiance);
+                vertex_radiance += ibl_radiance;
+                vertex_aovs.add(m_env_edf->get_render_layer_index(), ibl_radiance);
+            }
+
+            vertex_radiance *= vertex.m_throughput;
+            m_radiance += vertex_radiance;
+            vertex_aovs *= vertex.m_throughput;
+            m_aovs += vertex_aovs;
+        }
+
+        void visit_environment(const PathVertex& vertex)
+        {
+            // Light coming directly from the environment is not part of indirect lighting.
+        }
+    };
+
+
+    // Return the smallest of two hit distances, where 0 stands for no hit.
+    double min_hit_distance(const double d1, const double d2)
+    {
+        if (d1 == 0.0)
+            return d2;
+
+        if (d2 == 0.0)
+            return d1;
+
+        return min(d1, d2);
+    }
+
+
+    //
+    // Computes irradiance records at the surfaces seen through a band of pixels of a grid.
+    //
+
+    typedef vector<IrradianceRecord> IrradianceRecordVector;
+
+    class IrradianceCacheJob
+      : public IJob
+    {
+      public:
+        IrradianceCacheJob(
+            const DRTPassCallback&              pass_callback,
+            const DRTPassCallback::Parameters&  params,
+            const Scene&                        scene,
+            const Frame&                        frame,
+            const TraceContext&                 trace_context,
+            TextureStore&                       texture_store,
+            OIIO::TextureSystem&                oiio_texture_system,
+            OSL::ShadingSystem&                 shading_system,
+            const size_t                        spacing,
+            const size_t                        y_begin,
+            const size_t                        y_end,
+            IrradianceRecordVector&             records,
+            IAbortSwitch&                       abort_switch)
+          : m_pass_callback(pass_callback)
+          , m_params(params)
+          , m_camera(*scene.get_active_camera())
+          , m_frame(frame)
+          , m_texture_cache(texture_store)
+          , m_intersector(trace_context, m_texture_cache)
+          , m_oiio_texture_system(oiio_texture_system)
+          , m_shadergroup_exec(shading_system)
+          , m_tracer(
+                scene,
+                m_intersector,
+                m_texture_cache,
+                m_shadergroup_exec,
+                m_params.m_transparency_threshold,
+                m_params.m_max_iterations,
+                false)
+          , m_spacing(spacing)
+          , m_y_begin(y_begin)
+          , m_y_end(y_end)
+          , m_records(records)
+          , m_abort_switch(abort_switch)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            const ShadingContext shading_context(
+                m_intersector,
+                m_tracer,
+                m_texture_cache,
+                m_oiio_texture_system,
+                m_shadergroup_exec,
+                thread_index);
+
+            const uint32 instance =
+                mix_uint32(
+                    static_cast<uint32>(m_spacing),
+                    static_cast<uint32>(m_y_begin));
+            SamplingContext::RNGType rng(instance);
+            SamplingContext sampling_context(
+                rng,
+                m_params.m_sampling_mode,
+                2,                          // number of dimensions
+                0,                          // number of samples -- unknown
+                instance);                  // initial instance number
+
+            // Pixels already visited by a coarser grid are skipped.
+            const AABB2u& crop_window = m_frame.get_crop_window();
+            const size_t coarser_spacing = m_spacing < m_params.m_grid_spacing ? 2 * m_spacing : 0;
+
+            for (size_t y = m_y_begin; y < m_y_end && !m_abort_switch.is_aborted(); ++y)
+            {
+                const size_t grid_y = y - crop_window.min.y;
+                if (grid_y % m_spacing != 0)
+                    continue;
+
+                for (size_t x = crop_window.min.x; x <= crop_window.max.x; x += m_spacing)
+                {
+                    const size_t grid_x = x - crop_window.min.x;
+                    if (coarser_spacing > 0 && grid_x % coarser_spacing == 0 && grid_y % coarser_spacing == 0)
+                        continue;
+
+                    process_pixel(sampling_context, shading_context, x, y);
+                }
+            }
+        }
+
+      private:
+        const DRTPassCallback&              m_pass_callback;
+        const DRTPassCallback::Parameters&  m_params;
+        const Camera&                       m_camera;
+        const Frame&                        m_frame;
+        TextureCache                        m_texture_cache;
+        Intersector                         m_intersector;
+        OIIO::TextureSystem&                m_oiio_texture_system;
+        OSLShaderGroupExec                  m_shadergroup_exec;
+        Tracer                              m_tracer;
+        const size_t                        m_spacing;
+        const size_t                        m_y_begin;
+        const size_t                        m_y_end;
+        IrradianceRecordVector&             m_records;
+        IAbortSwitch&                       m_abort_switch;
+
+        void process_pixel(
+            SamplingContext&                sampling_context,
+            const ShadingContext&           shading_context,
+            const size_t                    x,
+            const size_t                    y)
+        {
+            // Find the surface seen through the center of the pixel.
+            const Vector2d ndc = m_frame.get_sample_position(x, y, 0.5, 0.5);
+            ShadingRay ray;
+            m_camera.spawn_ray(sampling_context, Dual2d(ndc), ray);
+            ShadingPoint shading_point;
+            m_intersector.trace(ray, shading_point);
+
+            // Only surfaces with a BSDF receive indirect lighting.
+            if (!shading_point.hit())
+                return;
+            const Material* material = shading_point.get_material();
+            if (material == 0 || material->get_render_data().m_bsdf == 0)
+                return;
+
+            // Use the shading normal on the side from which the surface is seen.
+            Vector3d normal = shading_point.get_shading_normal();
+            if (dot(normal, ray.m_dir) > 0.0)
+                normal = -normal;
+
+            // Compute a new record if the existing ones aren't valid here.
+            Spectrum irradiance;
+            if (m_pass_callback.get_irradiance_cache().lookup(shading_point.get_point(), normal, irradiance))
+                return;
+
+            IrradianceRecord record;
+            m_pass_callback.compute_irradiance_record(
+                sampling_context,
+                shading_context,
+                shading_point,
+                normal,
+                m_frame.aov_images().size(),
+                record);
+            m_records.push_back(record);
+        }
+    };
+}
+
+
+//
+// DRTPassCallback::Parameters class implementation.
+//
+
+DRTPassCallback::Parameters::Parameters(const ParamArray& params)
+  : m_sampling_mode(get_sampling_context_mode(params))
+  , m_enable_ibl(params.get_optional<bool>("enable_ibl", true))
+  , m_max_error(params.get_optional<float>("irradiance_cache_max_error", 0.2f))
+  , m_grid_spacing(max<size_t>(params.get_optional<size_t>("irradiance_cache_grid_spacing", 16), 1))
+  , m_sample_count(max<size_t>(params.get_optional<size_t>("irradiance_cache_samples", 256), 1))
+  , m_transparency_threshold(params.get_optional<float>("transparency_threshold", 0.001f))
+  , m_max_iterations(params.get_optional<size_t>("max_iterations", 1000))
+{
+}
+
+void DRTPassCallback::Parameters::print() const
+{
+    RENDERER_LOG_INFO(
+        "irradiance cache settings:\n"
+        "  max error        %f\n"
+        "  grid spacing     %s\n"
+        "  samples          %s",
+        m_max_error,
+        pretty_uint(m_grid_spacing).c_str(),
+        pretty_uint(m_sample_count).c_str());
+}
+
+
+//
+// DRTPassCallback class implementation.
+//
+
+DRTPassCallback::DRTPassCallback(
+    const Scene&            scene,
+    const LightSampler&     light_sampler,
+    const TraceContext&     trace_context,
+    TextureStore&           texture_store,
+    OIIO::TextureSystem&    oiio_texture_system,
+    OSL::ShadingSystem&     shading_system,
+    const ParamArray&       params)
+  : m_params(params)
+  , m_scene(scene)
+  , m_light_sampler(light_sampler)
+  , m_trace_context(trace_context)
+  , m_texture_store(texture_store)
+  , m_oiio_texture_system(oiio_texture_system)
+  , m_shading_system(shading_system)
+  , m_built(false)
+{
+    m_params.print();
+
+    GAABB3 scene_bbox = scene.compute_bbox();
+    if (!scene_bbox.is_valid())
+        scene_bbox = GAABB3(GVector3(-1.0), GVector3(1.0));
+
+    // Limit the radius of records to a range of sizes relative to the scene.
+    const float scene_diameter = static_cast<float>(scene_bbox.diameter());
+    m_min_radius = 0.001f * scene_diameter;
+    m_max_radius = 0.1f * scene_diameter;
+
+    m_bbox = AABB3d(scene_bbox);
+    m_irradiance_cache.reset(new IrradianceCache(m_bbox, m_params.m_max_error));
+    m_pending_cache.reset(new IrradianceCache(m_bbox, m_params.m_max_error));
+}
+
+void DRTPassCallback::release()
+{
+    delete this;
+}
+
+void DRTPassCallback::pre_render(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+    if (!m_built)
+        build_irradiance_cache(frame, job_queue, abort_switch);
+}
+
+void DRTPassCallback::post_render(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+    // No lighting engine is running at this point: merge the records computed on the fly.
+    if (m_pending_records.empty())
+        return;
+
+    for (size_t i = 0, e = m_pending_records.size(); i < e; ++i)
+        m_irradiance_cache->insert(m_pending_records[i]);
+
+    RENDERER_LOG_DEBUG(
+        "added %s irradiance %s computed during rendering to the irradiance cache.",
+        pretty_uint(m_pending_records.size()).c_str(),
+        m_pending_records.size() > 1 ? "records" : "record");
+
+    m_pending_cache.reset(new IrradianceCache(m_bbox, m_params.m_max_error));
+    clear_release_memory(m_pending_records);
+}
+
+bool DRTPassCallback::lookup_irradiance(
+    const Vector3d&         point,
+    const Vector3d&         normal,
+    Spectrum&               irradiance,
+    SpectrumStack&          aov_irradiance) const
+{
+    // The irradiance cache is only modified between passes.
+    if (m_irradiance_cache->lookup(point, normal, irradiance, aov_irradiance))
+        return true;
+
+    boost::shared_lock<boost::shared_mutex> lock(m_pending_mutex);
+    return m_pending_cache->lookup(point, normal, irradiance, aov_irradiance);
+}
+
+void DRTPassCallback::insert_irradiance_record(const IrradianceRecord& record)
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_pending_mutex);
+    m_pending_cache->insert(record);
+    m_pending_records.push_back(record);
+}
+
+void DRTPassCallback::build_irradiance_cache(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+    if (m_scene.get_active_camera() == 0)
+        return;
+
+    RENDERER_LOG_INFO("building irradiance cache...");
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    // Each job covers a band of rows and stores its records into its own segment.
+    const size_t BandHeight = 32;
+    const AABB2u& crop_window = frame.get_crop_window();
+    const size_t band_count = (crop_window.max.y - crop_window.min.y + BandHeight) / BandHeight;
+    m_record_segments.resize(band_count);
+
+    // Refine the grid of pixels until every pixel has been visited.
+    size_t spacing = m_params.m_grid_spacing;
+
+    while (true)
+    {
+        for (size_t i = 0; i < band_count; ++i)
+        {
+            m_record_segments[i].clear();
+
+            const size_t y_begin = crop_window.min.y + i * BandHeight;
+            const size_t y_end = min(y_begin + BandHeight, crop_window.max.y + 1);
+
+            job_queue.schedule(
+                new IrradianceCacheJob(
+                    *this,
+                    m_params,
+                    m_scene,
+                    frame,
+                    m_trace_context,
+                    m_texture_store,
+                    m_oiio_texture_system,
+                    m_shading_system,
+                    spacing,
+                    y_begin,
+                    y_end,
+                    m_record_segments[i],
+                    abort_switch));
+        }
+
+        job_queue.wait_until_completion();
+
+        if (abort_switch.is_aborted())
+            return;
+
+        // The cache is only modified between levels, while no job is reading it.
+        size_t record_count = 0;
+        for (size_t i = 0; i < band_count; ++i)
+        {
+            const IrradianceRecordVector& segment = m_record_segments[i];
+            for (size_t j = 0, e = segment.size(); j < e; ++j)
+                m_irradiance_cache->insert(segment[j]);
+            record_count += segment.size();
+        }
+
+        RENDERER_LOG_DEBUG(
+            "computed %s irradiance %s on a grid of spacing %s.",
+            pretty_uint(record_count).c_str(),
+            record_count > 1 ? "records" : "record",
+            pretty_uint(spacing).c_str());
+
+        if (spacing == 1)
+            break;
+
+        spacing /= 2;
+    }
+
+    clear_release_memory(m_record_segments);
+
+    m_built = true;
+
+    RENDERER_LOG_INFO(
+        "built irradiance cache with %s %s in %s.",
+        pretty_uint(m_irradiance_cache->size()).c_str(),
+        m_irradiance_cache->size() > 1 ? "records" : "record",
+        pretty_time(stopwatch.measure().get_seconds()).c_str());
+}
+
+void DRTPassCallback::compute_irradiance_record(
+    SamplingContext&        sampling_context,
+    const ShadingContext&   shading_context,
+    const ShadingPoint&     shading_point,
+    const Vector3d&         normal,
+    const size_t            aov_count,
+    IrradianceRecord&       record) const
+{
+    assert(is_normalized(normal));
+
+    // Stratify the hemisphere with respect to the cosine-weighted solid angle,
+    // with about three times as many strata in azimuth than in elevation.
+    const size_t theta_count =
+        max<size_t>(truncate<size_t>(sqrt(m_params.m_sample_count / Pi<double>()) + 0.5), 1);
+    const size_t phi_count =
+        max<size_t>(truncate<size_t>(Pi<double>() * theta_count + 0.5), 1);
+    const size_t sample_count = theta_count * phi_count;
+
+    const Basis3d basis(normal);
+    const Vector3d& tangent_u = basis.get_tangent_u();
+    const Vector3d& tangent_v = basis.get_tangent_v();
+
+    const EnvironmentEDF* env_edf =
+        m_params.m_enable_ibl ? m_scene.get_environment()->get_environment_edf() : 0;
+
+    vector<float> values(sample_count);
+    vector<double> distances(sample_count);
+
+    Spectrum irradiance(0.0f);
+    SpectrumStack aov_irradiance(aov_count, 0.0f);
+    Vector3d rotational_gradient(0.0);
+    double rcp_distance_sum = 0.0;
+
+    SamplingContext child_sampling_context = sampling_context.split(2, sample_count);
+
+    for (size_t j = 0; j < theta_count; ++j)
+    {
+        for (size_t k = 0; k < phi_count; ++k)
+        {
+            const Vector2d s = child_sampling_context.next2<Vector2d>();
+
+            // Build a direction in the (j, k) stratum.
+            const double sin2_theta = (j + s[0]) / theta_count;
+            const double sin_theta = sqrt(sin2_theta);
+            const double cos_theta = sqrt(1.0 - sin2_theta);
+            const double phi = TwoPi<double>() * (k + s[1]) / phi_count;
+            const Vector3d direction =
+                  (sin_theta * cos(phi)) * tangent_u
+                + (sin_theta * sin(phi)) * tangent_v
+                + cos_theta * normal;
+
+            // Compute the radiance reflected toward the gathering point in this direction.
+            const ShadingRay ray(
+                shading_point.get_biased_point(direction),
+                direction,
+                shading_point.get_time(),
+                ScatteringMode::get_vis_flags(ScatteringMode::Diffuse),
+                shading_point.get_ray().m_depth + 1);
+
+            Spectrum radiance(0.0f);
+            SpectrumStack aov_radiance(aov_count, 0.0f);
+            double distance = 0.0;
+            GatherVisitor visitor(
+                m_light_sampler,
+                shading_context,
+                env_edf,
+                radiance,
+                aov_radiance,
+                distance);
+            PathTracer<GatherVisitor, false> path_tracer(     // false = not adjoint
+                visitor,
+                ~0,                         // never use Russian Roulette
+                1,                          // only visit the first vertex
+                shading_context.get_max_iterations());
+            path_tracer.trace(
+                child_sampling_context,
+                shading_context,
+                ray,
+                &shading_point);
+
+            const size_t i = j * phi_count + k;
+            const float value = average_value(radiance);
+            values[i] = value;
+            distances[i] = distance;
+
+            irradiance += radiance;
+            aov_irradiance += aov_radiance;
+            if (distance > 0.0)
+                rcp_distance_sum += 1.0 / distance;
+
+            // Rotational gradient (Ward and Heckbert).
+            if (cos_theta > 0.0)
+                rotational_gradient += (value / cos_theta) * cross(normal, direction);
+        }
+    }
+
+    // Translational gradient (Ward and Heckbert), from the changes in projected solid angle
+    // of the walls between strata as the gathering point moves.
+    Vector3d translational_gradient(0.0);
+    for (size_t k = 0; k < phi_count; ++k)
+    {
+        // Walls between strata of consecutive elevations.
+        const double phi_center = TwoPi<double>() * (k + 0.5) / phi_count;
+        const Vector3d u_k = cos(phi_center) * tangent_u + sin(phi_center) * tangent_v;
+        for (size_t j = 1; j < theta_count; ++j)
+        {
+            const size_t i = j * phi_count + k;
+            const size_t prev_i = (j - 1) * phi_count + k;
+            const double d = min_hit_distance(distances[i], distances[prev_i]);
+            if (d == 0.0)
+                continue;
+
+            const double sin2_theta = static_cast<double>(j) / theta_count;
+            const double w = TwoPi<double>() / phi_count * sqrt(sin2_theta) * (1.0 - sin2_theta) / d;
+            translational_gradient += (w * (values[i] - values[prev_i])) * u_k;
+        }
+
+        // Walls between strata of consecutive azimuths.
+        const double phi_wall = TwoPi<double>() * k / phi_count;
+        const Vector3d v_k = -sin(phi_wall) * tangent_u + cos(phi_wall) * tangent_v;
+        const size_t prev_k = (k + phi_count - 1) % phi_count;
+        for (size_t j = 0; j < theta_count; ++j)
+        {
+            const size_t i = j * phi_count + k;
+            const size_t prev_i = j * phi_count + prev_k;
+            const double d = min_hit_distance(distances[i], distances[prev_i]);
+            if (d == 0.0)
+                continue;
+
+            const double sin_theta_min = sqrt(static_cast<double>(j) / theta_count);
+            const double sin_theta_max = sqrt(static_cast<double>(j + 1) / theta_count);
+            const double w = (sin_theta_max - sin_theta_min) / d;
+            translational_gradient += (w * (values[i] - values[prev_i])) * v_k;
+        }
+    }
+
+    // Each sample stands for a projected solid angle of pi / sample_count.
+    const float rcp_sample_count = Pi<float>() / sample_count;
+    irradiance *= rcp_sample_count;
+    aov_irradiance *= rcp_sample_count;
+    rotational_gradient *= static_cast<double>(rcp_sample_count);
+
+    // The radius of the record is the harmonic mean distance to the surfaces around it,
+    // reduced where the irradiance changes quickly.
+    const double average_irradiance = average_value(irradiance);
+    double radius =
+        rcp_distance_sum > 0.0
+            ? sample_count / rcp_distance_sum
+            : static_cast<double>(m_max_radius);
+    const double translational_gradient_norm = norm(translational_gradient);
+    if (translational_gradient_norm > 0.0)
+        radius = min(radius, average_irradiance / translational_gradient_norm);
+    radius = clamp(radius, static_cast<double>(m_min_radius), static_cast<double>(m_max_radius));
+
+    record.m_position = shading_point.get_point();
+    record.m_normal = normal;
+    record.m_irradiance = irradiance;
+    record.m_aov_irradiance.resize(aov_count);
+    for (size_t i = 0; i < aov_count; ++i)
+        record.m_aov_irradiance[i] = aov_irradiance[i];
+    record.m_radius = static_cast<float>(radius);
+
+    // Store gradients relative to the irradiance.
+    if (average_irradiance > 0.0)
+    {
+        record.m_rotational_gradient = Vector3f(rotational_gradient / average_irradiance);
+        record.m_translational_gradient = Vector3f(translational_gradient / average_irradiance);
+    }
+    else
+    {
+        record.m_rotational_gradient = Vector3f(0.0f);
+        record.m_translational_gradient = Vector3f(0.0f);
+    }
+}
+
+}   // namespace renderer
@@ -0,0 +1,201 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_DRT_DRTPASSCALLBACK_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_DRT_DRTPASSCALLBACK_H
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/lighting/irradiancecache.h"
+#include "renderer/kernel/rendering/ipasscallback.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/thread.h"
+
+// OSL headers.
+#include "foundation/platform/oslheaderguards.h"
+BEGIN_OSL_INCLUDES
+#include "OSL/oslexec.h"
+END_OSL_INCLUDES
+
+// OpenImageIO headers.
+#include "foundation/platform/oiioheaderguards.h"
+BEGIN_OIIO_INCLUDES
+#include "OpenImageIO/texture.h"
+END_OIIO_INCLUDES
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class JobQueue; }
+namespace renderer      { class Frame; }
+namespace renderer      { class LightSampler; }
+namespace renderer      { class Scene; }
+namespace renderer      { class ShadingContext; }
+namespace renderer      { class ShadingPoint; }
+namespace renderer      { class TextureStore; }
+namespace renderer      { class TraceContext; }
+
+namespace renderer
+{
+
+//
+// This class builds the irradiance cache of the distribution ray tracer before the first
+// pass begins. Irradiance records are computed at the surfaces seen through a grid of
+// pixels, starting with a coarse grid and refining it down to every pixel, wherever the
+// records computed so far are not valid.
+//
+// During a pass, the cache is shared read-only by all lighting engines. Records that
+// lighting engines compute on the fly where the cache has no valid record are stored
+// in a separate cache protected by a lock, so that lookups hitting the main cache never
+// contend; they are merged into the main cache at the end of the pass.
+//
+// Irradiance is gathered by tracing rays in the hemisphere and computing direct lighting
+// (including image-based lighting) at the points they hit. Light reaching the gathering
+// point directly is left out since the distribution ray tracer already accounts for it.
+//
+
+class DRTPassCallback
+  : public IPassCallback
+{
+  public:
+    struct Parameters
+    {
+        const SamplingContext::Mode m_sampling_mode;
+        const bool                  m_enable_ibl;               // is image-based lighting enabled?
+        const float                 m_max_error;                // maximum error of interpolated irradiance records
+        const size_t                m_grid_spacing;             // spacing in pixels of the coarsest grid of records
+        const size_t                m_sample_count;             // number of rays traced to compute an irradiance record
+        const float                 m_transparency_threshold;
+        const size_t                m_max_iterations;
+
+        explicit Parameters(const ParamArray& params);
+
+        void print() const;
+    };
+
+    // Constructor.
+    DRTPassCallback(
+        const Scene&                scene,
+        const LightSampler&         light_sampler,
+        const TraceContext&         trace_context,
+        TextureStore&               texture_store,
+        OIIO::TextureSystem&        oiio_texture_system,
+        OSL::ShadingSystem&         shading_system,
+        const ParamArray&           params);
+
+    // Delete this instance.
+    virtual void release() APPLESEED_OVERRIDE;
+
+    // This method is called at the beginning of a pass.
+    virtual void pre_render(
+        const Frame&                frame,
+        foundation::JobQueue&       job_queue,
+        foundation::IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE;
+
+    // This method is called at the end of a pass.
+    virtual void post_render(
+        const Frame&                frame,
+        foundation::JobQueue&       job_queue,
+        foundation::IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE;
+
+    // Return the irradiance cache.
+    const IrradianceCache& get_irradiance_cache() const;
+
+    // Interpolate the irradiance at a given point with a given unit-length normal, from
+    // the irradiance cache or from the records computed on the fly during the current
+    // pass. Return false if no record is valid at this point. Thread-safe.
+    bool lookup_irradiance(
+        const foundation::Vector3d& point,
+        const foundation::Vector3d& normal,
+        Spectrum&                   irradiance,
+        SpectrumStack&              aov_irradiance) const;
+
+    // Store a record computed on the fly during a pass. The record is used by subsequent
+    // lookups right away and is merged into the irradiance cache at the end of the pass.
+    // Thread-safe.
+    void insert_irradiance_record(const IrradianceRecord& record);
+
+    // Compute an irradiance record at a given shading point, around a given unit-length
+    // normal pointing toward the side from which the point is seen, split into a given
+    // number of render layers. Thread-safe.
+    void compute_irradiance_record(
+        SamplingContext&            sampling_context,
+        const ShadingContext&       shading_context,
+        const ShadingPoint&         shading_point,
+        const foundation::Vector3d& normal,
+        const size_t                aov_count,
+        IrradianceRecord&           record) const;
+
+  private:
+    typedef std::vector<IrradianceRecord> IrradianceRecordVector;
+
+    const Parameters                    m_params;
+    const Scene&                        m_scene;
+    const LightSampler&                 m_light_sampler;
+    const TraceContext&                 m_trace_context;
+    TextureStore&                       m_texture_store;
+    OIIO::TextureSystem&                m_oiio_texture_system;
+    OSL::ShadingSystem&                 m_shading_system;
+    foundation::AABB3d                  m_bbox;
+    float                               m_min_radius;
+    float                               m_max_radius;
+    std::auto_ptr<IrradianceCache>      m_irradiance_cache;
+    bool                                m_built;
+    std::vector<IrradianceRecordVector> m_record_segments;
+    mutable boost::shared_mutex         m_pending_mutex;
+    std::auto_ptr<IrradianceCache>      m_pending_cache;
+    IrradianceRecordVector              m_pending_records;
+
+    void build_irradiance_cache(
+        const Frame&                frame,
+        foundation::JobQueue&       job_queue,
+        foundation::IAbortSwitch&   abort_switch);
+};
+
+
+//
+// DRTPassCallback class implementation.
+//
+
+inline const IrradianceCache& DRTPassCallback::get_irradiance_cache() const
+{
+    return *m_irradiance_cache.get();
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_DRT_DRTPASSCALLBACK_H
@@ -0,0 +1,259 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "irradiancecache.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/aov/spectrumstack.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    AABB3d child_bbox(const AABB3d& bbox, const size_t child)
+    {
+        const Vector3d center = bbox.center();
+
+        AABB3d result;
+
+        for (size_t i = 0; i < 3; ++i)
+        {
+            if (child & (size_t(1) << i))
+            {
+                result.min[i] = center[i];
+                result.max[i] = bbox.max[i];
+            }
+            else
+            {
+                result.min[i] = bbox.min[i];
+                result.max[i] = center[i];
+            }
+        }
+
+        return result;
+    }
+}
+
+IrradianceCache::IrradianceCache(
+    const AABB3d&   bbox,
+    const float     max_error)
+  : m_max_error(max_error)
+{
+    assert(bbox.is_valid());
+    assert(max_error > 0.0f);
+
+    // Use a slightly enlarged cube so that octree nodes stay cubic.
+    const Vector3d center = bbox.center();
+    const double half_size = 0.505 * max_value(bbox.extent()) + 1.0e-6;
+    m_bbox.min = center - Vector3d(half_size);
+    m_bbox.max = center + Vector3d(half_size);
+
+    Node root;
+    root.m_first_child = 0;
+    m_nodes.push_back(root);
+}
+
+void IrradianceCache::insert(const IrradianceRecord& record)
+{
+    assert(record.m_radius > 0.0f);
+
+    const uint32 record_index = static_cast<uint32>(m_records.size());
+    m_records.push_back(record);
+
+    // The record can only be used inside this box.
+    const double valid_radius = static_cast<double>(m_max_error) * record.m_radius;
+    const AABB3d record_bbox(
+        record.m_position - Vector3d(valid_radius),
+        record.m_position + Vector3d(valid_radius));
+
+    if (AABB3d::overlap(m_bbox, record_bbox))
+        insert(0, m_bbox, 0, record_index, record_bbox);
+}
+
+void IrradianceCache::insert(
+    const size_t    node_index,
+    const AABB3d&   node_bbox,
+    const size_t    depth,
+    const uint32    record_index,
+    const AABB3d&   record_bbox)
+{
+    // Store the record in this node if its children would be smaller than the record's domain.
+    if (depth == MaxDepth ||
+        square_norm(node_bbox.extent()) < 4.0 * square_norm(record_bbox.extent()))
+    {
+        m_nodes[node_index].m_records.push_back(record_index);
+        return;
+    }
+
+    // Create the children of this node if needed.
+    if (m_nodes[node_index].m_first_child == 0)
+    {
+        const size_t first_child = m_nodes.size();
+
+        Node child;
+        child.m_first_child = 0;
+        m_nodes.resize(first_child + 8, child);
+
+        m_nodes[node_index].m_first_child = first_child;
+    }
+
+    // Recurse into the children that overlap the record's domain.
+    const size_t first_child = m_nodes[node_index].m_first_child;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        const AABB3d bbox = child_bbox(node_bbox, i);
+        if (AABB3d::overlap(bbox, record_bbox))
+            insert(first_child + i, bbox, depth + 1, record_index, record_bbox);
+    }
+}
+
+bool IrradianceCache::lookup(
+    const Vector3d& point,
+    const Vector3d& normal,
+    Spectrum&       irradiance) const
+{
+    return lookup(point, normal, irradiance, 0);
+}
+
+bool IrradianceCache::lookup(
+    const Vector3d& point,
+    const Vector3d& normal,
+    Spectrum&       irradiance,
+    SpectrumStack&  aov_irradiance) const
+{
+    return lookup(point, normal, irradiance, &aov_irradiance);
+}
+
+bool IrradianceCache::lookup(
+    const Vector3d& point,
+    const Vector3d& normal,
+    Spectrum&       irradiance,
+    SpectrumStack*  aov_irradiance) const
+{
+    assert(is_normalized(normal));
+
+    irradiance.set(0.0f);
+
+    if (aov_irradiance)
+        aov_irradiance->set(0.0f);
+
+    if (!m_bbox.contains(point))
+        return false;
+
+    const float rcp_max_error = 1.0f / m_max_error;
+    float weight_sum = 0.0f;
+
+    size_t node_index = 0;
+    AABB3d node_bbox = m_bbox;
+
+    while (true)
+    {
+        const Node& node = m_nodes[node_index];
+
+        for (size_t i = 0, e = node.m_records.size(); i < e; ++i)
+        {
+            const IrradianceRecord& record = m_records[node.m_records[i]];
+            const Vector3d d = point - record.m_position;
+
+            // Reject records located in front of the point.
+            if (0.5 * dot(d, normal + record.m_normal) < -0.01 * record.m_radius)
+                continue;
+
+            // Compute the error of the record at this point.
+            const double cos_normals = dot(normal, record.m_normal);
+            const float error =
+                static_cast<float>(
+                    norm(d) / record.m_radius +
+                    sqrt(max(1.0 - cos_normals, 0.0)));
+            if (error >= m_max_error)
+                continue;
+
+            // Extrapolate the irradiance of the record using its gradients.
+            const float gradient_factor =
+                1.0f +
+                dot(Vector3f(cross(record.m_normal, normal)), record.m_rotational_gradient) +
+                dot(Vector3f(d), record.m_translational_gradient);
+            if (gradient_factor <= 0.0f)
+                continue;
+
+            const float weight = 1.0f / max(error, 1.0e-4f) - rcp_max_error;
+            Spectrum contribution = record.m_irradiance;
+            contribution *= weight * gradient_factor;
+            irradiance += contribution;
+            weight_sum += weight;
+
+            if (aov_irradiance)
+            {
+                const size_t aov_count = min(aov_irradiance->size(), record.m_aov_irradiance.size());
+                for (size_t j = 0; j < aov_count; ++j)
+                {
+                    Spectrum aov_contribution = record.m_aov_irradiance[j];
+                    aov_contribution *= weight * gradient_factor;
+                    (*aov_irradiance)[j] += aov_contribution;
+                }
+            }
+        }
+
+        if (node.m_first_child == 0)
+            break;
+
+        // Move to the child containing the point.
+        const Vector3d center = node_bbox.center();
+        const size_t child =
+            (point.x >= center.x ? 1 : 0) |
+            (point.y >= center.y ? 2 : 0) |
+            (point.z >= center.z ? 4 : 0);
+        node_bbox = child_bbox(node_bbox, child);
+        node_index = node.m_first_child + child;
+    }
+
+    if (weight_sum == 0.0f)
+        return false;
+
+    irradiance /= weight_sum;
+
+    if (aov_irradiance)
+        *aov_irradiance *= 1.0f / weight_sum;
+
+    return true;
+}
+
+}   // namespace renderer
@@ -0,0 +1,188 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_IRRADIANCECACHE_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_IRRADIANCECACHE_H
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class SpectrumStack; }
+
+namespace renderer
+{
+
+//
+// An irradiance sample together with its gradients.
+//
+// Gradients are relative to the irradiance: the irradiance at a nearby point p with
+// normal n is extrapolated as
+//
+//   E * (1 + dot(cross(m_normal, n), m_rotational_gradient)
+//          + dot(p - m_position, m_translational_gradient))
+//
+// The irradiance is also split by render layer, according to the lights it comes from,
+// and the same gradients are used to extrapolate each part.
+//
+
+class IrradianceRecord
+{
+  public:
+    foundation::Vector3d        m_position;
+    foundation::Vector3d        m_normal;                   // unit-length
+    Spectrum                    m_irradiance;               // in W.m^-2
+    std::vector<Spectrum>       m_aov_irradiance;           // irradiance per render layer, in W.m^-2
+    foundation::Vector3f        m_rotational_gradient;
+    foundation::Vector3f        m_translational_gradient;
+    float                       m_radius;                   // harmonic mean distance to the surfaces seen from the record
+};
+
+
+//
+// A sparse irradiance cache: irradiance records stored in a world space octree and
+// interpolated at nearby points with similar normals.
+//
+// The error of a record i at a point p with normal n is
+//
+//   e_i(p, n) = |p - p_i| / R_i + sqrt(1 - dot(n, n_i))
+//
+// and the record is used if e_i < a, the maximum error, with the weight 1/e_i - 1/a
+// so that records fade out smoothly at the border of their domain. Records located
+// behind p are rejected. Each record is stored in the octree nodes that overlap its
+// domain of validity and are about as large as it; a lookup only visits the nodes
+// along the path from the root to the leaf containing the point.
+//
+// References:
+//
+//   Gregory J. Ward, Francis M. Rubinstein, Robert D. Clear, A Ray Tracing Solution
+//   for Diffuse Interreflection, SIGGRAPH 1988.
+//
+//   Gregory J. Ward, Paul S. Heckbert, Irradiance Gradients, Third Eurographics
+//   Workshop on Rendering, 1992.
+//
+//   Eric Tabellion, Arnauld Lamorlette, An Approximate Global Illumination System
+//   for Computer Generated Films, SIGGRAPH 2004.
+//
+
+class IrradianceCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. Records must lie inside a given bounding box.
+    IrradianceCache(
+        const foundation::AABB3d&   bbox,
+        const float                 max_error);
+
+    // Return the maximum error of interpolated records.
+    float get_max_error() const;
+
+    // Return the number of records in the cache.
+    size_t size() const;
+
+    // Return the number of nodes in the octree.
+    size_t get_node_count() const;
+
+    // Insert a record into the cache. Not thread-safe.
+    void insert(const IrradianceRecord& record);
+
+    // Interpolate the irradiance at a given point with a given unit-length normal.
+    // Return false if no record is valid at this point.
+    bool lookup(
+        const foundation::Vector3d& point,
+        const foundation::Vector3d& normal,
+        Spectrum&                   irradiance) const;
+
+    // Same as above, but also interpolate the irradiance of each render layer.
+    bool lookup(
+        const foundation::Vector3d& point,
+        const foundation::Vector3d& normal,
+        Spectrum&                   irradiance,
+        SpectrumStack&              aov_irradiance) const;
+
+  private:
+    enum { MaxDepth = 20 };
+
+    struct Node
+    {
+        size_t                              m_first_child;  // index of the first of the 8 children, 0 for leaves
+        std::vector<foundation::uint32>     m_records;
+    };
+
+    foundation::AABB3d                      m_bbox;
+    const float                             m_max_error;
+    std::vector<IrradianceRecord>           m_records;
+    std::vector<Node>                       m_nodes;
+
+    bool lookup(
+        const foundation::Vector3d& point,
+        const foundation::Vector3d& normal,
+        Spectrum&                   irradiance,
+        SpectrumStack*              aov_irradiance) const;
+
+    void insert(
+        const size_t                node_index,
+        const foundation::AABB3d&   node_bbox,
+        const size_t                depth,
+        const foundation::uint32    record_index,
+        const foundation::AABB3d&   record_bbox);
+};
+
+
+//
+// IrradianceCache class implementation.
+//
+
+inline float IrradianceCache::get_max_error() const
+{
+    return m_max_error;
+}
+
+inline size_t IrradianceCache::size() const
+{
+    return m_records.size();
+}
+
+inline size_t IrradianceCache::get_node_count() const
+{
+    return m_nodes.size();
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_IRRADIANCECACHE_H
@@ -56,11 +56,13 @@
 #include "foundation/math/scalar.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/lazy.h"
+#include "foundation/utility/makevector.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
 #include <cassert>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -121,16 +123,20 @@ LightSampler::LightSampler(const Scene& scene, const ParamArray& params)
     // Build the hash table of emitting triangles.
     build_emitting_triangle_hash_table();
 
-    // Prepare the CDFs for sampling.
-    if (m_non_physical_lights_cdf.valid())
-        m_non_physical_lights_cdf.prepare();
-    if (m_emitting_triangles_cdf.valid())
-        m_emitting_triangles_cdf.prepare();
+    // Prepare the alias tables for sampling.
+    if (m_non_physical_lights_table.valid())
+        m_non_physical_lights_table.prepare();
+    if (m_emitting_triangles_table.valid())
+        m_emitting_triangles_table.prepare();
 
     // Store the triangle probability densities into the emitting triangles.
     const size_t emitting_triangle_count = m_emitting_triangles.size();
     for (size_t i = 0; i < emitting_triangle_count; ++i)
-        m_emitting_triangles[i].m_triangle_prob = m_emitting_triangles_cdf[i].second;
+        m_emitting_triangles[i].m_triangle_prob = m_emitting_triangles_table[i].second;
+
+    // Build the light tree.
+    if (m_params.m_use_light_tree && m_emitting_triangles_table.valid())
+        build_emitting_triangle_tree();
 
    RENDERER_LOG_INFO(
         "found %s %s, %s emitting %s.",
@@ -185,11 +191,11 @@ void LightSampler::collect_non_physical_lights(
         light_info.m_light = &light;
         m_non_physical_lights.push_back(light_info);
 
-        // Insert the light into the CDF.
+        // Insert the light into the alias table.
         // todo: compute importance.
         float importance = 1.0f;
         importance *= light.get_uncached_importance_multiplier();
-        m_non_physical_lights_cdf.insert(light_index, importance);
+        m_non_physical_lights_table.insert(light_index, importance);
     }
 }
 
@@ -374,15 +380,15 @@ void LightSampler::collect_emitting_triangles(
                     emitting_triangle.m_geometric_normal = side == 0 ? geometric_normal : -geometric_normal;
                     emitting_triangle.m_triangle_support_plane = triangle_support_plane;
                     emitting_triangle.m_rcp_area = static_cast<float>(rcp_area);
-                    emitting_triangle.m_triangle_prob = 0.0f;   // will be initialized once the emitting triangle CDF is built
+                    emitting_triangle.m_triangle_prob = 0.0f;   // will be initialized once the emitting triangle alias table is built
                     emitting_triangle.m_material = material;
 
                     // Store the light-emitting triangle.
                     const size_t emitting_triangle_index = m_emitting_triangles.size();
                     m_emitting_triangles.push_back(emitting_triangle);
 
-                    // Insert the light-emitting triangle into the CDF.
-                    m_emitting_triangles_cdf.insert(emitting_triangle_index, triangle_prob);
+                    // Insert the light-emitting triangle into the alias table.
+                    m_emitting_triangles_table.insert(emitting_triangle_index, triangle_prob);
                 }
             }
         }
@@ -422,14 +428,41 @@ void LightSampler::build_emitting_triangle_hash_table()
     }
 }
 
+void LightSampler::build_emitting_triangle_tree()
+{
+    const size_t emitting_triangle_count = m_emitting_triangles.size();
+
+    vector<LightTree::Item> items(emitting_triangle_count);
+
+    for (size_t i = 0; i < emitting_triangle_count; ++i)
+    {
+        const EmittingTriangle& emitting_triangle = m_emitting_triangles[i];
+
+        LightTree::Item& item = items[i];
+        item.m_bbox.invalidate();
+        item.m_bbox.insert(emitting_triangle.m_v0);
+        item.m_bbox.insert(emitting_triangle.m_v1);
+        item.m_bbox.insert(emitting_triangle.m_v2);
+        item.m_normal = emitting_triangle.m_geometric_normal;
+        item.m_power = emitting_triangle.m_triangle_prob;
+    }
+
+    m_emitting_triangles_tree.build(items);
+
+    RENDERER_LOG_INFO(
+        "built light tree with %s %s.",
+        pretty_int(m_emitting_triangles_tree.get_node_count()).c_str(),
+        plural(m_emitting_triangles_tree.get_node_count(), "node").c_str());
+}
+
 void LightSampler::sample_non_physical_lights(
     const ShadingRay::Time&             time,
     const Vector3f&                     s,
     LightSample&                        light_sample) const
 {
-    assert(m_non_physical_lights_cdf.valid());
+    assert(m_non_physical_lights_table.valid());
 
-    const EmitterCDF::ItemWeightPair result = m_non_physical_lights_cdf.sample(s[0]);
+    const EmitterAliasTable::ItemWeightPair result = m_non_physical_lights_table.sample(s[0]);
     const size_t light_index = result.first;
     const float light_prob = result.second;
 
@@ -449,11 +482,40 @@ void LightSampler::sample_emitting_triangles(
     const Vector3f&                     s,
     LightSample&                        light_sample) const
 {
-    assert(m_emitting_triangles_cdf.valid());
+    assert(m_emitting_triangles_table.valid());
 
-    const EmitterCDF::ItemWeightPair result = m_emitting_triangles_cdf.sample(s[0]);
+    const EmitterAliasTable::ItemWeightPair result = m_emitting_triangles_table.sample(s[0]);
     const size_t emitter_index = result.first;
     const float emitter_prob = result.second;
+    assert(m_emitting_triangles[emitter_index].m_triangle_prob == emitter_prob);
+
+    light_sample.m_light = 0;
+    sample_emitting_triangle(
+        time,
+        Vector2f(s[1], s[2]),
+        emitter_index,
+        emitter_prob,
+        light_sample);
+
+    assert(light_sample.m_triangle);
+    assert(light_sample.m_probability > 0.0f);
+}
+
+void LightSampler::sample_emitting_triangles(
+    const ShadingRay::Time&             time,
+    const Vector3d&                     point,
+    const Vector3f&                     s,
+    LightSample&                        light_sample) const
+{
+    if (m_emitting_triangles_tree.empty())
+    {
+        sample_emitting_triangles(time, s, light_sample);
+        return;
+    }
+
+    float emitter_prob;
+    const size_t emitter_index =
+        m_emitting_triangles_tree.sample(point, s[0], emitter_prob);
 
     light_sample.m_light = 0;
     sample_emitting_triangle(
@@ -472,11 +534,11 @@ void LightSampler::sample(
     const Vector3f&                     s,
     LightSample&                        light_sample) const
 {
-    assert(m_non_physical_lights_cdf.valid() || m_emitting_triangles_cdf.valid());
+    assert(m_non_physical_lights_table.valid() || m_emitting_triangles_table.valid());
 
-    if (m_non_physical_lights_cdf.valid())
+    if (m_non_physical_lights_table.valid())
     {
-        if (m_emitting_triangles_cdf.valid())
+        if (m_emitting_triangles_table.valid())
         {
             if (s[0] < 0.5f)
             {
@@ -500,6 +562,41 @@ void LightSampler::sample(
     else sample_emitting_triangles(time, s, light_sample);
 }
 
+void LightSampler::sample(
+    const ShadingRay::Time&             time,
+    const Vector3d&                     point,
+    const Vector3f&                     s,
+    LightSample&                        light_sample) const
+{
+    assert(m_non_physical_lights_table.valid() || m_emitting_triangles_table.valid());
+
+    if (m_non_physical_lights_table.valid())
+    {
+        if (m_emitting_triangles_table.valid())
+        {
+            if (s[0] < 0.5f)
+            {
+                sample_non_physical_lights(
+                    time,
+                    Vector3f(s[0] * 2.0f, s[1], s[2]),
+                    light_sample);
+            }
+            else
+            {
+                sample_emitting_triangles(
+                    time,
+                    point,
+                    Vector3f((s[0] - 0.5f) * 2.0f, s[1], s[2]),
+                    light_sample);
+            }
+
+            light_sample.m_probability *= 0.5f;
+        }
+        else sample_non_physical_lights(time, s, light_sample);
+    }
+    else sample_emitting_triangles(time, point, s, light_sample);
+}
+
 float LightSampler::evaluate_pdf(const ShadingPoint& shading_point) const
 {
     assert(shading_point.is_triangle_primitive());
@@ -511,6 +608,32 @@ float LightSampler::evaluate_pdf(const ShadingPoint& shading_point) const
         shading_point.get_primitive_index());
 
     const EmittingTriangle* triangle = m_emitting_triangle_hash_table.get(triangle_key);
+
+    if (!m_emitting_triangles_tree.empty())
+    {
+        const size_t triangle_index = static_cast<size_t>(triangle - &m_emitting_triangles[0]);
+        const float triangle_prob =
+            m_emitting_triangles_tree.evaluate_pdf(
+                shading_point.get_ray().m_org,
+                triangle_index);
+        return triangle_prob * triangle->m_rcp_area;
+    }
+
+    return triangle->m_triangle_prob * triangle->m_rcp_area;
+}
+
+float LightSampler::evaluate_emitting_triangle_pdf(const ShadingPoint& shading_point) const
+{
+    assert(shading_point.is_triangle_primitive());
+
+    const EmittingTriangleKey triangle_key(
+        shading_point.get_assembly_instance().get_uid(),
+        shading_point.get_object_instance_index(),
+        shading_point.get_region_index(),
+        shading_point.get_primitive_index());
+
+    const EmittingTriangle* triangle = m_emitting_triangle_hash_table.get(triangle_key);
+
     return triangle->m_triangle_prob * triangle->m_rcp_area;
 }
 
@@ -542,7 +665,6 @@ void LightSampler::sample_emitting_triangle(
 {
     // Fetch the emitting triangle.
     const EmittingTriangle& emitting_triangle = m_emitting_triangles[triangle_index];
-    assert(emitting_triangle.m_triangle_prob == triangle_prob);
 
     // Store a pointer to the emitting triangle.
     light_sample.m_triangle = &emitting_triangle;
@@ -600,6 +722,11 @@ void LightSampler::store_object_area_in_shadergroups(
 
 LightSampler::Parameters::Parameters(const ParamArray& params)
   : m_importance_sampling(params.get_optional<bool>("enable_importance_sampling", false))
+  , m_use_light_tree(
+        params.get_optional<string>(
+            "algorithm",
+            "cdf",
+            make_vector("cdf", "lighttree")) == "lighttree")
 {
 }
 
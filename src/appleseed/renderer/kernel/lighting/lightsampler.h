@@ -32,13 +32,14 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/lighting/lighttree.h"
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/modeling/scene/containers.h"
 #include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
-#include "foundation/math/cdf.h"
+#include "foundation/math/aliastable.h"
 #include "foundation/math/hash.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
@@ -171,6 +172,11 @@ class LightSample
 // The light sampler collects all the light-emitting entities (non-physical lights, mesh lights)
 // and allows to sample them.
 //
+// Emitting triangles are either sampled proportionally to their power regardless of the point
+// being lit ("cdf" algorithm), or, when the position of the point being lit is known, by
+// traversing a light tree ("lighttree" algorithm). Non-physical lights are always sampled
+// proportionally to their power.
+//
 
 class LightSampler
   : public foundation::NonCopyable
@@ -208,26 +214,47 @@ class LightSampler
         const foundation::Vector3f&         s,
         LightSample&                        light_sample) const;
 
+    // Sample the set of emitting triangles as seen from a given point.
+    void sample_emitting_triangles(
+        const ShadingRay::Time&             time,
+        const foundation::Vector3d&         point,
+        const foundation::Vector3f&         s,
+        LightSample&                        light_sample) const;
+
     // Sample the sets of non-physical lights and emitting triangles.
     void sample(
         const ShadingRay::Time&             time,
         const foundation::Vector3f&         s,
         LightSample&                        light_sample) const;
 
-    // Compute the probability density in area measure of a given light sample.
+    // Sample the sets of non-physical lights and emitting triangles as seen from a given point.
+    void sample(
+        const ShadingRay::Time&             time,
+        const foundation::Vector3d&         point,
+        const foundation::Vector3f&         s,
+        LightSample&                        light_sample) const;
+
+    // Compute the probability density in area measure of a given light sample. When the light
+    // tree is used, the origin of the ray that hit the light is taken as the point being lit,
+    // consistently with the position-dependent sampling methods.
     float evaluate_pdf(const ShadingPoint& shading_point) const;
 
+    // Compute the probability density in area measure with which the position-independent
+    // variant of sample_emitting_triangles() would have chosen a given point on a light.
+    float evaluate_emitting_triangle_pdf(const ShadingPoint& shading_point) const;
+
   private:
     struct Parameters
     {
         const bool m_importance_sampling;
+        const bool m_use_light_tree;
 
         explicit Parameters(const ParamArray& params);
     };
 
     typedef std::vector<NonPhysicalLightInfo> NonPhysicalLightVector;
     typedef std::vector<EmittingTriangle> EmittingTriangleVector;
-    typedef foundation::CDF<size_t, float> EmitterCDF;
+    typedef foundation::AliasTable<size_t, float> EmitterAliasTable;
 
     const Parameters            m_params;
 
@@ -236,8 +263,9 @@ class LightSampler
 
     EmittingTriangleVector      m_emitting_triangles;
 
-    EmitterCDF                  m_non_physical_lights_cdf;
-    EmitterCDF                  m_emitting_triangles_cdf;
+    EmitterAliasTable           m_non_physical_lights_table;
+    EmitterAliasTable           m_emitting_triangles_table;
+    LightTree                   m_emitting_triangles_tree;
 
     EmittingTriangleKeyHasher   m_triangle_key_hasher;
     EmittingTriangleHashTable   m_emitting_triangle_hash_table;
@@ -266,6 +294,9 @@ class LightSampler
     // Build a hash table that allows to find the emitting triangle at a given shading point.
     void build_emitting_triangle_hash_table();
 
+    // Build the light tree over the emitting triangles.
+    void build_emitting_triangle_tree();
+
     // Sample a given non-physical light.
     void sample_non_physical_light(
         const ShadingRay::Time&             time,
@@ -350,7 +381,7 @@ inline size_t LightSampler::get_emitting_triangle_count() const
 
 inline bool LightSampler::has_lights_or_emitting_triangles() const
 {
-    return m_non_physical_lights_cdf.valid() || m_emitting_triangles_cdf.valid();
+    return m_non_physical_lights_table.valid() || m_emitting_triangles_table.valid();
 }
 
 inline void LightSampler::sample_non_physical_light(
@@ -224,9 +224,6 @@ namespace
             m_light_sample_count = 0;
 
             SampleGeneratorBase::generate_samples(sample_count, buffer, abort_switch);
-
-            static_cast<GlobalSampleAccumulationBuffer&>(buffer)
-                .increment_sample_count(m_light_sample_count);
         }
 
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
@@ -541,6 +538,25 @@ namespace
             return stored_sample_count;
         }
 
+        virtual void store_samples(
+            SampleAccumulationBuffer&   buffer,
+            const size_t                sample_count,
+            const Sample                samples[],
+            IAbortSwitch&               abort_switch) APPLESEED_OVERRIDE
+        {
+            // Light samples that didn't contribute to the image still count: store them
+            // along with the samples so that the buffer always normalizes pixel values
+            // by the number of light samples whose contributions it actually holds.
+            if (m_light_sample_count > 0)
+            {
+                static_cast<GlobalSampleAccumulationBuffer&>(buffer).store_samples(
+                    sample_count,
+                    samples,
+                    m_light_sample_count,
+                    abort_switch);
+            }
+        }
+
         size_t generate_light_sample(
             SamplingContext&            sampling_context,
             SampleVector&               samples)
@@ -0,0 +1,334 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "lighttree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/basis.h"
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    //
+    // Bounding cones of directions.
+    //
+
+    struct Cone
+    {
+        Vector3d    m_axis;
+        double      m_angle;
+    };
+
+    // Return the smallest cone (approximately) bounding two given cones.
+    Cone merge_cones(const Cone& lhs, const Cone& rhs)
+    {
+        const Cone& a = lhs.m_angle >= rhs.m_angle ? lhs : rhs;
+        const Cone& b = lhs.m_angle >= rhs.m_angle ? rhs : lhs;
+
+        const double angle_d = acos(clamp(dot(a.m_axis, b.m_axis), -1.0, 1.0));
+
+        // The largest cone already contains the other one.
+        if (min(angle_d + b.m_angle, Pi<double>()) <= a.m_angle)
+            return a;
+
+        Cone result;
+        result.m_angle = 0.5 * (a.m_angle + angle_d + b.m_angle);
+
+        if (result.m_angle >= Pi<double>())
+        {
+            result.m_axis = a.m_axis;
+            result.m_angle = Pi<double>();
+            return result;
+        }
+
+        // Rotate the axis of the largest cone toward the axis of the other cone.
+        Vector3d w = b.m_axis - dot(a.m_axis, b.m_axis) * a.m_axis;
+        const double w_norm = norm(w);
+        w = w_norm > 1.0e-9 ? w / w_norm : Basis3d(a.m_axis).get_tangent_u();
+
+        const double rotation = result.m_angle - a.m_angle;
+        result.m_axis = normalize(cos(rotation) * a.m_axis + sin(rotation) * w);
+
+        return result;
+    }
+
+    struct CentroidComparator
+    {
+        const vector<LightTree::Item>&  m_items;
+        const size_t                    m_dim;
+
+        CentroidComparator(const vector<LightTree::Item>& items, const size_t dim)
+          : m_items(items)
+          , m_dim(dim)
+        {
+        }
+
+        bool operator()(const size_t lhs, const size_t rhs) const
+        {
+            return m_items[lhs].m_bbox.center(m_dim) < m_items[rhs].m_bbox.center(m_dim);
+        }
+    };
+}
+
+
+//
+// LightTree class implementation.
+//
+
+LightTree::LightTree()
+{
+}
+
+void LightTree::build(const vector<Item>& items)
+{
+    m_nodes.clear();
+    m_item_nodes.assign(items.size(), 0);
+
+    if (items.empty())
+        return;
+
+    m_nodes.reserve(2 * items.size() - 1);
+
+    vector<size_t> indices(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+        indices[i] = i;
+
+    m_nodes.push_back(Node());
+    build_node(items, indices, 0, items.size(), 0, 0);
+}
+
+void LightTree::build_node(
+    const vector<Item>&     items,
+    vector<size_t>&         indices,
+    const size_t            begin,
+    const size_t            end,
+    const size_t            node_index,
+    const size_t            parent)
+{
+    assert(end > begin);
+
+    if (end - begin == 1)
+    {
+        const size_t item_index = indices[begin];
+        const Item& item = items[item_index];
+
+        Node& node = m_nodes[node_index];
+        node.m_bbox = item.m_bbox;
+        node.m_cone_axis = item.m_normal;
+        node.m_cone_angle = 0.0;
+        node.m_power = item.m_power;
+        node.m_parent = parent;
+        node.m_child = item_index;
+        node.m_leaf = true;
+
+        m_item_nodes[item_index] = node_index;
+
+        return;
+    }
+
+    // Split at the median of the centroids along the longest axis of their bounding box.
+    AABB3d centroid_bbox;
+    centroid_bbox.invalidate();
+    for (size_t i = begin; i < end; ++i)
+        centroid_bbox.insert(items[indices[i]].m_bbox.center());
+
+    const size_t split_dim = max_index(centroid_bbox.extent());
+    const size_t middle = begin + (end - begin) / 2;
+
+    nth_element(
+        indices.begin() + begin,
+        indices.begin() + middle,
+        indices.begin() + end,
+        CentroidComparator(items, split_dim));
+
+    // Allocate both children next to each other, then build them.
+    const size_t first_child = m_nodes.size();
+    m_nodes.push_back(Node());
+    m_nodes.push_back(Node());
+    build_node(items, indices, begin, middle, first_child, node_index);
+    build_node(items, indices, middle, end, first_child + 1, node_index);
+
+    const Node& left = m_nodes[first_child];
+    const Node& right = m_nodes[first_child + 1];
+
+    Cone left_cone;
+    left_cone.m_axis = left.m_cone_axis;
+    left_cone.m_angle = left.m_cone_angle;
+
+    Cone right_cone;
+    right_cone.m_axis = right.m_cone_axis;
+    right_cone.m_angle = right.m_cone_angle;
+
+    const Cone cone = merge_cones(left_cone, right_cone);
+
+    AABB3d bbox = left.m_bbox;
+    bbox.insert(right.m_bbox);
+
+    Node& node = m_nodes[node_index];
+    node.m_bbox = bbox;
+    node.m_cone_axis = cone.m_axis;
+    node.m_cone_angle = cone.m_angle;
+    node.m_power = left.m_power + right.m_power;
+    node.m_parent = parent;
+    node.m_child = first_child;
+    node.m_leaf = false;
+}
+
+size_t LightTree::sample(
+    const Vector3d&         point,
+    const float             s,
+    float&                  prob) const
+{
+    assert(!m_nodes.empty());
+    assert(s >= 0.0f && s < 1.0f);
+
+    double u = s;
+    double p = 1.0;
+    size_t node_index = 0;
+
+    while (!m_nodes[node_index].m_leaf)
+    {
+        const Node& node = m_nodes[node_index];
+        const double p_first = compute_first_child_probability(node, point);
+
+        // Choose a child and reuse the sample for the next level.
+        if (u < p_first)
+        {
+            u /= p_first;
+            p *= p_first;
+            node_index = node.m_child;
+        }
+        else
+        {
+            u = (u - p_first) / (1.0 - p_first);
+            p *= 1.0 - p_first;
+            node_index = node.m_child + 1;
+        }
+
+        u = min(u, 1.0 - 1.0e-12);
+    }
+
+    prob = static_cast<float>(p);
+
+    return m_nodes[node_index].m_child;
+}
+
+float LightTree::evaluate_pdf(
+    const Vector3d&         point,
+    const size_t            item_index) const
+{
+    assert(item_index < m_item_nodes.size());
+
+    double p = 1.0;
+    size_t node_index = m_item_nodes[item_index];
+
+    // Walk up the tree and multiply the probabilities of the choices made when sampling.
+    while (node_index != 0)
+    {
+        const Node& parent = m_nodes[m_nodes[node_index].m_parent];
+        const double p_first = compute_first_child_probability(parent, point);
+
+        p *= node_index == parent.m_child ? p_first : 1.0 - p_first;
+
+        node_index = m_nodes[node_index].m_parent;
+    }
+
+    return static_cast<float>(p);
+}
+
+double LightTree::compute_importance(
+    const Node&             node,
+    const Vector3d&         point) const
+{
+    const Vector3d center = node.m_bbox.center();
+    const double radius = node.m_bbox.radius();
+
+    const Vector3d to_point = point - center;
+    const double square_distance = square_norm(to_point);
+
+    // Points inside the bounding sphere of the node: no orientation nor distance bound.
+    if (square_distance <= square(radius))
+        return node.m_power / max(square(radius), 1.0e-12);
+
+    const double distance = sqrt(square_distance);
+
+    // Angle between the axis of the cone and the direction to the point.
+    const double cos_theta = dot(node.m_cone_axis, to_point) / distance;
+    const double theta = acos(clamp(cos_theta, -1.0, 1.0));
+
+    // Half-angle of the cone subtended by the bounding sphere of the node.
+    const double theta_u = asin(min(radius / distance, 1.0));
+
+    // Smallest possible angle between an emitter normal and the direction to the point.
+    const double theta_prime = max(theta - node.m_cone_angle - theta_u, 0.0);
+
+    // Emitters only emit in the hemisphere around their normal.
+    if (theta_prime >= HalfPi<double>())
+        return 0.0;
+
+    return node.m_power * cos(theta_prime) / square_distance;
+}
+
+double LightTree::compute_first_child_probability(
+    const Node&             node,
+    const Vector3d&         point) const
+{
+    assert(!node.m_leaf);
+
+    const Node& first = m_nodes[node.m_child];
+    const Node& second = m_nodes[node.m_child + 1];
+
+    double i1 = compute_importance(first, point);
+    double i2 = compute_importance(second, point);
+
+    // If neither child seems to contribute, fall back to choosing by power.
+    if (i1 + i2 == 0.0)
+    {
+        i1 = first.m_power;
+        i2 = second.m_power;
+
+        if (i1 + i2 == 0.0)
+            return 0.5;
+    }
+
+    return i1 / (i1 + i2);
+}
+
+}   // namespace renderer
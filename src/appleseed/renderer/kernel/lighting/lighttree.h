@@ -0,0 +1,145 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_LIGHTTREE_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_LIGHTTREE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A bounding volume hierarchy over light emitters. Every node stores the total power,
+// the bounding box and a cone bounding the emission directions of the emitters below it,
+// which allows to choose an emitter with a probability proportional to an estimate of
+// its contribution to a given point, in time logarithmic in the number of emitters.
+//
+// Emitters are assumed to emit in the hemisphere around their normal.
+//
+// Reference:
+//
+//   Conty Estevez and Kulla, Importance Sampling of Many Lights with Adaptive Tree Splitting
+//   http://www.aconty.com/pdf/many-lights-hpg2018.pdf
+//
+
+class LightTree
+  : public foundation::NonCopyable
+{
+  public:
+    // An emitter.
+    struct Item
+    {
+        foundation::AABB3d      m_bbox;                 // world space bounding box
+        foundation::Vector3d    m_normal;               // world space normal, unit-length
+        float                   m_power;                // power or importance
+    };
+
+    // Constructor, builds an empty tree.
+    LightTree();
+
+    // Build the tree.
+    void build(const std::vector<Item>& items);
+
+    // Return true if the tree contains no emitter.
+    bool empty() const;
+
+    // Return the number of nodes in the tree.
+    size_t get_node_count() const;
+
+    // Choose an emitter given a point being lit and a uniform sample in [0,1).
+    // Return the index of the emitter and the probability of having chosen it.
+    size_t sample(
+        const foundation::Vector3d&     point,
+        const float                     s,
+        float&                          prob) const;
+
+    // Return the probability of choosing a given emitter for a given point being lit.
+    float evaluate_pdf(
+        const foundation::Vector3d&     point,
+        const size_t                    item_index) const;
+
+  private:
+    struct Node
+    {
+        foundation::AABB3d      m_bbox;
+        foundation::Vector3d    m_cone_axis;            // unit-length
+        double                  m_cone_angle;           // half-angle of the cone of normals, in radians
+        float                   m_power;
+        size_t                  m_parent;
+        size_t                  m_child;                // index of the first child, or of the item for leaves
+        bool                    m_leaf;
+    };
+
+    std::vector<Node>           m_nodes;
+    std::vector<size_t>         m_item_nodes;           // leaf node of every item
+
+    void build_node(
+        const std::vector<Item>&        items,
+        std::vector<size_t>&            indices,
+        const size_t                    begin,
+        const size_t                    end,
+        const size_t                    node_index,
+        const size_t                    parent);
+
+    // Estimate the contribution of the emitters below a given node to a given point.
+    double compute_importance(
+        const Node&                     node,
+        const foundation::Vector3d&     point) const;
+
+    // Return the probability of choosing the first child of a given interior node.
+    double compute_first_child_probability(
+        const Node&                     node,
+        const foundation::Vector3d&     point) const;
+};
+
+
+//
+// LightTree class implementation.
+//
+
+inline bool LightTree::empty() const
+{
+    return m_nodes.empty();
+}
+
+inline size_t LightTree::get_node_count() const
+{
+    return m_nodes.size();
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_LIGHTTREE_H
@@ -0,0 +1,292 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "pathguide.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/lighting/pathvertex.h"
+#include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/modeling/scene/scene.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    AABB3f compute_guiding_bbox(const Scene& scene)
+    {
+        const GAABB3 scene_bbox = scene.compute_bbox();
+
+        return
+            scene_bbox.is_valid()
+                ? AABB3f(scene_bbox)
+                : AABB3f(Vector3f(-1.0f), Vector3f(1.0f));
+    }
+}
+
+
+//
+// PathGuide::Parameters class implementation.
+//
+
+// The BSDF sampling fraction is kept above zero, otherwise specular scattering would be missed.
+PathGuide::Parameters::Parameters(const ParamArray& params)
+  : m_bsdf_sampling_fraction(clamp(params.get_optional<float>("path_guiding_bsdf_fraction", 0.5f), 0.05f, 1.0f))
+  , m_spatial_threshold(max(params.get_optional<float>("path_guiding_spatial_threshold", 12000.0f), 1.0f))
+  , m_directional_threshold(params.get_optional<float>("path_guiding_directional_threshold", 0.01f))
+  , m_max_directional_depth(params.get_optional<size_t>("path_guiding_max_directional_depth", 20))
+{
+}
+
+
+//
+// PathGuide class implementation.
+//
+
+PathGuide::PathGuide(
+    const Scene&            scene,
+    const ParamArray&       params)
+  : m_params(params)
+  , m_stree(compute_guiding_bbox(scene))
+  , m_pass_number(0)
+{
+    RENDERER_LOG_INFO(
+        "path guiding settings:\n"
+        "  bsdf fraction    %s\n"
+        "  spatial thresh.  %s\n"
+        "  direct. thresh.  %s\n"
+        "  max direct. dep. %s",
+        pretty_scalar(m_params.m_bsdf_sampling_fraction).c_str(),
+        pretty_scalar(m_params.m_spatial_threshold).c_str(),
+        pretty_scalar(m_params.m_directional_threshold).c_str(),
+        pretty_uint(m_params.m_max_directional_depth).c_str());
+}
+
+void PathGuide::release()
+{
+    delete this;
+}
+
+void PathGuide::pre_render(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+    m_stopwatch.start();
+}
+
+void PathGuide::post_render(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    // Merge the samples still held by the lighting engines.
+    for (size_t i = 0, e = m_sample_buffers.size(); i < e; ++i)
+        record_samples(*m_sample_buffers[i]);
+
+    if (abort_switch.is_aborted())
+        return;
+
+    // The radiance learned during this pass becomes the sampling distribution of the next pass.
+    for (size_t i = 0, e = m_stree.get_leaf_count(); i < e; ++i)
+    {
+        STree::Leaf& leaf = m_stree.get_leaf(i);
+        leaf.m_sampling = leaf.m_building;
+    }
+
+    // Refine the spatial subdivision, then the directional subdivision of every spatial cell.
+    m_stree.refine(m_params.m_spatial_threshold);
+
+    size_t dtree_node_count = 0;
+    for (size_t i = 0, e = m_stree.get_leaf_count(); i < e; ++i)
+    {
+        STree::Leaf& leaf = m_stree.get_leaf(i);
+        leaf.m_building.reset(
+            leaf.m_sampling,
+            m_params.m_directional_threshold,
+            m_params.m_max_directional_depth);
+        dtree_node_count += leaf.m_building.get_node_count();
+    }
+
+    m_stopwatch.measure();
+
+    RENDERER_LOG_INFO(
+        "path guiding pass %s completed in %s, %s spatial %s, %s directional %s.",
+        pretty_uint(m_pass_number + 1).c_str(),
+        pretty_time(m_stopwatch.get_seconds()).c_str(),
+        pretty_uint(m_stree.get_leaf_count()).c_str(),
+        plural(m_stree.get_leaf_count(), "cell").c_str(),
+        pretty_uint(dtree_node_count).c_str(),
+        plural(dtree_node_count, "node").c_str());
+
+    ++m_pass_number;
+}
+
+void PathGuide::register_sample_buffer(SampleVector* buffer)
+{
+    assert(buffer);
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_sample_buffers.push_back(buffer);
+}
+
+void PathGuide::unregister_sample_buffer(SampleVector* buffer)
+{
+    assert(buffer);
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    record_samples(*buffer);
+
+    const vector<SampleVector*>::iterator i =
+        find(m_sample_buffers.begin(), m_sample_buffers.end(), buffer);
+    assert(i != m_sample_buffers.end());
+
+    m_sample_buffers.erase(i);
+}
+
+void PathGuide::flush_sample_buffer(SampleVector& buffer)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    record_samples(buffer);
+}
+
+void PathGuide::record_samples(SampleVector& buffer)
+{
+    for (size_t i = 0, e = buffer.size(); i < e; ++i)
+    {
+        const Sample& sample = buffer[i];
+        m_stree.find_leaf(sample.m_position).m_building.record(sample.m_direction, sample.m_value);
+    }
+
+    buffer.clear();
+}
+
+
+//
+// PathGuideRecorder class implementation.
+//
+
+PathGuideRecorder::PathGuideRecorder(PathGuide& path_guide)
+  : m_path_guide(path_guide)
+  , m_record_count(0)
+  , m_has_position(false)
+{
+    m_samples.reserve(FlushThreshold + MaxRecordCount);
+    m_path_guide.register_sample_buffer(&m_samples);
+}
+
+PathGuideRecorder::~PathGuideRecorder()
+{
+    m_path_guide.unregister_sample_buffer(&m_samples);
+}
+
+void PathGuideRecorder::begin_path()
+{
+    m_record_count = 0;
+    m_has_position = false;
+}
+
+void PathGuideRecorder::visit_vertex(
+    const PathVertex&       vertex,
+    const Spectrum&         path_radiance)
+{
+    // Record the direction sampled at the previous vertex. The learned distribution
+    // can't be used to sample specular directions, so they are not recorded.
+    if (m_has_position &&
+        m_record_count < MaxRecordCount &&
+        vertex.m_prev_mode != ScatteringMode::Specular &&
+        vertex.m_prev_sampling_prob > 0.0f)
+    {
+        Record& record = m_records[m_record_count++];
+        record.m_position = m_position;
+        record.m_direction = -Vector3f(vertex.m_outgoing.get_value());
+        record.m_prob = vertex.m_prev_sampling_prob;
+        record.m_throughput = vertex.m_throughput;
+        record.m_path_radiance = path_radiance;
+    }
+
+    m_has_position = false;
+}
+
+void PathGuideRecorder::leave_vertex(const PathVertex& vertex)
+{
+    // Only directions sampled from BSDFs are recorded.
+    if (vertex.m_bsdf)
+    {
+        m_position = Vector3f(vertex.get_point());
+        m_has_position = true;
+    }
+}
+
+void PathGuideRecorder::end_path(const Spectrum& path_radiance)
+{
+    for (size_t i = 0; i < m_record_count; ++i)
+    {
+        const Record& record = m_records[i];
+
+        // Estimate the incident radiance along the recorded direction.
+        float radiance = 0.0f;
+        for (size_t c = 0, e = path_radiance.size(); c < e; ++c)
+        {
+            if (record.m_throughput[c] > 0.0f)
+                radiance += (path_radiance[c] - record.m_path_radiance[c]) / record.m_throughput[c];
+        }
+        radiance /= path_radiance.size();
+
+        PathGuide::Sample sample;
+        sample.m_position = record.m_position;
+        sample.m_direction = record.m_direction;
+        sample.m_value = radiance / record.m_prob;
+        m_samples.push_back(sample);
+    }
+
+    m_record_count = 0;
+
+    if (m_samples.size() >= FlushThreshold)
+        m_path_guide.flush_sample_buffer(m_samples);
+}
+
+}   // namespace renderer
@@ -0,0 +1,217 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_PATHGUIDE_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_PATHGUIDE_H
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/lighting/sdtree.h"
+#include "renderer/kernel/rendering/ipasscallback.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/timers.h"
+#include "foundation/utility/stopwatch.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class JobQueue; }
+namespace renderer      { class Frame; }
+namespace renderer      { class PathVertex; }
+namespace renderer      { class Scene; }
+
+namespace renderer
+{
+
+//
+// Path guiding: learns the distribution of incident radiance in the scene over successive
+// rendering passes and allows path tracers to sample directions from it.
+//
+// Lighting engines record radiance samples into their own buffers, which are merged into
+// the SD-tree under a lock whenever they fill up. At the end of each pass, the radiance
+// learned during the pass becomes the sampling distribution of the next pass and the
+// SD-tree is refined.
+//
+
+class PathGuide
+  : public IPassCallback
+{
+  public:
+    struct Parameters
+    {
+        const float     m_bsdf_sampling_fraction;       // probability of sampling the BSDF rather than the learned distribution
+        const float     m_spatial_threshold;            // number of samples per pass above which a spatial cell is split
+        const float     m_directional_threshold;        // fraction of the energy above which a directional cell is split
+        const size_t    m_max_directional_depth;        // maximum depth of the directional quadtrees
+
+        explicit Parameters(const ParamArray& params);
+    };
+
+    // A radiance sample.
+    struct Sample
+    {
+        foundation::Vector3f    m_position;
+        foundation::Vector3f    m_direction;            // direction of the incoming light, pointing away from the position
+        float                   m_value;                // incident radiance divided by the probability density of the direction
+    };
+
+    typedef std::vector<Sample> SampleVector;
+
+    // Constructor.
+    PathGuide(
+        const Scene&                scene,
+        const ParamArray&           params);
+
+    // Delete this instance.
+    virtual void release() APPLESEED_OVERRIDE;
+
+    // This method is called at the beginning of a pass.
+    virtual void pre_render(
+        const Frame&                frame,
+        foundation::JobQueue&       job_queue,
+        foundation::IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE;
+
+    // This method is called at the end of a pass.
+    virtual void post_render(
+        const Frame&                frame,
+        foundation::JobQueue&       job_queue,
+        foundation::IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE;
+
+    // Return the probability of sampling the BSDF rather than the learned distribution.
+    float get_bsdf_sampling_fraction() const;
+
+    // Return the learned distribution of incident radiance at a given point,
+    // or 0 if nothing was learned there yet. Only valid during a pass.
+    const DTree* get_dtree(const foundation::Vector3d& point) const;
+
+    // Register or unregister a per-thread sample buffer. Samples left in a buffer
+    // are merged into the SD-tree when the buffer is unregistered and at the end
+    // of every pass.
+    void register_sample_buffer(SampleVector* buffer);
+    void unregister_sample_buffer(SampleVector* buffer);
+
+    // Merge the samples of a buffer into the SD-tree and clear the buffer.
+    void flush_sample_buffer(SampleVector& buffer);
+
+  private:
+    const Parameters                m_params;
+    boost::mutex                    m_mutex;
+    STree                           m_stree;
+    std::vector<SampleVector*>      m_sample_buffers;
+    size_t                          m_pass_number;
+    foundation::Stopwatch<foundation::DefaultWallclockTimer>
+                                    m_stopwatch;
+
+    void record_samples(SampleVector& buffer);
+};
+
+
+//
+// Records the radiance samples found along paths traced by a path tracer and hands
+// them over to a PathGuide.
+//
+// The incident radiance at a vertex along the sampled direction is estimated as the
+// radiance gathered by the rest of the path divided by the throughput of the path at
+// the next vertex.
+//
+
+class PathGuideRecorder
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor, registers the sample buffer of this recorder.
+    explicit PathGuideRecorder(PathGuide& path_guide);
+
+    // Destructor, unregisters the sample buffer of this recorder.
+    ~PathGuideRecorder();
+
+    // Start a new path.
+    void begin_path();
+
+    // Call when a vertex (including the environment) is reached, before the radiance
+    // found at this vertex is added to the path radiance.
+    void visit_vertex(
+        const PathVertex&           vertex,
+        const Spectrum&             path_radiance);
+
+    // Call once a surface vertex has been visited.
+    void leave_vertex(const PathVertex& vertex);
+
+    // Call once the path is complete.
+    void end_path(const Spectrum& path_radiance);
+
+  private:
+    enum { MaxRecordCount = 16, FlushThreshold = 16 * 1024 };
+
+    struct Record
+    {
+        foundation::Vector3f        m_position;
+        foundation::Vector3f        m_direction;
+        float                       m_prob;
+        Spectrum                    m_throughput;
+        Spectrum                    m_path_radiance;
+    };
+
+    PathGuide&                      m_path_guide;
+    PathGuide::SampleVector         m_samples;
+    Record                          m_records[MaxRecordCount];
+    size_t                          m_record_count;
+    bool                            m_has_position;
+    foundation::Vector3f            m_position;
+};
+
+
+//
+// PathGuide class implementation.
+//
+
+inline float PathGuide::get_bsdf_sampling_fraction() const
+{
+    return m_params.m_bsdf_sampling_fraction;
+}
+
+inline const DTree* PathGuide::get_dtree(const foundation::Vector3d& point) const
+{
+    const DTree& dtree = m_stree.find_leaf(foundation::Vector3f(point)).m_sampling;
+    return dtree.empty() ? 0 : &dtree;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_PATHGUIDE_H
@@ -34,6 +34,7 @@
 #include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/lighting/pathguide.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
 #include "renderer/kernel/lighting/subsurfacesampler.h"
@@ -80,7 +81,8 @@ class PathTracer
         const size_t            rr_min_path_length,
         const size_t            max_path_length,
         const size_t            max_iterations = 1000,
-        const double            near_start = 0.0);          // abort tracing if the first ray is shorter than this
+        const double            near_start = 0.0,           // abort tracing if the first ray is shorter than this
+        const PathGuide*        path_guide = 0);            // if set, sample directions according to the learned incident radiance
 
     size_t trace(
         SamplingContext&        sampling_context,
@@ -115,6 +117,14 @@ class PathTracer
     const size_t                m_max_path_length;
     const size_t                m_max_iterations;
     const double                m_near_start;
+    const PathGuide*            m_path_guide;
+
+    // Sample the BSDF, possibly guided by the learned distribution of incident radiance.
+    // Returns the probability density with which the incoming direction was chosen.
+    float sample_bsdf(
+        SamplingContext&        sampling_context,
+        const PathVertex&       vertex,
+        BSDFSample&             sample) const;
 
     // Determine whether a ray can pass through a surface with a given alpha value.
     static bool pass_through(
@@ -133,12 +143,14 @@ inline PathTracer<PathVisitor, Adjoint>::PathTracer(
     const size_t                rr_min_path_length,
     const size_t                max_path_length,
     const size_t                max_iterations,
-    const double                near_start)
+    const double                near_start,
+    const PathGuide*            path_guide)
   : m_path_visitor(path_visitor)
   , m_rr_min_path_length(rr_min_path_length)
   , m_max_path_length(max_path_length)
   , m_max_iterations(max_iterations)
   , m_near_start(near_start)
+  , m_path_guide(path_guide)
 {
 }
 
@@ -178,6 +190,7 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
     vertex.m_shading_point = &shading_point;
     vertex.m_prev_mode = ScatteringMode::Specular;
     vertex.m_prev_prob = BSDF::DiracDelta;
+    vertex.m_prev_sampling_prob = BSDF::DiracDelta;
 
     // This variable tracks the beginning of the path segment inside the current medium.
     // While it is properly initialized when entering a medium, we also initialize it
@@ -449,12 +462,7 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
         {
             // Sample the BSDF.
             BSDFSample sample(*vertex.m_shading_point, vertex.m_outgoing);
-            vertex.m_bsdf->sample(
-                sampling_context,
-                vertex.m_bsdf_data,
-                Adjoint,
-                true,       // multiply by |cos(incoming, normal)|
-                sample);
+            const float sampling_prob = sample_bsdf(sampling_context, vertex, sample);
 
             // Terminate the path if it gets absorbed.
             if (sample.m_mode == ScatteringMode::Absorption)
@@ -466,12 +474,15 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
 
             // Compute the path throughput multiplier.
             value = sample.m_value;
-            if (sample.m_probability != BSDF::DiracDelta)
-                value /= sample.m_probability;
+            if (sampling_prob != BSDF::DiracDelta)
+                value /= sampling_prob;
 
-            // Properties of this scattering event.
+            // Properties of this scattering event. Multiple importance sampling
+            // keeps using the BSDF probability density, which keeps the weights
+            // computed by the visitors consistent with light sampling.
             vertex.m_prev_mode = sample.m_mode;
             vertex.m_prev_prob = sample.m_probability;
+            vertex.m_prev_sampling_prob = sampling_prob;
 
             // Origin and direction of the scattered ray.
             parent_shading_point = vertex.m_shading_point;
@@ -505,6 +516,7 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
             // Properties of this scattering event.
             vertex.m_prev_mode = ScatteringMode::Diffuse;
             vertex.m_prev_prob = incoming_prob;
+            vertex.m_prev_sampling_prob = incoming_prob;
 
             // Origin of the scattered ray.
             parent_shading_point = vertex.m_incoming_point;
@@ -630,6 +642,120 @@ size_t PathTracer<PathVisitor, Adjoint>::trace(
     return vertex.m_path_length;
 }
 
+template <typename PathVisitor, bool Adjoint>
+float PathTracer<PathVisitor, Adjoint>::sample_bsdf(
+    SamplingContext&            sampling_context,
+    const PathVertex&           vertex,
+    BSDFSample&                 sample) const
+{
+    const DTree* dtree =
+        m_path_guide && !vertex.m_bsdf->is_purely_specular()
+            ? m_path_guide->get_dtree(vertex.get_point())
+            : 0;
+
+    if (dtree == 0)
+    {
+        vertex.m_bsdf->sample(
+            sampling_context,
+            vertex.m_bsdf_data,
+            Adjoint,
+            true,       // multiply by |cos(incoming, normal)|
+            sample);
+
+        return sample.m_probability;
+    }
+
+    // Pick either the BSDF or the learned distribution to sample the incoming direction.
+    const float bsdf_fraction = m_path_guide->get_bsdf_sampling_fraction();
+    sampling_context.split_in_place(1, 1);
+    const float s = sampling_context.next2<float>();
+
+    float guide_prob;
+
+    if (s < bsdf_fraction)
+    {
+        vertex.m_bsdf->sample(
+            sampling_context,
+            vertex.m_bsdf_data,
+            Adjoint,
+            true,       // multiply by |cos(incoming, normal)|
+            sample);
+
+        if (sample.m_mode == ScatteringMode::Absorption)
+            return 0.0f;
+
+        // Dirac directions can only be chosen by the BSDF.
+        if (sample.m_probability == BSDF::DiracDelta)
+        {
+            sample.m_value /= bsdf_fraction;
+            return BSDF::DiracDelta;
+        }
+
+        // BSDFs made of several closures or layers only return the value and the probability
+        // density of the component they sampled. The mixture needs the ones of the whole BSDF,
+        // consistent with the ones computed when the learned distribution is sampled.
+        const foundation::Vector3f incoming(sample.m_incoming.get_value());
+        const float bsdf_prob =
+            vertex.m_bsdf->evaluate(
+                vertex.m_bsdf_data,
+                Adjoint,
+                true,       // multiply by |cos(incoming, normal)|
+                sample.m_geometric_normal,
+                sample.m_shading_basis,
+                sample.m_outgoing.get_value(),
+                incoming,
+                ScatteringMode::Diffuse | ScatteringMode::Glossy,
+                sample.m_value);
+
+        if (bsdf_prob == 0.0f)
+        {
+            sample.m_mode = ScatteringMode::Absorption;
+            return 0.0f;
+        }
+
+        sample.m_probability = bsdf_prob;
+
+        guide_prob = dtree->evaluate_pdf(incoming);
+    }
+    else
+    {
+        sampling_context.split_in_place(2, 1);
+        const foundation::Vector3f incoming =
+            dtree->sample(sampling_context.next2<foundation::Vector2f>());
+
+        const float bsdf_prob =
+            vertex.m_bsdf->evaluate(
+                vertex.m_bsdf_data,
+                Adjoint,
+                true,       // multiply by |cos(incoming, normal)|
+                sample.m_geometric_normal,
+                sample.m_shading_basis,
+                sample.m_outgoing.get_value(),
+                incoming,
+                ScatteringMode::Diffuse | ScatteringMode::Glossy,
+                sample.m_value);
+
+        // The BSDF does not scatter light in this direction.
+        if (bsdf_prob == 0.0f)
+        {
+            sample.m_mode = ScatteringMode::Absorption;
+            return 0.0f;
+        }
+
+        sample.m_mode =
+            ScatteringMode::has_diffuse(vertex.m_bsdf->get_modes())
+                ? ScatteringMode::Diffuse
+                : ScatteringMode::Glossy;
+        sample.m_incoming = foundation::Dual3f(incoming);
+        sample.m_probability = bsdf_prob;
+
+        guide_prob = dtree->evaluate_pdf(incoming);
+    }
+
+    // One-sample model: the incoming direction was drawn from the mixture of both distributions.
+    return bsdf_fraction * sample.m_probability + (1.0f - bsdf_fraction) * guide_prob;
+}
+
 template <typename PathVisitor, bool Adjoint>
 inline bool PathTracer<PathVisitor, Adjoint>::pass_through(
     SamplingContext&            sampling_context,
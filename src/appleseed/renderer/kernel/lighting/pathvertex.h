@@ -91,6 +91,10 @@ class PathVertex
     ScatteringMode::Mode        m_prev_mode;
     float                       m_prev_prob;
 
+    // Probability density with which the last scattered direction was actually chosen.
+    // Differs from m_prev_prob when path guiding is used.
+    float                       m_prev_sampling_prob;
+
     // Constructor.
     explicit PathVertex(SamplingContext& sampling_context);
 
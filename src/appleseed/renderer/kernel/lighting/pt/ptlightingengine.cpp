@@ -36,6 +36,7 @@
 #include "renderer/kernel/aov/spectrumstack.h"
 #include "renderer/kernel/lighting/directlightingintegrator.h"
 #include "renderer/kernel/lighting/imagebasedlighting.h"
+#include "renderer/kernel/lighting/pathguide.h"
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
@@ -67,6 +68,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <memory>
 #include <string>
 
 // Forward declarations.
@@ -172,11 +174,15 @@ namespace
 
         PTLightingEngine(
             const LightSampler&     light_sampler,
+            PathGuide*              path_guide,
             const ParamArray&       params)
           : m_params(params)
           , m_light_sampler(light_sampler)
+          , m_path_guide(path_guide)
           , m_path_count(0)
         {
+            if (m_path_guide)
+                m_path_guide_recorder.reset(new PathGuideRecorder(*m_path_guide));
         }
 
         virtual void release() APPLESEED_OVERRIDE
@@ -227,13 +233,19 @@ namespace
                 shading_context,
                 shading_point.get_scene(),
                 radiance,
-                aovs);
+                aovs,
+                m_path_guide_recorder.get());
 
             PathTracer<PathVisitor, false> path_tracer(     // false = not adjoint
                 path_visitor,
                 m_params.m_rr_min_path_length,
                 m_params.m_max_path_length,
-                shading_context.get_max_iterations());
+                shading_context.get_max_iterations(),
+                0.0,
+                m_path_guide);
+
+            if (m_path_guide_recorder.get())
+                m_path_guide_recorder->begin_path();
 
             const size_t path_length =
                 path_tracer.trace(
@@ -241,6 +253,9 @@ namespace
                     shading_context,
                     shading_point);
 
+            if (m_path_guide_recorder.get())
+                m_path_guide_recorder->end_path(radiance);
+
             // Update statistics.
             ++m_path_count;
             m_path_length.insert(path_length);
@@ -258,6 +273,8 @@ namespace
       private:
         const Parameters                m_params;
         const LightSampler&             m_light_sampler;
+        PathGuide*                      m_path_guide;
+        auto_ptr<PathGuideRecorder>     m_path_guide_recorder;
 
         uint64                          m_path_count;
         Population<uint64>              m_path_length;
@@ -276,6 +293,7 @@ namespace
             const EnvironmentEDF*       m_env_edf;
             Spectrum&                   m_path_radiance;
             SpectrumStack&              m_path_aovs;
+            PathGuideRecorder*          m_path_guide_recorder;
             bool                        m_omit_emitted_light;   // todo: get rid of this
 
             PathVisitorBase(
@@ -285,7 +303,8 @@ namespace
                 const ShadingContext&   shading_context,
                 const Scene&            scene,
                 Spectrum&               path_radiance,
-                SpectrumStack&          path_aovs)
+                SpectrumStack&          path_aovs,
+                PathGuideRecorder*      path_guide_recorder)
               : m_params(params)
               , m_light_sampler(light_sampler)
               , m_sampling_context(sampling_context)
@@ -294,10 +313,23 @@ namespace
               , m_env_edf(scene.get_environment()->get_environment_edf())
               , m_path_radiance(path_radiance)
               , m_path_aovs(path_aovs)
+              , m_path_guide_recorder(path_guide_recorder)
               , m_omit_emitted_light(false)
             {
             }
 
+            void begin_vertex(const PathVertex& vertex)
+            {
+                if (m_path_guide_recorder)
+                    m_path_guide_recorder->visit_vertex(vertex, m_path_radiance);
+            }
+
+            void end_vertex(const PathVertex& vertex)
+            {
+                if (m_path_guide_recorder)
+                    m_path_guide_recorder->leave_vertex(vertex);
+            }
+
             bool accept_scattering(
                 const ScatteringMode::Mode  prev_mode,
                 const ScatteringMode::Mode  next_mode)
@@ -335,7 +367,8 @@ namespace
                 const ShadingContext&   shading_context,
                 const Scene&            scene,
                 Spectrum&               path_radiance,
-                SpectrumStack&          path_aovs)
+                SpectrumStack&          path_aovs,
+                PathGuideRecorder*      path_guide_recorder)
               : PathVisitorBase(
                     params,
                     light_sampler,
@@ -343,12 +376,15 @@ namespace
                     shading_context,
                     scene,
                     path_radiance,
-                    path_aovs)
+                    path_aovs,
+                    path_guide_recorder)
             {
             }
 
             void visit_vertex(const PathVertex& vertex)
             {
+                begin_vertex(vertex);
+
                 if ((!m_omit_emitted_light || m_params.m_enable_caustics) &&
                     vertex.m_edf &&
                     vertex.m_cos_on > 0.0 &&
@@ -367,12 +403,16 @@ namespace
                     m_path_radiance += emitted_radiance;
                     m_path_aovs.add(vertex.m_edf->get_render_layer_index(), emitted_radiance);
                 }
+
+                end_vertex(vertex);
             }
 
             void visit_environment(const PathVertex& vertex)
             {
                 assert(vertex.m_prev_mode != ScatteringMode::Absorption);
 
+                begin_vertex(vertex);
+
                 // Can't look up the environment if there's no environment EDF.
                 if (m_env_edf == 0)
                     return;
@@ -415,7 +455,8 @@ namespace
                 const ShadingContext&   shading_context,
                 const Scene&            scene,
                 Spectrum&               path_radiance,
-                SpectrumStack&          path_aovs)
+                SpectrumStack&          path_aovs,
+                PathGuideRecorder*      path_guide_recorder)
               : PathVisitorBase(
                     params,
                     light_sampler,
@@ -423,13 +464,16 @@ namespace
                     shading_context,
                     scene,
                     path_radiance,
-                    path_aovs)
+                    path_aovs,
+                    path_guide_recorder)
               , m_is_indirect_lighting(false)
             {
             }
 
             void visit_vertex(const PathVertex& vertex)
             {
+                begin_vertex(vertex);
+
                 // Any light contribution after a diffuse or glossy bounce is considered indirect.
                 if (ScatteringMode::has_diffuse_or_glossy(vertex.m_prev_mode))
                     m_is_indirect_lighting = true;
@@ -513,6 +557,8 @@ namespace
                 // Update path radiance.
                 m_path_radiance += vertex_radiance;
                 m_path_aovs += vertex_aovs;
+
+                end_vertex(vertex);
             }
 
             void add_direct_lighting_contribution_bsdf(
@@ -783,6 +829,8 @@ namespace
             {
                 assert(vertex.m_prev_mode != ScatteringMode::Absorption);
 
+                begin_vertex(vertex);
+
                 // Can't look up the environment if there's no environment EDF.
                 if (m_env_edf == 0)
                     return;
@@ -855,9 +903,11 @@ namespace
 
 PTLightingEngineFactory::PTLightingEngineFactory(
     const LightSampler& light_sampler,
-    const ParamArray&   params)
+    const ParamArray&   params,
+    PathGuide*          path_guide)
   : m_light_sampler(light_sampler)
   , m_params(params)
+  , m_path_guide(path_guide)
 {
     PTLightingEngine::Parameters(params).print();
 }
@@ -869,7 +919,7 @@ void PTLightingEngineFactory::release()
 
 ILightingEngine* PTLightingEngineFactory::create()
 {
-    return new PTLightingEngine(m_light_sampler, m_params);
+    return new PTLightingEngine(m_light_sampler, m_path_guide, m_params);
 }
 
 Dictionary PTLightingEngineFactory::get_params_metadata()
@@ -930,6 +980,24 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "Max Ray Intensity")
             .insert("help", "Clamp intensity of rays (after the first bounce) to this value to reduce fireflies"));
 
+    metadata.dictionaries().insert(
+        "enable_path_guiding",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Path Guiding")
+            .insert("help", "Learn the distribution of incident light over successive passes and use it to guide paths"));
+
+    metadata.dictionaries().insert(
+        "path_guiding_bsdf_fraction",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.5")
+            .insert("min", "0.05")
+            .insert("max", "1.0")
+            .insert("label", "Path Guiding BSDF Fraction")
+            .insert("help", "Probability of sampling the BSDF rather than the learned distribution of incident light"));
+
     return metadata;
 }
 
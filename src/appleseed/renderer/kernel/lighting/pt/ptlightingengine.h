@@ -40,6 +40,7 @@
 // Forward declarations.
 namespace foundation    { class Dictionary; }
 namespace renderer      { class LightSampler; }
+namespace renderer      { class PathGuide; }
 
 namespace renderer
 {
@@ -55,7 +56,8 @@ class PTLightingEngineFactory
     // Constructor.
     PTLightingEngineFactory(
         const LightSampler& light_sampler,
-        const ParamArray&   params);
+        const ParamArray&   params,
+        PathGuide*          path_guide = 0);        // optional, enables path guiding
 
     // Delete this instance.
     virtual void release() APPLESEED_OVERRIDE;
@@ -69,6 +71,7 @@ class PTLightingEngineFactory
   private:
     const LightSampler&     m_light_sampler;
     ParamArray              m_params;
+    PathGuide*              m_path_guide;
 };
 
 }       // namespace renderer
@@ -0,0 +1,372 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sdtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Largest float smaller than 1.
+    const float OneMinusEpsilon = 0.99999994f;
+
+    // Select the quadrant containing a point of the unit square
+    // and express the point in the coordinates of this quadrant.
+    size_t select_quadrant(Vector2f& p)
+    {
+        const size_t x = p[0] >= 0.5f ? 1 : 0;
+        const size_t y = p[1] >= 0.5f ? 1 : 0;
+
+        p[0] = min(2.0f * p[0] - x, OneMinusEpsilon);
+        p[1] = min(2.0f * p[1] - y, OneMinusEpsilon);
+
+        return x + 2 * y;
+    }
+
+    // Choose between two options with a probability proportional to their weights
+    // and rescale the uniform sample s so that it can be reused.
+    size_t choose(const float w0, const float w1, float& s)
+    {
+        const float p0 = w0 / (w0 + w1);
+
+        if (s < p0)
+        {
+            s = min(s / p0, OneMinusEpsilon);
+            return 0;
+        }
+        else
+        {
+            s = min((s - p0) / (1.0f - p0), OneMinusEpsilon);
+            return 1;
+        }
+    }
+}
+
+
+//
+// DTree class implementation.
+//
+
+DTree::DTree()
+  : m_nodes(1)
+  , m_sample_weight(0.0f)
+{
+}
+
+void DTree::record(
+    const Vector3f&     direction,
+    const float         value)
+{
+    m_sample_weight += 1.0f;
+
+    // Discard invalid values, but keep counting the samples.
+    if (!(value > 0.0f) || value == numeric_limits<float>::infinity())
+        return;
+
+    Vector2f p = direction_to_square(direction);
+    size_t node_index = 0;
+
+    while (true)
+    {
+        Node& node = m_nodes[node_index];
+        const size_t quadrant = select_quadrant(p);
+
+        node.m_sum[quadrant] += value;
+
+        if (node.m_child[quadrant] == 0)
+            break;
+
+        node_index = node.m_child[quadrant];
+    }
+}
+
+Vector3f DTree::sample(const Vector2f& s) const
+{
+    assert(!empty());
+
+    Vector2f u = s;
+    Vector2f origin(0.0f);
+    float size = 1.0f;
+    size_t node_index = 0;
+
+    while (true)
+    {
+        const Node& node = m_nodes[node_index];
+
+        // Choose a column (left or right), then a quadrant within this column.
+        const size_t x = choose(node.m_sum[0] + node.m_sum[2], node.m_sum[1] + node.m_sum[3], u[0]);
+        const size_t y = choose(node.m_sum[x], node.m_sum[x + 2], u[1]);
+        const size_t quadrant = x + 2 * y;
+
+        size *= 0.5f;
+        origin[0] += x * size;
+        origin[1] += y * size;
+
+        if (node.m_child[quadrant] == 0)
+            break;
+
+        node_index = node.m_child[quadrant];
+    }
+
+    // Sample the leaf quadrant uniformly.
+    const Vector2f p(
+        min(origin[0] + u[0] * size, OneMinusEpsilon),
+        min(origin[1] + u[1] * size, OneMinusEpsilon));
+
+    return square_to_direction(p);
+}
+
+float DTree::evaluate_pdf(const Vector3f& direction) const
+{
+    if (empty())
+        return RcpFourPi<float>();
+
+    Vector2f p = direction_to_square(direction);
+    float pdf = RcpFourPi<float>();
+    size_t node_index = 0;
+
+    while (true)
+    {
+        const Node& node = m_nodes[node_index];
+        const size_t quadrant = select_quadrant(p);
+
+        const float sum = node.m_sum[quadrant];
+        if (sum <= 0.0f)
+            return 0.0f;
+
+        pdf *= 4.0f * sum / node.get_sum();
+
+        if (node.m_child[quadrant] == 0)
+            break;
+
+        node_index = node.m_child[quadrant];
+    }
+
+    return pdf;
+}
+
+void DTree::reset(
+    const DTree&        source,
+    const float         subdivision_threshold,
+    const size_t        max_depth)
+{
+    m_nodes.assign(1, Node());
+    m_sample_weight = 0.0f;
+
+    const Node& root = source.m_nodes[0];
+    const float total = root.get_sum();
+
+    if (total > 0.0f)
+    {
+        build_node(
+            source,
+            0,
+            root.m_sum,
+            0,
+            total,
+            subdivision_threshold,
+            1,
+            max_depth);
+    }
+}
+
+void DTree::build_node(
+    const DTree&        source,
+    const size_t        source_index,
+    const float         sums[4],
+    const size_t        node_index,
+    const float         total,
+    const float         subdivision_threshold,
+    const size_t        depth,
+    const size_t        max_depth)
+{
+    if (depth >= max_depth)
+        return;
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        if (sums[i] <= subdivision_threshold * total)
+            continue;
+
+        // Retrieve the energy of the four children of this quadrant. Quadrants that were
+        // leaves in the source tree are assumed to have a uniform energy distribution.
+        const size_t source_child =
+            source_index != ~size_t(0) && source.m_nodes[source_index].m_child[i] != 0
+                ? source.m_nodes[source_index].m_child[i]
+                : ~size_t(0);
+        float child_sums[4];
+        for (size_t j = 0; j < 4; ++j)
+        {
+            child_sums[j] =
+                source_child != ~size_t(0)
+                    ? source.m_nodes[source_child].m_sum[j]
+                    : 0.25f * sums[i];
+        }
+
+        // Subdivide this quadrant.
+        const size_t child_index = m_nodes.size();
+        m_nodes.push_back(Node());
+        m_nodes[node_index].m_child[i] = static_cast<uint32>(child_index);
+
+        build_node(
+            source,
+            source_child,
+            child_sums,
+            child_index,
+            total,
+            subdivision_threshold,
+            depth + 1,
+            max_depth);
+    }
+}
+
+Vector2f DTree::direction_to_square(const Vector3f& direction)
+{
+    const float cos_theta = clamp(direction[2], -1.0f, 1.0f);
+
+    float phi = atan2(direction[1], direction[0]);
+    if (phi < 0.0f)
+        phi += TwoPi<float>();
+
+    return
+        Vector2f(
+            min(0.5f * (cos_theta + 1.0f), OneMinusEpsilon),
+            min(phi * RcpTwoPi<float>(), OneMinusEpsilon));
+}
+
+Vector3f DTree::square_to_direction(const Vector2f& p)
+{
+    const float cos_theta = 2.0f * p[0] - 1.0f;
+    const float sin_theta = sqrt(max(1.0f - cos_theta * cos_theta, 0.0f));
+    const float phi = TwoPi<float>() * p[1];
+
+    return
+        Vector3f(
+            sin_theta * cos(phi),
+            sin_theta * sin(phi),
+            cos_theta);
+}
+
+
+//
+// STree class implementation.
+//
+
+STree::STree(const AABB3f& bbox)
+  : m_nodes(1)
+  , m_leaves(1)
+{
+    // Use a cubic bounding box so that subdivisions along successive axes
+    // produce cells of similar extents.
+    const Vector3f center = bbox.center();
+    const float half_extent = 0.5f * max(max_value(bbox.extent()), 1.0e-6f) * 1.001f;
+
+    m_origin = center - Vector3f(half_extent);
+    m_rcp_extent = Vector3f(0.5f / half_extent);
+
+    m_nodes[0].m_child[0] = m_nodes[0].m_child[1] = 0;
+    m_nodes[0].m_leaf = 0;
+    m_nodes[0].m_axis = 0;
+}
+
+size_t STree::find_leaf_index(const Vector3f& point) const
+{
+    Vector3f p;
+    for (size_t i = 0; i < 3; ++i)
+        p[i] = clamp((point[i] - m_origin[i]) * m_rcp_extent[i], 0.0f, OneMinusEpsilon);
+
+    size_t node_index = 0;
+
+    while (m_nodes[node_index].m_child[0] != 0)
+    {
+        const Node& node = m_nodes[node_index];
+        const size_t axis = node.m_axis;
+
+        if (p[axis] < 0.5f)
+        {
+            p[axis] = 2.0f * p[axis];
+            node_index = node.m_child[0];
+        }
+        else
+        {
+            p[axis] = 2.0f * p[axis] - 1.0f;
+            node_index = node.m_child[1];
+        }
+    }
+
+    return m_nodes[node_index].m_leaf;
+}
+
+void STree::refine(const float subdivision_threshold)
+{
+    assert(subdivision_threshold > 0.0f);
+
+    // Nodes created by a split are visited as well since they are appended to the node vector.
+    for (size_t node_index = 0; node_index < m_nodes.size(); ++node_index)
+    {
+        if (m_nodes[node_index].m_child[0] != 0)
+            continue;
+
+        const size_t leaf_index = m_nodes[node_index].m_leaf;
+        if (m_leaves[leaf_index].m_building.get_sample_weight() <= subdivision_threshold)
+            continue;
+
+        // Both halves inherit the D-trees of the parent and half of its samples.
+        m_leaves[leaf_index].m_building.scale_sample_weight(0.5f);
+        const Leaf leaf = m_leaves[leaf_index];
+        const size_t new_leaf_index = m_leaves.size();
+        m_leaves.push_back(leaf);
+
+        const uint8 child_axis = static_cast<uint8>((m_nodes[node_index].m_axis + 1) % 3);
+        for (size_t i = 0; i < 2; ++i)
+        {
+            Node child;
+            child.m_child[0] = child.m_child[1] = 0;
+            child.m_leaf = static_cast<uint32>(i == 0 ? leaf_index : new_leaf_index);
+            child.m_axis = child_axis;
+            m_nodes[node_index].m_child[i] = static_cast<uint32>(m_nodes.size());
+            m_nodes.push_back(child);
+        }
+    }
+}
+
+}   // namespace renderer
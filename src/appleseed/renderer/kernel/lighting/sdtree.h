@@ -0,0 +1,244 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_SDTREE_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_SDTREE_H
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// Spatial-directional tree (SD-tree) used to learn the distribution of incident radiance
+// for path guiding.
+//
+// A binary tree partitions space (the S-tree); each of its leaves holds a quadtree over
+// the sphere of directions (a D-tree). Directions are mapped to the unit square using the
+// cylindrical equal-area mapping, so that D-tree densities are simply scaled by 1/(4*Pi).
+//
+// Every leaf of the S-tree holds two D-trees: one that is being built from the radiance
+// samples of the current pass, and one built during the previous pass that is used for
+// sampling. Both only change between passes.
+//
+// Reference:
+//
+//   Thomas Mueller, Markus Gross, Jan Novak, Practical Path Guiding for Efficient
+//   Light-Transport Simulation, Computer Graphics Forum 36(4), 2017.
+//
+
+class DTree
+{
+  public:
+    // Constructor, builds a tree with a single level and no samples.
+    DTree();
+
+    // Return the number of nodes in the tree.
+    size_t get_node_count() const;
+
+    // Return the number of samples recorded into the tree.
+    float get_sample_weight() const;
+
+    // Scale the number of samples recorded into the tree.
+    void scale_sample_weight(const float factor);
+
+    // Return true if no energy was recorded into the tree.
+    bool empty() const;
+
+    // Record a radiance sample. The value is the incident radiance divided by the
+    // probability density with which the direction was sampled.
+    void record(
+        const foundation::Vector3f&     direction,      // world space direction, unit-length
+        const float                     value);
+
+    // Sample a direction proportionally to the recorded energy. The tree must not be empty.
+    foundation::Vector3f sample(const foundation::Vector2f& s) const;
+
+    // Return the probability density (with respect to solid angle) of a direction.
+    float evaluate_pdf(const foundation::Vector3f& direction) const;
+
+    // Make this tree an empty tree whose structure adapts to the energy recorded into
+    // another one: quadrants holding more than a given fraction of the total energy
+    // are subdivided, the others are collapsed.
+    void reset(
+        const DTree&                    source,
+        const float                     subdivision_threshold,
+        const size_t                    max_depth);
+
+    // Map a direction to the unit square and back.
+    static foundation::Vector2f direction_to_square(const foundation::Vector3f& direction);
+    static foundation::Vector3f square_to_direction(const foundation::Vector2f& p);
+
+  private:
+    struct Node
+    {
+        float                   m_sum[4];           // energy recorded into each quadrant
+        foundation::uint32      m_child[4];         // index of the child node of each quadrant, 0 for leaves
+
+        Node();
+
+        float get_sum() const;
+    };
+
+    std::vector<Node>           m_nodes;
+    float                       m_sample_weight;
+
+    void build_node(
+        const DTree&                    source,
+        const size_t                    source_index,
+        const float                     sums[4],
+        const size_t                    node_index,
+        const float                     total,
+        const float                     subdivision_threshold,
+        const size_t                    depth,
+        const size_t                    max_depth);
+};
+
+class STree
+{
+  public:
+    struct Leaf
+    {
+        DTree                   m_building;
+        DTree                   m_sampling;
+    };
+
+    // Constructor, builds a tree with a single leaf covering a given bounding box.
+    explicit STree(const foundation::AABB3f& bbox);
+
+    // Return the number of leaves in the tree.
+    size_t get_leaf_count() const;
+
+    // Access the i'th leaf.
+    Leaf& get_leaf(const size_t i);
+    const Leaf& get_leaf(const size_t i) const;
+
+    // Return the leaf containing a given point. Points outside of the tree's bounding box
+    // are clamped to it.
+    Leaf& find_leaf(const foundation::Vector3f& point);
+    const Leaf& find_leaf(const foundation::Vector3f& point) const;
+
+    // Split the leaves in which more than a given number of samples was recorded.
+    // Each half inherits the D-trees of its parent and half of its samples.
+    void refine(const float subdivision_threshold);
+
+  private:
+    struct Node
+    {
+        foundation::uint32      m_child[2];         // index of the children, 0 for leaves
+        foundation::uint32      m_leaf;             // index of the leaf, for leaves
+        foundation::uint8       m_axis;             // splitting axis
+    };
+
+    foundation::Vector3f        m_origin;
+    foundation::Vector3f        m_rcp_extent;
+    std::vector<Node>           m_nodes;
+    std::vector<Leaf>           m_leaves;
+
+    size_t find_leaf_index(const foundation::Vector3f& point) const;
+};
+
+
+//
+// DTree class implementation.
+//
+
+inline size_t DTree::get_node_count() const
+{
+    return m_nodes.size();
+}
+
+inline float DTree::get_sample_weight() const
+{
+    return m_sample_weight;
+}
+
+inline void DTree::scale_sample_weight(const float factor)
+{
+    m_sample_weight *= factor;
+}
+
+inline bool DTree::empty() const
+{
+    return !(m_nodes[0].get_sum() > 0.0f);
+}
+
+inline DTree::Node::Node()
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        m_sum[i] = 0.0f;
+        m_child[i] = 0;
+    }
+}
+
+inline float DTree::Node::get_sum() const
+{
+    return m_sum[0] + m_sum[1] + m_sum[2] + m_sum[3];
+}
+
+
+//
+// STree class implementation.
+//
+
+inline size_t STree::get_leaf_count() const
+{
+    return m_leaves.size();
+}
+
+inline STree::Leaf& STree::get_leaf(const size_t i)
+{
+    return m_leaves[i];
+}
+
+inline const STree::Leaf& STree::get_leaf(const size_t i) const
+{
+    return m_leaves[i];
+}
+
+inline STree::Leaf& STree::find_leaf(const foundation::Vector3f& point)
+{
+    return m_leaves[find_leaf_index(point)];
+}
+
+inline const STree::Leaf& STree::find_leaf(const foundation::Vector3f& point) const
+{
+    return m_leaves[find_leaf_index(point)];
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_SDTREE_H
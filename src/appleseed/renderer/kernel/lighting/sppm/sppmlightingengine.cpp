@@ -40,6 +40,8 @@
 #include "renderer/kernel/lighting/sppm/sppmpasscallback.h"
 #include "renderer/kernel/lighting/sppm/sppmphoton.h"
 #include "renderer/kernel/lighting/sppm/sppmphotonmap.h"
+#include "renderer/kernel/lighting/sppm/sppmpixelstatistics.h"
+#include "renderer/kernel/rendering/pixelcontext.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/modeling/bsdf/bsdf.h"
@@ -65,7 +67,6 @@
 #include <cstddef>
 
 // Forward declarations.
-namespace renderer  { class PixelContext; }
 namespace renderer  { class TextureCache; }
 
 using namespace foundation;
@@ -126,7 +127,7 @@ namespace
     {
       public:
         SPPMLightingEngine(
-            const SPPMPassCallback& pass_callback,
+            SPPMPassCallback&       pass_callback,
             const LightSampler&     light_sampler,
             const SPPMParameters&   params)
           : m_params(params)
@@ -159,8 +160,10 @@ namespace
             PathVisitor path_visitor(
                 m_params,
                 m_pass_callback,
+                m_pass_callback.get_pixel_statistics(),
                 m_light_sampler,
                 sampling_context,
+                pixel_context,
                 shading_context,
                 shading_point.get_scene(),
                 m_answer,
@@ -195,7 +198,7 @@ namespace
 
       private:
         const SPPMParameters            m_params;
-        const SPPMPassCallback&         m_pass_callback;
+        SPPMPassCallback&               m_pass_callback;
         const LightSampler&             m_light_sampler;
         uint64                          m_path_count;
         Population<uint64>              m_path_length;
@@ -205,20 +208,25 @@ namespace
         {
             const SPPMParameters&       m_params;
             const SPPMPassCallback&     m_pass_callback;
+            SPPMPixelStatistics*        m_pixel_statistics;
             const LightSampler&         m_light_sampler;
             SamplingContext&            m_sampling_context;
+            const PixelContext&         m_pixel_context;
             const ShadingContext&       m_shading_context;
             TextureCache&               m_texture_cache;
             const EnvironmentEDF*       m_env_edf;
             knn::Answer<float>&         m_answer;
             Spectrum&                   m_path_radiance;
             SpectrumStack&              m_path_aovs;
+            bool                        m_visible_point_found;
 
             PathVisitor(
                 const SPPMParameters&   params,
                 const SPPMPassCallback& pass_callback,
+                SPPMPixelStatistics*    pixel_statistics,
                 const LightSampler&     light_sampler,
                 SamplingContext&        sampling_context,
+                const PixelContext&     pixel_context,
                 const ShadingContext&   shading_context,
                 const Scene&            scene,
                 knn::Answer<float>&     answer,
@@ -226,14 +234,17 @@ namespace
                 SpectrumStack&          path_aovs)
               : m_params(params)
               , m_pass_callback(pass_callback)
+              , m_pixel_statistics(pixel_statistics)
               , m_light_sampler(light_sampler)
               , m_sampling_context(sampling_context)
+              , m_pixel_context(pixel_context)
               , m_shading_context(shading_context)
               , m_texture_cache(shading_context.get_texture_cache())
               , m_env_edf(scene.get_environment()->get_environment_edf())
               , m_answer(answer)
               , m_path_radiance(path_radiance)
               , m_path_aovs(path_aovs)
+              , m_visible_point_found(false)
             {
             }
 
@@ -349,12 +360,18 @@ namespace
                 if (photon_map.empty())
                     return;
 
+                // The first lookup of the path, at its visible point, uses the radius of the pixel.
+                const bool use_pixel_radius = m_pixel_statistics != 0 && !m_visible_point_found;
+                m_visible_point_found = true;
+
                 const Vector3f point(vertex.get_point());
-                const float radius = m_pass_callback.get_lookup_radius();
+                const float radius =
+                    use_pixel_radius
+                        ? m_pixel_statistics->get_radius(m_pixel_context.get_pixel_coords())
+                        : m_pass_callback.get_lookup_radius();
 
                 // Find the nearby photons around the path vertex.
-                const knn::Query3f query(photon_map, m_answer);
-                query.run(point, radius * radius);
+                photon_map.find_photons(point, radius * radius, m_answer);
                 const size_t photon_count = m_answer.size();
 
                 // Compute the square radius of the lookup disk.
@@ -373,6 +390,15 @@ namespace
                 }
                 const float rcp_max_square_dist = 1.0f / max_square_dist;
 
+                // Let the pixel radius shrink according to the photons found within the lookup disk.
+                if (use_pixel_radius)
+                {
+                    m_pixel_statistics->record_lookup(
+                        m_pixel_context.get_pixel_coords(),
+                        photon_count,
+                        max_square_dist);
+                }
+
                 // Accumulate photons contributions.
                 Spectrum indirect_radiance;
                 if (m_params.m_photon_type == SPPMParameters::Monochromatic)
@@ -601,11 +627,10 @@ namespace
             Spectrum&               radiance)
         {
             const SPPMPhotonMap& photon_map = m_pass_callback.get_photon_map();
-            const knn::Query3f query(photon_map, m_answer);
-
-            query.run(
+            photon_map.find_photons(
                 Vector3f(shading_point.get_point()),
-                square(m_params.m_view_photons_radius));
+                square(m_params.m_view_photons_radius),
+                m_answer);
 
             radiance.set(0.0f);
 
@@ -643,7 +668,7 @@ namespace
 //
 
 SPPMLightingEngineFactory::SPPMLightingEngineFactory(
-    const SPPMPassCallback&     pass_callback,
+    SPPMPassCallback&           pass_callback,
     const LightSampler&         light_sampler,
     const SPPMParameters&       params)
   : m_pass_callback(pass_callback)
@@ -797,6 +822,36 @@ Dictionary SPPMLightingEngineFactory::get_params_metadata()
             .insert("label", "Max Photons per Estimate")
             .insert("help", "Maximum number of photons used to estimate radiance"));
 
+    metadata.dictionaries().insert(
+        "per_pixel_radius",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "true")
+            .insert("label", "Per-Pixel Radius")
+            .insert("help", "Shrink the lookup radius of each pixel according to the photons it gathers"));
+
+    metadata.dictionaries().insert(
+        "photon_map",
+        Dictionary()
+            .insert("type", "enum")
+            .insert("values", "kdtree|hashgrid")
+            .insert("default", "kdtree")
+            .insert("label", "Photon Map")
+            .insert("help", "Acceleration structure used to look up photons")
+            .insert(
+                "options",
+                Dictionary()
+                    .insert(
+                        "kdtree",
+                        Dictionary()
+                            .insert("label", "Kd-Tree")
+                            .insert("help", "Kd-tree, adapts to the photon density"))
+                    .insert(
+                        "hashgrid",
+                        Dictionary()
+                            .insert("label", "Hash Grid")
+                            .insert("help", "Hashed uniform grid, faster to build"))));
+
     metadata.dictionaries().insert(
         "alpha",
         Dictionary()
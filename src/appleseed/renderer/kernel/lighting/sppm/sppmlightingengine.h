@@ -55,7 +55,7 @@ class SPPMLightingEngineFactory
   public:
     // Constructor.
     SPPMLightingEngineFactory(
-        const SPPMPassCallback&     pass_callback,
+        SPPMPassCallback&           pass_callback,
         const LightSampler&         light_sampler,
         const SPPMParameters&       params);
 
@@ -70,7 +70,7 @@ class SPPMLightingEngineFactory
 
   private:
     const SPPMParameters            m_params;
-    const SPPMPassCallback&         m_pass_callback;
+    SPPMPassCallback&               m_pass_callback;
     const LightSampler&             m_light_sampler;
 };
 
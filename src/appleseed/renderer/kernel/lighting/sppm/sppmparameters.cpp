@@ -88,6 +88,23 @@ namespace
             value == "rt" ? SPPMParameters::RayTraced :
             SPPMParameters::Off;
     }
+
+    SPPMParameters::PhotonMapType get_photon_map_type(
+        const ParamArray&   params,
+        const char*         name,
+        const char*         default_value)
+    {
+        const string value =
+            params.get_optional<string>(
+                name,
+                default_value,
+                make_vector("kdtree", "hashgrid"));
+
+        return
+            value == "kdtree"
+                ? SPPMParameters::KdTree
+                : SPPMParameters::HashGrid;
+    }
 }
 
 SPPMParameters::SPPMParameters(const ParamArray& params)
@@ -108,6 +125,8 @@ SPPMParameters::SPPMParameters(const ParamArray& params)
   , m_initial_radius_percents(params.get_optional<float>("initial_radius", 0.1f))
   , m_alpha(params.get_optional<float>("alpha", 0.7f))
   , m_max_photons_per_estimate(params.get_optional<size_t>("max_photons_per_estimate", 100))
+  , m_photon_map_type(get_photon_map_type(params, "photon_map", "kdtree"))
+  , m_per_pixel_radius(params.get_optional<bool>("per_pixel_radius", true))
   , m_dl_light_sample_count(params.get_optional<float>("dl_light_samples", 1.0))
   , m_view_photons(params.get_optional<bool>("view_photons", false))
   , m_view_photons_radius(params.get_optional<float>("view_photons_radius", 1.0e-3f))
@@ -148,13 +167,17 @@ void SPPMParameters::print() const
         "  rr min path len. %s\n"
         "  initial radius   %s%%\n"
         "  alpha            %s\n"
+        "  per-pixel radius %s\n"
         "  max photons/est. %s\n"
+        "  photon map       %s\n"
         "  dl light samples %s",
         m_path_tracing_max_path_length == size_t(~0) ? "infinite" : pretty_uint(m_path_tracing_max_path_length).c_str(),
         m_path_tracing_rr_min_path_length == size_t(~0) ? "infinite" : pretty_uint(m_path_tracing_rr_min_path_length).c_str(),
         pretty_scalar(m_initial_radius_percents, 3).c_str(),
         pretty_scalar(m_alpha, 1).c_str(),
+        m_per_pixel_radius ? "on" : "off",
         pretty_uint(m_max_photons_per_estimate).c_str(),
+        m_photon_map_type == KdTree ? "kd-tree" : "hash grid",
         pretty_scalar(m_dl_light_sample_count).c_str());
 }
 
@@ -46,6 +46,7 @@ struct SPPMParameters
 {
     enum PhotonType { Monochromatic, Polychromatic };
     enum Mode { RayTraced, SPPM, Off };
+    enum PhotonMapType { KdTree, HashGrid };
 
     const SamplingContext::Mode m_sampling_mode;
     const PhotonType            m_photon_type;
@@ -70,6 +71,8 @@ struct SPPMParameters
     const float                 m_initial_radius_percents;              // initial lookup radius as a percentage of the scene diameter
     const float                 m_alpha;                                // radius shrinking control
     const size_t                m_max_photons_per_estimate;             // maximum number of photons per density estimation
+    const PhotonMapType         m_photon_map_type;                      // acceleration structure used for photon lookups
+    const bool                  m_per_pixel_radius;                     // does each pixel have its own lookup radius?
     const float                 m_dl_light_sample_count;                // number of light samples used to estimate direct illumination in ray traced mode
     float                       m_rcp_dl_light_sample_count;
 
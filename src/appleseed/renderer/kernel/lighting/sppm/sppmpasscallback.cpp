@@ -33,9 +33,12 @@
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
+#include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/scene/scene.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
 #include "foundation/math/hash.h"
 #include "foundation/utility/job/iabortswitch.h"
 #include "foundation/utility/string.h"
@@ -82,6 +85,7 @@ SPPMPassCallback::SPPMPassCallback(
 
     // Start with the initial lookup radius.
     m_lookup_radius = m_initial_lookup_radius;
+    m_average_pixel_radius = m_initial_lookup_radius;
 }
 
 void SPPMPassCallback::release()
@@ -94,12 +98,32 @@ void SPPMPassCallback::pre_render(
     JobQueue&               job_queue,
     IAbortSwitch&           abort_switch)
 {
+    // Give each pixel its own lookup radius.
+    if (m_params.m_per_pixel_radius && !m_params.m_view_photons && m_pixel_statistics.empty())
+    {
+        const CanvasProperties& props = frame.image().properties();
+        m_pixel_statistics.initialize(
+            props.m_canvas_width,
+            props.m_canvas_height,
+            m_initial_lookup_radius);
+    }
+
     if (m_initial_lookup_radius > 0.0f)
     {
-        RENDERER_LOG_INFO(
-            "sppm lookup radius is %f (%s of initial radius).",
-            m_lookup_radius,
-            pretty_percent(m_lookup_radius, m_initial_lookup_radius, 3).c_str());
+        if (m_pixel_statistics.empty())
+        {
+            RENDERER_LOG_INFO(
+                "sppm lookup radius is %f (%s of initial radius).",
+                m_lookup_radius,
+                pretty_percent(m_lookup_radius, m_initial_lookup_radius, 3).c_str());
+        }
+        else
+        {
+            RENDERER_LOG_INFO(
+                "sppm average pixel lookup radius is %f (%s of initial radius).",
+                m_average_pixel_radius,
+                pretty_percent(m_average_pixel_radius, m_initial_lookup_radius, 3).c_str());
+        }
     }
 
     m_stopwatch.start();
@@ -117,7 +141,12 @@ void SPPMPassCallback::pre_render(
         return;
 
     // Build a new photon map.
-    m_photon_map.reset(new SPPMPhotonMap(m_photons));
+    m_photon_map.reset(
+        new SPPMPhotonMap(
+            m_photons,
+            m_params.m_photon_map_type,
+            m_params.m_view_photons ? m_params.m_view_photons_radius : m_lookup_radius,
+            job_queue));
 }
 
 void SPPMPassCallback::post_render(
@@ -130,6 +159,10 @@ void SPPMPassCallback::post_render(
     assert(k <= 1.0);
     m_lookup_radius *= sqrt(k);
 
+    // Shrink the lookup radius of each pixel according to the photons it gathered.
+    if (!m_pixel_statistics.empty())
+        m_average_pixel_radius = m_pixel_statistics.end_pass(m_params.m_alpha);
+
     m_stopwatch.measure();
 
     RENDERER_LOG_INFO(
@@ -35,6 +35,7 @@
 #include "renderer/kernel/lighting/sppm/sppmphoton.h"
 #include "renderer/kernel/lighting/sppm/sppmphotonmap.h"
 #include "renderer/kernel/lighting/sppm/sppmphotontracer.h"
+#include "renderer/kernel/lighting/sppm/sppmpixelstatistics.h"
 #include "renderer/kernel/rendering/ipasscallback.h"
 
 // appleseed.foundation headers.
@@ -114,6 +115,9 @@ class SPPMPassCallback
     // Return the current lookup radius.
     float get_lookup_radius() const;
 
+    // Return the per-pixel lookup radii, or 0 if pixels share the same lookup radius.
+    SPPMPixelStatistics* get_pixel_statistics();
+
   private:
     const SPPMParameters            m_params;
     SPPMPhotonTracer                m_photon_tracer;
@@ -122,6 +126,8 @@ class SPPMPassCallback
     std::auto_ptr<SPPMPhotonMap>    m_photon_map;
     float                           m_initial_lookup_radius;
     float                           m_lookup_radius;
+    SPPMPixelStatistics             m_pixel_statistics;
+    float                           m_average_pixel_radius;
     foundation::Stopwatch<foundation::DefaultWallclockTimer>
                                     m_stopwatch;
 };
@@ -151,6 +157,11 @@ inline float SPPMPassCallback::get_lookup_radius() const
     return m_lookup_radius;
 }
 
+inline SPPMPixelStatistics* SPPMPassCallback::get_pixel_statistics()
+{
+    return m_pixel_statistics.empty() ? 0 : &m_pixel_statistics;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_SPPM_SPPMPASSCALLBACK_H
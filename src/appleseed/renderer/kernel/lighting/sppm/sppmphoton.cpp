@@ -102,13 +102,4 @@ void SPPMPhotonVector::push_back(
     m_poly_photons.push_back(photon);
 }
 
-void SPPMPhotonVector::append(const SPPMPhotonVector& rhs)
-{
-    boost::mutex::scoped_lock lock(m_mutex);
-
-    m_positions.insert(m_positions.end(), rhs.m_positions.begin(), rhs.m_positions.end());
-    m_mono_photons.insert(m_mono_photons.end(), rhs.m_mono_photons.begin(), rhs.m_mono_photons.end());
-    m_poly_photons.insert(m_poly_photons.end(), rhs.m_poly_photons.begin(), rhs.m_poly_photons.end());
-}
-
 }   // namespace renderer
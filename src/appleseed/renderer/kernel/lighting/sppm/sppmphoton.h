@@ -35,9 +35,6 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
-
-// Boost headers.
-#include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 
 // Standard headers.
@@ -89,7 +86,6 @@ class SPPMPhotonVector
     std::vector<foundation::Vector3f>   m_positions;
     std::vector<SPPMMonoPhoton>         m_mono_photons;
     std::vector<SPPMPolyPhoton>         m_poly_photons;
-    boost::mutex                        m_mutex;
 
     bool empty() const;
     size_t size() const;
@@ -107,9 +103,6 @@ class SPPMPhotonVector
     void push_back(
         const foundation::Vector3f&     position,
         const SPPMPolyPhoton&           photon);
-
-    // The only thread-safe method of this class.
-    void append(const SPPMPhotonVector& rhs);
 };
 
 }       // namespace renderer
@@ -36,7 +36,9 @@
 
 // appleseed.foundation headers.
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
@@ -48,7 +50,12 @@ using namespace foundation;
 namespace renderer
 {
 
-SPPMPhotonMap::SPPMPhotonMap(SPPMPhotonVector& photons)
+SPPMPhotonMap::SPPMPhotonMap(
+    SPPMPhotonVector&                   photons,
+    const SPPMParameters::PhotonMapType type,
+    const float                         lookup_radius,
+    JobQueue&                           job_queue)
+  : m_type(type)
 {
     const size_t photon_count = photons.size();
 
@@ -59,13 +66,33 @@ SPPMPhotonMap::SPPMPhotonMap(SPPMPhotonVector& photons)
             pretty_uint(photon_count).c_str(),
             photon_count > 1 ? "photons" : "photon");
 
-        knn::Builder3f builder(*this);
-        builder.build_move_points<DefaultWallclockTimer>(photons.m_positions);
-
         Statistics statistics;
-        statistics.insert_time("build time", builder.get_build_time());
-        statistics.insert_size("size", photons.get_memory_size());
-        statistics.merge(knn::TreeStatistics<knn::Tree3f>(*this));
+
+        if (m_type == SPPMParameters::KdTree)
+        {
+            knn::Builder3f builder(m_tree);
+            builder.build_move_points<DefaultWallclockTimer>(photons.m_positions, job_queue);
+
+            statistics.insert_time("build time", builder.get_build_time());
+            statistics.insert_size("size", photons.get_memory_size());
+            statistics.merge(knn::TreeStatistics<knn::Tree3f>(m_tree));
+        }
+        else
+        {
+            Stopwatch<DefaultWallclockTimer> stopwatch;
+            stopwatch.start();
+
+            // A lookup then visits at most 2x2x2 cells.
+            const float cell_size = 2.0f * lookup_radius;
+            m_grid.build_move_points(photons.m_positions, cell_size);
+
+            stopwatch.measure();
+
+            statistics.insert_time("build time", stopwatch.get_seconds());
+            statistics.insert_size("size", photons.get_memory_size());
+            statistics.insert_size("grid size", m_grid.get_memory_size());
+            statistics.insert("cell size", static_cast<double>(cell_size));
+        }
 
         RENDERER_LOG_DEBUG("%s",
             StatisticsVector::make(
@@ -30,23 +30,102 @@
 #ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_SPPM_SPPMPHOTONMAP_H
 #define APPLESEED_RENDERER_KERNEL_LIGHTING_SPPM_SPPMPHOTONMAP_H
 
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmparameters.h"
+
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/knn.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <cstddef>
 
 // Forward declarations.
-namespace renderer  { class SPPMPhotonVector; }
+namespace foundation    { class JobQueue; }
+namespace renderer      { class SPPMPhotonVector; }
 
 namespace renderer
 {
 
+//
+// The photon map stores the photon positions in either a kd-tree or a hash grid.
+//
+// Kd-tree lookups adapt to the photon density and work for any lookup radius.
+// The hash grid is built in linear time and answers fixed-radius lookups with a
+// handful of contiguous scans, but its cells are sized after the lookup radius
+// known at build time and lookups with a much larger radius get slow.
+//
+
 class SPPMPhotonMap
-  : public foundation::knn::Tree3f
+  : public foundation::NonCopyable
 {
   public:
     // Constructor, *moves* the photon positions into the map.
-    explicit SPPMPhotonMap(SPPMPhotonVector& photons);
+    // The kd-tree is built in parallel using the threads servicing the job queue.
+    // The hash grid is optimized for lookups within a distance of lookup_radius.
+    SPPMPhotonMap(
+        SPPMPhotonVector&                   photons,
+        const SPPMParameters::PhotonMapType type,
+        const float                         lookup_radius,
+        foundation::JobQueue&               job_queue);
+
+    // Return true if the map does not contain any photon.
+    bool empty() const;
+
+    // Transform an internal index to a photon index.
+    size_t remap(const size_t i) const;
+
+    // Return the position of the i'th photon, where i is an internal index.
+    const foundation::Vector3f& get_point(const size_t i) const;
+
+    // Find the photons within a given distance of a point. If there are more such photons
+    // than the answer can hold, only the closest ones are returned. Entries of the answer
+    // refer to photons using internal indices.
+    void find_photons(
+        const foundation::Vector3f&         point,
+        const float                         max_square_dist,
+        foundation::knn::Answer<float>&     answer) const;
+
+  private:
+    const SPPMParameters::PhotonMapType     m_type;
+    foundation::knn::Tree3f                 m_tree;
+    foundation::knn::HashGrid3f             m_grid;
 };
 
+
+//
+// SPPMPhotonMap class implementation.
+//
+
+inline bool SPPMPhotonMap::empty() const
+{
+    return m_type == SPPMParameters::KdTree ? m_tree.empty() : m_grid.empty();
+}
+
+inline size_t SPPMPhotonMap::remap(const size_t i) const
+{
+    return m_type == SPPMParameters::KdTree ? m_tree.remap(i) : m_grid.remap(i);
+}
+
+inline const foundation::Vector3f& SPPMPhotonMap::get_point(const size_t i) const
+{
+    return m_type == SPPMParameters::KdTree ? m_tree.get_point(i) : m_grid.get_point(i);
+}
+
+inline void SPPMPhotonMap::find_photons(
+    const foundation::Vector3f&             point,
+    const float                             max_square_dist,
+    foundation::knn::Answer<float>&         answer) const
+{
+    if (m_type == SPPMParameters::KdTree)
+    {
+        const foundation::knn::Query3f query(m_tree, answer);
+        query.run(point, max_square_dist);
+    }
+    else m_grid.query(point, max_square_dist, answer);
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_SPPM_SPPMPHOTONMAP_H
@@ -212,7 +212,7 @@ namespace
             OIIO::TextureSystem&    oiio_texture_system,
             OSL::ShadingSystem&     shading_system,
             const SPPMParameters&   params,
-            SPPMPhotonVector&       global_photons,
+            SPPMPhotonVector&       photons,
             const size_t            photon_begin,
             const size_t            photon_end,
             const size_t            pass_hash,
@@ -233,7 +233,7 @@ namespace
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
                 false)
-          , m_global_photons(global_photons)
+          , m_photons(photons)
           , m_photon_begin(photon_begin)
           , m_photon_end(photon_end)
           , m_pass_hash(pass_hash)
@@ -265,8 +265,6 @@ namespace
 
             for (size_t i = m_photon_begin; i < m_photon_end && !m_abort_switch.is_aborted(); ++i)
                 trace_light_photon(shading_context, sampling_context);
-
-            m_global_photons.append(m_local_photons);
         }
 
       private:
@@ -279,12 +277,11 @@ namespace
         OSLShaderGroupExec          m_shadergroup_exec;
         const SPPMParameters        m_params;
         Tracer                      m_tracer;
-        SPPMPhotonVector&           m_global_photons;
+        SPPMPhotonVector&           m_photons;
         const size_t                m_photon_begin;
         const size_t                m_photon_end;
         const size_t                m_pass_hash;
         IAbortSwitch&               m_abort_switch;
-        SPPMPhotonVector            m_local_photons;
         float                       m_shutter_open_time;
         float                       m_shutter_close_time;
 
@@ -399,7 +396,7 @@ namespace
                 m_params.m_dl_mode == SPPMParameters::SPPM, // store direct lighting photons?
                 cast_indirect_light,
                 m_params.m_enable_caustics,
-                m_local_photons);
+                m_photons);
             PathTracer<PathVisitor, true> path_tracer(      // true = adjoint
                 path_visitor,
                 m_params.m_photon_tracing_rr_min_path_length,
@@ -460,7 +457,7 @@ namespace
                 m_params.m_dl_mode == SPPMParameters::SPPM, // store direct lighting photons?
                 cast_indirect_light,
                 m_params.m_enable_caustics,
-                m_local_photons);
+                m_photons);
             PathTracer<PathVisitor, true> path_tracer(      // true = adjoint
                 path_visitor,
                 m_params.m_photon_tracing_rr_min_path_length,
@@ -493,7 +490,7 @@ namespace
             OIIO::TextureSystem&    oiio_texture_system,
             OSL::ShadingSystem&     shading_system,
             const SPPMParameters&   params,
-            SPPMPhotonVector&       global_photons,
+            SPPMPhotonVector&       photons,
             const size_t            photon_begin,
             const size_t            photon_end,
             const size_t            pass_hash,
@@ -515,7 +512,7 @@ namespace
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
                 false)
-          , m_global_photons(global_photons)
+          , m_photons(photons)
           , m_photon_begin(photon_begin)
           , m_photon_end(photon_end)
           , m_pass_hash(pass_hash)
@@ -552,8 +549,6 @@ namespace
 
             for (size_t i = m_photon_begin; i < m_photon_end && !m_abort_switch.is_aborted(); ++i)
                 trace_env_photon(shading_context, sampling_context);
-
-            m_global_photons.append(m_local_photons);
         }
 
       private:
@@ -567,12 +562,11 @@ namespace
         OSLShaderGroupExec          m_shadergroup_exec;
         const SPPMParameters        m_params;
         Tracer                      m_tracer;
-        SPPMPhotonVector&           m_global_photons;
+        SPPMPhotonVector&           m_photons;
         const size_t                m_photon_begin;
         const size_t                m_photon_end;
         const size_t                m_pass_hash;
         IAbortSwitch&               m_abort_switch;
-        SPPMPhotonVector            m_local_photons;
         float                       m_shutter_open_time;
         float                       m_shutter_close_time;
 
@@ -655,7 +649,7 @@ namespace
                 true,
                 cast_indirect_light,
                 m_params.m_enable_caustics,
-                m_local_photons);
+                m_photons);
             PathTracer<PathVisitor, true> path_tracer(      // true = adjoint
                 path_visitor,
                 m_params.m_photon_tracing_rr_min_path_length,
@@ -669,6 +663,56 @@ namespace
                 ray);
         }
     };
+
+
+    //
+    // A job to copy a photon segment into the final photon vector.
+    //
+
+    class CopyPhotonSegmentJob
+      : public IJob
+    {
+      public:
+        CopyPhotonSegmentJob(
+            const SPPMPhotonVector& segment,
+            SPPMPhotonVector&       photons,
+            const size_t            photon_offset)
+          : m_segment(segment)
+          , m_photons(photons)
+          , m_photon_offset(photon_offset)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            std::copy(
+                m_segment.m_positions.begin(),
+                m_segment.m_positions.end(),
+                m_photons.m_positions.begin() + m_photon_offset);
+
+            // Photons are either all monochromatic or all polychromatic.
+            if (!m_segment.m_mono_photons.empty())
+            {
+                std::copy(
+                    m_segment.m_mono_photons.begin(),
+                    m_segment.m_mono_photons.end(),
+                    m_photons.m_mono_photons.begin() + m_photon_offset);
+            }
+
+            if (!m_segment.m_poly_photons.empty())
+            {
+                std::copy(
+                    m_segment.m_poly_photons.begin(),
+                    m_segment.m_poly_photons.end(),
+                    m_photons.m_poly_photons.begin() + m_photon_offset);
+            }
+        }
+
+      private:
+        const SPPMPhotonVector&     m_segment;
+        SPPMPhotonVector&           m_photons;
+        const size_t                m_photon_offset;
+    };
 }
 
 
@@ -771,25 +815,34 @@ void SPPMPhotonTracer::trace_photons(
         Transformd::identity(),
         photon_targets);
 
+    // Each photon tracing job stores its photons into its own segment, without locking.
+    // Segments are kept from one pass to the next to reuse their memory.
+    const bool trace_light_photons = m_light_sampler.has_lights_or_emitting_triangles();
+    const bool trace_env_photons = m_params.m_enable_ibl && m_scene.get_environment()->get_environment_edf();
+    const size_t segment_count =
+        (trace_light_photons ? get_job_count(m_params.m_light_photon_count) : 0) +
+        (trace_env_photons ? get_job_count(m_params.m_env_photon_count) : 0);
+    m_photon_segments.resize(segment_count);
+    for (size_t i = 0; i < segment_count; ++i)
+        m_photon_segments[i].clear_keep_memory();
+
     // Schedule photon tracing jobs.
     size_t job_count = 0;
     size_t emitted_photon_count = 0;
-    if (m_light_sampler.has_lights_or_emitting_triangles())
+    if (trace_light_photons)
     {
         schedule_light_photon_tracing_jobs(
             photon_targets,
-            photons,
             pass_hash,
             job_queue,
             job_count,
             emitted_photon_count,
             abort_switch);
     }
-    if (m_params.m_enable_ibl && m_scene.get_environment()->get_environment_edf())
+    if (trace_env_photons)
     {
         schedule_environment_photon_tracing_jobs(
             photon_targets,
-            photons,
             pass_hash,
             job_queue,
             job_count,
@@ -799,6 +852,10 @@ void SPPMPhotonTracer::trace_photons(
 
     // Wait until the photon tracing jobs have completed.
     job_queue.wait_until_completion();
+    assert(job_count == segment_count);
+
+    // Concatenate the photon segments.
+    merge_photon_segments(photons, job_queue);
 
     // Update photon tracing statistics.
     m_total_emitted_photon_count += emitted_photon_count;
@@ -822,7 +879,6 @@ void SPPMPhotonTracer::trace_photons(
 
 void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
     const LightTargetArray& photon_targets,
-    SPPMPhotonVector&       photons,
     const size_t            pass_hash,
     JobQueue&               job_queue,
     size_t&                 job_count,
@@ -849,7 +905,7 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
                 m_oiio_texture_system,
                 m_shading_system,
                 m_params,
-                photons,
+                m_photon_segments[job_count],
                 photon_begin,
                 photon_end,
                 pass_hash,
@@ -862,7 +918,6 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
 
 void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
     const LightTargetArray& photon_targets,
-    SPPMPhotonVector&       photons,
     const size_t            pass_hash,
     JobQueue&               job_queue,
     size_t&                 job_count,
@@ -889,7 +944,7 @@ void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
                 m_oiio_texture_system,
                 m_shading_system,
                 m_params,
-                photons,
+                m_photon_segments[job_count],
                 photon_begin,
                 photon_end,
                 pass_hash,
@@ -900,4 +955,54 @@ void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
     }
 }
 
+size_t SPPMPhotonTracer::get_job_count(const size_t photon_count) const
+{
+    return (photon_count + m_params.m_photon_packet_size - 1) / m_params.m_photon_packet_size;
+}
+
+void SPPMPhotonTracer::merge_photon_segments(
+    SPPMPhotonVector&       photons,
+    JobQueue&               job_queue)
+{
+    size_t photon_count = 0;
+    size_t mono_photon_count = 0;
+    size_t poly_photon_count = 0;
+
+    for (size_t i = 0; i < m_photon_segments.size(); ++i)
+    {
+        const SPPMPhotonVector& segment = m_photon_segments[i];
+        photon_count += segment.m_positions.size();
+        mono_photon_count += segment.m_mono_photons.size();
+        poly_photon_count += segment.m_poly_photons.size();
+    }
+
+    assert(mono_photon_count == 0 || poly_photon_count == 0);
+    assert(mono_photon_count + poly_photon_count == photon_count);
+
+    // Size the photon vector once.
+    photons.m_positions.resize(photon_count);
+    photons.m_mono_photons.resize(mono_photon_count);
+    photons.m_poly_photons.resize(poly_photon_count);
+
+    // Copy the segments in parallel.
+    size_t photon_offset = 0;
+    for (size_t i = 0; i < m_photon_segments.size(); ++i)
+    {
+        const SPPMPhotonVector& segment = m_photon_segments[i];
+
+        if (!segment.empty())
+        {
+            job_queue.schedule(
+                new CopyPhotonSegmentJob(
+                    segment,
+                    photons,
+                    photon_offset));
+
+            photon_offset += segment.size();
+        }
+    }
+
+    job_queue.wait_until_completion();
+}
+
 }   // namespace renderer
@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/lighting/sppm/sppmparameters.h"
+#include "renderer/kernel/lighting/sppm/sppmphoton.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
@@ -50,6 +51,7 @@ END_OIIO_INCLUDES
 
 // Standard headers.
 #include <cstddef>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -57,7 +59,6 @@ namespace foundation    { class JobQueue; }
 namespace renderer      { class LightSampler; }
 namespace renderer      { class LightTargetArray; }
 namespace renderer      { class Scene; }
-namespace renderer      { class SPPMPhotonVector; }
 namespace renderer      { class TextureStore; }
 namespace renderer      { class TraceContext; }
 
@@ -93,10 +94,10 @@ class SPPMPhotonTracer
     size_t                          m_total_stored_photon_count;
     OIIO::TextureSystem&            m_oiio_texture_system;
     OSL::ShadingSystem&             m_shading_system;
+    std::vector<SPPMPhotonVector>   m_photon_segments;              // one segment per photon tracing job
 
     void schedule_light_photon_tracing_jobs(
         const LightTargetArray&     photon_targets,
-        SPPMPhotonVector&           photons,
         const size_t                pass_hash,
         foundation::JobQueue&       job_queue,
         size_t&                     job_count,
@@ -105,12 +106,17 @@ class SPPMPhotonTracer
 
     void schedule_environment_photon_tracing_jobs(
         const LightTargetArray&     photon_targets,
-        SPPMPhotonVector&           photons,
         const size_t                pass_hash,
         foundation::JobQueue&       job_queue,
         size_t&                     job_count,
         size_t&                     emitted_photon_count,
         foundation::IAbortSwitch&   abort_switch);
+
+    size_t get_job_count(const size_t photon_count) const;
+
+    void merge_photon_segments(
+        SPPMPhotonVector&           photons,
+        foundation::JobQueue&       job_queue);
 };
 
 }       // namespace renderer
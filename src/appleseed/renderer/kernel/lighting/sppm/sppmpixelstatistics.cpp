@@ -0,0 +1,100 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sppmpixelstatistics.h"
+
+// Standard headers.
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SPPMPixelStatistics class implementation.
+//
+
+SPPMPixelStatistics::SPPMPixelStatistics()
+  : m_width(0)
+  , m_height(0)
+{
+}
+
+void SPPMPixelStatistics::initialize(
+    const size_t    width,
+    const size_t    height,
+    const float     initial_radius)
+{
+    Pixel pixel;
+    pixel.m_radius = initial_radius;
+    pixel.m_photon_count = 0.0f;
+    pixel.m_pass_photon_count = 0.0f;
+    pixel.m_pass_lookup_count = 0;
+
+    m_width = width;
+    m_height = height;
+    m_pixels.assign(width * height, pixel);
+}
+
+float SPPMPixelStatistics::end_pass(const float alpha)
+{
+    const size_t pixel_count = m_pixels.size();
+    double radius_sum = 0.0;
+
+    for (size_t i = 0; i < pixel_count; ++i)
+    {
+        Pixel& pixel = m_pixels[i];
+
+        if (pixel.m_pass_lookup_count > 0)
+        {
+            // Average number of photons found by the lookups of this pixel.
+            const float m = pixel.m_pass_photon_count / pixel.m_pass_lookup_count;
+
+            if (m > 0.0f)
+            {
+                // Keep a fraction alpha of the new photons and shrink the radius accordingly.
+                const float n = pixel.m_photon_count;
+                const float new_n = n + alpha * m;
+                pixel.m_radius *= sqrt(new_n / (n + m));
+                pixel.m_photon_count = new_n;
+            }
+
+            pixel.m_pass_photon_count = 0.0f;
+            pixel.m_pass_lookup_count = 0;
+        }
+
+        radius_sum += pixel.m_radius;
+    }
+
+    return pixel_count > 0 ? static_cast<float>(radius_sum / pixel_count) : 0.0f;
+}
+
+}   // namespace renderer
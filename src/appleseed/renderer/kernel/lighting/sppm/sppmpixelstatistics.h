@@ -0,0 +1,169 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_SPPM_SPPMPIXELSTATISTICS_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_SPPM_SPPMPIXELSTATISTICS_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// Per-pixel lookup radii for SPPM.
+//
+// Each pixel has its own lookup radius, used to gather photons around the
+// first non-specular vertex of the paths traced from it. After each pass, the
+// radius of a pixel shrinks according to the number of photons found in the
+// pass, as in Hachisuka and Jensen's SPPM: dense regions shrink fast while
+// sparse regions keep gathering photons from a larger area.
+//
+// Lookups may be capped to the closest photons, in which case they only cover a
+// disk smaller than the pixel radius. The photon count of such a lookup is scaled
+// by the ratio of the areas of the two disks, assuming a locally uniform photon
+// density, so that the count used to shrink the radius does not saturate.
+//
+// The accumulated flux is not stored per pixel. The original algorithm rescales
+// it by R'^2 / R^2 after each pass and divides it by pi R^2 and by the number of
+// emitted photons. Written with tau / R^2, the rescaling cancels out and the
+// estimate is the average over passes of each pass flux divided by pi R^2, R
+// being the radius of that pass. The frame renderer computes this same average
+// when it accumulates the independent estimates of successive passes, as in
+// Knaus and Zwicker's probabilistic formulation.
+//
+// Reference:
+//
+//   Stochastic Progressive Photon Mapping
+//   Toshiya Hachisuka, Henrik Wann Jensen
+//   http://cs.au.dk/~toshiya/sppm.pdf
+//
+
+class SPPMPixelStatistics
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    SPPMPixelStatistics();
+
+    // Return true if the statistics have not been initialized.
+    bool empty() const;
+
+    // Set the size of the canvas and reset the radius of all pixels.
+    void initialize(
+        const size_t                width,
+        const size_t                height,
+        const float                 initial_radius);
+
+    // Return the lookup radius of a given pixel. Pixels outside the canvas
+    // use the radius of the closest pixel inside the canvas.
+    float get_radius(const foundation::Vector2i& pixel) const;
+
+    // Record the number of photons found by a lookup from a given pixel, within
+    // a given square distance which may be smaller than the square radius of the
+    // pixel if the lookup was capped. Lookups outside the canvas are ignored.
+    // This method is thread-safe.
+    void record_lookup(
+        const foundation::Vector2i& pixel,
+        const size_t                photon_count,
+        const float                 square_dist);
+
+    // Shrink the radius of each pixel according to the photons found during
+    // the pass, and reset the per-pass counters. Return the average radius.
+    float end_pass(const float alpha);
+
+  private:
+    struct Pixel
+    {
+        float                       m_radius;               // lookup radius
+        float                       m_photon_count;         // accumulated photon count
+        float                       m_pass_photon_count;    // photons within the lookup radius during the current pass
+        foundation::uint32          m_pass_lookup_count;    // lookups during the current pass
+    };
+
+    size_t                          m_width;
+    size_t                          m_height;
+    std::vector<Pixel>              m_pixels;
+};
+
+
+//
+// SPPMPixelStatistics class implementation.
+//
+
+inline bool SPPMPixelStatistics::empty() const
+{
+    return m_pixels.empty();
+}
+
+inline float SPPMPixelStatistics::get_radius(const foundation::Vector2i& pixel) const
+{
+    assert(!empty());
+
+    const size_t x = pixel.x < 0 ? 0 : std::min(static_cast<size_t>(pixel.x), m_width - 1);
+    const size_t y = pixel.y < 0 ? 0 : std::min(static_cast<size_t>(pixel.y), m_height - 1);
+
+    return m_pixels[y * m_width + x].m_radius;
+}
+
+inline void SPPMPixelStatistics::record_lookup(
+    const foundation::Vector2i&     pixel,
+    const size_t                    photon_count,
+    const float                     square_dist)
+{
+    // Pixels in the margins of a tile are also rendered by the neighboring tiles.
+    if (pixel.x < 0 || pixel.y < 0 ||
+        static_cast<size_t>(pixel.x) >= m_width ||
+        static_cast<size_t>(pixel.y) >= m_height)
+        return;
+
+    Pixel& p = m_pixels[pixel.y * m_width + pixel.x];
+
+    // Estimate the number of photons within the radius of the pixel.
+    const float square_radius = p.m_radius * p.m_radius;
+    const float count =
+        square_dist > 0.0f && square_dist < square_radius
+            ? photon_count * (square_radius / square_dist)
+            : static_cast<float>(photon_count);
+
+    foundation::atomic_add(&p.m_pass_photon_count, count);
+    foundation::atomic_inc(&p.m_pass_lookup_count);
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_SPPM_SPPMPIXELSTATISTICS_H
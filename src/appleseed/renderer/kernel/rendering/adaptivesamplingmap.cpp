@@ -0,0 +1,306 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "adaptivesamplingmap.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// AdaptiveSamplingMap class implementation.
+//
+
+namespace
+{
+    // Width and height of a block, in pixels.
+    const size_t BlockSize = 8;
+
+    // Luminance added to the mean of a pixel before computing its relative error,
+    // to prevent noise in very dark pixels from dominating the error estimates.
+    const float DarkLuminance = 0.01f;
+
+    // Largest value smaller than 1.
+    const double OneMinusEpsilon = 1.0 - 1.0e-9;
+
+    size_t get_pixel_count(const AABB2u& rect)
+    {
+        return (rect.extent()[0] + 1) * (rect.extent()[1] + 1);
+    }
+}
+
+AdaptiveSamplingMap::Parameters::Parameters(const ParamArray& params)
+  : m_min_samples(params.get_optional<size_t>("min_samples", 16))
+  , m_max_samples(params.get_optional<size_t>("max_samples", 0))
+  , m_max_error(pow(10.0f, -params.get_optional<float>("quality", 2.0f)))
+{
+}
+
+AdaptiveSamplingMap::AdaptiveSamplingMap(
+    const size_t        canvas_width,
+    const size_t        canvas_height,
+    const AABB2u&       crop_window,
+    const ParamArray&   params)
+  : m_params(params)
+  , m_canvas_width(canvas_width)
+  , m_canvas_height(canvas_height)
+  , m_crop_window(crop_window)
+  , m_window_width(crop_window.extent()[0] + 1)
+  , m_window_height(crop_window.extent()[1] + 1)
+  , m_block_count_x((m_window_width + BlockSize - 1) / BlockSize)
+  , m_block_count_y((m_window_height + BlockSize - 1) / BlockSize)
+  , m_pixels(m_window_width * m_window_height)
+{
+    assert(crop_window.max.x < canvas_width);
+    assert(crop_window.max.y < canvas_height);
+
+    clear();
+}
+
+void AdaptiveSamplingMap::clear()
+{
+    boost::unique_lock<boost::shared_mutex> lock(m_cdf_mutex);
+
+    PixelStatistics empty;
+    empty.m_sum = 0.0;
+    empty.m_sum_squares = 0.0;
+    empty.m_count = 0;
+    fill(m_pixels.begin(), m_pixels.end(), empty);
+
+    m_sample_count = 0;
+    m_next_update = max<uint64>(m_pixels.size() / 4, 1);
+    m_converged = false;
+
+    // Sample the crop window uniformly until error estimates are available.
+    m_cdf.clear();
+    m_cdf_blocks.clear();
+}
+
+void AdaptiveSamplingMap::store_samples(
+    const size_t        sample_count,
+    const Sample        samples[])
+{
+    const float fw = static_cast<float>(m_canvas_width);
+    const float fh = static_cast<float>(m_canvas_height);
+
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        const Sample& sample = samples[i];
+
+        const size_t x = truncate<size_t>(max(sample.m_position.x * fw, 0.0f));
+        const size_t y = truncate<size_t>(max(sample.m_position.y * fh, 0.0f));
+
+        if (x < m_crop_window.min.x || x > m_crop_window.max.x ||
+            y < m_crop_window.min.y || y > m_crop_window.max.y)
+            continue;
+
+        const double value =
+            luminance(
+                Color3f(
+                    sample.m_values[0],
+                    sample.m_values[1],
+                    sample.m_values[2]));
+
+        PixelStatistics& pixel =
+            m_pixels[(y - m_crop_window.min.y) * m_window_width + (x - m_crop_window.min.x)];
+
+        atomic_add(&pixel.m_sum, value);
+        atomic_add(&pixel.m_sum_squares, value * value);
+        atomic_inc(&pixel.m_count);
+    }
+
+    m_sample_count += sample_count;
+}
+
+void AdaptiveSamplingMap::update()
+{
+    if (m_sample_count < m_next_update)
+        return;
+
+    // Only one thread updates the map; the others keep using the current distribution.
+    boost::mutex::scoped_try_lock update_lock(m_update_mutex);
+    if (!update_lock.owns_lock() || m_sample_count < m_next_update)
+        return;
+
+    // Update the map every quarter of a sample per pixel.
+    m_next_update = m_sample_count + max<uint64>(m_pixels.size() / 4, 1);
+
+    const size_t block_count = m_block_count_x * m_block_count_y;
+
+    vector<float> errors(block_count);
+    float max_error = m_params.m_max_error;
+
+    for (size_t i = 0; i < block_count; ++i)
+    {
+        errors[i] = compute_block_error(get_block_rect(i));
+        max_error = max(max_error, errors[i]);
+    }
+
+    // Build the distribution of the blocks that have not converged. Blocks whose
+    // pixels lack samples to estimate their error are given the largest error.
+    vector<double> cdf;
+    vector<uint32> cdf_blocks;
+    double weight_sum = 0.0;
+
+    for (size_t i = 0; i < block_count; ++i)
+    {
+        if (errors[i] < 0.0f)
+            continue;
+
+        const AABB2u rect = get_block_rect(i);
+        const float error = errors[i] == 0.0f ? max_error : errors[i];
+
+        weight_sum += static_cast<double>(error) * get_pixel_count(rect);
+        cdf.push_back(weight_sum);
+        cdf_blocks.push_back(static_cast<uint32>(i));
+    }
+
+    if (cdf.empty())
+    {
+        // Keep the current distribution for the samples still being rendered.
+        if (!m_converged.exchange(true))
+            RENDERER_LOG_INFO("adaptive sampling: all pixels have converged.");
+        return;
+    }
+
+    boost::unique_lock<boost::shared_mutex> lock(m_cdf_mutex);
+    m_cdf.swap(cdf);
+    m_cdf_blocks.swap(cdf_blocks);
+}
+
+Vector2d AdaptiveSamplingMap::sample(const Vector2d& s) const
+{
+    assert(s[0] >= 0.0 && s[0] < 1.0);
+    assert(s[1] >= 0.0 && s[1] < 1.0);
+
+    boost::shared_lock<boost::shared_mutex> lock(m_cdf_mutex);
+
+    if (m_cdf.empty())
+    {
+        return
+            Vector2d(
+                m_crop_window.min.x + s[0] * m_window_width,
+                m_crop_window.min.y + s[1] * m_window_height);
+    }
+
+    // Choose a block, then reuse the first coordinate to choose a position inside it.
+    const double x = s[0] * m_cdf.back();
+    const size_t i =
+        min<size_t>(
+            upper_bound(m_cdf.begin(), m_cdf.end(), x) - m_cdf.begin(),
+            m_cdf.size() - 1);
+
+    const double begin = i > 0 ? m_cdf[i - 1] : 0.0;
+    const double u = saturate((x - begin) / (m_cdf[i] - begin));
+
+    const AABB2u rect = get_block_rect(m_cdf_blocks[i]);
+
+    return
+        Vector2d(
+            rect.min.x + min(u, OneMinusEpsilon) * (rect.extent()[0] + 1),
+            rect.min.y + min(s[1], OneMinusEpsilon) * (rect.extent()[1] + 1));
+}
+
+AABB2u AdaptiveSamplingMap::get_block_rect(const size_t block_index) const
+{
+    const size_t bx = block_index % m_block_count_x;
+    const size_t by = block_index / m_block_count_x;
+
+    const size_t x0 = m_crop_window.min.x + bx * BlockSize;
+    const size_t y0 = m_crop_window.min.y + by * BlockSize;
+
+    return
+        AABB2u(
+            Vector2u(x0, y0),
+            Vector2u(
+                min(x0 + BlockSize - 1, m_crop_window.max.x),
+                min(y0 + BlockSize - 1, m_crop_window.max.y)));
+}
+
+float AdaptiveSamplingMap::compute_block_error(const AABB2u& rect) const
+{
+    size_t sample_count = 0;
+    bool measured = true;
+    double error_sum = 0.0;
+
+    for (size_t y = rect.min.y; y <= rect.max.y; ++y)
+    {
+        for (size_t x = rect.min.x; x <= rect.max.x; ++x)
+        {
+            const PixelStatistics& pixel =
+                m_pixels[(y - m_crop_window.min.y) * m_window_width + (x - m_crop_window.min.x)];
+
+            const uint32 n = pixel.m_count;
+            sample_count += n;
+
+            if (n < max<size_t>(m_params.m_min_samples, 2))
+            {
+                measured = false;
+                continue;
+            }
+
+            const double mean = pixel.m_sum / n;
+            const double variance = max((pixel.m_sum_squares - pixel.m_sum * mean) / (n - 1), 0.0);
+            const double error = sqrt(variance / n) / (mean + DarkLuminance);
+            error_sum += error * error;
+        }
+    }
+
+    const size_t pixel_count = get_pixel_count(rect);
+
+    // Blocks that reached the maximum number of samples per pixel have converged.
+    if (m_params.m_max_samples > 0 && sample_count >= m_params.m_max_samples * pixel_count)
+        return -1.0f;
+
+    // Some pixels lack samples: the error of the block is unknown.
+    if (!measured)
+        return 0.0f;
+
+    const float error = static_cast<float>(sqrt(error_sum / pixel_count));
+
+    return error <= m_params.m_max_error ? -1.0f : error;
+}
+
+}   // namespace renderer
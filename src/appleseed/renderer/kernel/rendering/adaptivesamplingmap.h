@@ -0,0 +1,159 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_ADAPTIVESAMPLINGMAP_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_ADAPTIVESAMPLINGMAP_H
+
+// appleseed.renderer headers.
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer      { class Sample; }
+
+namespace renderer
+{
+
+//
+// Error estimates driving adaptive sampling in progressive rendering.
+//
+// The map records the luminance mean and variance of the samples falling into
+// each pixel of the crop window. Pixels are grouped into square blocks; the
+// error of a block is the RMS of the relative standard errors of its pixels.
+// A block has converged once all its pixels received a minimum number of
+// samples and its error is below the threshold, or once its pixels received
+// a maximum number of samples on average.
+//
+// Sample positions are then drawn with a density proportional to the error
+// of the blocks that have not converged. Sample accumulation buffers normalize
+// pixel values by filter weights, so with a reconstruction filter whose radius
+// does not exceed half a pixel this does not bias the image. Wider filters mix
+// samples of neighboring pixels: within a filter radius of the boundaries between
+// blocks that received different numbers of samples, pixels give more weight to
+// the more densely sampled side. Since converged blocks stop receiving samples,
+// these differences persist in the final image and so does this bias; it is
+// proportional to the difference of the signal across the boundary.
+//
+
+class AdaptiveSamplingMap
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    AdaptiveSamplingMap(
+        const size_t                canvas_width,
+        const size_t                canvas_height,
+        const foundation::AABB2u&   crop_window,
+        const ParamArray&           params);
+
+    // Reset the map to its initial state.
+    void clear();
+
+    // Record a set of samples whose positions are expressed in normalized device coordinates. Thread-safe.
+    void store_samples(
+        const size_t                sample_count,
+        const Sample                samples[]);
+
+    // Recompute error estimates and the sampling distribution if enough samples
+    // were recorded since the last update. Thread-safe.
+    void update();
+
+    // Map a point of [0,1)^2 to a position in the crop window, expressed in pixels. Thread-safe.
+    foundation::Vector2d sample(const foundation::Vector2d& s) const;
+
+    // Return true if all blocks have converged. Thread-safe.
+    bool has_converged() const;
+
+  private:
+    struct Parameters
+    {
+        const size_t    m_min_samples;          // minimum number of samples per pixel
+        const size_t    m_max_samples;          // maximum number of samples per pixel, 0 for unlimited
+        const float     m_max_error;            // maximum relative standard error of converged blocks
+
+        explicit Parameters(const ParamArray& params);
+    };
+
+    // Sums are accumulated in double precision since the variance is
+    // computed from them as the difference of two large quantities.
+    struct PixelStatistics
+    {
+        double                      m_sum;
+        double                      m_sum_squares;
+        foundation::uint32          m_count;
+    };
+
+    const Parameters                m_params;
+    const size_t                    m_canvas_width;
+    const size_t                    m_canvas_height;
+    const foundation::AABB2u        m_crop_window;
+    const size_t                    m_window_width;
+    const size_t                    m_window_height;
+    const size_t                    m_block_count_x;
+    const size_t                    m_block_count_y;
+
+    std::vector<PixelStatistics>    m_pixels;
+    boost::atomic<foundation::uint64> m_sample_count;
+    boost::atomic<foundation::uint64> m_next_update;
+    boost::atomic<bool>             m_converged;
+    boost::mutex                    m_update_mutex;
+
+    mutable boost::shared_mutex     m_cdf_mutex;
+    std::vector<double>             m_cdf;
+    std::vector<foundation::uint32> m_cdf_blocks;
+
+    foundation::AABB2u get_block_rect(const size_t block_index) const;
+
+    // Return the error of a block, or a negative value if the block has converged.
+    float compute_block_error(const foundation::AABB2u& rect) const;
+};
+
+
+//
+// AdaptiveSamplingMap class implementation.
+//
+
+inline bool AdaptiveSamplingMap::has_converged() const
+{
+    return m_converged;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_ADAPTIVESAMPLINGMAP_H
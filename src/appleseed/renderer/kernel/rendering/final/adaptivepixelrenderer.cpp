@@ -162,6 +162,12 @@ namespace
             }
         }
 
+        virtual bool needs_whole_tiles() const APPLESEED_OVERRIDE
+        {
+            // Diagnostics are written to the AOVs of whole tiles after they are developed.
+            return m_params.m_diagnostics;
+        }
+
         virtual void render_pixel(
             const Frame&                frame,
             Tile&                       tile,
@@ -191,6 +197,7 @@ namespace
                 2,                          // number of dimensions
                 0,                          // number of samples -- unknown
                 instance);                  // initial instance number
+            sampling_context.set_pixel(pi.x, pi.y, static_cast<uint32>(pass_hash));
 
             VariationTracker trackers[3];
 
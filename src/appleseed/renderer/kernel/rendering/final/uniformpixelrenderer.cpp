@@ -136,6 +136,7 @@ namespace
                     2,                          // number of dimensions
                     0,                          // number of samples -- unknown
                     instance);                  // initial instance number
+                sampling_context.set_pixel(pi.x, pi.y, static_cast<uint32>(pass_hash));
 
                 for (size_t i = 0; i < m_sample_count; ++i)
                 {
@@ -200,6 +201,10 @@ namespace
                             1,                          // number of dimensions
                             instance,                   // number of samples
                             instance);                  // initial instance number -- end of sequence
+                        sampling_context.set_pixel(
+                            pi.x,
+                            pi.y,
+                            mix_uint32(static_cast<uint32>(pass_hash), static_cast<uint32>(sy * m_sqrt_sample_count + sx)));
 
                         // Render the sample.
                         ShadingResult shading_result(aov_count);
@@ -32,28 +32,41 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/aov/aovsettings.h"
+#include "renderer/kernel/aov/imagestack.h"
 #include "renderer/kernel/rendering/generic/tilejob.h"
 #include "renderer/kernel/rendering/generic/tilejobfactory.h"
 #include "renderer/kernel/rendering/iframerenderer.h"
 #include "renderer/kernel/rendering/ipasscallback.h"
 #include "renderer/kernel/rendering/itilecallback.h"
 #include "renderer/kernel/rendering/itilerenderer.h"
+#include "renderer/modeling/frame/frame.h"
 #include "renderer/utility/settingsparsing.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/analysis.h"
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
 #include "foundation/math/hash.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/defaulttimers.h"
 #include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/job.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -83,12 +96,32 @@ namespace
             const ParamArray&       params)
           : m_frame(frame)
           , m_params(params)
+          , m_tile_renderer_factory(tile_renderer_factory)
           , m_pass_callback(pass_callback)
+          , m_sample_budget_aov_index(~0)
           , m_is_rendering(false)
         {
             // We must have a renderer factory, but it's OK not to have a callback factory.
             assert(tile_renderer_factory);
 
+            // Fill the AOV showing the fraction of the passes spent on each tile if the frame
+            // declares it, or create it if diagnostics are enabled.
+            if (m_params.m_noise_threshold > 0.0f || m_params.m_time_limit > 0.0)
+            {
+                ImageStack& images = frame.aov_images();
+
+                m_sample_budget_aov_index = images.get_index("sample_budget");
+                if (m_params.m_diagnostics && m_sample_budget_aov_index == size_t(~0) && images.size() < MaxAOVCount)
+                    m_sample_budget_aov_index = images.append("sample_budget", ImageStack::IdentificationType, 4, PixelFormatFloat);
+
+                if (m_params.m_diagnostics && m_sample_budget_aov_index == size_t(~0))
+                {
+                    RENDERER_LOG_WARNING(
+                        "could not create sample budget AOV, maximum number of AOVs (" FMT_SIZE_T ") reached.",
+                        MaxAOVCount);
+                }
+            }
+
             // Create and initialize job manager.
             m_job_manager.reset(
                 new JobManager(
@@ -113,9 +146,15 @@ namespace
             RENDERER_LOG_INFO(
                 "rendering settings:\n"
                 "  sampling mode    %s\n"
-                "  threads          %s",
+                "  threads          %s\n"
+                "  passes           %s\n"
+                "  noise threshold  %s\n"
+                "  time limit       %s",
                 get_sampling_context_mode_name(get_sampling_context_mode(params)).c_str(),
-                pretty_int(m_params.m_thread_count).c_str());
+                pretty_int(m_params.m_thread_count).c_str(),
+                m_params.m_pass_count != size_t(~0) ? pretty_uint(m_params.m_pass_count).c_str() : "unlimited",
+                m_params.m_noise_threshold > 0.0f ? pretty_scalar(m_params.m_noise_threshold, 4).c_str() : "none",
+                m_params.m_time_limit > 0.0 ? pretty_time(m_params.m_time_limit).c_str() : "none");
         }
 
         virtual ~GenericFrameRenderer()
@@ -169,6 +208,10 @@ namespace
                     m_frame,
                     m_params.m_tile_ordering,
                     m_params.m_pass_count,
+                    m_params.m_noise_threshold,
+                    m_params.m_time_limit,
+                    m_sample_budget_aov_index,
+                    m_tile_renderer_factory,
                     m_tile_renderers,
                     m_tile_callbacks,
                     m_pass_callback,
@@ -216,12 +259,18 @@ namespace
         {
             const size_t                        m_thread_count;     // number of rendering threads
             const TileJobFactory::TileOrdering  m_tile_ordering;    // tile rendering order
-            const size_t                        m_pass_count;       // number of rendering passes
+            const size_t                        m_pass_count;       // maximum number of rendering passes, ~0 for unlimited
+            const float                         m_noise_threshold;  // relative error below which tiles have converged, 0 to disable
+            const double                        m_time_limit;       // rendering time budget in seconds, 0 for unlimited
+            const bool                          m_diagnostics;      // output the sample budget AOV
 
             explicit Parameters(const ParamArray& params)
               : m_thread_count(get_rendering_thread_count(params))
               , m_tile_ordering(get_tile_ordering(params))
-              , m_pass_count(params.get_optional<size_t>("passes", 1))
+              , m_pass_count(GenericFrameRendererFactory::get_pass_count(params))
+              , m_noise_threshold(params.get_optional<float>("noise_threshold", 0.0f))
+              , m_time_limit(params.get_optional<double>("time_limit", 0.0))
+              , m_diagnostics(params.get_optional<bool>("enable_diagnostics", false))
             {
             }
 
@@ -259,6 +308,15 @@ namespace
             }
         };
 
+        //
+        // Rendering passes are driven by a dedicated thread.
+        //
+        // When a noise threshold is set, the error of a tile is estimated after each pass
+        // from the spread of the average luminances of the tile in the individual passes,
+        // and converged tiles are not rendered again. When a time limit is set, no new pass
+        // is started if it would not complete in the remaining time.
+        //
+
         class PassManagerFunc
           : public NonCopyable
         {
@@ -267,6 +325,10 @@ namespace
                 const Frame&                        frame,
                 const TileJobFactory::TileOrdering  tile_ordering,
                 const size_t                        pass_count,
+                const float                         noise_threshold,
+                const double                        time_limit,
+                const size_t                        sample_budget_aov_index,
+                ITileRendererFactory*               tile_renderer_factory,
                 vector<ITileRenderer*>&             tile_renderers,
                 vector<ITileCallback*>&             tile_callbacks,
                 IPassCallback*                      pass_callback,
@@ -275,18 +337,32 @@ namespace
                 bool&                               is_rendering)
               : m_frame(frame)
               , m_tile_ordering(tile_ordering)
-              , m_pass_count(pass_count)
+              , m_tile_renderer_factory(tile_renderer_factory)
               , m_tile_renderers(tile_renderers)
               , m_tile_callbacks(tile_callbacks)
               , m_pass_callback(pass_callback)
+              , m_pass_count(pass_count)
+              , m_noise_threshold(noise_threshold)
+              , m_time_limit(time_limit)
+              , m_sample_budget_aov_index(sample_budget_aov_index)
               , m_job_queue(job_queue)
               , m_abort_switch(abort_switch)
               , m_is_rendering(is_rendering)
+              , m_rendered_pass_count(0)
+              , m_tail_time(0.0)
             {
             }
 
             void operator()()
             {
+                const size_t tile_count = m_frame.image().properties().m_tile_count;
+                m_active_tiles.assign(tile_count, true);
+                m_tile_pass_counts.assign(tile_count, 0);
+                m_tile_stats.assign(tile_count, TileStatistics());
+
+                Stopwatch<DefaultWallclockTimer> stopwatch;
+                stopwatch.start();
+
                 for (size_t pass = 0; pass < m_pass_count && !m_abort_switch.is_aborted(); ++pass)
                 {
                     if (m_pass_count > 1)
@@ -300,8 +376,12 @@ namespace
                         assert(!m_job_queue.has_scheduled_or_running_jobs());
                     }
 
+                    // Tell the tile renderers which tiles will be rendered during this pass.
+                    m_tile_renderer_factory->on_pass_begin(m_active_tiles);
+
                     // Create tile jobs.
                     const uint32 pass_hash = hash_uint32(static_cast<uint32>(pass));
+                    TileJob::PassState pass_state(m_job_queue);
                     TileJobFactory::TileJobVector tile_jobs;
                     m_tile_job_factory.create(
                         m_frame,
@@ -309,6 +389,8 @@ namespace
                         m_tile_renderers,
                         m_tile_callbacks,
                         pass_hash,
+                        m_active_tiles,
+                        pass_state,
                         tile_jobs,
                         m_abort_switch);
 
@@ -319,6 +401,10 @@ namespace
                     // Wait until tile jobs have effectively stopped.
                     m_job_queue.wait_until_completion();
 
+                    // Account for the time during which some rendering threads were idle.
+                    m_tail_time += pass_state.get_tail_time();
+                    ++m_rendered_pass_count;
+
                     // Invoke the post-pass callback if there is one.
                     if (m_pass_callback)
                     {
@@ -326,27 +412,187 @@ namespace
                         m_pass_callback->post_render(m_frame, m_job_queue, m_abort_switch);
                         assert(!m_job_queue.has_scheduled_or_running_jobs());
                     }
+
+                    if (m_abort_switch.is_aborted())
+                        break;
+
+                    const size_t active_tile_count = update_active_tiles();
+
+                    if (m_sample_budget_aov_index != size_t(~0))
+                        write_sample_budget_aov();
+
+                    if (m_noise_threshold > 0.0f)
+                    {
+                        RENDERER_LOG_INFO(
+                            "%s of tiles converged after pass %s.",
+                            pretty_percent(tile_count - active_tile_count, tile_count).c_str(),
+                            pretty_uint(pass + 1).c_str());
+                    }
+
+                    if (active_tile_count == 0)
+                    {
+                        RENDERER_LOG_INFO("all tiles have converged.");
+                        break;
+                    }
+
+                    // Don't start a pass that would likely exceed the time limit.
+                    if (m_time_limit > 0.0)
+                    {
+                        stopwatch.measure();
+                        const double elapsed = stopwatch.get_seconds();
+                        const double pass_duration = elapsed / (pass + 1);
+
+                        if (elapsed + pass_duration > m_time_limit)
+                        {
+                            RENDERER_LOG_INFO(
+                                "stopping after pass %s to honor the time limit of %s.",
+                                pretty_uint(pass + 1).c_str(),
+                                pretty_time(m_time_limit).c_str());
+                            break;
+                        }
+                    }
                 }
 
                 m_is_rendering = false;
             }
 
+            StatisticsVector get_statistics() const
+            {
+                Statistics stats;
+                stats.insert("passes", m_rendered_pass_count);
+                stats.insert_time("tail time", m_tail_time);
+
+                return StatisticsVector::make("generic frame renderer statistics", stats);
+            }
+
           private:
+            // Luminance statistics of a tile over the passes rendered so far.
+            struct TileStatistics
+            {
+                double  m_luminance;            // average luminance of the tile after the last pass
+                double  m_pass_luminance_sum;   // sum of the average luminances of the tile in individual passes
+                double  m_pass_luminance_sum2;  // sum of their squares
+
+                TileStatistics()
+                  : m_luminance(0.0)
+                  , m_pass_luminance_sum(0.0)
+                  , m_pass_luminance_sum2(0.0)
+                {
+                }
+            };
+
             const Frame&                            m_frame;
             const TileJobFactory::TileOrdering      m_tile_ordering;
+            ITileRendererFactory*                   m_tile_renderer_factory;
             vector<ITileRenderer*>&                 m_tile_renderers;
             vector<ITileCallback*>&                 m_tile_callbacks;
             IPassCallback*                          m_pass_callback;
             const size_t                            m_pass_count;
+            const float                             m_noise_threshold;
+            const double                            m_time_limit;
+            const size_t                            m_sample_budget_aov_index;
             JobQueue&                               m_job_queue;
             IAbortSwitch&                           m_abort_switch;
             bool&                                   m_is_rendering;
             TileJobFactory                          m_tile_job_factory;
+            vector<bool>                            m_active_tiles;
+            vector<size_t>                          m_tile_pass_counts;
+            vector<TileStatistics>                  m_tile_stats;
+            uint64                                  m_rendered_pass_count;
+            double                                  m_tail_time;                // total time spent with idle rendering threads, in seconds
+
+            // Account for the pass that was just rendered, and return the number of tiles that still need rendering.
+            size_t update_active_tiles()
+            {
+                const Image& image = m_frame.image();
+                const CanvasProperties& props = image.properties();
+
+                size_t active_tile_count = 0;
+
+                for (size_t i = 0; i < props.m_tile_count; ++i)
+                {
+                    if (!m_active_tiles[i])
+                        continue;
+
+                    const size_t pass_count = ++m_tile_pass_counts[i];
+
+                    if (m_noise_threshold > 0.0f)
+                    {
+                        const Tile& tile = image.tile(i % props.m_tile_count_x, i / props.m_tile_count_x);
+
+                        if (update_tile_error(tile, pass_count, m_tile_stats[i]) <= m_noise_threshold)
+                        {
+                            m_active_tiles[i] = false;
+                            continue;
+                        }
+                    }
+
+                    ++active_tile_count;
+                }
+
+                return active_tile_count;
+            }
+
+            // Account for a new pass in the statistics of a tile and estimate the relative error of the tile.
+            // Return a value larger than any threshold if there are not enough passes to estimate the error.
+            static float update_tile_error(
+                const Tile&                         tile,
+                const size_t                        pass_count,
+                TileStatistics&                     stats)
+            {
+                // Minimum number of passes before the error of a tile is estimated.
+                const size_t MinPassCount = 4;
+
+                // Luminance added to the average luminance of the tile, to prevent noise
+                // in very dark tiles from dominating the error estimate.
+                const double DarkLuminance = 0.01;
+
+                // Passes accumulate, and each pass adds the same number of samples to the tile: if L(k)
+                // is the average luminance of the tile after k passes, the average luminance of the tile
+                // in pass k alone is k L(k) - (k - 1) L(k - 1).
+                const double k = static_cast<double>(pass_count);
+                const double luminance = compute_average_luminance(tile);
+                const double pass_luminance = k * luminance - (k - 1.0) * stats.m_luminance;
+                stats.m_luminance = luminance;
+                stats.m_pass_luminance_sum += pass_luminance;
+                stats.m_pass_luminance_sum2 += square(pass_luminance);
+
+                if (pass_count < MinPassCount)
+                    return numeric_limits<float>::max();
+
+                // Variance of the average luminance of the tile in a single pass.
+                const double mean = stats.m_pass_luminance_sum / k;
+                const double variance = max((stats.m_pass_luminance_sum2 - k * square(mean)) / (k - 1.0), 0.0);
+
+                // The average of n pixels with independent noise of variance s^2 has a variance of s^2 / n,
+                // so the standard deviation of a single pixel after k passes is sqrt(n variance / k).
+                // Reconstruction filters correlate neighboring pixels, which makes this estimate conservative.
+                const double pixel_count = static_cast<double>(tile.get_pixel_count());
+                const double error = sqrt(pixel_count * variance / k);
+
+                return static_cast<float>(error / (luminance + DarkLuminance));
+            }
+
+            void write_sample_budget_aov() const
+            {
+                static const Color4f Blue(0.0f, 0.0f, 1.0f, 1.0f);
+                static const Color4f Red(1.0f, 0.0f, 0.0f, 1.0f);
+
+                Image& aov_image = m_frame.aov_images().get_image(m_sample_budget_aov_index);
+                const CanvasProperties& props = aov_image.properties();
+
+                for (size_t i = 0; i < props.m_tile_count; ++i)
+                {
+                    const float budget = static_cast<float>(m_tile_pass_counts[i]) / m_rendered_pass_count;
+                    aov_image.tile(i % props.m_tile_count_x, i / props.m_tile_count_x).clear(lerp(Blue, Red, budget));
+                }
+            }
         };
 
         const Frame&                m_frame;            // target framebuffer
         const Parameters            m_params;
 
+        ITileRendererFactory*       m_tile_renderer_factory;
         JobQueue                    m_job_queue;
         auto_ptr<JobManager>        m_job_manager;
         AbortSwitch                 m_abort_switch;
@@ -354,6 +600,7 @@ namespace
         vector<ITileRenderer*>      m_tile_renderers;   // tile renderers, one per thread
         vector<ITileCallback*>      m_tile_callbacks;   // tile callbacks, none or one per thread
         IPassCallback*              m_pass_callback;
+        size_t                      m_sample_budget_aov_index;
 
         TileJobFactory              m_tile_job_factory;
 
@@ -370,6 +617,9 @@ namespace
             for (size_t i = 0; i < m_tile_renderers.size(); ++i)
                 stats.merge(m_tile_renderers[i]->get_statistics());
 
+            if (m_pass_manager_func.get())
+                stats.merge(m_pass_manager_func->get_statistics());
+
             RENDERER_LOG_DEBUG("%s", stats.to_string().c_str());
         }
     };
@@ -426,6 +676,27 @@ IFrameRenderer* GenericFrameRendererFactory::create(
             params);
 }
 
+size_t GenericFrameRendererFactory::get_pass_count(const ParamArray& params)
+{
+    // Without a noise threshold or a time limit, there would be nothing to stop an unlimited number of passes.
+    const bool has_stopping_criterion =
+        params.get_optional<float>("noise_threshold", 0.0f) > 0.0f ||
+        params.get_optional<double>("time_limit", 0.0) > 0.0;
+
+    const size_t pass_count = params.get_optional<size_t>("passes", has_stopping_criterion ? 0 : 1);
+
+    if (pass_count == 0)
+    {
+        if (has_stopping_criterion)
+            return ~0;
+
+        RENDERER_LOG_WARNING("an unlimited number of passes requires a noise threshold or a time limit, rendering a single pass.");
+        return 1;
+    }
+
+    return pass_count;
+}
+
 Dictionary GenericFrameRendererFactory::get_params_metadata()
 {
     Dictionary metadata;
@@ -436,7 +707,33 @@ Dictionary GenericFrameRendererFactory::get_params_metadata()
             .insert("type", "int")
             .insert("default", "1")
             .insert("label", "Passes")
-            .insert("help", "Number of render passes"));
+            .insert("help", "Number of render passes; 0 for unlimited, which is the default when a noise threshold or a time limit is set"));
+
+    metadata.dictionaries().insert(
+        "noise_threshold",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.0")
+            .insert("label", "Noise Threshold")
+            .insert("help", "Relative error below which tiles are no longer rendered; estimated from the fourth pass on, 0 to disable"));
+
+    metadata.dictionaries().insert(
+        "time_limit",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.0")
+            .insert("label", "Time Limit")
+            .insert("help", "Rendering time budget in seconds; no pass is started past this budget, 0 for unlimited"));
+
+    metadata.dictionaries().insert(
+        "enable_diagnostics",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Diagnostics")
+            .insert(
+                "help",
+                "Output a sample budget AOV showing the fraction of the passes spent on each tile"));
 
     metadata.dictionaries().insert(
         "tile_ordering",
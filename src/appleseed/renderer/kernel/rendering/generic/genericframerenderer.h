@@ -37,6 +37,9 @@
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class Dictionary; }
 namespace renderer      { class Frame; }
@@ -80,6 +83,9 @@ class GenericFrameRendererFactory
     // Return the metadata of the generic frame renderer parameters.
     static foundation::Dictionary get_params_metadata();
 
+    // Return the maximum number of passes to render, ~0 if the number of passes is unlimited.
+    static size_t get_pass_count(const ParamArray& params);
+
   private:
     const Frame&                m_frame;
     ITileRendererFactory*       m_tile_renderer_factory;
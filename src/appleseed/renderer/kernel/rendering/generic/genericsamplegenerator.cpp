@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/rendering/adaptivesamplingmap.h"
 #include "renderer/kernel/rendering/isamplerenderer.h"
 #include "renderer/kernel/rendering/localsampleaccumulationbuffer.h"
 #include "renderer/kernel/rendering/pixelcontext.h"
@@ -51,6 +52,7 @@
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
@@ -91,6 +93,7 @@ namespace
           , m_sample_renderer(sample_renderer_factory->create(generator_index))
           , m_window_width_next_pow2(next_power(static_cast<double>(m_window_width), 2.0))
           , m_window_height_next_pow3(next_power(static_cast<double>(m_window_height), 3.0))
+          , m_adaptive_sampling_map(0)
         {
         }
 
@@ -105,6 +108,20 @@ namespace
             m_rng = SamplingContext::RNGType();
         }
 
+        virtual void generate_samples(
+            const size_t                    sample_count,
+            SampleAccumulationBuffer&       buffer,
+            IAbortSwitch&                   abort_switch) APPLESEED_OVERRIDE
+        {
+            // Sample positions are drawn from the adaptive sampling map of the buffer, if any.
+            m_adaptive_sampling_map = buffer.get_adaptive_sampling_map();
+
+            SampleGeneratorBase::generate_samples(sample_count, buffer, abort_switch);
+
+            if (m_adaptive_sampling_map)
+                m_adaptive_sampling_map->update();
+        }
+
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
         {
             Statistics stats;
@@ -147,6 +164,8 @@ namespace
         Population<uint64>                  m_total_sampling_dim;
         Population<uint64>                  m_total_sampling_inst;
 
+        AdaptiveSamplingMap*                m_adaptive_sampling_map;
+
         virtual size_t generate_samples(
             const size_t                    sequence_index,
             SampleVector&                   samples) APPLESEED_OVERRIDE
@@ -155,8 +174,22 @@ namespace
             const size_t Bases[2] = { 2, 3 };
             const Vector2d s = halton_sequence<double, 2>(Bases, sequence_index);
 
-            // Compute the coordinates of the pixel in the padded crop window.
-            const Vector2d t(s[0] * m_window_width_next_pow2, s[1] * m_window_height_next_pow3);
+            Vector2d t;
+
+            if (m_adaptive_sampling_map)
+            {
+                // Compute the coordinates of the pixel in the crop window, with a density
+                // proportional to the estimated error.
+                t = m_adaptive_sampling_map->sample(s);
+                t[0] -= m_window_origin_x;
+                t[1] -= m_window_origin_y;
+            }
+            else
+            {
+                // Compute the coordinates of the pixel in the padded crop window.
+                t = Vector2d(s[0] * m_window_width_next_pow2, s[1] * m_window_height_next_pow3);
+            }
+
             const int x = truncate<int>(t[0]);
             const int y = truncate<int>(t[1]);
 
@@ -254,11 +287,60 @@ SampleAccumulationBuffer* GenericSampleGeneratorFactory::create_sample_accumulat
 {
     const CanvasProperties& props = m_frame.image().properties();
 
+    AdaptiveSamplingMap* adaptive_sampling_map =
+        m_params.get_optional<bool>("adaptive", false)
+            ? new AdaptiveSamplingMap(
+                  props.m_canvas_width,
+                  props.m_canvas_height,
+                  m_frame.get_crop_window(),
+                  m_params)
+            : 0;
+
     return
         new LocalSampleAccumulationBuffer(
             props.m_canvas_width,
             props.m_canvas_height,
-            m_frame.get_filter());
+            m_frame.get_filter(),
+            adaptive_sampling_map);
+}
+
+Dictionary GenericSampleGeneratorFactory::get_params_metadata()
+{
+    Dictionary metadata;
+
+    metadata.dictionaries().insert(
+        "adaptive",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Adaptive Sampling")
+            .insert("help", "Concentrate samples in noisy regions and stop rendering once the image has converged"));
+
+    metadata.dictionaries().insert(
+        "min_samples",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "16")
+            .insert("label", "Min Samples")
+            .insert("help", "Minimum number of samples per pixel before a pixel may be considered converged"));
+
+    metadata.dictionaries().insert(
+        "max_samples",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "0")
+            .insert("label", "Max Samples")
+            .insert("help", "Maximum number of samples per pixel, or 0 for unlimited"));
+
+    metadata.dictionaries().insert(
+        "quality",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "2.0")
+            .insert("label", "Quality")
+            .insert("help", "Quality factor; the noise target is a relative error of 10^-quality"));
+
+    return metadata;
 }
 
 }   // namespace renderer
@@ -33,6 +33,7 @@
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/rendering/generic/sharedborderaccumulationbuffer.h"
 #include "renderer/kernel/aov/imagestack.h"
 #include "renderer/kernel/aov/tilestack.h"
 #include "renderer/kernel/rendering/ipixelrenderer.h"
@@ -42,6 +43,7 @@
 #include "renderer/modeling/frame/frame.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
 #include "foundation/image/tile.h"
@@ -60,7 +62,11 @@
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/string.h"
 
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <memory>
@@ -78,6 +84,19 @@ namespace
     //
     // Generic tile renderer.
     //
+    // The pixels of a padded tile are rendered in segments of consecutive pixels along
+    // the tile's Hilbert pixel ordering. The RNG is reseeded at the beginning of each
+    // segment, such that the segments of a tile may be rendered independently.
+    //
+    // When rendering threads are idle, the segments of a tile that remain to be rendered
+    // are split in two halves and the second half is handed off to the idle threads.
+    // Each part of a split tile accumulates samples into its own framebuffer; these
+    // framebuffers are merged together and developed by the part completed last.
+    //
+    // When tile borders are shared, only the pixels of the tile itself are rendered,
+    // into a framebuffer padded with the tile margins, which is then accumulated into
+    // the tile and its neighbors by a SharedBorderAccumulationBuffer.
+    //
 
 #ifndef NDEBUG
 
@@ -87,6 +106,134 @@ namespace
 
 #endif
 
+    // Number of pixels in a segment of a tile.
+    const size_t SegmentSize = 128;
+
+    // Compute the margins by which tiles must be padded for the reconstruction filter to cover their borders.
+    void compute_tile_margins(
+        const Frame&                        frame,
+        int&                                margin_width,
+        int&                                margin_height)
+    {
+        margin_width = truncate<int>(ceil(frame.get_filter().get_xradius() - 0.5f));
+        margin_height = truncate<int>(ceil(frame.get_filter().get_yradius() - 0.5f));
+    }
+
+    // State shared by the parts of a split tile.
+    struct SplitTile
+      : public NonCopyable
+    {
+        IShadingResultFrameBufferFactory*   m_framebuffer_factory;      // 0 if the framebuffer is owned by this object
+        ShadingResultFrameBuffer*           m_framebuffer;              // framebuffer of the first part
+        boost::mutex                        m_mutex;
+        size_t                              m_pending_part_count;       // number of parts not completed yet
+        vector<ShadingResultFrameBuffer*>   m_part_framebuffers;        // framebuffers of the other completed parts
+
+        SplitTile(
+            IShadingResultFrameBufferFactory*   framebuffer_factory,
+            ShadingResultFrameBuffer*           framebuffer)
+          : m_framebuffer_factory(framebuffer_factory)
+          , m_framebuffer(framebuffer)
+          , m_pending_part_count(1)
+        {
+        }
+
+        ~SplitTile()
+        {
+            for (size_t i = 0; i < m_part_framebuffers.size(); ++i)
+                delete m_part_framebuffers[i];
+
+            if (m_framebuffer_factory)
+                m_framebuffer_factory->destroy(m_framebuffer);
+            else delete m_framebuffer;
+        }
+
+        void add_part()
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            ++m_pending_part_count;
+        }
+
+        // Return true if the completed part was the last one.
+        bool complete_part(ShadingResultFrameBuffer* part_framebuffer)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            if (part_framebuffer)
+                m_part_framebuffers.push_back(part_framebuffer);
+
+            assert(m_pending_part_count > 0);
+            return --m_pending_part_count == 0;
+        }
+
+        // Merge the framebuffers of all parts into the framebuffer of the first part.
+        void merge_parts()
+        {
+            const size_t width = m_framebuffer->get_width();
+            const size_t height = m_framebuffer->get_height();
+
+            for (size_t i = 0; i < m_part_framebuffers.size(); ++i)
+            {
+                for (size_t y = 0; y < height; ++y)
+                {
+                    for (size_t x = 0; x < width; ++x)
+                        m_framebuffer->merge(x, y, *m_part_framebuffers[i], x, y, 1.0f);
+                }
+            }
+        }
+    };
+
+    // A range of segments of a split tile, handed off to another rendering thread.
+    class TilePart
+      : public ITileSplitter::Part
+    {
+      public:
+        SplitTile*      m_split_tile;
+        const size_t    m_begin;
+        const size_t    m_end;
+
+        TilePart(
+            SplitTile*      split_tile,
+            const size_t    begin,
+            const size_t    end)
+          : m_split_tile(split_tile)
+          , m_begin(begin)
+          , m_end(end)
+        {
+            m_split_tile->add_part();
+        }
+
+        virtual ~TilePart() APPLESEED_OVERRIDE
+        {
+            // Account for parts that were never rendered, e.g. because rendering was aborted.
+            if (m_split_tile && m_split_tile->complete_part(0))
+                delete m_split_tile;
+        }
+    };
+
+    // A tile splitter for tiles rendered outside of tile jobs: tiles are never split.
+    class NoTileSplitter
+      : public ITileSplitter
+    {
+      public:
+        virtual bool has_idle_threads() const APPLESEED_OVERRIDE
+        {
+            return false;
+        }
+
+        virtual void split(Part* part) APPLESEED_OVERRIDE
+        {
+            assert(!"Tiles cannot be split.");
+            delete part;
+        }
+
+        virtual void on_tile_completed(
+            const size_t    tile_x,
+            const size_t    tile_y) APPLESEED_OVERRIDE
+        {
+        }
+    };
+
     class GenericTileRenderer
       : public ITileRenderer
     {
@@ -95,12 +242,22 @@ namespace
             const Frame&                        frame,
             IPixelRendererFactory*              pixel_renderer_factory,
             IShadingResultFrameBufferFactory*   framebuffer_factory,
+            SharedBorderAccumulationBuffer*     shared_borders,
             const ParamArray&                   params,
             const size_t                        thread_index)
           : m_pixel_renderer(pixel_renderer_factory->create(thread_index))
           , m_framebuffer_factory(framebuffer_factory)
+          , m_shared_borders(m_pixel_renderer->needs_whole_tiles() ? 0 : shared_borders)
+          , m_split_count(0)
         {
-            compute_tile_margins(frame, thread_index == 0);
+            if (shared_borders && m_shared_borders == 0 && thread_index == 0)
+                RENDERER_LOG_WARNING("the pixel renderer does not support shared tile borders, tiles will be padded.");
+
+            compute_tile_margins(frame, m_margin_width, m_margin_height);
+
+            if (thread_index == 0 && m_shared_borders == 0)
+                print_wasted_effort(frame);
+
             compute_pixel_ordering(frame);
         }
 
@@ -110,11 +267,24 @@ namespace
         }
 
         virtual void render_tile(
-            const Frame&    frame,
-            const size_t    tile_x,
-            const size_t    tile_y,
-            const size_t    pass_hash,
-            IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE
+            const Frame&            frame,
+            const size_t            tile_x,
+            const size_t            tile_y,
+            const size_t            pass_hash,
+            IAbortSwitch&           abort_switch) APPLESEED_OVERRIDE
+        {
+            NoTileSplitter tile_splitter;
+            render_tile_part(frame, tile_x, tile_y, pass_hash, 0, tile_splitter, abort_switch);
+        }
+
+        virtual bool render_tile_part(
+            const Frame&            frame,
+            const size_t            tile_x,
+            const size_t            tile_y,
+            const size_t            pass_hash,
+            ITileSplitter::Part*    part,
+            ITileSplitter&          tile_splitter,
+            IAbortSwitch&           abort_switch) APPLESEED_OVERRIDE
         {
             // Retrieve frame properties.
             const CanvasProperties& frame_properties = frame.image().properties();
@@ -135,7 +305,7 @@ namespace
             tile_bbox.max.y = tile_origin_y + static_cast<int>(tile.get_height()) - 1;
             tile_bbox = AABB2i::intersect(tile_bbox, AABB2i(frame.get_crop_window()));
             if (!tile_bbox.is_valid())
-                return;
+                return true;
 
             // Transform the bounding box to local (tile) space.
             tile_bbox.min.x -= tile_origin_x;
@@ -153,94 +323,207 @@ namespace
             // Inform the pixel renderer that we are about to render a tile.
             m_pixel_renderer->on_tile_begin(frame, tile, aov_tiles);
 
-            // Create the framebuffer into which we will accumulate the samples.
-            ShadingResultFrameBuffer* framebuffer =
-                m_framebuffer_factory->create(
-                    frame,
-                    tile_x,
-                    tile_y,
-                    tile_bbox);
+            // Retrieve the range of segments to render and create the framebuffer into
+            // which we will accumulate the samples.
+            SplitTile* split_tile;
+            size_t begin, end;
+            ShadingResultFrameBuffer* framebuffer;
+            if (part)
+            {
+                TilePart* tile_part = static_cast<TilePart*>(part);
+                split_tile = tile_part->m_split_tile;
+                tile_part->m_split_tile = 0;
+                begin = tile_part->m_begin;
+                end = tile_part->m_end;
+                if (m_shared_borders)
+                    framebuffer = m_shared_borders->create_padded_framebuffer(tile_x, tile_y);
+                else
+                {
+                    framebuffer =
+                        new ShadingResultFrameBuffer(
+                            tile.get_width(),
+                            tile.get_height(),
+                            frame.aov_images().size(),
+                            tile_bbox,
+                            frame.get_filter());
+                    framebuffer->clear();
+                }
+            }
+            else
+            {
+                split_tile = 0;
+                begin = 0;
+                end = (m_pixel_ordering.size() + SegmentSize - 1) / SegmentSize;
+                if (m_shared_borders)
+                    framebuffer = m_shared_borders->create_padded_framebuffer(tile_x, tile_y);
+                else
+                {
+                    framebuffer =
+                        m_framebuffer_factory->create(
+                            frame,
+                            tile_x,
+                            tile_y,
+                            tile_bbox);
+                }
+            }
             assert(framebuffer);
 
-            // Seed the RNG with the tile index and the pass hash.
-            // Seeding the RNG per tile instead of per pixel has potential consequences on
-            // debugging: rendering a subset of a tile may lead to different computations
-            // than rendering the full tile, e.g. if the sampling context switches to random
+            // Only render the pixels of the tile itself if its borders are shared with its
+            // neighbors. Pixel coordinates are then offset into the padded framebuffer.
+            const AABB2i& pixel_bbox = m_shared_borders ? tile_bbox : padded_tile_bbox;
+            const AABB2i framebuffer_bbox =
+                m_shared_borders
+                    ? m_shared_borders->get_padded_crop_window(tile_x, tile_y)
+                    : tile_bbox;
+            const Vector2i framebuffer_offset =
+                m_shared_borders
+                    ? Vector2i(m_margin_width, m_margin_height)
+                    : Vector2i(0, 0);
+
+            // Seed the RNG of each segment with the tile index, the segment index and the pass hash.
+            // Seeding the RNG per segment instead of per pixel has potential consequences on
+            // debugging: rendering a subset of a segment may lead to different computations
+            // than rendering the full segment, e.g. if the sampling context switches to random
             // sampling because the number of dimensions becomes too high.
             const size_t tile_index = tile_y * frame_properties.m_tile_count_x + tile_x;
 #ifdef APPLESEED_ARCH64
-            m_rng = SamplingContext::RNGType(hash_uint64_to_uint32(pass_hash ^ tile_index));
+            const uint32 tile_seed = hash_uint64_to_uint32(pass_hash ^ tile_index);
 #else
-            m_rng = SamplingContext::RNGType(pass_hash ^ tile_index);
+            const uint32 tile_seed = static_cast<uint32>(pass_hash ^ tile_index);
 #endif
 
-            // Loop over tile pixels.
-            for (size_t i = 0, e = m_pixel_ordering.size(); i < e; ++i)
+            // Loop over tile segments.
+            for (size_t segment = begin; segment < end; ++segment)
             {
                 // Cancel any work done on this tile if rendering is aborted.
                 if (abort_switch.is_aborted())
-                    return;
+                    break;
+
+                // Hand off the second half of the remaining segments to idle rendering threads.
+                if (!m_pixel_renderer->needs_whole_tiles() &&
+                    end - segment > 1 &&
+                    tile_splitter.has_idle_threads())
+                {
+                    if (split_tile == 0)
+                        split_tile = new SplitTile(m_shared_borders ? 0 : m_framebuffer_factory, framebuffer);
+
+                    const size_t middle = segment + (end - segment) / 2;
+                    tile_splitter.split(new TilePart(split_tile, middle, end));
+                    end = middle;
+
+                    ++m_split_count;
+                }
+
+                m_rng = SamplingContext::RNGType(mix_uint32(tile_seed, static_cast<uint32>(segment)));
 
-                // Retrieve the coordinates of the pixel in the padded tile.
-                const Vector2i pt(m_pixel_ordering[i].x, m_pixel_ordering[i].y);
+                // Loop over the pixels of the segment.
+                const size_t pixel_begin = segment * SegmentSize;
+                const size_t pixel_end = min(pixel_begin + SegmentSize, m_pixel_ordering.size());
+                for (size_t i = pixel_begin; i < pixel_end; ++i)
+                {
+                    // Retrieve the coordinates of the pixel in the padded tile.
+                    const Vector2i pt(m_pixel_ordering[i].x, m_pixel_ordering[i].y);
 
-                // Skip pixels outside the intersection of the padded tile and the crop window.
-                if (!padded_tile_bbox.contains(pt))
-                    continue;
+                    // Skip pixels outside the intersection of the padded tile and the crop window.
+                    if (!pixel_bbox.contains(pt))
+                        continue;
 
-                const Vector2i pi(tile_origin_x + pt.x, tile_origin_y + pt.y);
+                    const Vector2i pi(tile_origin_x + pt.x, tile_origin_y + pt.y);
 
 #ifdef DEBUG_BREAK_AT_PIXEL
 
-                // Break in the debugger when this pixel is reached.
-                if (pi == DEBUG_BREAK_AT_PIXEL)
-                    BREAKPOINT();
+                    // Break in the debugger when this pixel is reached.
+                    if (pi == DEBUG_BREAK_AT_PIXEL)
+                        BREAKPOINT();
 
 #endif
 
-                // Render this pixel.
-                m_pixel_renderer->render_pixel(
-                    frame,
-                    tile,
-                    aov_tiles,
-                    tile_bbox,
-                    pass_hash,
-                    pi,
-                    pt,
-                    m_rng,
-                    *framebuffer);
+                    // Render this pixel.
+                    m_pixel_renderer->render_pixel(
+                        frame,
+                        tile,
+                        aov_tiles,
+                        framebuffer_bbox,
+                        pass_hash,
+                        pi,
+                        pt + framebuffer_offset,
+                        m_rng,
+                        *framebuffer);
+                }
+            }
+
+            if (split_tile)
+            {
+                // Let the part completed last merge and develop the framebuffers of all parts.
+                if (!split_tile->complete_part(part ? framebuffer : 0))
+                {
+                    m_pixel_renderer->on_tile_end(frame, tile, aov_tiles);
+                    return false;
+                }
+
+                split_tile->merge_parts();
+                framebuffer = split_tile->m_framebuffer;
             }
 
-            // Develop the framebuffer to the tile.
-            if (frame.is_premultiplied_alpha())
-                framebuffer->develop_to_tile_premult_alpha(tile, aov_tiles);
-            else framebuffer->develop_to_tile_straight_alpha(tile, aov_tiles);
+            // Develop the framebuffer to the tile, or accumulate it into the tile and its neighbors.
+            bool tile_completed = true;
+            if (!abort_switch.is_aborted())
+            {
+                if (m_shared_borders)
+                {
+                    vector<Vector2u> completed_tiles;
+                    m_shared_borders->accumulate(tile_x, tile_y, pass_hash, *framebuffer, completed_tiles);
+
+                    // The tile itself may still be waiting for the contributions of its neighbors.
+                    tile_completed = false;
+                    for (size_t i = 0; i < completed_tiles.size(); ++i)
+                    {
+                        if (completed_tiles[i].x == tile_x && completed_tiles[i].y == tile_y)
+                            tile_completed = true;
+                        else tile_splitter.on_tile_completed(completed_tiles[i].x, completed_tiles[i].y);
+                    }
+                }
+                else if (frame.is_premultiplied_alpha())
+                    framebuffer->develop_to_tile_premult_alpha(tile, aov_tiles);
+                else framebuffer->develop_to_tile_straight_alpha(tile, aov_tiles);
+            }
 
-            // Release the framebuffer.
-            m_framebuffer_factory->destroy(framebuffer);
+            // Release the framebuffers.
+            if (split_tile)
+                delete split_tile;
+            else if (m_shared_borders)
+                delete framebuffer;
+            else m_framebuffer_factory->destroy(framebuffer);
 
             // Inform the pixel renderer that we are done rendering the tile.
             m_pixel_renderer->on_tile_end(frame, tile, aov_tiles);
+
+            return tile_completed;
         }
 
         virtual StatisticsVector get_statistics() const APPLESEED_OVERRIDE
         {
-            return m_pixel_renderer->get_statistics();
+            Statistics stats;
+            stats.insert("tile splits", m_split_count);
+
+            StatisticsVector vec = m_pixel_renderer->get_statistics();
+            vec.merge(StatisticsVector::make("generic tile renderer statistics", stats));
+
+            return vec;
         }
 
       protected:
         auto_release_ptr<IPixelRenderer>    m_pixel_renderer;
         IShadingResultFrameBufferFactory*   m_framebuffer_factory;
+        SharedBorderAccumulationBuffer*     m_shared_borders;
+        uint64                              m_split_count;
         int                                 m_margin_width;
         int                                 m_margin_height;
         vector<Vector<int16, 2> >           m_pixel_ordering;
         SamplingContext::RNGType            m_rng;
 
-        void compute_tile_margins(const Frame& frame, const bool primary)
+        void print_wasted_effort(const Frame& frame) const
         {
-            m_margin_width = truncate<int>(ceil(frame.get_filter().get_xradius() - 0.5f));
-            m_margin_height = truncate<int>(ceil(frame.get_filter().get_yradius() - 0.5f));
-
             const CanvasProperties& properties = frame.image().properties();
             const size_t padded_tile_width = properties.m_tile_width + 2 * m_margin_width;
             const size_t padded_tile_height = properties.m_tile_height + 2 * m_margin_height;
@@ -250,17 +533,14 @@ namespace
             const double wasted_effort = static_cast<double>(overhead_pixel_count) / pixel_count * 100.0;
             const double MaxWastedEffort = 15.0;    // percents
 
-            if (primary)
-            {
-                RENDERER_LOG(
-                    wasted_effort > MaxWastedEffort ? LogMessage::Warning : LogMessage::Info,
-                    "rendering effort wasted by tile borders: %s (tile dimensions: %s x %s, tile margins: %s x %s)",
-                    pretty_percent(overhead_pixel_count, pixel_count).c_str(),
-                    pretty_uint(properties.m_tile_width).c_str(),
-                    pretty_uint(properties.m_tile_height).c_str(),
-                    pretty_uint(2 * m_margin_width).c_str(),
-                    pretty_uint(2 * m_margin_height).c_str());
-            }
+            RENDERER_LOG(
+                wasted_effort > MaxWastedEffort ? LogMessage::Warning : LogMessage::Info,
+                "rendering effort wasted by tile borders: %s (tile dimensions: %s x %s, tile margins: %s x %s)",
+                pretty_percent(overhead_pixel_count, pixel_count).c_str(),
+                pretty_uint(properties.m_tile_width).c_str(),
+                pretty_uint(properties.m_tile_height).c_str(),
+                pretty_uint(2 * m_margin_width).c_str(),
+                pretty_uint(2 * m_margin_height).c_str());
         }
 
         void compute_pixel_ordering(const Frame& frame)
@@ -307,6 +587,33 @@ GenericTileRendererFactory::GenericTileRendererFactory(
   , m_framebuffer_factory(framebuffer_factory)
   , m_params(params)
 {
+    if (m_params.get_optional<bool>("shared_tile_borders", false))
+    {
+        int margin_width, margin_height;
+        compute_tile_margins(frame, margin_width, margin_height);
+
+        const CanvasProperties& properties = frame.image().properties();
+
+        if (static_cast<size_t>(margin_width) <= properties.m_tile_width &&
+            static_cast<size_t>(margin_height) <= properties.m_tile_height)
+        {
+            m_shared_borders.reset(
+                new SharedBorderAccumulationBuffer(
+                    frame,
+                    framebuffer_factory,
+                    margin_width,
+                    margin_height));
+        }
+        else
+        {
+            RENDERER_LOG_WARNING(
+                "tile margins (%s x %s) exceed tile dimensions (%s x %s), tile borders will not be shared.",
+                pretty_uint(margin_width).c_str(),
+                pretty_uint(margin_height).c_str(),
+                pretty_uint(properties.m_tile_width).c_str(),
+                pretty_uint(properties.m_tile_height).c_str());
+        }
+    }
 }
 
 void GenericTileRendererFactory::release()
@@ -322,8 +629,16 @@ ITileRenderer* GenericTileRendererFactory::create(
             m_frame,
             m_pixel_renderer_factory,
             m_framebuffer_factory,
+            m_shared_borders.get(),
             m_params,
             thread_index);
 }
 
+void GenericTileRendererFactory::on_pass_begin(
+    const vector<bool>& active_tiles)
+{
+    if (m_shared_borders.get())
+        m_shared_borders->set_active_tiles(active_tiles);
+}
+
 }   // namespace renderer
@@ -31,6 +31,7 @@
 #define APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_GENERICTILERENDERER_H
 
 // appleseed.renderer headers.
+#include "renderer/kernel/rendering/generic/sharedborderaccumulationbuffer.h"
 #include "renderer/kernel/rendering/itilerenderer.h"
 #include "renderer/utility/paramarray.h"
 
@@ -39,6 +40,8 @@
 
 // Standard headers.
 #include <cstddef>
+#include <memory>
+#include <vector>
 
 // Forward declarations.
 namespace renderer  { class Frame; }
@@ -70,11 +73,16 @@ class GenericTileRendererFactory
     virtual ITileRenderer* create(
         const size_t                        thread_index) APPLESEED_OVERRIDE;
 
+    // Account for the tiles that will be rendered during the next pass.
+    virtual void on_pass_begin(
+        const std::vector<bool>&            active_tiles) APPLESEED_OVERRIDE;
+
   private:
     const Frame&                            m_frame;
     IPixelRendererFactory*                  m_pixel_renderer_factory;
     IShadingResultFrameBufferFactory*       m_framebuffer_factory;
     const ParamArray                        m_params;
+    std::auto_ptr<SharedBorderAccumulationBuffer> m_shared_borders;
 };
 
 }       // namespace renderer
@@ -0,0 +1,318 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sharedborderaccumulationbuffer.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/aov/imagestack.h"
+#include "renderer/kernel/aov/tilestack.h"
+#include "renderer/kernel/rendering/ishadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
+#include "renderer/modeling/frame/frame.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SharedBorderAccumulationBuffer class implementation.
+//
+
+SharedBorderAccumulationBuffer::SharedBorderAccumulationBuffer(
+    const Frame&                        frame,
+    IShadingResultFrameBufferFactory*   framebuffer_factory,
+    const size_t                        margin_width,
+    const size_t                        margin_height)
+  : m_frame(frame)
+  , m_framebuffer_factory(framebuffer_factory)
+  , m_margin_width(static_cast<int>(margin_width))
+  , m_margin_height(static_cast<int>(margin_height))
+{
+    const CanvasProperties& props = frame.image().properties();
+
+    // Samples may only spread over the direct neighbors of a tile.
+    assert(margin_width <= props.m_tile_width);
+    assert(margin_height <= props.m_tile_height);
+
+    m_tiles.resize(props.m_tile_count);
+
+    for (size_t i = 0; i < props.m_tile_count; ++i)
+    {
+        TileState* state = new TileState();
+        state->m_framebuffer = 0;
+        state->m_pass_hash = 0;
+        state->m_contribution_count = 0;
+        m_tiles[i] = state;
+    }
+
+    set_active_tiles(vector<bool>(props.m_tile_count, true));
+}
+
+SharedBorderAccumulationBuffer::~SharedBorderAccumulationBuffer()
+{
+    for (size_t i = 0; i < m_tiles.size(); ++i)
+    {
+        if (m_tiles[i]->m_framebuffer)
+            m_framebuffer_factory->destroy(m_tiles[i]->m_framebuffer);
+
+        delete m_tiles[i];
+    }
+}
+
+void SharedBorderAccumulationBuffer::set_active_tiles(const vector<bool>& active_tiles)
+{
+    const CanvasProperties& props = m_frame.image().properties();
+    assert(active_tiles.size() == props.m_tile_count);
+
+    for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+    {
+        for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+        {
+            m_tiles[ty * props.m_tile_count_x + tx]->m_expected_contribution_count =
+                compute_expected_contribution_count(tx, ty, active_tiles);
+        }
+    }
+}
+
+ShadingResultFrameBuffer* SharedBorderAccumulationBuffer::create_padded_framebuffer(
+    const size_t                        tile_x,
+    const size_t                        tile_y) const
+{
+    const Tile& tile = m_frame.image().tile(tile_x, tile_y);
+
+    ShadingResultFrameBuffer* framebuffer =
+        new ShadingResultFrameBuffer(
+            tile.get_width() + 2 * m_margin_width,
+            tile.get_height() + 2 * m_margin_height,
+            m_frame.aov_images().size(),
+            AABB2u(get_padded_crop_window(tile_x, tile_y)),
+            m_frame.get_filter());
+
+    framebuffer->clear();
+
+    return framebuffer;
+}
+
+AABB2i SharedBorderAccumulationBuffer::get_padded_crop_window(
+    const size_t                        tile_x,
+    const size_t                        tile_y) const
+{
+    const AABB2i tile_bbox = get_tile_bbox(tile_x, tile_y);
+    assert(tile_bbox.is_valid());
+
+    AABB2i padded_bbox = get_padded_tile_bbox(tile_bbox);
+    padded_bbox.translate(-get_padded_origin(tile_x, tile_y));
+
+    return padded_bbox;
+}
+
+void SharedBorderAccumulationBuffer::accumulate(
+    const size_t                        tile_x,
+    const size_t                        tile_y,
+    const size_t                        pass_hash,
+    const ShadingResultFrameBuffer&     padded_framebuffer,
+    vector<Vector2u>&                   completed_tiles)
+{
+    const CanvasProperties& props = m_frame.image().properties();
+
+    const AABB2i tile_bbox = get_tile_bbox(tile_x, tile_y);
+    assert(tile_bbox.is_valid());
+
+    const AABB2i padded_bbox = get_padded_tile_bbox(tile_bbox);
+    const Vector2i padded_origin = get_padded_origin(tile_x, tile_y);
+
+    const size_t min_nx = tile_x > 0 ? tile_x - 1 : 0;
+    const size_t min_ny = tile_y > 0 ? tile_y - 1 : 0;
+    const size_t max_nx = min(tile_x + 1, props.m_tile_count_x - 1);
+    const size_t max_ny = min(tile_y + 1, props.m_tile_count_y - 1);
+
+    for (size_t ny = min_ny; ny <= max_ny; ++ny)
+    {
+        for (size_t nx = min_nx; nx <= max_nx; ++nx)
+        {
+            const AABB2i overlap = AABB2i::intersect(padded_bbox, get_tile_bbox(nx, ny));
+            if (!overlap.is_valid())
+                continue;
+
+            const Vector2i origin(
+                static_cast<int>(nx * props.m_tile_width),
+                static_cast<int>(ny * props.m_tile_height));
+
+            TileState& state = *m_tiles[ny * props.m_tile_count_x + nx];
+            boost::mutex::scoped_lock lock(state.m_mutex);
+
+            // Retrieve the framebuffer of this tile for this pass.
+            if (state.m_framebuffer == 0 || state.m_pass_hash != pass_hash)
+            {
+                if (state.m_framebuffer)
+                    m_framebuffer_factory->destroy(state.m_framebuffer);
+
+                AABB2i crop_window = get_tile_bbox(nx, ny);
+                crop_window.translate(-origin);
+
+                state.m_framebuffer =
+                    m_framebuffer_factory->create(
+                        m_frame,
+                        nx,
+                        ny,
+                        AABB2u(crop_window));
+                state.m_pass_hash = pass_hash;
+                state.m_contribution_count = 0;
+            }
+
+            // Merge the overlapping pixels of the padded framebuffer.
+            for (int y = overlap.min.y; y <= overlap.max.y; ++y)
+            {
+                for (int x = overlap.min.x; x <= overlap.max.x; ++x)
+                {
+                    state.m_framebuffer->merge(
+                        static_cast<size_t>(x - origin.x),
+                        static_cast<size_t>(y - origin.y),
+                        padded_framebuffer,
+                        static_cast<size_t>(x - padded_origin.x),
+                        static_cast<size_t>(y - padded_origin.y),
+                        1.0f);
+                }
+            }
+
+            // Develop the tile and release its framebuffer once all contributions were received.
+            if (++state.m_contribution_count == state.m_expected_contribution_count)
+            {
+                develop(nx, ny, *state.m_framebuffer);
+                completed_tiles.push_back(Vector2u(nx, ny));
+
+                m_framebuffer_factory->destroy(state.m_framebuffer);
+                state.m_framebuffer = 0;
+            }
+        }
+    }
+}
+
+AABB2i SharedBorderAccumulationBuffer::get_tile_bbox(
+    const size_t                        tile_x,
+    const size_t                        tile_y) const
+{
+    const CanvasProperties& props = m_frame.image().properties();
+    const Tile& tile = m_frame.image().tile(tile_x, tile_y);
+
+    AABB2i tile_bbox;
+    tile_bbox.min.x = static_cast<int>(tile_x * props.m_tile_width);
+    tile_bbox.min.y = static_cast<int>(tile_y * props.m_tile_height);
+    tile_bbox.max.x = tile_bbox.min.x + static_cast<int>(tile.get_width()) - 1;
+    tile_bbox.max.y = tile_bbox.min.y + static_cast<int>(tile.get_height()) - 1;
+
+    return AABB2i::intersect(tile_bbox, AABB2i(m_frame.get_crop_window()));
+}
+
+AABB2i SharedBorderAccumulationBuffer::get_padded_tile_bbox(const AABB2i& tile_bbox) const
+{
+    AABB2i padded_bbox;
+    padded_bbox.min.x = tile_bbox.min.x - m_margin_width;
+    padded_bbox.min.y = tile_bbox.min.y - m_margin_height;
+    padded_bbox.max.x = tile_bbox.max.x + m_margin_width;
+    padded_bbox.max.y = tile_bbox.max.y + m_margin_height;
+
+    return AABB2i::intersect(padded_bbox, AABB2i(m_frame.get_crop_window()));
+}
+
+Vector2i SharedBorderAccumulationBuffer::get_padded_origin(
+    const size_t                        tile_x,
+    const size_t                        tile_y) const
+{
+    const CanvasProperties& props = m_frame.image().properties();
+
+    return
+        Vector2i(
+            static_cast<int>(tile_x * props.m_tile_width) - m_margin_width,
+            static_cast<int>(tile_y * props.m_tile_height) - m_margin_height);
+}
+
+size_t SharedBorderAccumulationBuffer::compute_expected_contribution_count(
+    const size_t                        tile_x,
+    const size_t                        tile_y,
+    const vector<bool>&                 active_tiles) const
+{
+    const CanvasProperties& props = m_frame.image().properties();
+
+    const AABB2i tile_bbox = get_tile_bbox(tile_x, tile_y);
+    if (!tile_bbox.is_valid())
+        return 0;
+
+    const size_t min_nx = tile_x > 0 ? tile_x - 1 : 0;
+    const size_t min_ny = tile_y > 0 ? tile_y - 1 : 0;
+    const size_t max_nx = min(tile_x + 1, props.m_tile_count_x - 1);
+    const size_t max_ny = min(tile_y + 1, props.m_tile_count_y - 1);
+
+    size_t count = 0;
+
+    for (size_t ny = min_ny; ny <= max_ny; ++ny)
+    {
+        for (size_t nx = min_nx; nx <= max_nx; ++nx)
+        {
+            if (!active_tiles[ny * props.m_tile_count_x + nx])
+                continue;
+
+            const AABB2i neighbor_bbox = get_tile_bbox(nx, ny);
+            if (!neighbor_bbox.is_valid())
+                continue;
+
+            if (AABB2i::intersect(get_padded_tile_bbox(neighbor_bbox), tile_bbox).is_valid())
+                ++count;
+        }
+    }
+
+    return count;
+}
+
+void SharedBorderAccumulationBuffer::develop(
+    const size_t                        tile_x,
+    const size_t                        tile_y,
+    const ShadingResultFrameBuffer&     framebuffer) const
+{
+    Tile& tile = m_frame.image().tile(tile_x, tile_y);
+    TileStack aov_tiles = m_frame.aov_images().tiles(tile_x, tile_y);
+
+    if (m_frame.is_premultiplied_alpha())
+        framebuffer.develop_to_tile_premult_alpha(tile, aov_tiles);
+    else framebuffer.develop_to_tile_straight_alpha(tile, aov_tiles);
+}
+
+}   // namespace renderer
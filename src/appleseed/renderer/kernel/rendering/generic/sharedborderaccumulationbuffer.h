@@ -0,0 +1,156 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_SHAREDBORDERACCUMULATIONBUFFER_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_SHAREDBORDERACCUMULATIONBUFFER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class Frame; }
+namespace renderer  { class IShadingResultFrameBufferFactory; }
+namespace renderer  { class ShadingResultFrameBuffer; }
+
+namespace renderer
+{
+
+//
+// A frame-level accumulation buffer in which tiles share their borders.
+//
+// Samples are only taken inside tiles, but the reconstruction filter spreads them
+// over the margins of the tiles. Each tile is rendered into a padded framebuffer
+// that covers the tile and its margins; the padded framebuffer is then merged into
+// the framebuffers of the tile and of its neighbors. This way, no pixel is sampled
+// more than once per pass.
+//
+// The framebuffers of the tiles are obtained from a shading result framebuffer
+// factory at the first contribution they receive during a pass, and they are
+// released once all the tiles rendered during the pass that overlap them have
+// contributed. Tiles are developed at that point only, so that they are developed
+// once per pass and never show borders that are missing the contributions of their
+// neighbors.
+//
+// All methods of this class are thread-safe, except set_active_tiles().
+//
+
+class SharedBorderAccumulationBuffer
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    SharedBorderAccumulationBuffer(
+        const Frame&                        frame,
+        IShadingResultFrameBufferFactory*   framebuffer_factory,
+        const size_t                        margin_width,
+        const size_t                        margin_height);
+
+    // Destructor.
+    ~SharedBorderAccumulationBuffer();
+
+    // Declare which tiles (in row-major order) will be rendered during the next pass.
+    // All tiles are rendered by default. Must not be called during a pass.
+    void set_active_tiles(const std::vector<bool>& active_tiles);
+
+    // Create the padded framebuffer into which a given tile must be rendered.
+    // Its pixel (margin_width, margin_height) is the top-left pixel of the tile.
+    ShadingResultFrameBuffer* create_padded_framebuffer(
+        const size_t                        tile_x,
+        const size_t                        tile_y) const;
+
+    // Return the bounding box in padded framebuffer space of the pixels that
+    // receive contributions when rendering a given tile.
+    foundation::AABB2i get_padded_crop_window(
+        const size_t                        tile_x,
+        const size_t                        tile_y) const;
+
+    // Merge the padded framebuffer of a tile into the framebuffers of the tile and of
+    // its neighbors, then develop the tiles that received all their contributions for
+    // this pass. The coordinates of these tiles are appended to `completed_tiles`.
+    void accumulate(
+        const size_t                        tile_x,
+        const size_t                        tile_y,
+        const size_t                        pass_hash,
+        const ShadingResultFrameBuffer&     padded_framebuffer,
+        std::vector<foundation::Vector2u>&  completed_tiles);
+
+  private:
+    struct TileState
+    {
+        boost::mutex                        m_mutex;
+        ShadingResultFrameBuffer*           m_framebuffer;
+        size_t                              m_pass_hash;
+        size_t                              m_contribution_count;
+        size_t                              m_expected_contribution_count;
+    };
+
+    const Frame&                            m_frame;
+    IShadingResultFrameBufferFactory*       m_framebuffer_factory;
+    const int                               m_margin_width;
+    const int                               m_margin_height;
+    std::vector<TileState*>                 m_tiles;
+
+    // Return the image space bounding box of the pixels of a tile that lie in the crop window.
+    foundation::AABB2i get_tile_bbox(
+        const size_t                        tile_x,
+        const size_t                        tile_y) const;
+
+    // Return the image space bounding box of the pixels that receive contributions
+    // from the samples of a tile.
+    foundation::AABB2i get_padded_tile_bbox(
+        const foundation::AABB2i&           tile_bbox) const;
+
+    // Return the image space coordinates of the top-left pixel of the padded framebuffer of a tile.
+    foundation::Vector2i get_padded_origin(
+        const size_t                        tile_x,
+        const size_t                        tile_y) const;
+
+    // Return the number of active tiles that contribute to a given tile.
+    size_t compute_expected_contribution_count(
+        const size_t                        tile_x,
+        const size_t                        tile_y,
+        const std::vector<bool>&            active_tiles) const;
+
+    void develop(
+        const size_t                        tile_x,
+        const size_t                        tile_y,
+        const ShadingResultFrameBuffer&     framebuffer) const;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_SHAREDBORDERACCUMULATIONBUFFER_H
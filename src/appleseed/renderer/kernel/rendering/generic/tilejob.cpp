@@ -39,6 +39,7 @@
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
 #include "foundation/image/tile.h"
+#include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cassert>
@@ -50,6 +51,49 @@ using namespace std;
 namespace renderer
 {
 
+//
+// TileJob::PassState class implementation.
+//
+
+TileJob::PassState::PassState(JobQueue& job_queue)
+  : m_job_queue(job_queue)
+  , m_tail_started(false)
+  , m_tail_start_time(0)
+  , m_pending_job_count(0)
+  , m_running_job_count(0)
+{
+}
+
+double TileJob::PassState::get_tail_time()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (!m_tail_started)
+        return 0.0;
+
+    const uint64 elapsed = m_timer.read() - m_tail_start_time;
+
+    return static_cast<double>(elapsed) / m_timer.frequency();
+}
+
+void TileJob::PassState::on_job_end()
+{
+    --m_running_job_count;
+
+    // The rendering thread that just completed a job is about to become idle.
+    if (m_pending_job_count > 0)
+        return;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (!m_tail_started)
+    {
+        m_tail_started = true;
+        m_tail_start_time = m_timer.read();
+    }
+}
+
+
 //
 // TileJob class implementation.
 //
@@ -61,6 +105,7 @@ TileJob::TileJob(
     const size_t                tile_x,
     const size_t                tile_y,
     const size_t                pass_hash,
+    PassState&                  pass_state,
     IAbortSwitch&               abort_switch)
   : m_tile_renderers(tile_renderers)
   , m_tile_callbacks(tile_callbacks)
@@ -68,27 +113,47 @@ TileJob::TileJob(
   , m_tile_x(tile_x)
   , m_tile_y(tile_y)
   , m_pass_hash(pass_hash)
+  , m_pass_state(pass_state)
   , m_abort_switch(abort_switch)
+  , m_part(0)
+  , m_tile_callback(0)
+  , m_started(false)
 {
     // Either there is no tile callback, or there is the same number
     // of tile callbacks and rendering threads.
     assert(
            m_tile_callbacks.size() == 0
         || m_tile_callbacks.size() == tile_renderers.size());
+
+    ++m_pass_state.m_pending_job_count;
+}
+
+TileJob::~TileJob()
+{
+    // Account for jobs that were never executed, e.g. because rendering was aborted.
+    if (!m_started)
+        --m_pass_state.m_pending_job_count;
+
+    delete m_part;
 }
 
 void TileJob::execute(const size_t thread_index)
 {
     assert(thread_index < m_tile_renderers.size());
 
+    m_started = true;
+    ++m_pass_state.m_running_job_count;
+    --m_pass_state.m_pending_job_count;
+
     // Retrieve the tile callback.
     ITileCallback* tile_callback =
         m_tile_callbacks.size() == m_tile_renderers.size()
             ? m_tile_callbacks[thread_index]
             : 0;
+    m_tile_callback = tile_callback;
 
-    // Call the pre-render tile callback.
-    if (tile_callback)
+    // Call the pre-render tile callback, unless another job already did.
+    if (tile_callback && m_part == 0)
     {
         const Image& frame_image = m_frame.image();
 
@@ -103,15 +168,20 @@ void TileJob::execute(const size_t thread_index)
         tile_callback->pre_render(x, y, width, height);
     }
 
+    bool tile_completed;
+
     try
     {
         // Render the tile.
-        m_tile_renderers[thread_index]->render_tile(
-            m_frame,
-            m_tile_x,
-            m_tile_y,
-            m_pass_hash,
-            m_abort_switch);
+        tile_completed =
+            m_tile_renderers[thread_index]->render_tile_part(
+                m_frame,
+                m_tile_x,
+                m_tile_y,
+                m_pass_hash,
+                m_part,
+                *this,
+                m_abort_switch);
     }
     catch (const exception&)
     {
@@ -119,13 +189,52 @@ void TileJob::execute(const size_t thread_index)
         if (tile_callback)
             tile_callback->post_render_tile(&m_frame, m_tile_x, m_tile_y);
 
+        m_pass_state.on_job_end();
+
         // Rethrow the exception.
         throw;
     }
 
-    // Call the post-render tile callback.
-    if (tile_callback)
+    // Call the post-render tile callback once the whole tile is rendered.
+    if (tile_callback && tile_completed)
         tile_callback->post_render_tile(&m_frame, m_tile_x, m_tile_y);
+
+    m_pass_state.on_job_end();
+}
+
+bool TileJob::has_idle_threads() const
+{
+    return
+        m_pass_state.m_pending_job_count == 0 &&
+        m_pass_state.m_running_job_count < m_tile_renderers.size();
+}
+
+void TileJob::split(Part* part)
+{
+    assert(part);
+
+    TileJob* job =
+        new TileJob(
+            m_tile_renderers,
+            m_tile_callbacks,
+            m_frame,
+            m_tile_x,
+            m_tile_y,
+            m_pass_hash,
+            m_pass_state,
+            m_abort_switch);
+
+    job->m_part = part;
+
+    m_pass_state.m_job_queue.schedule(job);
+}
+
+void TileJob::on_tile_completed(
+    const size_t                tile_x,
+    const size_t                tile_y)
+{
+    if (m_tile_callback)
+        m_tile_callback->post_render_tile(&m_frame, tile_x, tile_y);
 }
 
 }   // namespace renderer
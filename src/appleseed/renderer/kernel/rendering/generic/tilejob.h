@@ -30,9 +30,19 @@
 #ifndef APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_TILEJOB_H
 #define APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_TILEJOB_H
 
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/itilerenderer.h"
+
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/job.h"
 
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
 #include <cstddef>
 #include <vector>
@@ -40,7 +50,6 @@
 // Forward declarations.
 namespace renderer  { class Frame; }
 namespace renderer  { class ITileCallback; }
-namespace renderer  { class ITileRenderer; }
 
 namespace renderer
 {
@@ -48,14 +57,49 @@ namespace renderer
 //
 // Tile rendering job.
 //
+// Tile jobs act as tile splitters for the tile renderers: when rendering threads
+// become idle, the unrendered part of a tile is handed off to them as a new tile job.
+//
 
 class TileJob
   : public foundation::IJob
+  , public ITileSplitter
 {
   public:
     typedef std::vector<ITileRenderer*> TileRendererVector;
     typedef std::vector<ITileCallback*> TileCallbackVector;
 
+    //
+    // State shared by all the tile jobs of a rendering pass.
+    //
+
+    class PassState
+      : public foundation::NonCopyable
+    {
+      public:
+        // Constructor.
+        explicit PassState(foundation::JobQueue& job_queue);
+
+        // Return the time in seconds elapsed since a rendering thread first ran out
+        // of work during this pass, or 0 if no rendering thread ran out of work yet.
+        double get_tail_time();
+
+      private:
+        friend class TileJob;
+
+        foundation::JobQueue&               m_job_queue;
+        foundation::DefaultWallclockTimer   m_timer;
+        boost::mutex                        m_mutex;
+        bool                                m_tail_started;
+        foundation::uint64                  m_tail_start_time;
+
+        // Tile jobs are counted without locking the job queue since tile renderers frequently check for idle threads.
+        boost::atomic<size_t>               m_pending_job_count;    // tile jobs created but not started yet
+        boost::atomic<size_t>               m_running_job_count;    // tile jobs being executed
+
+        void on_job_end();
+    };
+
     // Constructor.
     TileJob(
         const TileRendererVector&   tile_renderers,
@@ -64,11 +108,26 @@ class TileJob
         const size_t                tile_x,
         const size_t                tile_y,
         const size_t                pass_hash,
+        PassState&                  pass_state,
         foundation::IAbortSwitch&   abort_switch);
 
+    // Destructor.
+    ~TileJob();
+
     // Execute the job.
     virtual void execute(const size_t thread_index);
 
+    // Return true if some rendering threads are waiting for work.
+    virtual bool has_idle_threads() const;
+
+    // Schedule the rendering of a part of the tile.
+    virtual void split(Part* part);
+
+    // Call the post-render tile callback for another tile of the frame.
+    virtual void on_tile_completed(
+        const size_t                tile_x,
+        const size_t                tile_y);
+
   private:
     const TileRendererVector&       m_tile_renderers;
     const TileCallbackVector&       m_tile_callbacks;
@@ -76,7 +135,11 @@ class TileJob
     const size_t                    m_tile_x;
     const size_t                    m_tile_y;
     const size_t                    m_pass_hash;
+    PassState&                      m_pass_state;
     foundation::IAbortSwitch&       m_abort_switch;
+    Part*                           m_part;
+    ITileCallback*                  m_tile_callback;
+    bool                            m_started;
 };
 
 }       // namespace renderer
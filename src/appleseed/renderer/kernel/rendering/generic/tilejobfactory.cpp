@@ -58,11 +58,36 @@ void TileJobFactory::create(
     const TileJob::TileRendererVector&  tile_renderers,
     const TileJob::TileCallbackVector&  tile_callbacks,
     const size_t                        pass_hash,
+    TileJob::PassState&                 pass_state,
+    TileJobVector&                      tile_jobs,
+    IAbortSwitch&                       abort_switch)
+{
+    create(
+        frame,
+        tile_ordering,
+        tile_renderers,
+        tile_callbacks,
+        pass_hash,
+        vector<bool>(frame.image().properties().m_tile_count, true),
+        pass_state,
+        tile_jobs,
+        abort_switch);
+}
+
+void TileJobFactory::create(
+    const Frame&                        frame,
+    const TileOrdering                  tile_ordering,
+    const TileJob::TileRendererVector&  tile_renderers,
+    const TileJob::TileCallbackVector&  tile_callbacks,
+    const size_t                        pass_hash,
+    const vector<bool>&                 tile_mask,
+    TileJob::PassState&                 pass_state,
     TileJobVector&                      tile_jobs,
     IAbortSwitch&                       abort_switch)
 {
     // Retrieve frame properties.
     const CanvasProperties& props = frame.image().properties();
+    assert(tile_mask.size() == props.m_tile_count);
 
     // Generate tiles ordering.
     vector<size_t> tiles;
@@ -71,11 +96,14 @@ void TileJobFactory::create(
     // Make sure the right number of tiles was created.
     assert(tiles.size() == props.m_tile_count);
 
-    // Create tile jobs, one per tile.
+    // Create tile jobs, one per flagged tile.
     for (size_t i = 0; i < props.m_tile_count; ++i)
     {
-        // Compute coordinates of the tile in the frame.
         const size_t tile_index = tiles[i];
+        if (!tile_mask[tile_index])
+            continue;
+
+        // Compute coordinates of the tile in the frame.
         const size_t tile_x = tile_index % props.m_tile_count_x;
         const size_t tile_y = tile_index / props.m_tile_count_x;
         assert(tile_x < props.m_tile_count_x);
@@ -90,6 +118,7 @@ void TileJobFactory::create(
                 tile_x,
                 tile_y,
                 pass_hash,
+                pass_state,
                 abort_switch));
     }
 }
@@ -74,6 +74,20 @@ class TileJobFactory
         const TileJob::TileRendererVector&  tile_renderers,
         const TileJob::TileCallbackVector&  tile_callbacks,
         const size_t                        pass_hash,
+        TileJob::PassState&                 pass_state,
+        TileJobVector&                      tile_jobs,
+        foundation::IAbortSwitch&           abort_switch);
+
+    // Create tile jobs for the tiles of a given frame whose index (ty * tile_count_x + tx)
+    // is flagged in `tile_mask`.
+    void create(
+        const Frame&                        frame,
+        const TileOrdering                  tile_ordering,
+        const TileJob::TileRendererVector&  tile_renderers,
+        const TileJob::TileCallbackVector&  tile_callbacks,
+        const size_t                        pass_hash,
+        const std::vector<bool>&            tile_mask,
+        TileJob::PassState&                 pass_state,
         TileJobVector&                      tile_jobs,
         foundation::IAbortSwitch&           abort_switch);
 
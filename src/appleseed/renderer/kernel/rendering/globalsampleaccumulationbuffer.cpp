@@ -45,6 +45,9 @@
 // Boost headers.
 #include "boost/chrono/duration.hpp"
 
+// Standard headers.
+#include <cassert>
+
 using namespace foundation;
 using namespace std;
 
@@ -74,6 +77,15 @@ void GlobalSampleAccumulationBuffer::store_samples(
     const size_t    sample_count,
     const Sample    samples[],
     IAbortSwitch&   abort_switch)
+{
+    store_samples(sample_count, samples, 1, abort_switch);
+}
+
+void GlobalSampleAccumulationBuffer::store_samples(
+    const size_t    sample_count,
+    const Sample    samples[],
+    const uint64    estimate_count,
+    IAbortSwitch&   abort_switch)
 {
     // Request non-exclusive access.
     boost::shared_lock<boost::shared_mutex> lock(m_mutex, boost::defer_lock);
@@ -85,32 +97,37 @@ void GlobalSampleAccumulationBuffer::store_samples(
             break;
     }
 
-    const float fw = static_cast<float>(m_fb.get_width());
-    const float fh = static_cast<float>(m_fb.get_height());
-    size_t counter = 0;
-
-    const Sample* sample_end = samples + sample_count;
-    for (const Sample* s = samples; s < sample_end; ++s)
-    {
-        if ((counter++ & 4096) == 0 && abort_switch.is_aborted())
-            return;
-
-        const float fx = s->m_position.x * fw;
-        const float fy = s->m_position.y * fh;
+    // Samples produced by light tracing land anywhere in the frame: splat them
+    // with atomic updates rather than locking nearly every stripe of the buffer.
+    // Normalization is applied in develop_to_tile().
+    if (m_fb.splat_samples(sample_count, samples, estimate_count, abort_switch))
+        m_sample_count += estimate_count;
+}
 
-        Color3f value(s->m_values);
-        value *= m_filter_rcp_norm_factor;
+void GlobalSampleAccumulationBuffer::develop_to_frame(
+    Frame&          frame,
+    IAbortSwitch&   abort_switch)
+{
+    develop(frame, 0, abort_switch);
+}
 
-        m_fb.add(fx, fy, &value[0]);
-    }
+void GlobalSampleAccumulationBuffer::develop_dirty_tiles_to_frame(
+    Frame&          frame,
+    vector<size_t>& tiles,
+    IAbortSwitch&   abort_switch)
+{
+    develop(frame, &tiles, abort_switch);
 }
 
-void GlobalSampleAccumulationBuffer::develop_to_frame(
+void GlobalSampleAccumulationBuffer::develop(
     Frame&          frame,
+    vector<size_t>* tiles,
     IAbortSwitch&   abort_switch)
 {
-    // Request exclusive access.
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex, boost::defer_lock);
+    // Request non-exclusive access. Samples may be splatted while the buffer is developed:
+    // each tile is developed while holding its stripes, whose pixels are normalized by the
+    // number of estimates splatted into them, so that tiles are always consistent.
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex, boost::defer_lock);
     while (true)
     {
         if (abort_switch.is_aborted())
@@ -122,50 +139,67 @@ void GlobalSampleAccumulationBuffer::develop_to_frame(
     Image& image = frame.image();
     const CanvasProperties& frame_props = image.properties();
 
-    assert(frame_props.m_canvas_width == m_fb.get_width());
-    assert(frame_props.m_canvas_height == m_fb.get_height());
+    assert(frame_props.m_canvas_width == m_fb.tile().get_width());
+    assert(frame_props.m_canvas_height == m_fb.tile().get_height());
     assert(frame_props.m_channel_count == 4);
 
-    const float scale = 1.0f / m_sample_count;
+    // Find which stripes received samples.
+    vector<bool> dirty_stripes;
+    m_fb.fetch_dirty_stripes(dirty_stripes);
+    const bool develop_all = tiles == 0;
 
     for (size_t ty = 0; ty < frame_props.m_tile_count_y; ++ty)
     {
         for (size_t tx = 0; tx < frame_props.m_tile_count_x; ++tx)
         {
+            const size_t x = tx * frame_props.m_tile_width;
+            const size_t y = ty * frame_props.m_tile_height;
+
             if (abort_switch.is_aborted())
+            {
+                // Dirty stripes were reset: make sure the next develop updates the remaining tiles.
+                m_fb.mark_rows_dirty(y, frame_props.m_canvas_height - 1);
                 return;
+            }
 
             Tile& tile = image.tile(tx, ty);
 
-            const size_t x = tx * frame_props.m_tile_width;
-            const size_t y = ty * frame_props.m_tile_height;
+            const size_t max_y = y + tile.get_height() - 1;
+
+            if (!develop_all && !m_fb.are_rows_dirty(dirty_stripes, y, max_y))
+                continue;
+
+            m_fb.lock_rows(y, max_y);
+            develop_to_tile(tile, x, y, tx, ty);
+            m_fb.unlock_rows(y, max_y);
 
-            develop_to_tile(tile, x, y, tx, ty, scale);
+            if (tiles)
+                tiles->push_back(ty * frame_props.m_tile_count_x + tx);
         }
     }
 }
 
-void GlobalSampleAccumulationBuffer::increment_sample_count(const uint64 delta_sample_count)
-{
-    m_sample_count += delta_sample_count;
-}
-
 void GlobalSampleAccumulationBuffer::develop_to_tile(
     Tile&           tile,
     const size_t    origin_x,
     const size_t    origin_y,
     const size_t    tile_x,
-    const size_t    tile_y,
-    const float     scale) const
+    const size_t    tile_y) const
 {
     const size_t tile_width = tile.get_width();
     const size_t tile_height = tile.get_height();
 
     for (size_t y = 0; y < tile_height; ++y)
     {
+        const uint64 estimate_count = m_fb.get_row_estimate_count(origin_y + y);
+        const float scale =
+            estimate_count > 0
+                ? m_filter_rcp_norm_factor / estimate_count
+                : 0.0f;
+
         for (size_t x = 0; x < tile_width; ++x)
         {
-            const float* ptr = m_fb.pixel(origin_x + x, origin_y + y);
+            const float* ptr = m_fb.tile().pixel(origin_x + x, origin_y + y);
 
             Color4f color(ptr[1], ptr[2], ptr[3], 1.0f);
             color.rgb() *= scale;
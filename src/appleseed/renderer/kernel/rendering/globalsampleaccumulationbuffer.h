@@ -32,9 +32,9 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/rendering/sampleaccumulationbuffer.h"
+#include "renderer/kernel/rendering/stripedfilteredtile.h"
 
 // appleseed.foundation headers.
-#include "foundation/image/filteredtile.h"
 #include "foundation/math/filter.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/thread.h"
@@ -42,6 +42,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -66,31 +67,48 @@ class GlobalSampleAccumulationBuffer
     virtual void clear() APPLESEED_OVERRIDE;
 
     // Store a set of samples into the buffer. Thread-safe.
+    // The samples are accounted for as a single estimate; see the next method.
     virtual void store_samples(
         const size_t                sample_count,
         const Sample                samples[],
         foundation::IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE;
 
+    // Store a set of samples produced by a given number of estimates (e.g. light paths,
+    // whether or not they contributed samples) into the buffer. Pixel values are divided
+    // by the total number of estimates. Thread-safe.
+    void store_samples(
+        const size_t                sample_count,
+        const Sample                samples[],
+        const foundation::uint64    estimate_count,
+        foundation::IAbortSwitch&   abort_switch);
+
     // Develop the buffer to a frame. Thread-safe.
     virtual void develop_to_frame(
         Frame&                      frame,
         foundation::IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE;
 
-    // Increment the number of samples used for pixel values renormalization. Thread-safe.
-    void increment_sample_count(const foundation::uint64 delta_sample_count);
+    // Develop to a frame the tiles that may have changed since the last develop. Thread-safe.
+    virtual void develop_dirty_tiles_to_frame(
+        Frame&                      frame,
+        std::vector<size_t>&        tiles,
+        foundation::IAbortSwitch&   abort_switch) APPLESEED_OVERRIDE;
 
   private:
     boost::shared_mutex             m_mutex;
-    foundation::FilteredTile        m_fb;
+    StripedFilteredTile             m_fb;
     const float                     m_filter_rcp_norm_factor;
 
+    void develop(
+        Frame&                      frame,
+        std::vector<size_t>*        tiles,
+        foundation::IAbortSwitch&   abort_switch);
+
     void develop_to_tile(
         foundation::Tile&           tile,
         const size_t                origin_x,
         const size_t                origin_y,
         const size_t                tile_x,
-        const size_t                tile_y,
-        const float                 scale) const;
+        const size_t                tile_y) const;
 };
 
 }       // namespace renderer
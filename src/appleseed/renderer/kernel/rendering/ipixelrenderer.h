@@ -71,6 +71,14 @@ class IPixelRenderer
         foundation::Tile&           tile,
         TileStack&                  aov_tiles) = 0;
 
+    // Return true if this pixel renderer must render whole tiles into framebuffers that
+    // match the tiles, e.g. because it keeps per-tile state. Otherwise, tiles may be
+    // rendered in several parts by different threads, in which case on_tile_begin() and
+    // on_tile_end() are called once per part, and pixels may be rendered into framebuffers
+    // that extend beyond the tile, in which case `pt` and `tile_bbox` are expressed in the
+    // space of the framebuffer.
+    virtual bool needs_whole_tiles() const = 0;
+
     // Render a pixel.
     virtual void render_pixel(
         const Frame&                frame,
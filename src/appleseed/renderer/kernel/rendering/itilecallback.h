@@ -76,6 +76,18 @@ class APPLESEED_DLLSYMBOL ITileCallback
     // Only whole-frame (progressive) renderers call this method.
     virtual void post_render(
         const Frame*    frame) = 0;
+
+    // This method is called after a tile was updated but not necessarily rendered
+    // to completion, for instance when a progressive renderer refreshes the tiles
+    // that changed. Only whole-frame (progressive) renderers call this method.
+    // The default implementation forwards to post_render_tile().
+    virtual void post_update_tile(
+        const Frame*    frame,
+        const size_t    tile_x,
+        const size_t    tile_y)
+    {
+        post_render_tile(frame, tile_x, tile_y);
+    }
 };
 
 
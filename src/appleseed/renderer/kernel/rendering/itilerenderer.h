@@ -34,7 +34,9 @@
 #include "foundation/core/concepts/iunknown.h"
 
 // Standard headers.
+#include <cassert>
 #include <cstddef>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -44,6 +46,44 @@ namespace renderer      { class Frame; }
 namespace renderer
 {
 
+//
+// Tile splitter interface.
+//
+// While rendering a tile, a tile renderer may use a tile splitter to hand off the
+// part of the tile it has not rendered yet to rendering threads that ran out of
+// work, typically at the end of a rendering pass. The tile splitter is also told
+// about other tiles of the frame that the rendering of the tile completed.
+//
+
+class ITileSplitter
+{
+  public:
+    // A part of a tile handed off to another rendering thread.
+    // Its content is only known to the tile renderer that created it.
+    class Part
+    {
+      public:
+        virtual ~Part() {}
+    };
+
+    // Destructor.
+    virtual ~ITileSplitter() {}
+
+    // Return true if some rendering threads are waiting for work.
+    virtual bool has_idle_threads() const = 0;
+
+    // Schedule the rendering of a part of the tile.
+    // Ownership of the part is transferred to the tile splitter.
+    virtual void split(Part* part) = 0;
+
+    // Report that the rendering of the tile completed another tile of the frame,
+    // for instance by contributing the last samples to its borders.
+    virtual void on_tile_completed(
+        const size_t                tile_x,
+        const size_t                tile_y) = 0;
+};
+
+
 //
 // Tile renderer interface.
 //
@@ -60,6 +100,25 @@ class ITileRenderer
         const size_t                pass_hash,
         foundation::IAbortSwitch&   abort_switch) = 0;
 
+    // Render a tile, or only the part of it designated by `part` if it is not null.
+    // Return true if this call completed the tile, false if other parts of the tile
+    // are still being rendered by other threads or if the tile is still waiting
+    // for contributions from its neighbors. The default implementation never splits
+    // tiles and renders them with render_tile().
+    virtual bool render_tile_part(
+        const Frame&                frame,
+        const size_t                tile_x,
+        const size_t                tile_y,
+        const size_t                pass_hash,
+        ITileSplitter::Part*        part,
+        ITileSplitter&              tile_splitter,
+        foundation::IAbortSwitch&   abort_switch)
+    {
+        assert(part == 0);
+        render_tile(frame, tile_x, tile_y, pass_hash, abort_switch);
+        return true;
+    }
+
     // Retrieve performance statistics.
     virtual foundation::StatisticsVector get_statistics() const = 0;
 };
@@ -75,6 +134,13 @@ class ITileRendererFactory
   public:
     // Return a new tile renderer instance.
     virtual ITileRenderer* create(const size_t thread_index) = 0;
+
+    // This method is called before a rendering pass during which only the tiles
+    // flagged in `active_tiles` (in row-major order) will be rendered.
+    // The default implementation does nothing.
+    virtual void on_pass_begin(const std::vector<bool>& active_tiles)
+    {
+    }
 };
 
 }       // namespace renderer
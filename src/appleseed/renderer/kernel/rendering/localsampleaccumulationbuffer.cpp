@@ -33,7 +33,9 @@
 // appleseed.renderer headers.
 #include "renderer/kernel/aov/imagestack.h"
 #include "renderer/kernel/aov/tilestack.h"
+#include "renderer/kernel/rendering/adaptivesamplingmap.h"
 #include "renderer/kernel/rendering/sample.h"
+#include "renderer/kernel/rendering/stripedfilteredtile.h"
 #include "renderer/modeling/frame/frame.h"
 
 // appleseed.foundation headers.
@@ -52,6 +54,8 @@
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <limits>
+#include <vector>
 
 using namespace boost;
 using namespace foundation;
@@ -77,13 +81,23 @@ namespace renderer
 //   pushing samples to and the level that is displayed. As soon as a level contains enough
 //   samples, it becomes the new active level.
 //
+//   Levels are split into horizontal stripes, each with its own lock (see StripedFilteredTile).
+//   Threads storing samples and develop_to_frame() only wait for each other when they access
+//   the same stripes; m_lock is only held exclusively by clear().
+//
+//   develop_dirty_tiles_to_frame() only develops the frame tiles that map to stripes of the
+//   active level that received samples since the last develop, unless the active level has
+//   changed in the meantime, in which case the whole frame is developed.
+//
 
 //#define PRINT_DETAILED_PERF_REPORTS
 
 LocalSampleAccumulationBuffer::LocalSampleAccumulationBuffer(
-    const size_t        width,
-    const size_t        height,
-    const Filter2f&     filter)
+    const size_t            width,
+    const size_t            height,
+    const Filter2f&         filter,
+    AdaptiveSamplingMap*    adaptive_sampling_map)
+  : m_adaptive_sampling_map(adaptive_sampling_map)
 {
     const size_t MinSize = 32;
 
@@ -92,7 +106,7 @@ LocalSampleAccumulationBuffer::LocalSampleAccumulationBuffer(
 
     while (true)
     {
-        m_levels.push_back(new FilteredTile(level_width, level_height, 5, filter));
+        m_levels.push_back(new StripedFilteredTile(level_width, level_height, 5, filter));
 
         if (level_width <= MinSize && level_height <= MinSize)
             break;
@@ -108,6 +122,7 @@ LocalSampleAccumulationBuffer::LocalSampleAccumulationBuffer(
 
 LocalSampleAccumulationBuffer::~LocalSampleAccumulationBuffer()
 {
+    delete m_adaptive_sampling_map;
     delete[] m_remaining_pixels;
 
     for (size_t i = 0, e = m_levels.size(); i < e; ++i)
@@ -136,10 +151,14 @@ void LocalSampleAccumulationBuffer::clear()
         m_levels[i]->clear();
 
         m_remaining_pixels[i] =
-            static_cast<int32>(m_levels[i]->get_pixel_count());
+            static_cast<int32>(m_levels[i]->tile().get_pixel_count());
     }
 
     m_active_level = static_cast<uint32>(m_levels.size() - 1);
+    m_developed_level = numeric_limits<uint32>::max();
+
+    if (m_adaptive_sampling_map)
+        m_adaptive_sampling_map->clear();
 }
 
 void LocalSampleAccumulationBuffer::store_samples(
@@ -167,25 +186,12 @@ void LocalSampleAccumulationBuffer::store_samples(
 #endif
 
         // Store samples at every level, starting with the highest resolution level up to the active level.
-        size_t counter = 0;
         for (uint32 i = 0, e = m_active_level; i <= e; ++i)
         {
-            FilteredTile* level = m_levels[i];
-            const float level_width = static_cast<float>(level->get_width());
-            const float level_height = static_cast<float>(level->get_height());
-
-            const Sample* sample_end = samples + sample_count;
-            for (const Sample* s = samples; s < sample_end; ++s)
+            if (!m_levels[i]->store_samples(sample_count, samples, abort_switch))
             {
-                if ((counter++ & 4096) == 0 && abort_switch.is_aborted())
-                {
-                    m_lock.unlock_read();
-                    return;
-                }
-
-                const float fx = s->m_position.x * level_width;
-                const float fy = s->m_position.y * level_height;
-                level->add(fx, fy, s->m_values);
+                m_lock.unlock_read();
+                return;
             }
         }
 
@@ -194,6 +200,9 @@ void LocalSampleAccumulationBuffer::store_samples(
 
     m_sample_count += sample_count;
 
+    if (m_adaptive_sampling_map)
+        m_adaptive_sampling_map->store_samples(sample_count, samples);
+
 #ifdef PRINT_DETAILED_PERF_REPORTS
     sw.measure();
     RENDERER_LOG_DEBUG("store_samples: " FMT_SIZE_T " -> %f", sample_count, sw.get_seconds() * 1000.0);
@@ -228,14 +237,30 @@ void LocalSampleAccumulationBuffer::store_samples(
 void LocalSampleAccumulationBuffer::develop_to_frame(
     Frame&              frame,
     IAbortSwitch&       abort_switch)
+{
+    develop(frame, 0, abort_switch);
+}
+
+void LocalSampleAccumulationBuffer::develop_dirty_tiles_to_frame(
+    Frame&              frame,
+    vector<size_t>&     tiles,
+    IAbortSwitch&       abort_switch)
+{
+    develop(frame, &tiles, abort_switch);
+}
+
+void LocalSampleAccumulationBuffer::develop(
+    Frame&              frame,
+    vector<size_t>*     tiles,
+    IAbortSwitch&       abort_switch)
 {
 #ifdef PRINT_DETAILED_PERF_REPORTS
     Stopwatch<DefaultWallclockTimer> sw(0);
     sw.start();
 #endif
 
-    // Request exclusive access.
-    while (!m_lock.try_lock_write())
+    // Request non-exclusive access; stripes of the active level are locked as they are read.
+    while (!m_lock.try_lock_read())
     {
         foundation::sleep(5);
         if (abort_switch.is_aborted())
@@ -245,21 +270,30 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
 #ifdef PRINT_DETAILED_PERF_REPORTS
     sw.measure();
     const double t1 = sw.get_seconds();
-    RENDERER_LOG_DEBUG("develop_to_frame: acquiring lock: %f", t1 * 1000.0);
+    RENDERER_LOG_DEBUG("develop: acquiring lock: %f", t1 * 1000.0);
 #endif
 
     Image& color_image = frame.image();
     Image& depth_image = frame.aov_images().get_image(0);
 
     const CanvasProperties& frame_props = color_image.properties();
-    assert(frame_props.m_canvas_width == m_levels[0]->get_width());
-    assert(frame_props.m_canvas_height == m_levels[0]->get_height());
+    assert(frame_props.m_canvas_width == m_levels[0]->tile().get_width());
+    assert(frame_props.m_canvas_height == m_levels[0]->tile().get_height());
     assert(frame_props.m_channel_count == 4);
 
     const AABB2u& crop_window = frame.get_crop_window();
     const bool undo_premultiplied_alpha = !frame.is_premultiplied_alpha();
 
-    const FilteredTile& level = *m_levels[m_active_level];
+    const uint32 active_level = m_active_level;
+    StripedFilteredTile& striped_level = *m_levels[active_level];
+    const FilteredTile& level = striped_level.tile();
+
+    // Find which stripes of the active level received samples.
+    vector<bool> dirty_stripes;
+    striped_level.fetch_dirty_stripes(dirty_stripes);
+    const bool develop_all =
+        tiles == 0 ||
+        m_developed_level.exchange(active_level) != active_level;
 
     for (size_t ty = 0; ty < frame_props.m_tile_count_y; ++ty)
     {
@@ -267,7 +301,9 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
         {
             if (abort_switch.is_aborted())
             {
-                m_lock.unlock_write();
+                // Dirty stripes were reset: force the next develop to update the whole frame.
+                m_developed_level = numeric_limits<uint32>::max();
+                m_lock.unlock_read();
                 return;
             }
 
@@ -283,6 +319,18 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
 
             const AABB2u rect = AABB2u::intersect(tile_rect, crop_window);
 
+            if (rect.min.x > rect.max.x || rect.min.y > rect.max.y)
+                continue;
+
+            // Lock the rows of the level that map to this tile.
+            const size_t level_min_y = rect.min.y * level.get_height() / frame_props.m_canvas_height;
+            const size_t level_max_y = rect.max.y * level.get_height() / frame_props.m_canvas_height;
+
+            if (!develop_all && !striped_level.are_rows_dirty(dirty_stripes, level_min_y, level_max_y))
+                continue;
+
+            striped_level.lock_rows(level_min_y, level_max_y);
+
             if (undo_premultiplied_alpha)
             {
                 develop_to_tile_undo_premult_alpha(
@@ -307,18 +355,28 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
                     origin_y,
                     rect);
             }
+
+            striped_level.unlock_rows(level_min_y, level_max_y);
+
+            if (tiles)
+                tiles->push_back(ty * frame_props.m_tile_count_x + tx);
         }
     }
 
-    m_lock.unlock_write();
+    m_lock.unlock_read();
 
 #ifdef PRINT_DETAILED_PERF_REPORTS
     sw.measure();
     const double t2 = sw.get_seconds();
-    RENDERER_LOG_DEBUG("develop_to_frame: %f", (t2 - t1) * 1000.0);
+    RENDERER_LOG_DEBUG("develop: %f", (t2 - t1) * 1000.0);
 #endif
 }
 
+AdaptiveSamplingMap* LocalSampleAccumulationBuffer::get_adaptive_sampling_map()
+{
+    return m_adaptive_sampling_map;
+}
+
 void LocalSampleAccumulationBuffer::develop_to_tile_undo_premult_alpha(
     Tile&               color_tile,
     Tile&               depth_tile,
@@ -49,8 +49,10 @@
 namespace foundation    { class FilteredTile; }
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class Tile; }
+namespace renderer      { class AdaptiveSamplingMap; }
 namespace renderer      { class Frame; }
 namespace renderer      { class Sample; }
+namespace renderer      { class StripedFilteredTile; }
 
 namespace renderer
 {
@@ -59,11 +61,12 @@ class LocalSampleAccumulationBuffer
   : public SampleAccumulationBuffer
 {
   public:
-    // Constructor.
+    // Constructor. Takes ownership of the adaptive sampling map, if any.
     LocalSampleAccumulationBuffer(
         const size_t                        width,
         const size_t                        height,
-        const foundation::Filter2f&         filter);
+        const foundation::Filter2f&         filter,
+        AdaptiveSamplingMap*                adaptive_sampling_map = 0);
 
     // Destructor.
     ~LocalSampleAccumulationBuffer();
@@ -82,6 +85,15 @@ class LocalSampleAccumulationBuffer
         Frame&                              frame,
         foundation::IAbortSwitch&           abort_switch) APPLESEED_OVERRIDE;
 
+    // Develop to a frame the tiles that may have changed since the last develop. Thread-safe.
+    virtual void develop_dirty_tiles_to_frame(
+        Frame&                              frame,
+        std::vector<size_t>&                tiles,
+        foundation::IAbortSwitch&           abort_switch) APPLESEED_OVERRIDE;
+
+    // Return the adaptive sampling map fed by this buffer, or 0 if there is none.
+    virtual AdaptiveSamplingMap* get_adaptive_sampling_map() APPLESEED_OVERRIDE;
+
     // Exposed for tests and benchmarks.
     static void develop_to_tile_undo_premult_alpha(
         foundation::Tile&                   color_tile,
@@ -108,9 +120,16 @@ class LocalSampleAccumulationBuffer
     > LockType;
 
     LockType                                m_lock;
-    std::vector<foundation::FilteredTile*>  m_levels;
+    std::vector<StripedFilteredTile*>       m_levels;
     boost::atomic<foundation::int32>*       m_remaining_pixels;
     boost::atomic<foundation::uint32>       m_active_level;
+    boost::atomic<foundation::uint32>       m_developed_level;
+    AdaptiveSamplingMap*                    m_adaptive_sampling_map;
+
+    void develop(
+        Frame&                              frame,
+        std::vector<size_t>*                tiles,
+        foundation::IAbortSwitch&           abort_switch);
 };
 
 }       // namespace renderer
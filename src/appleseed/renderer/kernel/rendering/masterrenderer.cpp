@@ -285,7 +285,9 @@ IRendererController::Status MasterRenderer::render_frame_sequence(
         m_renderer_controller->on_frame_begin();
 
         // Perform pre-frame rendering actions. Don't proceed if that failed.
-        OnFrameBeginRecorder recorder;
+        // Entities get the rendering parameters through the recorder, e.g. to honor
+        // the number of rendering threads.
+        OnFrameBeginRecorder recorder(m_params);
         if (!m_project.get_scene()->on_frame_begin(m_project, 0, recorder, &abort_switch))
         {
             recorder.on_frame_end(m_project);
@@ -64,6 +64,11 @@ void PixelRendererBase::on_tile_end(
 {
 }
 
+bool PixelRendererBase::needs_whole_tiles() const
+{
+    return false;
+}
+
 void PixelRendererBase::on_pixel_begin()
 {
     m_invalid_sample_count = 0;
@@ -71,6 +71,9 @@ class PixelRendererBase
         foundation::Tile&           tile,
         TileStack&                  aov_tiles) APPLESEED_OVERRIDE;
 
+    // Return true if this pixel renderer must render whole tiles.
+    virtual bool needs_whole_tiles() const APPLESEED_OVERRIDE;
+
   protected:
     void on_pixel_begin();
     void on_pixel_end(const foundation::Vector2i& pi);
@@ -463,8 +463,9 @@ namespace
                 const double t1 = m_stopwatch.get_seconds();
 #endif
 
-                // Develop the accumulation buffer to the frame.
-                m_buffer.develop_to_frame(m_frame, m_abort_switch);
+                // Develop the parts of the accumulation buffer that changed to the frame.
+                m_dirty_tiles.clear();
+                m_buffer.develop_dirty_tiles_to_frame(m_frame, m_dirty_tiles, m_abort_switch);
 
 #ifdef PRINT_DISPLAY_THREAD_PERFS
                 m_stopwatch.measure();
@@ -475,8 +476,22 @@ namespace
                 if (m_abort_switch.is_aborted())
                     return;
 
-                // Present the frame.
-                m_tile_callback->post_render(&m_frame);
+                // Present the frame if all tiles of the crop window changed, otherwise only present
+                // the tiles that changed. These tiles are not rendered to completion, so they aren't
+                // reported as rendered.
+                const CanvasProperties& frame_props = m_frame.image().properties();
+                if (are_all_crop_window_tiles_dirty(frame_props))
+                    m_tile_callback->post_render(&m_frame);
+                else
+                {
+                    for (const_each<vector<size_t> > i = m_dirty_tiles; i; ++i)
+                    {
+                        m_tile_callback->post_update_tile(
+                            &m_frame,
+                            *i % frame_props.m_tile_count_x,
+                            *i / frame_props.m_tile_count_x);
+                    }
+                }
 
 #ifdef PRINT_DISPLAY_THREAD_PERFS
                 m_stopwatch.measure();
@@ -495,6 +510,28 @@ namespace
             }
 
           private:
+            bool are_all_crop_window_tiles_dirty(const CanvasProperties& frame_props) const
+            {
+                const AABB2u& crop_window = m_frame.get_crop_window();
+                const size_t min_tx = crop_window.min.x / frame_props.m_tile_width;
+                const size_t min_ty = crop_window.min.y / frame_props.m_tile_height;
+                const size_t max_tx = crop_window.max.x / frame_props.m_tile_width;
+                const size_t max_ty = crop_window.max.y / frame_props.m_tile_height;
+                const size_t crop_tile_count = (max_tx - min_tx + 1) * (max_ty - min_ty + 1);
+
+                // Tiles outside the crop window may be dirty too, for instance when light paths are splatted.
+                size_t dirty_crop_tile_count = 0;
+                for (const_each<vector<size_t> > i = m_dirty_tiles; i; ++i)
+                {
+                    const size_t tx = *i % frame_props.m_tile_count_x;
+                    const size_t ty = *i / frame_props.m_tile_count_x;
+                    if (tx >= min_tx && tx <= max_tx && ty >= min_ty && ty <= max_ty)
+                        ++dirty_crop_tile_count;
+                }
+
+                return dirty_crop_tile_count == crop_tile_count;
+            }
+
             Frame&                              m_frame;
             SampleAccumulationBuffer&           m_buffer;
             ITileCallback*                      m_tile_callback;
@@ -503,6 +540,7 @@ namespace
             IAbortSwitch&                       m_abort_switch;
             ThreadFlag                          m_pause_flag;
             Stopwatch<DefaultWallclockTimer>    m_stopwatch;
+            vector<size_t>                      m_dirty_tiles;
         };
 
         //
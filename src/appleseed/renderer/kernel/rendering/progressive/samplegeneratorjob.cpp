@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/rendering/adaptivesamplingmap.h"
 #include "renderer/kernel/rendering/isamplegenerator.h"
 #include "renderer/kernel/rendering/progressive/samplecounter.h"
 #include "renderer/kernel/rendering/sampleaccumulationbuffer.h"
@@ -116,6 +117,11 @@ void SampleGeneratorJob::execute(const size_t thread_index)
     const double t1 = stopwatch.get_seconds();
 #endif
 
+    // Terminate this job if adaptive sampling determined that the image has converged.
+    const AdaptiveSamplingMap* adaptive_sampling_map = m_buffer.get_adaptive_sampling_map();
+    if (adaptive_sampling_map && adaptive_sampling_map->has_converged())
+        return;
+
     // We will base the number of samples to be rendered by this job on
     // the number of samples already reserved (not necessarily rendered).
     const uint64 current_sample_count = m_sample_counter.read();
@@ -31,8 +31,11 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/lighting/bdpt/bdptlightingengine.h"
 #include "renderer/kernel/lighting/drt/drtlightingengine.h"
+#include "renderer/kernel/lighting/drt/drtpasscallback.h"
 #include "renderer/kernel/lighting/lighttracing/lighttracingsamplegenerator.h"
+#include "renderer/kernel/lighting/pathguide.h"
 #include "renderer/kernel/lighting/pt/ptlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmparameters.h"
@@ -148,20 +151,72 @@ bool RendererComponents::create_lighting_engine_factory()
     {
         return true;
     }
+    else if (name == "bdpt")
+    {
+        m_lighting_engine_factory.reset(
+            new BDPTLightingEngineFactory(
+                m_light_sampler,
+                get_child_and_inherit_globals(m_params, "bdpt")));
+        return true;
+    }
     else if (name == "drt")
     {
+        const ParamArray drt_params =
+            get_child_and_inherit_globals(m_params, "drt");         // todo: change to "drt_lighting_engine"?
+
+        DRTPassCallback* drt_pass_callback = 0;
+
+        if (drt_params.get_optional<bool>("enable_irradiance_cache", false))
+        {
+            // The cache is built before the first pass of the generic frame renderer.
+            if (m_params.get_optional<string>("frame_renderer", "generic") != "generic")
+                RENDERER_LOG_WARNING("the irradiance cache requires the generic frame renderer, irradiance will be computed on the fly.");
+
+            drt_pass_callback =
+                new DRTPassCallback(
+                    m_scene,
+                    m_light_sampler,
+                    m_trace_context,
+                    m_texture_store,
+                    m_texture_system,
+                    m_shading_system,
+                    drt_params);
+            m_pass_callback.reset(drt_pass_callback);
+        }
+
         m_lighting_engine_factory.reset(
             new DRTLightingEngineFactory(
                 m_light_sampler,
-                get_child_and_inherit_globals(m_params, "drt")));   // todo: change to "drt_lighting_engine"?
+                drt_params,
+                drt_pass_callback));
+
         return true;
     }
     else if (name == "pt")
     {
+        const ParamArray pt_params =
+            get_child_and_inherit_globals(m_params, "pt");          // todo: change to "pt_lighting_engine"?
+
+        PathGuide* path_guide = 0;
+
+        if (pt_params.get_optional<bool>("enable_path_guiding", false))
+        {
+            // Learning only happens between passes of the generic frame renderer.
+            if (m_params.get_optional<string>("frame_renderer", "generic") != "generic" ||
+                GenericFrameRendererFactory::get_pass_count(
+                    get_child_and_inherit_globals(m_params, "generic_frame_renderer")) < 2)
+                RENDERER_LOG_WARNING("path guiding requires the generic frame renderer with multiple passes.");
+
+            path_guide = new PathGuide(m_scene, pt_params);
+            m_pass_callback.reset(path_guide);
+        }
+
         m_lighting_engine_factory.reset(
             new PTLightingEngineFactory(
                 m_light_sampler,
-                get_child_and_inherit_globals(m_params, "pt")));    // todo: change to "pt_lighting_engine"?
+                pt_params,
+                path_guide));
+
         return true;
     }
     else if (name == "sppm")
@@ -336,7 +391,21 @@ bool RendererComponents::create_pixel_renderer_factory()
 
 bool RendererComponents::create_shading_result_framebuffer_factory()
 {
-    const string name = m_params.get_optional<string>("shading_result_framebuffer", "ephemeral");
+    string name = m_params.get_optional<string>("shading_result_framebuffer", "ephemeral");
+
+    // The noise threshold of the generic frame renderer compares the accumulated
+    // values of tiles between passes, which only makes sense if passes accumulate.
+    if (name != "permanent" &&
+        m_params.get_optional<string>("frame_renderer", "generic") == "generic" &&
+        get_child_and_inherit_globals(m_params, "generic_frame_renderer")
+            .get_optional<float>("noise_threshold", 0.0f) > 0.0f)
+    {
+        RENDERER_LOG_WARNING(
+            "the noise threshold requires the permanent shading result framebuffer, "
+            "using \"permanent\" instead of \"%s\".",
+            name.c_str());
+        name = "permanent";
+    }
 
     if (name.empty())
     {
@@ -37,9 +37,11 @@
 
 // Standard headers.
 #include <cstddef>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class AdaptiveSamplingMap; }
 namespace renderer      { class Frame; }
 namespace renderer      { class Sample; }
 
@@ -70,6 +72,16 @@ class SampleAccumulationBuffer
         Frame&                      frame,
         foundation::IAbortSwitch&   abort_switch) = 0;
 
+    // Develop to a frame the tiles that may have changed since the last time the buffer
+    // was developed, and append their indices (ty * tile_count_x + tx) to `tiles`. Thread-safe.
+    virtual void develop_dirty_tiles_to_frame(
+        Frame&                      frame,
+        std::vector<size_t>&        tiles,
+        foundation::IAbortSwitch&   abort_switch) = 0;
+
+    // Return the adaptive sampling map fed by this buffer, or 0 if there is none.
+    virtual AdaptiveSamplingMap* get_adaptive_sampling_map();
+
   protected:
     boost::atomic<foundation::uint64> m_sample_count;
 };
@@ -84,6 +96,11 @@ inline foundation::uint64 SampleAccumulationBuffer::get_sample_count() const
     return m_sample_count;
 }
 
+inline AdaptiveSamplingMap* SampleAccumulationBuffer::get_adaptive_sampling_map()
+{
+    return 0;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_SAMPLEACCUMULATIONBUFFER_H
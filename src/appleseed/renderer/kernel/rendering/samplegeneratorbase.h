@@ -78,6 +78,14 @@ class SampleGeneratorBase
         const size_t                sequence_index,
         SampleVector&               samples) = 0;
 
+    // Store the samples generated by a call to generate_samples() into a buffer.
+    // The default implementation simply stores them if there are any.
+    virtual void store_samples(
+        SampleAccumulationBuffer&   buffer,
+        const size_t                sample_count,
+        const Sample                samples[],
+        foundation::IAbortSwitch&   abort_switch);
+
     void signal_invalid_sample();
 
   private:
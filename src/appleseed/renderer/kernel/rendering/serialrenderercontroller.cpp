@@ -145,6 +145,24 @@ void SerialRendererController::add_post_render_tile_callback(const Frame* frame)
     m_pending_callbacks.push_back(callback);
 }
 
+void SerialRendererController::add_post_update_tile_callback(
+    const Frame*            frame,
+    const size_t            tile_x,
+    const size_t            tile_y)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    PendingTileCallback callback;
+    callback.m_type = PendingTileCallback::PostUpdateTile;
+    callback.m_frame = frame;
+    callback.m_x = tile_x;
+    callback.m_y = tile_y;
+    callback.m_width = 0;
+    callback.m_height = 0;
+
+    m_pending_callbacks.push_back(callback);
+}
+
 void SerialRendererController::exec_callback(const PendingTileCallback& cb)
 {
     switch (cb.m_type)
@@ -161,6 +179,10 @@ void SerialRendererController::exec_callback(const PendingTileCallback& cb)
         m_tile_callback->post_render(cb.m_frame);
         break;
 
+      case PendingTileCallback::PostUpdateTile:
+        m_tile_callback->post_update_tile(cb.m_frame, cb.m_x, cb.m_y);
+        break;
+
       assert_otherwise;
     }
 }
@@ -82,6 +82,11 @@ class SerialRendererController
 
     void add_post_render_tile_callback(const Frame* frame);
 
+    void add_post_update_tile_callback(
+        const Frame*            frame,
+        const size_t            tile_x,
+        const size_t            tile_y);
+
   private:
     struct PendingTileCallback
     {
@@ -89,7 +94,8 @@ class SerialRendererController
         {
             PreRender,
             PostRenderTile,
-            PostRender
+            PostRender,
+            PostUpdateTile
         };
 
         CallbackType    m_type;
@@ -77,6 +77,14 @@ namespace
             m_controller->add_post_render_tile_callback(frame);
         }
 
+        virtual void post_update_tile(
+            const Frame*    frame,
+            const size_t    tile_x,
+            const size_t    tile_y) APPLESEED_OVERRIDE
+        {
+            m_controller->add_post_update_tile_callback(frame, tile_x, tile_y);
+        }
+
       private:
         SerialRendererController* m_controller;
     };
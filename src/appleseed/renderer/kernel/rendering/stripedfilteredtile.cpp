@@ -0,0 +1,354 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "stripedfilteredtile.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/system.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/memory.h"
+
+// Standard headers.
+#include <algorithm>
+#include <new>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// StripedFilteredTile class implementation.
+//
+
+namespace
+{
+    // Minimum height of a stripe, in pixels.
+    const size_t MinStripeHeight = 16;
+
+    size_t compute_stripe_height(const size_t height)
+    {
+        // Use a few stripes per thread so that threads rarely compete for the same stripe.
+        const size_t max_stripe_count = 4 * System::get_logical_cpu_core_count();
+        const size_t stripe_count = max<size_t>(min(max_stripe_count, height / MinStripeHeight), 1);
+
+        return (height + stripe_count - 1) / stripe_count;
+    }
+}
+
+StripedFilteredTile::StripedFilteredTile(
+    const size_t        width,
+    const size_t        height,
+    const size_t        channel_count,
+    const Filter2f&     filter)
+  : m_tile(width, height, channel_count, filter)
+  , m_stripe_count((height + compute_stripe_height(height) - 1) / compute_stripe_height(height))
+  , m_stripe_height(compute_stripe_height(height))
+{
+    // Operator new[] doesn't guarantee the alignment of Stripe.
+    m_stripes = static_cast<Stripe*>(aligned_malloc(m_stripe_count * sizeof(Stripe), 64));
+
+    for (size_t i = 0; i < m_stripe_count; ++i)
+        new (&m_stripes[i]) Stripe();
+
+    m_tile.clear();
+
+    for (size_t i = 0; i < m_stripe_count; ++i)
+    {
+        m_stripes[i].m_dirty = 1;
+        m_stripes[i].m_estimate_count = 0;
+    }
+}
+
+StripedFilteredTile::~StripedFilteredTile()
+{
+    for (size_t i = 0; i < m_sort_buffers.size(); ++i)
+        delete m_sort_buffers[i];
+
+    for (size_t i = 0; i < m_stripe_count; ++i)
+        m_stripes[i].~Stripe();
+
+    aligned_free(m_stripes);
+}
+
+void StripedFilteredTile::clear()
+{
+    lock_stripes(0, m_stripe_count - 1);
+    m_tile.clear();
+
+    for (size_t i = 0; i < m_stripe_count; ++i)
+    {
+        m_stripes[i].m_dirty = 1;
+        m_stripes[i].m_estimate_count = 0;
+    }
+
+    unlock_stripes(0, m_stripe_count - 1);
+}
+
+StripedFilteredTile::SortBuffers* StripedFilteredTile::acquire_sort_buffers()
+{
+    {
+        Spinlock::ScopedLock lock(m_sort_buffers_lock);
+
+        if (!m_sort_buffers.empty())
+        {
+            SortBuffers* buffers = m_sort_buffers.back();
+            m_sort_buffers.pop_back();
+            return buffers;
+        }
+    }
+
+    return new SortBuffers();
+}
+
+void StripedFilteredTile::release_sort_buffers(SortBuffers* buffers)
+{
+    Spinlock::ScopedLock lock(m_sort_buffers_lock);
+    m_sort_buffers.push_back(buffers);
+}
+
+void StripedFilteredTile::sort_samples_by_stripe(
+    const size_t        sample_count,
+    const Sample        samples[],
+    SortBuffers&        buffers) const
+{
+    const float fh = static_cast<float>(m_tile.get_height());
+    const float yradius = m_tile.get_filter().get_yradius();
+    const int max_row = static_cast<int>(m_tile.get_height()) - 1;
+
+    // Find the first and last stripes affected by each sample, the same way
+    // FilteredTile::add() finds the rows affected by a sample. Samples that
+    // don't affect any row are assigned to a virtual stripe that is skipped.
+    vector<uint32>& first_stripe = buffers.m_first_stripe;
+    vector<uint32>& order = buffers.m_order;
+    vector<size_t>& bucket_begin = buffers.m_bucket_begin;
+    vector<size_t>& bucket_end = buffers.m_bucket_end;
+    vector<size_t>& bucket_last_stripe = buffers.m_bucket_last_stripe;
+
+    first_stripe.resize(sample_count);
+    bucket_begin.assign(m_stripe_count + 2, 0);
+    bucket_last_stripe.resize(m_stripe_count + 1);
+
+    for (size_t i = 0; i < m_stripe_count + 1; ++i)
+        bucket_last_stripe[i] = i;
+
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        const float dy = samples[i].m_position.y * fh - 0.5f;
+        const int min_y = max(truncate<int>(fast_ceil(dy - yradius)), 0);
+        const int max_y = min(truncate<int>(fast_floor(dy + yradius)), max_row);
+
+        size_t first = m_stripe_count;
+        if (min_y <= max_y)
+        {
+            first = get_stripe_index(static_cast<size_t>(min_y));
+            const size_t last = get_stripe_index(static_cast<size_t>(max_y));
+            bucket_last_stripe[first] = max(bucket_last_stripe[first], last);
+        }
+
+        first_stripe[i] = static_cast<uint32>(first);
+        ++bucket_begin[first + 1];
+    }
+
+    // Sort samples by first stripe.
+    for (size_t i = 1; i < m_stripe_count + 2; ++i)
+        bucket_begin[i] += bucket_begin[i - 1];
+
+    order.resize(sample_count);
+
+    bucket_end.assign(bucket_begin.begin(), bucket_begin.end() - 1);
+    for (size_t i = 0; i < sample_count; ++i)
+        order[bucket_end[first_stripe[i]]++] = static_cast<uint32>(i);
+}
+
+bool StripedFilteredTile::store_samples(
+    const size_t        sample_count,
+    const Sample        samples[],
+    IAbortSwitch&       abort_switch)
+{
+    const float fw = static_cast<float>(m_tile.get_width());
+    const float fh = static_cast<float>(m_tile.get_height());
+
+    SortBuffers* buffers = acquire_sort_buffers();
+    sort_samples_by_stripe(sample_count, samples, *buffers);
+
+    const vector<uint32>& order = buffers->m_order;
+    const vector<size_t>& bucket_begin = buffers->m_bucket_begin;
+    const vector<size_t>& bucket_last_stripe = buffers->m_bucket_last_stripe;
+
+    // Store samples, one stripe at a time.
+    for (size_t s = 0; s < m_stripe_count; ++s)
+    {
+        const size_t begin = bucket_begin[s];
+        const size_t end = bucket_begin[s + 1];
+
+        if (begin == end)
+            continue;
+
+        if (abort_switch.is_aborted())
+        {
+            release_sort_buffers(buffers);
+            return false;
+        }
+
+        lock_stripes(s, bucket_last_stripe[s]);
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Sample& sample = samples[order[i]];
+            m_tile.add_exclusive(
+                sample.m_position.x * fw,
+                sample.m_position.y * fh,
+                sample.m_values);
+        }
+
+        for (size_t i = s; i <= bucket_last_stripe[s]; ++i)
+            m_stripes[i].m_dirty = 1;
+
+        unlock_stripes(s, bucket_last_stripe[s]);
+    }
+
+    release_sort_buffers(buffers);
+
+    return true;
+}
+
+bool StripedFilteredTile::splat_samples(
+    const size_t        sample_count,
+    const Sample        samples[],
+    const uint64        estimate_count,
+    IAbortSwitch&       abort_switch)
+{
+    // Only check for abortion before splatting anything so that
+    // the estimate counts of all stripes remain consistent.
+    if (abort_switch.is_aborted())
+        return false;
+
+    const float fw = static_cast<float>(m_tile.get_width());
+    const float fh = static_cast<float>(m_tile.get_height());
+
+    SortBuffers* buffers = acquire_sort_buffers();
+    sort_samples_by_stripe(sample_count, samples, *buffers);
+
+    const vector<uint32>& order = buffers->m_order;
+    const vector<size_t>& bucket_begin = buffers->m_bucket_begin;
+    const vector<size_t>& bucket_last_stripe = buffers->m_bucket_last_stripe;
+
+    // Splat samples one stripe at a time. Stripes are acquired in increasing order
+    // and a stripe is only released once its estimate count was incremented, after
+    // which no subsequent sample can affect it: a reader holding the stripe thus
+    // never sees a sample without the estimate it belongs to, and vice versa.
+    size_t last_locked = 0;
+    m_stripes[0].m_lock.lock_read();
+
+    for (size_t s = 0; s < m_stripe_count; ++s)
+    {
+        for (size_t i = last_locked + 1; i <= bucket_last_stripe[s]; ++i)
+            m_stripes[i].m_lock.lock_read();
+
+        last_locked = max(last_locked, bucket_last_stripe[s]);
+
+        for (size_t i = bucket_begin[s], e = bucket_begin[s + 1]; i < e; ++i)
+        {
+            const Sample& sample = samples[order[i]];
+            m_tile.add(
+                sample.m_position.x * fw,
+                sample.m_position.y * fh,
+                sample.m_values);
+        }
+
+        // All stripes change since pixel values are normalized by the estimate count.
+        m_stripes[s].m_estimate_count += estimate_count;
+
+        // Flag the stripe only if it isn't flagged already, to avoid
+        // bouncing the cache lines of the stripes between threads.
+        if (atomic_read(&m_stripes[s].m_dirty) == 0)
+            atomic_write(&m_stripes[s].m_dirty, 1);
+
+        m_stripes[s].m_lock.unlock_read();
+
+        // Keep holding the next stripe so that it cannot be read between
+        // the samples of stripe s that overlap it and its own samples.
+        if (s + 1 < m_stripe_count && last_locked < s + 1)
+        {
+            m_stripes[s + 1].m_lock.lock_read();
+            last_locked = s + 1;
+        }
+    }
+
+    release_sort_buffers(buffers);
+
+    return true;
+}
+
+void StripedFilteredTile::fetch_dirty_stripes(vector<bool>& dirty)
+{
+    dirty.resize(m_stripe_count);
+
+    for (size_t i = 0; i < m_stripe_count; ++i)
+    {
+        m_stripes[i].m_lock.lock_write();
+        dirty[i] = atomic_cas(&m_stripes[i].m_dirty, 1, 0) != 0;
+        m_stripes[i].m_lock.unlock_write();
+    }
+}
+
+void StripedFilteredTile::mark_rows_dirty(const size_t min_y, const size_t max_y)
+{
+    for (size_t i = get_stripe_index(min_y), e = get_stripe_index(max_y); i <= e; ++i)
+        atomic_write(&m_stripes[i].m_dirty, 1);
+}
+
+void StripedFilteredTile::lock_stripes(const size_t first, const size_t last)
+{
+    assert(first <= last);
+    assert(last < m_stripe_count);
+
+    // Always acquire locks in the same order to prevent deadlocks.
+    for (size_t i = first; i <= last; ++i)
+        m_stripes[i].m_lock.lock_write();
+}
+
+void StripedFilteredTile::unlock_stripes(const size_t first, const size_t last)
+{
+    assert(first <= last);
+    assert(last < m_stripe_count);
+
+    for (size_t i = first; i <= last; ++i)
+        m_stripes[i].m_lock.unlock_write();
+}
+
+}   // namespace renderer
@@ -0,0 +1,235 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_STRIPEDFILTEREDTILE_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_STRIPEDFILTEREDTILE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/filteredtile.h"
+#include "foundation/math/filter.h"
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class Sample; }
+
+namespace renderer
+{
+
+//
+// A filtered tile split into horizontal stripes, each protected by its own lock.
+//
+// Threads storing samples only wait for each other when they write to the same
+// stripe at the same time, and pixels are updated without atomic operations.
+// Samples are grouped by stripe so that each lock is acquired once per batch.
+//
+// Samples spread over the whole tile, such as the ones produced by light tracing,
+// can instead be splatted while holding stripes in shared mode: threads splatting
+// samples never wait for each other and pixels are updated with atomic operations.
+// Each stripe then also counts the estimates (e.g. light paths) that were splatted
+// into it, so that a reader holding the stripe sees pixel values and a count that
+// are consistent with each other.
+//
+// Each stripe also records whether it was modified, so that only the parts of
+// the tile that changed need to be read back.
+//
+
+class StripedFilteredTile
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    StripedFilteredTile(
+        const size_t                width,
+        const size_t                height,
+        const size_t                channel_count,
+        const foundation::Filter2f& filter);
+
+    // Destructor.
+    ~StripedFilteredTile();
+
+    // Access the underlying tile. Use lock_rows() to read pixels while samples are being stored.
+    const foundation::FilteredTile& tile() const;
+
+    // Return the number of stripes.
+    size_t get_stripe_count() const;
+
+    // Return the index of the stripe containing a given row.
+    size_t get_stripe_index(const size_t y) const;
+
+    // Set all pixels to black and all weights to zero. Thread-safe.
+    void clear();
+
+    // Store a set of samples whose positions are expressed in normalized device
+    // coordinates. Return false if the operation was aborted. Thread-safe.
+    bool store_samples(
+        const size_t                sample_count,
+        const Sample                samples[],
+        foundation::IAbortSwitch&   abort_switch);
+
+    // Same as store_samples() but stripes are only held in shared mode and pixels are
+    // updated atomically. Meant for samples scattered over the tile, where most stripes
+    // would be locked for a handful of samples each. The samples were produced by
+    // `estimate_count` estimates, which are added to the estimate count of every stripe
+    // (including the ones that received no sample). Either all samples are splatted, or
+    // none if the operation was aborted, in which case false is returned. Thread-safe.
+    bool splat_samples(
+        const size_t                sample_count,
+        const Sample                samples[],
+        const foundation::uint64    estimate_count,
+        foundation::IAbortSwitch&   abort_switch);
+
+    // Acquire or release exclusive access to the stripes covering rows [min_y, max_y].
+    void lock_rows(const size_t min_y, const size_t max_y);
+    void unlock_rows(const size_t min_y, const size_t max_y);
+
+    // Return the number of estimates splatted into the stripe containing a given row.
+    // The rows must be locked with lock_rows() for the count to match the pixels.
+    foundation::uint64 get_row_estimate_count(const size_t y) const;
+
+    // Retrieve which stripes were modified since the last call to this method,
+    // then mark all stripes as unmodified. Thread-safe.
+    void fetch_dirty_stripes(std::vector<bool>& dirty);
+
+    // Mark the stripes covering rows [min_y, max_y] as modified. Thread-safe.
+    void mark_rows_dirty(const size_t min_y, const size_t max_y);
+
+    // Return true if any stripe covering rows [min_y, max_y] is marked in `dirty`.
+    bool are_rows_dirty(
+        const std::vector<bool>&    dirty,
+        const size_t                min_y,
+        const size_t                max_y) const;
+
+  private:
+    typedef foundation::ReadWriteLock<foundation::YieldWaitPolicy> LockType;
+
+    // Stripes are aligned on cache lines to keep locks of different stripes in different cache lines.
+    struct Stripe
+    {
+        APPLESEED_ALIGN(64) LockType        m_lock;         // shared: splatting, exclusive: everything else
+        volatile foundation::uint32         m_dirty;        // may be set without holding the lock exclusively
+        boost::atomic<foundation::uint64>   m_estimate_count;
+    };
+
+    // Temporary buffers used to sort samples by stripe.
+    struct SortBuffers
+    {
+        std::vector<foundation::uint32>     m_first_stripe;
+        std::vector<foundation::uint32>     m_order;
+        std::vector<size_t>                 m_bucket_begin;
+        std::vector<size_t>                 m_bucket_end;
+        std::vector<size_t>                 m_bucket_last_stripe;
+    };
+
+    foundation::FilteredTile        m_tile;
+    const size_t                    m_stripe_count;
+    const size_t                    m_stripe_height;
+    Stripe*                         m_stripes;              // allocated on a cache line boundary
+
+    // Sort buffers not currently in use, kept around to avoid reallocating them for every batch of samples.
+    foundation::Spinlock            m_sort_buffers_lock;
+    std::vector<SortBuffers*>       m_sort_buffers;
+
+    SortBuffers* acquire_sort_buffers();
+    void release_sort_buffers(SortBuffers* buffers);
+
+    // Compute the order in which to store samples so that they are grouped by the first
+    // stripe they affect, and the last stripe affected by the samples of each group.
+    void sort_samples_by_stripe(
+        const size_t                sample_count,
+        const Sample                samples[],
+        SortBuffers&                buffers) const;
+
+    void lock_stripes(const size_t first, const size_t last);
+    void unlock_stripes(const size_t first, const size_t last);
+};
+
+
+//
+// StripedFilteredTile class implementation.
+//
+
+inline const foundation::FilteredTile& StripedFilteredTile::tile() const
+{
+    return m_tile;
+}
+
+inline size_t StripedFilteredTile::get_stripe_count() const
+{
+    return m_stripe_count;
+}
+
+inline void StripedFilteredTile::lock_rows(const size_t min_y, const size_t max_y)
+{
+    lock_stripes(get_stripe_index(min_y), get_stripe_index(max_y));
+}
+
+inline void StripedFilteredTile::unlock_rows(const size_t min_y, const size_t max_y)
+{
+    unlock_stripes(get_stripe_index(min_y), get_stripe_index(max_y));
+}
+
+inline size_t StripedFilteredTile::get_stripe_index(const size_t y) const
+{
+    assert(y < m_tile.get_height());
+    return y / m_stripe_height;
+}
+
+inline foundation::uint64 StripedFilteredTile::get_row_estimate_count(const size_t y) const
+{
+    return m_stripes[get_stripe_index(y)].m_estimate_count;
+}
+
+inline bool StripedFilteredTile::are_rows_dirty(
+    const std::vector<bool>&    dirty,
+    const size_t                min_y,
+    const size_t                max_y) const
+{
+    assert(dirty.size() == m_stripe_count);
+
+    for (size_t i = get_stripe_index(min_y), e = get_stripe_index(max_y); i <= e; ++i)
+    {
+        if (dirty[i])
+            return true;
+    }
+
+    return false;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_STRIPEDFILTEREDTILE_H
@@ -196,14 +196,18 @@ void TextureStore::TileSwapper::load(const TileKey& key, TileRecord& record)
     record.m_tile = texture->load_tile(key.get_tile_x(), key.get_tile_y());
     record.m_owners = 0;
 
-    // Convert the tile to the linear RGB color space.
+    // Convert the tile to the linear RGB color space. Tiles are kept in their
+    // native pixel format; 8-bit sRGB tiles are kept encoded since converting
+    // them in place would quantize linear values to 8 bits. They are decoded on
+    // the fly by TextureSource.
     switch (texture->get_color_space())
     {
       case ColorSpaceLinearRGB:
         break;
 
       case ColorSpaceSRGB:
-        convert_tile_srgb_to_linear_rgb(*record.m_tile);
+        if (record.m_tile->get_pixel_format() != PixelFormatUInt8)
+            convert_tile_srgb_to_linear_rgb(*record.m_tile);
         break;
 
       case ColorSpaceCIEXYZ:
@@ -0,0 +1,172 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+#include "renderer/kernel/rendering/stripedfilteredtile.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/filter.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Rendering_StripedFilteredTile)
+{
+    // Store samples scattered over the whole tile, as light tracing does.
+    template <bool Splat>
+    struct StoreSamplesJob
+      : public IJob
+    {
+        StripedFilteredTile&    m_tile;
+        const vector<Sample>&   m_samples;
+
+        StoreSamplesJob(
+            StripedFilteredTile&    tile,
+            const vector<Sample>&   samples)
+          : m_tile(tile)
+          , m_samples(samples)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            AbortSwitch abort_switch;
+
+            if (Splat)
+                m_tile.splat_samples(m_samples.size(), &m_samples[0], 1, abort_switch);
+            else m_tile.store_samples(m_samples.size(), &m_samples[0], abort_switch);
+        }
+    };
+
+    template <size_t ThreadCount>
+    struct Fixture
+    {
+        static const size_t JobCount = 64;
+        static const size_t SamplesPerJob = 4096;
+
+        Logger                          m_logger;
+        JobQueue                        m_job_queue;
+        JobManager                      m_job_manager;
+        BlackmanHarrisFilter2<float>    m_filter;
+        StripedFilteredTile             m_tile;
+        vector<Sample>                  m_samples[JobCount];
+
+        Fixture()
+          : m_job_manager(m_logger, m_job_queue, ThreadCount, JobManager::KeepRunningOnEmptyQueue)
+          , m_filter(1.5f, 1.5f)
+          , m_tile(1024, 1024, 3, m_filter)
+        {
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < JobCount; ++i)
+            {
+                m_samples[i].resize(SamplesPerJob);
+
+                for (size_t j = 0; j < SamplesPerJob; ++j)
+                {
+                    Sample& sample = m_samples[i][j];
+                    sample.m_position.x = rand_float1(rng);
+                    sample.m_position.y = rand_float1(rng);
+
+                    for (size_t c = 0; c < 5; ++c)
+                        sample.m_values[c] = rand_float1(rng);
+                }
+            }
+
+            m_job_manager.start();
+        }
+
+        template <bool Splat>
+        void payload()
+        {
+            vector<StoreSamplesJob<Splat>*> jobs;
+
+            for (size_t i = 0; i < JobCount; ++i)
+            {
+                jobs.push_back(new StoreSamplesJob<Splat>(m_tile, m_samples[i]));
+                m_job_queue.schedule(jobs.back(), false);
+            }
+
+            m_job_queue.wait_until_completion();
+
+            for (size_t i = 0; i < JobCount; ++i)
+                delete jobs[i];
+        }
+    };
+
+    BENCHMARK_CASE_F(StoreSamples_1Thread, Fixture<1>)
+    {
+        payload<false>();
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_2Threads, Fixture<2>)
+    {
+        payload<false>();
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_4Threads, Fixture<4>)
+    {
+        payload<false>();
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_8Threads, Fixture<8>)
+    {
+        payload<false>();
+    }
+
+    BENCHMARK_CASE_F(SplatSamples_1Thread, Fixture<1>)
+    {
+        payload<true>();
+    }
+
+    BENCHMARK_CASE_F(SplatSamples_2Threads, Fixture<2>)
+    {
+        payload<true>();
+    }
+
+    BENCHMARK_CASE_F(SplatSamples_4Threads, Fixture<4>)
+    {
+        payload<true>();
+    }
+
+    BENCHMARK_CASE_F(SplatSamples_8Threads, Fixture<8>)
+    {
+        payload<true>();
+    }
+}
@@ -0,0 +1,172 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/adaptivesamplingmap.h"
+#include "renderer/kernel/rendering/sample.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_AdaptiveSamplingMap)
+{
+    const size_t Width = 32;
+    const size_t Height = 16;
+
+    // Store samples at the center of every pixel; pixels in the left half of the image are noisy.
+    void store_samples(
+        AdaptiveSamplingMap&    map,
+        const size_t            samples_per_pixel,
+        const bool              noisy_left_half)
+    {
+        MersenneTwister rng;
+        vector<Sample> samples;
+
+        for (size_t i = 0; i < samples_per_pixel; ++i)
+        {
+            for (size_t y = 0; y < Height; ++y)
+            {
+                for (size_t x = 0; x < Width; ++x)
+                {
+                    const float value =
+                        noisy_left_half && x < Width / 2
+                            ? rand_float1(rng)
+                            : 0.5f;
+
+                    Sample sample;
+                    sample.m_position = Vector2f((x + 0.5f) / Width, (y + 0.5f) / Height);
+                    for (size_t c = 0; c < 5; ++c)
+                        sample.m_values[c] = value;
+
+                    samples.push_back(sample);
+                }
+            }
+        }
+
+        map.store_samples(samples.size(), &samples[0]);
+    }
+
+    AABB2u compute_sample_bbox(const AdaptiveSamplingMap& map)
+    {
+        MersenneTwister rng;
+        AABB2u bbox;
+        bbox.invalidate();
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            Vector2d s;
+            s[0] = rand_double2(rng);
+            s[1] = rand_double2(rng);
+
+            const Vector2d p = map.sample(s);
+            bbox.insert(Vector2u(static_cast<size_t>(p[0]), static_cast<size_t>(p[1])));
+        }
+
+        return bbox;
+    }
+
+    TEST_CASE(Sample_BeforeUpdate_CoversCropWindow)
+    {
+        const AABB2u crop_window(Vector2u(4, 2), Vector2u(19, 9));
+        AdaptiveSamplingMap map(Width, Height, crop_window, ParamArray());
+
+        const AABB2u bbox = compute_sample_bbox(map);
+
+        EXPECT_EQ(crop_window, bbox);
+    }
+
+    TEST_CASE(Update_GivenConvergedRightHalf_SamplesOnlyLeftHalf)
+    {
+        const AABB2u crop_window(Vector2u(0, 0), Vector2u(Width - 1, Height - 1));
+        AdaptiveSamplingMap map(Width, Height, crop_window, ParamArray().insert("min_samples", 8));
+
+        store_samples(map, 16, true);
+        map.update();
+
+        const AABB2u bbox = compute_sample_bbox(map);
+
+        EXPECT_FALSE(map.has_converged());
+        EXPECT_EQ(0, bbox.min.x);
+        EXPECT_EQ(Width / 2 - 1, bbox.max.x);
+    }
+
+    TEST_CASE(Update_GivenNoiselessImage_Converges)
+    {
+        const AABB2u crop_window(Vector2u(0, 0), Vector2u(Width - 1, Height - 1));
+        AdaptiveSamplingMap map(Width, Height, crop_window, ParamArray().insert("min_samples", 8));
+
+        store_samples(map, 16, false);
+        map.update();
+
+        EXPECT_TRUE(map.has_converged());
+    }
+
+    TEST_CASE(Update_GivenMaxSamplesReached_Converges)
+    {
+        const AABB2u crop_window(Vector2u(0, 0), Vector2u(Width - 1, Height - 1));
+        AdaptiveSamplingMap map(
+            Width,
+            Height,
+            crop_window,
+            ParamArray()
+                .insert("min_samples", 8)
+                .insert("max_samples", 16));
+
+        store_samples(map, 16, true);
+        map.update();
+
+        EXPECT_TRUE(map.has_converged());
+    }
+
+    TEST_CASE(Clear_ResetsConvergence)
+    {
+        const AABB2u crop_window(Vector2u(0, 0), Vector2u(Width - 1, Height - 1));
+        AdaptiveSamplingMap map(Width, Height, crop_window, ParamArray().insert("min_samples", 8));
+
+        store_samples(map, 16, false);
+        map.update();
+        map.clear();
+
+        EXPECT_FALSE(map.has_converged());
+        EXPECT_EQ(crop_window, compute_sample_bbox(map));
+    }
+}
@@ -0,0 +1,217 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/aov/spectrumstack.h"
+#include "renderer/kernel/lighting/irradiancecache.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_IrradianceCache)
+{
+    const AABB3d SceneBBox(Vector3d(-10.0), Vector3d(10.0));
+    const Vector3d Up(0.0, 1.0, 0.0);
+
+    IrradianceRecord make_record(
+        const Vector3d& position,
+        const Vector3d& normal,
+        const float     irradiance,
+        const float     radius)
+    {
+        IrradianceRecord record;
+        record.m_position = position;
+        record.m_normal = normal;
+        record.m_irradiance.set(irradiance);
+        record.m_rotational_gradient = Vector3f(0.0f);
+        record.m_translational_gradient = Vector3f(0.0f);
+        record.m_radius = radius;
+        return record;
+    }
+
+    TEST_CASE(Lookup_GivenEmptyCache_ReturnsFalse)
+    {
+        const IrradianceCache cache(SceneBBox, 0.2f);
+
+        Spectrum irradiance;
+        EXPECT_FALSE(cache.lookup(Vector3d(0.0), Up, irradiance));
+    }
+
+    TEST_CASE(Lookup_AtRecordPosition_ReturnsRecordIrradiance)
+    {
+        IrradianceCache cache(SceneBBox, 0.2f);
+        cache.insert(make_record(Vector3d(1.0, 0.0, 2.0), Up, 3.0f, 1.0f));
+
+        Spectrum irradiance;
+        ASSERT_TRUE(cache.lookup(Vector3d(1.0, 0.0, 2.0), Up, irradiance));
+
+        EXPECT_FEQ(3.0f, irradiance[0]);
+    }
+
+    TEST_CASE(Lookup_GivenPerpendicularNormal_ReturnsFalse)
+    {
+        IrradianceCache cache(SceneBBox, 0.2f);
+        cache.insert(make_record(Vector3d(0.0), Up, 1.0f, 1.0f));
+
+        Spectrum irradiance;
+        EXPECT_FALSE(cache.lookup(Vector3d(0.0), Vector3d(1.0, 0.0, 0.0), irradiance));
+    }
+
+    TEST_CASE(Lookup_BeyondRecordDomain_ReturnsFalse)
+    {
+        IrradianceCache cache(SceneBBox, 0.2f);
+        cache.insert(make_record(Vector3d(0.0), Up, 1.0f, 1.0f));
+
+        Spectrum irradiance;
+        EXPECT_FALSE(cache.lookup(Vector3d(0.25, 0.0, 0.0), Up, irradiance));
+    }
+
+    TEST_CASE(Lookup_GivenRecordInFrontOfPoint_ReturnsFalse)
+    {
+        IrradianceCache cache(SceneBBox, 0.2f);
+        cache.insert(make_record(Vector3d(0.0), Up, 1.0f, 1.0f));
+
+        Spectrum irradiance;
+        EXPECT_FALSE(cache.lookup(Vector3d(0.0, -0.1, 0.0), Up, irradiance));
+    }
+
+    TEST_CASE(Lookup_MidwayBetweenTwoRecords_ReturnsAverageIrradiance)
+    {
+        IrradianceCache cache(SceneBBox, 0.2f);
+        cache.insert(make_record(Vector3d(-0.1, 0.0, 0.0), Up, 1.0f, 1.0f));
+        cache.insert(make_record(Vector3d(0.1, 0.0, 0.0), Up, 3.0f, 1.0f));
+
+        Spectrum irradiance;
+        ASSERT_TRUE(cache.lookup(Vector3d(0.0), Up, irradiance));
+
+        EXPECT_FEQ(2.0f, irradiance[0]);
+    }
+
+    TEST_CASE(Lookup_MidwayBetweenTwoRecords_ReturnsAverageIrradiancePerRenderLayer)
+    {
+        IrradianceRecord record1 = make_record(Vector3d(-0.1, 0.0, 0.0), Up, 1.0f, 1.0f);
+        record1.m_aov_irradiance.resize(2);
+        record1.m_aov_irradiance[0].set(1.0f);
+        record1.m_aov_irradiance[1].set(0.0f);
+
+        IrradianceRecord record2 = make_record(Vector3d(0.1, 0.0, 0.0), Up, 3.0f, 1.0f);
+        record2.m_aov_irradiance.resize(2);
+        record2.m_aov_irradiance[0].set(1.0f);
+        record2.m_aov_irradiance[1].set(2.0f);
+
+        IrradianceCache cache(SceneBBox, 0.2f);
+        cache.insert(record1);
+        cache.insert(record2);
+
+        Spectrum irradiance;
+        SpectrumStack aov_irradiance(2);
+        ASSERT_TRUE(cache.lookup(Vector3d(0.0), Up, irradiance, aov_irradiance));
+
+        EXPECT_FEQ(2.0f, irradiance[0]);
+        EXPECT_FEQ(1.0f, aov_irradiance[0][0]);
+        EXPECT_FEQ(1.0f, aov_irradiance[1][0]);
+    }
+
+    TEST_CASE(Lookup_GivenTranslationalGradient_ExtrapolatesIrradiance)
+    {
+        IrradianceRecord record = make_record(Vector3d(0.0), Up, 2.0f, 1.0f);
+        record.m_translational_gradient = Vector3f(1.0f, 0.0f, 0.0f);
+
+        IrradianceCache cache(SceneBBox, 0.2f);
+        cache.insert(record);
+
+        Spectrum irradiance;
+        ASSERT_TRUE(cache.lookup(Vector3d(0.1, 0.0, 0.0), Up, irradiance));
+
+        EXPECT_FEQ(2.0f * 1.1f, irradiance[0]);
+    }
+
+    TEST_CASE(Lookup_GivenManyRecords_FindsValidRecordIfAndOnlyIfOneExists)
+    {
+        const float MaxError = 0.3f;
+
+        MersenneTwister rng;
+        vector<IrradianceRecord> records;
+        IrradianceCache cache(SceneBBox, MaxError);
+
+        for (size_t i = 0; i < 500; ++i)
+        {
+            const Vector3d position(
+                rand_double1(rng, -10.0, 10.0),
+                0.0,
+                rand_double1(rng, -10.0, 10.0));
+            const float radius = rand_float1(rng, 0.05f, 2.0f);
+
+            records.push_back(make_record(position, Up, 1.0f, radius));
+            cache.insert(records.back());
+        }
+
+        EXPECT_EQ(records.size(), cache.size());
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const Vector3d point(
+                rand_double1(rng, -10.0, 10.0),
+                0.0,
+                rand_double1(rng, -10.0, 10.0));
+
+            bool expected = false;
+            for (size_t j = 0; j < records.size(); ++j)
+            {
+                if (norm(point - records[j].m_position) / records[j].m_radius < MaxError)
+                {
+                    expected = true;
+                    break;
+                }
+            }
+
+            Spectrum irradiance;
+            const bool found = cache.lookup(point, Up, irradiance);
+
+            EXPECT_EQ(expected, found);
+
+            if (found)
+                EXPECT_FEQ(1.0f, irradiance[0]);
+        }
+    }
+}
@@ -0,0 +1,187 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/lighttree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/countof.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_LightTree)
+{
+    LightTree::Item make_item(
+        const Vector3d&     center,
+        const Vector3d&     normal,
+        const float         power)
+    {
+        LightTree::Item item;
+        item.m_bbox = AABB3d(center - Vector3d(0.01), center + Vector3d(0.01));
+        item.m_normal = normal;
+        item.m_power = power;
+        return item;
+    }
+
+    void make_random_items(
+        const size_t                item_count,
+        vector<LightTree::Item>&    items)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < item_count; ++i)
+        {
+            Vector3d center;
+            center.x = rand_double1(rng, -10.0, 10.0);
+            center.y = rand_double1(rng, -10.0, 10.0);
+            center.z = rand_double1(rng, -10.0, 10.0);
+
+            Vector2d s;
+            s.x = rand_double2(rng);
+            s.y = rand_double2(rng);
+
+            items.push_back(
+                make_item(
+                    center,
+                    sample_sphere_uniform(s),
+                    static_cast<float>(rand_double1(rng, 0.1, 10.0))));
+        }
+    }
+
+    TEST_CASE(Build_GivenNoItem_BuildsEmptyTree)
+    {
+        LightTree tree;
+        tree.build(vector<LightTree::Item>());
+
+        EXPECT_TRUE(tree.empty());
+    }
+
+    TEST_CASE(Sample_GivenSingleItem_ReturnsItemWithProbabilityOne)
+    {
+        vector<LightTree::Item> items;
+        items.push_back(make_item(Vector3d(0.0, 1.0, 0.0), Vector3d(0.0, -1.0, 0.0), 1.0f));
+
+        LightTree tree;
+        tree.build(items);
+
+        float prob;
+        const size_t index = tree.sample(Vector3d(0.0), 0.5f, prob);
+
+        EXPECT_EQ(1, tree.get_node_count());
+        EXPECT_EQ(0, index);
+        EXPECT_EQ(1.0f, prob);
+        EXPECT_EQ(1.0f, tree.evaluate_pdf(Vector3d(0.0), 0));
+    }
+
+    TEST_CASE(EvaluatePDF_SumsToOneOverAllItems)
+    {
+        vector<LightTree::Item> items;
+        make_random_items(100, items);
+
+        LightTree tree;
+        tree.build(items);
+
+        EXPECT_EQ(2 * items.size() - 1, tree.get_node_count());
+
+        const Vector3d points[] =
+        {
+            Vector3d(0.0),
+            Vector3d(5.0, -3.0, 2.0),
+            Vector3d(100.0, 0.0, 0.0)
+        };
+
+        for (size_t i = 0; i < countof(points); ++i)
+        {
+            double sum = 0.0;
+
+            for (size_t j = 0; j < items.size(); ++j)
+                sum += tree.evaluate_pdf(points[i], j);
+
+            EXPECT_FEQ_EPS(1.0, sum, 1.0e-4);
+        }
+    }
+
+    TEST_CASE(Sample_ReturnsSameProbabilityAsEvaluatePDF)
+    {
+        vector<LightTree::Item> items;
+        make_random_items(100, items);
+
+        LightTree tree;
+        tree.build(items);
+
+        const Vector3d point(1.0, 2.0, 3.0);
+
+        for (size_t i = 0; i < 64; ++i)
+        {
+            const float s = (i + 0.5f) / 64.0f;
+
+            float prob;
+            const size_t index = tree.sample(point, s, prob);
+
+            EXPECT_LT(items.size(), index);
+            EXPECT_FEQ_EPS(tree.evaluate_pdf(point, index), prob, 1.0e-5f);
+        }
+    }
+
+    TEST_CASE(EvaluatePDF_GivenItemFacingAway_ReturnsZero)
+    {
+        vector<LightTree::Item> items;
+        items.push_back(make_item(Vector3d(0.0, 1.0, 0.0), Vector3d(0.0, -1.0, 0.0), 1.0f));
+        items.push_back(make_item(Vector3d(0.0, -1.0, 0.0), Vector3d(0.0, -1.0, 0.0), 1.0f));
+
+        LightTree tree;
+        tree.build(items);
+
+        EXPECT_EQ(1.0f, tree.evaluate_pdf(Vector3d(0.0), 0));
+        EXPECT_EQ(0.0f, tree.evaluate_pdf(Vector3d(0.0), 1));
+    }
+
+    TEST_CASE(EvaluatePDF_GivenCloserItem_ReturnsHigherProbability)
+    {
+        vector<LightTree::Item> items;
+        items.push_back(make_item(Vector3d(0.0, 1.0, 0.0), Vector3d(0.0, -1.0, 0.0), 1.0f));
+        items.push_back(make_item(Vector3d(0.0, 10.0, 0.0), Vector3d(0.0, -1.0, 0.0), 1.0f));
+
+        LightTree tree;
+        tree.build(items);
+
+        EXPECT_GT(0.9f, tree.evaluate_pdf(Vector3d(0.0), 0));
+    }
+}
@@ -0,0 +1,159 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sdtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/qmc.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SDTree)
+{
+    Vector2f hammersley(const size_t i, const size_t count)
+    {
+        return Vector2f((i + 0.5f) / count, radical_inverse_base2<float>(i));
+    }
+
+    TEST_CASE(DirectionToSquare_SquareToDirection_RoundTrips)
+    {
+        const Vector3f direction = normalize(Vector3f(0.3f, -0.5f, 0.8f));
+
+        const Vector2f p = DTree::direction_to_square(direction);
+        const Vector3f result = DTree::square_to_direction(p);
+
+        EXPECT_FEQ_EPS(direction, result, 1.0e-5f);
+    }
+
+    TEST_CASE(EvaluatePdf_GivenEmptyTree_ReturnsUniformPdf)
+    {
+        const DTree dtree;
+
+        EXPECT_TRUE(dtree.empty());
+        EXPECT_FEQ(RcpFourPi<float>(), dtree.evaluate_pdf(Vector3f(0.0f, 1.0f, 0.0f)));
+    }
+
+    struct Fixture
+    {
+        static const size_t SampleCount = 4096;
+
+        const Vector3f  m_lobe_direction;
+        DTree           m_dtree;
+
+        Fixture()
+          : m_lobe_direction(normalize(Vector3f(1.0f, 1.0f, 0.0f)))
+        {
+            DTree building;
+
+            // Record the samples of a lobe around a given direction, twice to refine the tree.
+            for (size_t pass = 0; pass < 2; ++pass)
+            {
+                for (size_t i = 0; i < SampleCount; ++i)
+                {
+                    const Vector2f s = hammersley(i, SampleCount);
+                    const Vector3f direction = sample_sphere_uniform(s);
+                    const float cos_theta = dot(direction, m_lobe_direction);
+                    building.record(direction, cos_theta > 0.9f ? 1.0f : 0.01f);
+                }
+
+                m_dtree = building;
+                building.reset(m_dtree, 0.01f, 20);
+            }
+        }
+    };
+
+    TEST_CASE_F(EvaluatePdf_IntegratesToOne, Fixture)
+    {
+        float integral = 0.0f;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const Vector2f s = hammersley(i, SampleCount);
+            const Vector3f direction = sample_sphere_uniform(s);
+            integral += m_dtree.evaluate_pdf(direction) * FourPi<float>();
+        }
+
+        integral /= SampleCount;
+
+        EXPECT_FEQ_EPS(1.0f, integral, 0.05f);
+    }
+
+    TEST_CASE_F(Sample_ReturnsMostDirectionsInRecordedLobe, Fixture)
+    {
+        size_t count = 0;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const Vector2f s = hammersley(i, SampleCount);
+            const Vector3f direction = m_dtree.sample(s);
+            if (dot(direction, m_lobe_direction) > 0.9f)
+                ++count;
+        }
+
+        // The lobe covers 5% of the sphere but holds about 84% of the energy.
+        EXPECT_GT(SampleCount * 2 / 3, count);
+    }
+
+    TEST_CASE(Refine_GivenLeafAboveThreshold_SplitsLeaf)
+    {
+        STree stree(AABB3f(Vector3f(0.0f), Vector3f(1.0f)));
+
+        for (size_t i = 0; i < 100; ++i)
+            stree.get_leaf(0).m_building.record(Vector3f(0.0f, 1.0f, 0.0f), 1.0f);
+
+        stree.refine(60.0f);
+
+        EXPECT_EQ(2, stree.get_leaf_count());
+        EXPECT_NEQ(
+            &stree.find_leaf(Vector3f(0.25f, 0.5f, 0.5f)),
+            &stree.find_leaf(Vector3f(0.75f, 0.5f, 0.5f)));
+    }
+
+    TEST_CASE(Refine_GivenLeafBelowThreshold_KeepsLeaf)
+    {
+        STree stree(AABB3f(Vector3f(0.0f), Vector3f(1.0f)));
+
+        for (size_t i = 0; i < 10; ++i)
+            stree.get_leaf(0).m_building.record(Vector3f(0.0f, 1.0f, 0.0f), 1.0f);
+
+        stree.refine(60.0f);
+
+        EXPECT_EQ(1, stree.get_leaf_count());
+    }
+}
@@ -0,0 +1,234 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/generic/sharedborderaccumulationbuffer.h"
+#include "renderer/kernel/rendering/ephemeralshadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
+#include "renderer/kernel/shading/shadingresult.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_Generic_SharedBorderAccumulationBuffer)
+{
+    const size_t Width = 20;
+    const size_t Height = 20;
+
+    float get_sample_value(const size_t x, const size_t y)
+    {
+        return static_cast<float>(y * Width + x);
+    }
+
+    TEST_CASE(Accumulate_GivenAllTilesSampledOnce_DevelopsSameImageAsFrameWideSplatting)
+    {
+        // A 3x3 box filter and tiles that don't evenly divide the frame.
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "20 20")
+                    .insert("pixel_format", "float")
+                    .insert("tile_size", "8 8")
+                    .insert("filter", "box")
+                    .insert("filter_size", "1.5")));
+
+        EphemeralShadingResultFrameBufferFactory framebuffer_factory;
+        SharedBorderAccumulationBuffer buffer(frame.ref(), &framebuffer_factory, 1, 1);
+
+        // Take one sample at the center of each pixel of each tile.
+        const CanvasProperties& props = frame->image().properties();
+        for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+        {
+            for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+            {
+                auto_ptr<ShadingResultFrameBuffer> padded(buffer.create_padded_framebuffer(tx, ty));
+                const Tile& tile = frame->image().tile(tx, ty);
+
+                for (size_t y = 0; y < tile.get_height(); ++y)
+                {
+                    for (size_t x = 0; x < tile.get_width(); ++x)
+                    {
+                        const float value = get_sample_value(tx * props.m_tile_width + x, ty * props.m_tile_height + y);
+
+                        ShadingResult sample;
+                        sample.m_color_space = ColorSpaceLinearRGB;
+                        sample.set_main_to_linear_rgba(Color4f(value, value, value, 1.0f));
+
+                        padded->add(x + 1.5f, y + 1.5f, sample);
+                    }
+                }
+
+                vector<Vector2u> completed_tiles;
+                buffer.accumulate(tx, ty, 1, *padded, completed_tiles);
+            }
+        }
+
+        // Each pixel must be the average of the samples of the pixels of its 3x3 neighborhood.
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                float sum = 0.0f;
+                size_t count = 0;
+
+                for (size_t ny = y > 0 ? y - 1 : 0; ny <= y + 1 && ny < Height; ++ny)
+                {
+                    for (size_t nx = x > 0 ? x - 1 : 0; nx <= x + 1 && nx < Width; ++nx)
+                    {
+                        sum += get_sample_value(nx, ny);
+                        ++count;
+                    }
+                }
+
+                Color4f pixel;
+                frame->image().get_pixel(x, y, pixel);
+
+                EXPECT_FEQ(sum / count, pixel[0]);
+            }
+        }
+    }
+
+    TEST_CASE(Accumulate_GivenTilesRenderedInOrder_CompletesEachTileOnceAfterItsNeighbors)
+    {
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "20 20")
+                    .insert("pixel_format", "float")
+                    .insert("tile_size", "8 8")
+                    .insert("filter", "box")
+                    .insert("filter_size", "1.5")));
+
+        EphemeralShadingResultFrameBufferFactory framebuffer_factory;
+        SharedBorderAccumulationBuffer buffer(frame.ref(), &framebuffer_factory, 1, 1);
+
+        const CanvasProperties& props = frame->image().properties();
+        vector<size_t> completion_counts(props.m_tile_count, 0);
+
+        for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+        {
+            for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+            {
+                auto_ptr<ShadingResultFrameBuffer> padded(buffer.create_padded_framebuffer(tx, ty));
+
+                vector<Vector2u> completed_tiles;
+                buffer.accumulate(tx, ty, 1, *padded, completed_tiles);
+
+                for (size_t i = 0; i < completed_tiles.size(); ++i)
+                {
+                    const Vector2u& t = completed_tiles[i];
+
+                    // A tile is complete once its last neighbor in rendering order was rendered.
+                    const size_t last_x = min(t.x + 1, props.m_tile_count_x - 1);
+                    const size_t last_y = min(t.y + 1, props.m_tile_count_y - 1);
+                    EXPECT_EQ(last_x, tx);
+                    EXPECT_EQ(last_y, ty);
+
+                    ++completion_counts[t.y * props.m_tile_count_x + t.x];
+                }
+            }
+        }
+
+        for (size_t i = 0; i < props.m_tile_count; ++i)
+            EXPECT_EQ(1, completion_counts[i]);
+    }
+
+    TEST_CASE(Accumulate_GivenTileSkippedInSecondPass_CompletesEachTileOnceInSecondPass)
+    {
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "20 20")
+                    .insert("pixel_format", "float")
+                    .insert("tile_size", "8 8")
+                    .insert("filter", "box")
+                    .insert("filter_size", "1.5")));
+
+        EphemeralShadingResultFrameBufferFactory framebuffer_factory;
+        SharedBorderAccumulationBuffer buffer(frame.ref(), &framebuffer_factory, 1, 1);
+
+        const CanvasProperties& props = frame->image().properties();
+        vector<bool> active_tiles(props.m_tile_count, true);
+
+        for (size_t pass = 1; pass <= 2; ++pass)
+        {
+            // Skip the center tile in the second pass, as if it had converged.
+            if (pass == 2)
+            {
+                active_tiles[1 * props.m_tile_count_x + 1] = false;
+                buffer.set_active_tiles(active_tiles);
+            }
+
+            vector<size_t> completion_counts(props.m_tile_count, 0);
+
+            for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+            {
+                for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+                {
+                    if (!active_tiles[ty * props.m_tile_count_x + tx])
+                        continue;
+
+                    auto_ptr<ShadingResultFrameBuffer> padded(buffer.create_padded_framebuffer(tx, ty));
+
+                    vector<Vector2u> completed_tiles;
+                    buffer.accumulate(tx, ty, pass, *padded, completed_tiles);
+
+                    for (size_t i = 0; i < completed_tiles.size(); ++i)
+                        ++completion_counts[completed_tiles[i].y * props.m_tile_count_x + completed_tiles[i].x];
+                }
+            }
+
+            // Every tile has a rendered neighbor, so even the skipped tile receives contributions.
+            for (size_t i = 0; i < props.m_tile_count; ++i)
+                EXPECT_EQ(1, completion_counts[i]);
+        }
+    }
+}
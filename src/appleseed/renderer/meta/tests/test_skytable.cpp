@@ -0,0 +1,132 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/environmentedf/skytable.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/colorspace.h"
+#include "foundation/math/qmc.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Modeling_EnvironmentEDF_SkyTable)
+{
+    // CIE xy chromaticity of the D65 illuminant.
+    const float D65x = 0.3127f;
+    const float D65y = 0.3290f;
+
+    // Return the luminance in cd.m^-2 of a given radiance.
+    float radiance_to_luminance(const Spectrum& value)
+    {
+        float luminance = 0.0f;
+
+        for (size_t i = 0; i < value.size(); ++i)
+            luminance += value[i] * XYZCMFCIE19312Deg[1][i];
+
+        return luminance * 683.0f * Pi<float>();
+    }
+
+    TEST_CASE(Evaluate_AtTexelCenter_ReturnsTexelRadiance)
+    {
+        SkyTable table(16, 8);
+        table.set_texel(5, 2, D65x, D65y, 1000.0f);
+        table.prepare();
+
+        Spectrum value;
+        table.evaluate(table.get_texel_direction(5, 2), value);
+
+        EXPECT_FEQ_EPS(1000.0f, radiance_to_luminance(value), 1.0e-3f);
+    }
+
+    TEST_CASE(Evaluate_GivenBlackTexels_ReturnsZero)
+    {
+        SkyTable table(16, 8);
+        table.set_texel(5, 2, D65x, D65y, 1000.0f);
+        table.prepare();
+
+        Spectrum value;
+        table.evaluate(table.get_texel_direction(10, 6), value);
+
+        EXPECT_EQ(0.0f, radiance_to_luminance(value));
+    }
+
+    TEST_CASE(Sample_ReturnsSamePDFAsEvaluatePDF)
+    {
+        SkyTable table(16, 8);
+
+        for (size_t y = 0; y < 4; ++y)
+        {
+            for (size_t x = 0; x < 16; ++x)
+                table.set_texel(x, y, D65x, D65y, static_cast<float>(1 + x + y));
+        }
+
+        table.prepare();
+
+        const size_t SampleCount = 64;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const size_t Bases[1] = { 2 };
+            const Vector2f s = hammersley_sequence<float, 2>(Bases, SampleCount, i);
+
+            Vector3f outgoing;
+            Spectrum value;
+            float probability;
+            table.sample(s, outgoing, value, probability);
+
+            EXPECT_GT(0.0f, outgoing.y);
+            EXPECT_GT(0.0f, radiance_to_luminance(value));
+            EXPECT_FEQ(probability, table.evaluate_pdf(outgoing));
+        }
+    }
+
+    TEST_CASE(Sample_GivenBlackTable_SamplesUniformly)
+    {
+        SkyTable table(16, 8);
+        table.prepare();
+
+        Vector3f outgoing;
+        Spectrum value;
+        float probability;
+        table.sample(Vector2f(0.3f, 0.6f), outgoing, value, probability);
+
+        EXPECT_GT(0.0f, probability);
+        EXPECT_EQ(0.0f, radiance_to_luminance(value));
+        EXPECT_FEQ(probability, table.evaluate_pdf(outgoing));
+    }
+}
@@ -0,0 +1,89 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmpixelstatistics.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SPPM_SPPMPixelStatistics)
+{
+    TEST_CASE(EndPass_GivenUncappedLookup_ShrinksRadiusAccordingToPhotonCount)
+    {
+        SPPMPixelStatistics statistics;
+        statistics.initialize(1, 1, 1.0f);
+
+        statistics.record_lookup(Vector2i(0, 0), 10, 1.0f);
+        statistics.end_pass(0.5f);
+
+        // N' = 0 + 0.5 * 10 and R' = 1 * sqrt(5 / 10).
+        EXPECT_FEQ(sqrt(0.5f), statistics.get_radius(Vector2i(0, 0)));
+    }
+
+    TEST_CASE(EndPass_GivenCappedLookup_ScalesPhotonCountToPixelRadius)
+    {
+        SPPMPixelStatistics statistics;
+        statistics.initialize(1, 1, 1.0f);
+
+        // 10 photons within a quarter of the area of the pixel disk.
+        statistics.record_lookup(Vector2i(0, 0), 10, 0.25f);
+        statistics.record_lookup(Vector2i(0, 0), 10, 1.0f);
+        statistics.end_pass(0.5f);
+
+        // M = (40 + 10) / 2, N' = 0.5 * 25 and R' = 1 * sqrt(12.5 / 25).
+        EXPECT_FEQ(sqrt(0.5f), statistics.get_radius(Vector2i(0, 0)));
+
+        // The next pass starts with N = 12.5 at the new radius.
+        const float r2 = 0.5f;
+        statistics.record_lookup(Vector2i(0, 0), 10, r2 / 2.0f);
+        statistics.end_pass(0.5f);
+
+        // M = 20, N' = 12.5 + 10 and R'^2 = 0.5 * 22.5 / 32.5.
+        EXPECT_FEQ(sqrt(0.5f * 22.5f / 32.5f), statistics.get_radius(Vector2i(0, 0)));
+    }
+
+    TEST_CASE(RecordLookup_GivenPixelOutsideCanvas_IgnoresLookup)
+    {
+        SPPMPixelStatistics statistics;
+        statistics.initialize(2, 2, 1.0f);
+
+        statistics.record_lookup(Vector2i(-1, 0), 10, 1.0f);
+        statistics.record_lookup(Vector2i(0, 2), 10, 1.0f);
+
+        EXPECT_FEQ(1.0f, statistics.end_pass(0.5f));
+    }
+}
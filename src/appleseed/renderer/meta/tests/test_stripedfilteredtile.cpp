@@ -0,0 +1,194 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+#include "renderer/kernel/rendering/stripedfilteredtile.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/filteredtile.h"
+#include "foundation/math/filter.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_StripedFilteredTile)
+{
+    TEST_CASE(StoreSamples_MatchesFilteredTile)
+    {
+        const size_t Width = 37;
+        const size_t Height = 150;
+        const size_t SampleCount = 2000;
+
+        const GaussianFilter2<float> filter(2.0f, 2.0f, 8.0f);
+
+        // Generate samples, including some that fall slightly outside the tile.
+        MersenneTwister rng;
+        vector<Sample> samples(SampleCount);
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            samples[i].m_position.x = rand_float1(rng, -0.05f, 1.05f);
+            samples[i].m_position.y = rand_float1(rng, -0.05f, 1.05f);
+
+            for (size_t c = 0; c < 5; ++c)
+                samples[i].m_values[c] = rand_float1(rng);
+        }
+
+        FilteredTile expected(Width, Height, 5, filter);
+        expected.clear();
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            expected.add(
+                samples[i].m_position.x * Width,
+                samples[i].m_position.y * Height,
+                samples[i].m_values);
+        }
+
+        StripedFilteredTile striped(Width, Height, 5, filter);
+        AbortSwitch abort_switch;
+        EXPECT_TRUE(striped.store_samples(SampleCount, &samples[0], abort_switch));
+
+        // Samples are added in a different order, so results may differ slightly.
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                const float* expected_pixel = expected.pixel(x, y);
+                const float* pixel = striped.tile().pixel(x, y);
+
+                for (size_t c = 0; c < 6; ++c)
+                    EXPECT_FEQ_EPS(expected_pixel[c], pixel[c], 1.0e-4f);
+            }
+        }
+    }
+
+    TEST_CASE(SplatSamples_MatchesStoreSamples)
+    {
+        const size_t Width = 37;
+        const size_t Height = 150;
+        const size_t SampleCount = 2000;
+
+        const GaussianFilter2<float> filter(2.0f, 2.0f, 8.0f);
+
+        MersenneTwister rng;
+        vector<Sample> samples(SampleCount);
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            samples[i].m_position.x = rand_float1(rng, -0.05f, 1.05f);
+            samples[i].m_position.y = rand_float1(rng, -0.05f, 1.05f);
+
+            for (size_t c = 0; c < 5; ++c)
+                samples[i].m_values[c] = rand_float1(rng);
+        }
+
+        AbortSwitch abort_switch;
+
+        StripedFilteredTile stored(Width, Height, 5, filter);
+        EXPECT_TRUE(stored.store_samples(SampleCount, &samples[0], abort_switch));
+
+        StripedFilteredTile splatted(Width, Height, 5, filter);
+        EXPECT_TRUE(splatted.splat_samples(SampleCount, &samples[0], 3, abort_switch));
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                const float* expected_pixel = stored.tile().pixel(x, y);
+                const float* pixel = splatted.tile().pixel(x, y);
+
+                for (size_t c = 0; c < 6; ++c)
+                    EXPECT_FEQ_EPS(expected_pixel[c], pixel[c], 1.0e-4f);
+            }
+        }
+    }
+
+    TEST_CASE(SplatSamples_AddsEstimateCountToAllStripes)
+    {
+        const size_t Width = 32;
+        const size_t Height = 160;
+
+        const BoxFilter2<float> filter(1.0f, 1.0f);
+        StripedFilteredTile striped(Width, Height, 5, filter);
+
+        Sample sample;
+        sample.m_position.x = 0.5f;
+        sample.m_position.y = 0.5f;
+        for (size_t c = 0; c < 5; ++c)
+            sample.m_values[c] = 1.0f;
+
+        AbortSwitch abort_switch;
+        EXPECT_TRUE(striped.splat_samples(1, &sample, 7, abort_switch));
+        EXPECT_TRUE(striped.splat_samples(0, 0, 5, abort_switch));
+
+        for (size_t y = 0; y < Height; ++y)
+            EXPECT_EQ(12, striped.get_row_estimate_count(y));
+
+        striped.clear();
+
+        EXPECT_EQ(0, striped.get_row_estimate_count(0));
+    }
+
+    TEST_CASE(FetchDirtyStripes_ReturnsStripesThatReceivedSamples)
+    {
+        const size_t Width = 32;
+        const size_t Height = 160;
+
+        const BoxFilter2<float> filter(1.0f, 1.0f);
+        StripedFilteredTile striped(Width, Height, 5, filter);
+
+        // All stripes are dirty after construction, and none after fetching them.
+        vector<bool> dirty;
+        striped.fetch_dirty_stripes(dirty);
+        ASSERT_EQ(striped.get_stripe_count(), dirty.size());
+        EXPECT_TRUE(striped.are_rows_dirty(dirty, 0, Height - 1));
+        striped.fetch_dirty_stripes(dirty);
+        EXPECT_FALSE(striped.are_rows_dirty(dirty, 0, Height - 1));
+
+        Sample sample;
+        sample.m_position.x = 0.5f;
+        sample.m_position.y = 0.99f;
+        for (size_t c = 0; c < 5; ++c)
+            sample.m_values[c] = 1.0f;
+
+        AbortSwitch abort_switch;
+        EXPECT_TRUE(striped.store_samples(1, &sample, abort_switch));
+
+        striped.fetch_dirty_stripes(dirty);
+        EXPECT_FALSE(striped.are_rows_dirty(dirty, 0, 0));
+        EXPECT_TRUE(striped.are_rows_dirty(dirty, Height - 1, Height - 1));
+    }
+}
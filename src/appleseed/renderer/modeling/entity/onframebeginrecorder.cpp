@@ -31,6 +31,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/modeling/entity/entity.h"
+#include "renderer/utility/paramarray.h"
 
 // Standard headers.
 #include <cassert>
@@ -50,6 +51,7 @@ struct OnFrameBeginRecorder::Impl
     };
 
     stack<Record> m_records;
+    ParamArray    m_rendering_params;
 };
 
 OnFrameBeginRecorder::OnFrameBeginRecorder()
@@ -57,12 +59,23 @@ OnFrameBeginRecorder::OnFrameBeginRecorder()
 {
 }
 
+OnFrameBeginRecorder::OnFrameBeginRecorder(const ParamArray& rendering_params)
+  : impl(new Impl())
+{
+    impl->m_rendering_params = rendering_params;
+}
+
 OnFrameBeginRecorder::~OnFrameBeginRecorder()
 {
     assert(impl->m_records.empty());
     delete impl;
 }
 
+const ParamArray& OnFrameBeginRecorder::get_rendering_parameters() const
+{
+    return impl->m_rendering_params;
+}
+
 void OnFrameBeginRecorder::record(Entity* entity, const BaseGroup* parent)
 {
     Impl::Record record;
@@ -35,6 +35,7 @@
 // Forward declarations.
 namespace renderer  { class BaseGroup; }
 namespace renderer  { class Entity; }
+namespace renderer  { class ParamArray; }
 namespace renderer  { class Project; }
 
 namespace renderer
@@ -43,14 +44,19 @@ namespace renderer
 //
 // Keep tracks of which entity we have called on_frame_begin() on,
 // and allows to call on_frame_end() on all those entities, in reverse order.
+// Also carries the rendering parameters to the entities, if any.
 //
 
 class APPLESEED_DLLSYMBOL OnFrameBeginRecorder
 {
   public:
     OnFrameBeginRecorder();
+    explicit OnFrameBeginRecorder(const ParamArray& rendering_params);
     ~OnFrameBeginRecorder();
 
+    // Return the rendering parameters (empty if none were given).
+    const ParamArray& get_rendering_parameters() const;
+
     void record(Entity* entity, const BaseGroup* parent);
     void on_frame_end(const Project& project);
 
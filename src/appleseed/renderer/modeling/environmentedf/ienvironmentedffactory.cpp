@@ -125,6 +125,26 @@ void IEnvironmentEDFFactory::add_common_sky_input_metadata(DictionaryArray& meta
             .insert("use", "optional")
             .insert("default", "0.0")
             .insert("help", "Rotate the sky horizontally by a given number of degrees"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "bake_sky")
+            .insert("label", "Bake Sky")
+            .insert("type", "boolean")
+            .insert("use", "optional")
+            .insert("default", "false")
+            .insert("help", "Bake the sky into an importance-sampled table at the beginning of each frame"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "baked_sky_resolution")
+            .insert("label", "Baked Sky Resolution")
+            .insert("type", "numeric")
+            .insert("min_value", "16")
+            .insert("max_value", "4096")
+            .insert("use", "optional")
+            .insert("default", "512")
+            .insert("help", "Horizontal resolution of the baked sky table"));
 }
 
 }   // namespace renderer
@@ -35,6 +35,7 @@
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/texturing/texturecache.h"
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/entity/onframebeginrecorder.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/environmentedf/sphericalcoordinates.h"
 #include "renderer/modeling/input/inputarray.h"
@@ -46,6 +47,7 @@
 #include "renderer/modeling/scene/textureinstance.h"
 #include "renderer/modeling/texture/texture.h"
 #include "renderer/utility/paramarray.h"
+#include "renderer/utility/settingsparsing.h"
 #include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
@@ -54,6 +56,7 @@
 #include "foundation/image/colorspace.h"
 #include "foundation/math/fp.h"
 #include "foundation/math/matrix.h"
+#include "foundation/math/sampling/hierarchicalimageimportancesampler.h"
 #include "foundation/math/sampling/imageimportancesampler.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/transform.h"
@@ -63,16 +66,32 @@
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/makevector.h"
+#include "foundation/utility/searchpaths.h"
+#include "foundation/utility/siphash.h"
+
+// Boost headers.
+#include "boost/cstdint.hpp"
+#include "boost/filesystem/operations.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <fstream>
 #include <memory>
+#include <string>
 
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
@@ -93,6 +112,7 @@ namespace
     //
 
     typedef ImageImportanceSampler<Color3f, float> ImageImportanceSamplerType;
+    typedef HierarchicalImageImportanceSampler<float> HierarchicalImageImportanceSamplerType;
 
     class ImageSampler
     {
@@ -146,6 +166,12 @@ namespace
             }
         }
 
+        void sample(const size_t x, const size_t y, float& importance)
+        {
+            Color3f payload;
+            sample(x, y, payload, importance);
+        }
+
       private:
         TextureCache&   m_texture_cache;
         const Source*   m_radiance_source;
@@ -155,6 +181,106 @@ namespace
         const float     m_rcp_height;
     };
 
+    //
+    // Resample a band of rows of an importance map. Each job has its own texture cache.
+    //
+
+    template <typename ImportanceSampler>
+    class RebuildImportanceMapRowsJob
+      : public IJob
+    {
+      public:
+        RebuildImportanceMapRowsJob(
+            ImportanceSampler&  importance_sampler,
+            TextureStore&       texture_store,
+            const Source*       radiance_source,
+            const Source*       multiplier_source,
+            const Source*       exposure_source,
+            const size_t        width,
+            const size_t        height,
+            const size_t        y_begin,
+            const size_t        y_end,
+            IAbortSwitch*       abort_switch)
+          : m_importance_sampler(importance_sampler)
+          , m_texture_store(texture_store)
+          , m_radiance_source(radiance_source)
+          , m_multiplier_source(multiplier_source)
+          , m_exposure_source(exposure_source)
+          , m_width(width)
+          , m_height(height)
+          , m_y_begin(y_begin)
+          , m_y_end(y_end)
+          , m_abort_switch(abort_switch)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            TextureCache texture_cache(m_texture_store);
+            ImageSampler sampler(
+                texture_cache,
+                m_radiance_source,
+                m_multiplier_source,
+                m_exposure_source,
+                m_width,
+                m_height);
+
+            for (size_t y = m_y_begin; y < m_y_end; ++y)
+            {
+                if (is_aborted(m_abort_switch))
+                    break;
+
+                m_importance_sampler.rebuild_row(y, sampler);
+            }
+        }
+
+      private:
+        ImportanceSampler&      m_importance_sampler;
+        TextureStore&           m_texture_store;
+        const Source*           m_radiance_source;
+        const Source*           m_multiplier_source;
+        const Source*           m_exposure_source;
+        const size_t            m_width;
+        const size_t            m_height;
+        const size_t            m_y_begin;
+        const size_t            m_y_end;
+        IAbortSwitch*           m_abort_switch;
+    };
+
+    uint64 hash_string(const char* s)
+    {
+        return siphash24(s, strlen(s));
+    }
+
+    uint64 hash_strings(const StringDictionary& strings)
+    {
+        uint64 hash = 0;
+
+        for (const_each<StringDictionary> i = strings; i; ++i)
+        {
+            hash = siphash24(hash, hash_string(i->key()));
+            hash = siphash24(hash, hash_string(i->value()));
+        }
+
+        return hash;
+    }
+
+    //
+    // Importance map cache files are stored next to the environment texture file.
+    //
+    // Layout (native byte order):
+    //
+    //   uint32     magic number
+    //   uint32     version
+    //   uint64     key (hash of the texture file and of the parameters that affect the importance map)
+    //   uint64     width
+    //   uint64     height
+    //   float      importance of each texel, in row-major order
+    //
+
+    const uint32 ImportanceMapCacheMagic = 0x4D495341;     // 'ASIM'
+    const uint32 ImportanceMapCacheVersion = 1;
+
     const char* Model = "latlong_map_environment_edf";
 
     class LatLongMapEnvironmentEDF
@@ -175,6 +301,13 @@ namespace
 
             m_phi_shift = deg_to_rad(m_params.get_optional<float>("horizontal_shift", 0.0f));
             m_theta_shift = deg_to_rad(m_params.get_optional<float>("vertical_shift", 0.0f));
+
+            m_use_hierarchical_sampler =
+                m_params.get_optional<string>(
+                    "importance_sampler",
+                    "flat",
+                    make_vector("flat", "hierarchical")) == "hierarchical";
+            m_cache_importance_map = m_params.get_optional<bool>("cache_importance_map", false);
         }
 
         virtual void release() APPLESEED_OVERRIDE
@@ -202,8 +335,8 @@ namespace
             {
                 check_non_zero_emission("radiance", "radiance_multiplier");
 
-                if (m_importance_sampler.get() == 0)
-                    build_importance_map(*project.get_scene(), abort_switch);
+                if (!has_importance_map())
+                    build_importance_map(project, recorder.get_rendering_parameters(), abort_switch);
             }
 
             return true;
@@ -217,7 +350,7 @@ namespace
             Spectrum&               value,
             float&                  probability) const APPLESEED_OVERRIDE
         {
-            if (m_importance_sampler.get() == 0)
+            if (!has_importance_map())
             {
                 RENDERER_LOG_WARNING(
                     "cannot sample environment edf \"%s\" because it is not bound to the environment.",
@@ -231,7 +364,9 @@ namespace
             size_t x, y;
             Color3f payload;
             float prob_xy;
-            m_importance_sampler->sample(s, x, y, payload, prob_xy);
+            if (m_importance_sampler.get())
+                m_importance_sampler->sample(s, x, y, payload, prob_xy);
+            else m_hierarchical_importance_sampler->sample(s, x, y, prob_xy);
 
             // Compute the coordinates in [0,1]^2 of the sample.
             const float u = (x + 0.5f) * m_rcp_importance_map_width;
@@ -255,8 +390,10 @@ namespace
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             outgoing = transform.vector_to_parent(local_outgoing);
 
-            // Return the emitted radiance.
-            value = payload;
+            // Return the emitted radiance. The hierarchical sampler does not store it.
+            if (m_importance_sampler.get())
+                value = payload;
+            else lookup_environment_map(input_evaluator, u, v, value);
 
             // Compute the probability density of this direction.
             probability = prob_xy * m_probability_scale / sin_theta;
@@ -297,7 +434,7 @@ namespace
         {
             assert(is_normalized(outgoing));
 
-            if (m_importance_sampler.get() == 0)
+            if (!has_importance_map())
             {
                 RENDERER_LOG_WARNING(
                     "cannot compute pdf for environment edf \"%s\" because it is not bound to the environment.",
@@ -332,7 +469,7 @@ namespace
         {
             assert(is_normalized(outgoing));
 
-            if (m_importance_sampler.get() == 0)
+            if (!has_importance_map())
             {
                 RENDERER_LOG_WARNING(
                     "cannot compute pdf for environment edf \"%s\" because it is not bound to the environment.",
@@ -368,6 +505,8 @@ namespace
 
         float   m_phi_shift;                        // horizontal shift in radians
         float   m_theta_shift;                      // vertical shift in radians
+        bool    m_use_hierarchical_sampler;
+        bool    m_cache_importance_map;
 
         size_t  m_importance_map_width;
         size_t  m_importance_map_height;
@@ -377,8 +516,17 @@ namespace
         float   m_probability_scale;
 
         auto_ptr<ImageImportanceSamplerType> m_importance_sampler;
+        auto_ptr<HierarchicalImageImportanceSamplerType> m_hierarchical_importance_sampler;
 
-        void build_importance_map(const Scene& scene, IAbortSwitch*abort_switch)
+        bool has_importance_map() const
+        {
+            return m_importance_sampler.get() || m_hierarchical_importance_sampler.get();
+        }
+
+        void build_importance_map(
+            const Project&          project,
+            const ParamArray&       rendering_params,
+            IAbortSwitch*           abort_switch)
         {
             const Source* radiance_source = m_inputs.source("radiance");
             assert(radiance_source);
@@ -409,21 +557,68 @@ namespace
             const size_t texel_count = m_importance_map_width * m_importance_map_height;
             m_probability_scale = texel_count / (2.0f * PiSquare<float>());
 
-            TextureStore texture_store(scene);
-            TextureCache texture_cache(texture_store);
-            ImageSampler sampler(
-                texture_cache,
-                radiance_source,
-                m_inputs.source("radiance_multiplier"),
-                m_inputs.source("exposure"),
-                m_importance_map_width,
-                m_importance_map_height);
+            if (m_use_hierarchical_sampler)
+            {
+                auto_ptr<HierarchicalImageImportanceSamplerType> importance_sampler(
+                    new HierarchicalImageImportanceSamplerType(
+                        m_importance_map_width,
+                        m_importance_map_height));
 
-            m_importance_sampler.reset(
-                new ImageImportanceSamplerType(
-                    m_importance_map_width,
-                    m_importance_map_height));
+                string cache_filepath;
+                uint64 cache_key;
+                const bool use_cache =
+                    m_cache_importance_map &&
+                    get_importance_map_cache_key(project, cache_filepath, cache_key);
+
+                if (use_cache && read_importance_map_cache(cache_filepath, cache_key, *importance_sampler))
+                {
+                    importance_sampler->rebuild_levels();
+                    m_hierarchical_importance_sampler = importance_sampler;
+                    return;
+                }
+
+                rebuild_importance_map_rows(project, rendering_params, *importance_sampler, abort_switch);
+
+                if (is_aborted(abort_switch))
+                    return;
+
+                importance_sampler->rebuild_levels();
+
+                if (use_cache)
+                    write_importance_map_cache(cache_filepath, cache_key, *importance_sampler);
+
+                m_hierarchical_importance_sampler = importance_sampler;
+            }
+            else
+            {
+                auto_ptr<ImageImportanceSamplerType> importance_sampler(
+                    new ImageImportanceSamplerType(
+                        m_importance_map_width,
+                        m_importance_map_height));
+
+                rebuild_importance_map_rows(project, rendering_params, *importance_sampler, abort_switch);
+
+                if (is_aborted(abort_switch))
+                    return;
+
+                importance_sampler->rebuild_rows_table();
+
+                m_importance_sampler = importance_sampler;
+            }
 
+            RENDERER_LOG_INFO(
+                "built importance map for environment edf \"%s\".",
+                get_path().c_str());
+        }
+
+        // Resample the environment into an importance map using the rendering threads.
+        template <typename ImportanceSampler>
+        void rebuild_importance_map_rows(
+            const Project&          project,
+            const ParamArray&       rendering_params,
+            ImportanceSampler&      importance_sampler,
+            IAbortSwitch*           abort_switch) const
+        {
             RENDERER_LOG_INFO(
                 "building " FMT_SIZE_T "x" FMT_SIZE_T " importance map "
                 "for environment edf \"%s\"...",
@@ -431,15 +626,175 @@ namespace
                 m_importance_map_height,
                 get_path().c_str());
 
-            m_importance_sampler->rebuild(sampler, abort_switch);
+            const size_t RowsPerJob = 16;
 
-            if (is_aborted(abort_switch))
-                m_importance_sampler.reset();
-            else
+            TextureStore texture_store(*project.get_scene());
+            JobQueue job_queue;
+            size_t job_count = 0;
+
+            for (size_t y = 0; y < m_importance_map_height; y += RowsPerJob)
             {
-                RENDERER_LOG_INFO(
-                    "built importance map for environment edf \"%s\".",
+                job_queue.schedule(
+                    new RebuildImportanceMapRowsJob<ImportanceSampler>(
+                        importance_sampler,
+                        texture_store,
+                        m_inputs.source("radiance"),
+                        m_inputs.source("radiance_multiplier"),
+                        m_inputs.source("exposure"),
+                        m_importance_map_width,
+                        m_importance_map_height,
+                        y,
+                        min(y + RowsPerJob, m_importance_map_height),
+                        abort_switch));
+                ++job_count;
+            }
+
+            JobManager job_manager(
+                global_logger(),
+                job_queue,
+                min(get_rendering_thread_count(rendering_params), job_count));
+
+            job_manager.start();
+            job_queue.wait_until_completion();
+        }
+
+        // Compute the path of the importance map cache file and the key that identifies
+        // its content. Return false if the importance map cannot be cached.
+        bool get_importance_map_cache_key(
+            const Project&          project,
+            string&                 filepath,
+            uint64&                 key) const
+        {
+            const TextureSource* texture_source =
+                dynamic_cast<const TextureSource*>(m_inputs.source("radiance"));
+            if (texture_source == 0)
+                return false;
+
+            if (dynamic_cast<const TextureSource*>(m_inputs.source("radiance_multiplier")) ||
+                dynamic_cast<const TextureSource*>(m_inputs.source("exposure")))
+            {
+                RENDERER_LOG_WARNING(
+                    "not caching importance map for environment edf \"%s\" since its radiance "
+                    "multiplier or its exposure is textured.",
                     get_path().c_str());
+                return false;
+            }
+
+            const TextureInstance& texture_instance = texture_source->get_texture_instance();
+            const Texture& texture = texture_instance.get_texture();
+
+            const string filename = texture.get_parameters().get_optional<string>("filename", "");
+            if (filename.empty())
+                return false;
+
+            const string texture_filepath = project.search_paths().qualify(filename);
+            filepath = texture_filepath + ".importance";
+
+            // Identify the texture file by its path, its size and its modification time
+            // rather than by its content, to avoid reading the whole file at every render.
+            try
+            {
+                const boost::uintmax_t size = bf::file_size(texture_filepath);
+                const time_t mtime = bf::last_write_time(texture_filepath);
+                key = hash_string(texture_filepath.c_str());
+                key = siphash24(key, static_cast<uint64>(size));
+                key = siphash24(key, static_cast<uint64>(mtime));
+            }
+            catch (const exception& e)
+            {
+                RENDERER_LOG_WARNING(
+                    "not caching importance map for environment edf \"%s\" (%s).",
+                    get_path().c_str(),
+                    e.what());
+                return false;
+            }
+
+            key = siphash24(key, hash_strings(texture.get_parameters().strings()));
+            key = siphash24(key, hash_strings(texture_instance.get_parameters().strings()));
+            key = siphash24(key, siphash24(texture_instance.get_transform().get_local_to_parent()));
+            key = siphash24(key, hash_string(m_params.get_optional<string>("radiance_multiplier", "1.0").c_str()));
+            key = siphash24(key, hash_string(m_params.get_optional<string>("exposure", "0.0").c_str()));
+
+            return true;
+        }
+
+        bool read_importance_map_cache(
+            const string&                           filepath,
+            const uint64                            key,
+            HierarchicalImageImportanceSamplerType& importance_sampler) const
+        {
+            ifstream file(filepath.c_str(), ios::in | ios::binary);
+            if (!file.is_open())
+                return false;
+
+            uint32 magic = 0, version = 0;
+            uint64 file_key = 0, width = 0, height = 0;
+            file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+            file.read(reinterpret_cast<char*>(&version), sizeof(version));
+            file.read(reinterpret_cast<char*>(&file_key), sizeof(file_key));
+            file.read(reinterpret_cast<char*>(&width), sizeof(width));
+            file.read(reinterpret_cast<char*>(&height), sizeof(height));
+
+            if (!file ||
+                magic != ImportanceMapCacheMagic ||
+                version != ImportanceMapCacheVersion ||
+                file_key != key ||
+                width != importance_sampler.get_width() ||
+                height != importance_sampler.get_height())
+            {
+                RENDERER_LOG_WARNING(
+                    "ignoring importance map cache file %s since it is out-of-date.",
+                    filepath.c_str());
+                return false;
+            }
+
+            const size_t texel_count = m_importance_map_width * m_importance_map_height;
+            float* importances = importance_sampler.get_importances();
+            file.read(reinterpret_cast<char*>(importances), texel_count * sizeof(float));
+
+            bool valid = !file.fail();
+            for (size_t i = 0; valid && i < texel_count; ++i)
+                valid = FP<float>::is_finite(importances[i]) && importances[i] >= 0.0f;
+
+            if (!valid)
+            {
+                RENDERER_LOG_WARNING(
+                    "ignoring importance map cache file %s since it is corrupted.",
+                    filepath.c_str());
+                return false;
+            }
+
+            RENDERER_LOG_INFO(
+                "read importance map for environment edf \"%s\" from %s.",
+                get_path().c_str(),
+                filepath.c_str());
+
+            return true;
+        }
+
+        void write_importance_map_cache(
+            const string&                                   filepath,
+            const uint64                                    key,
+            const HierarchicalImageImportanceSamplerType&   importance_sampler) const
+        {
+            ofstream file(filepath.c_str(), ios::out | ios::binary | ios::trunc);
+
+            const uint64 width = importance_sampler.get_width();
+            const uint64 height = importance_sampler.get_height();
+            file.write(reinterpret_cast<const char*>(&ImportanceMapCacheMagic), sizeof(ImportanceMapCacheMagic));
+            file.write(reinterpret_cast<const char*>(&ImportanceMapCacheVersion), sizeof(ImportanceMapCacheVersion));
+            file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+            file.write(reinterpret_cast<const char*>(&width), sizeof(width));
+            file.write(reinterpret_cast<const char*>(&height), sizeof(height));
+            file.write(
+                reinterpret_cast<const char*>(importance_sampler.get_importances()),
+                width * height * sizeof(float));
+
+            if (!file)
+            {
+                RENDERER_LOG_WARNING(
+                    "failed to write importance map cache file %s.",
+                    filepath.c_str());
             }
         }
 
@@ -470,12 +825,15 @@ namespace
         {
             assert(u >= 0.0f && u < 1.0f);
             assert(v >= 0.0f && v < 1.0f);
-            assert(m_importance_sampler.get());
+            assert(has_importance_map());
 
             // Compute the probability density of this sample in the importance map.
             const size_t x = truncate<size_t>(m_importance_map_width * u);
             const size_t y = truncate<size_t>(m_importance_map_height * v);
-            const float prob_xy = m_importance_sampler->get_pdf(x, y);
+            const float prob_xy =
+                m_importance_sampler.get()
+                    ? m_importance_sampler->get_pdf(x, y)
+                    : m_hierarchical_importance_sampler->get_pdf(x, y);
 
             // Compute the probability density of the emission direction.
             return prob_xy * m_probability_scale / sin(theta);
@@ -562,6 +920,28 @@ DictionaryArray LatLongMapEnvironmentEDFFactory::get_input_metadata() const
             .insert("use", "optional")
             .insert("help", "Environment texture vertical shift in degrees"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "importance_sampler")
+            .insert("label", "Importance Sampler")
+            .insert("type", "enumeration")
+            .insert("items",
+                Dictionary()
+                    .insert("Flat", "flat")
+                    .insert("Hierarchical", "hierarchical"))
+            .insert("use", "optional")
+            .insert("default", "flat")
+            .insert("help", "Flat: stores the radiance of each texel; Hierarchical: uses less memory for large environment textures"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "cache_importance_map")
+            .insert("label", "Cache Importance Map")
+            .insert("type", "boolean")
+            .insert("use", "optional")
+            .insert("default", "false")
+            .insert("help", "Store the hierarchical importance map next to the environment texture and reuse it in later renders"));
+
     return metadata;
 }
 
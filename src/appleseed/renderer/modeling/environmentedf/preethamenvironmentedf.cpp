@@ -32,11 +32,18 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/environment/environment.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
+#include "renderer/modeling/environmentedf/skytable.h"
 #include "renderer/modeling/environmentedf/sphericalcoordinates.h"
 #include "renderer/modeling/input/inputarray.h"
 #include "renderer/modeling/input/inputevaluator.h"
 #include "renderer/modeling/input/source.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
 #include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
@@ -52,15 +59,14 @@
 #include "foundation/platform/compiler.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/job/iabortswitch.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
-
-// Forward declarations.
-namespace foundation    { class IAbortSwitch; }
-namespace renderer      { class InputEvaluator; }
-namespace renderer      { class Project; }
+#include <cstddef>
+#include <memory>
 
 using namespace foundation;
 using namespace std;
@@ -104,6 +110,9 @@ namespace
             m_inputs.declare("luminance_gamma", InputFormatFloat, "1.0");
             m_inputs.declare("saturation_multiplier", InputFormatFloat, "1.0");
             m_inputs.declare("horizon_shift", InputFormatFloat, "0.0");
+
+            m_bake_sky = m_params.get_optional<bool>("bake_sky", false);
+            m_baked_sky_resolution = max(m_params.get_optional<size_t>("baked_sky_resolution", 512), size_t(2));
         }
 
         virtual void release() APPLESEED_OVERRIDE
@@ -153,6 +162,15 @@ namespace
                 m_uniform_Y_zenith = compute_zenith_Y(static_cast<float>(m_uniform_values.m_turbidity), m_sun_theta);
             }
 
+            // The environment EDF transform is always evaluated at time 0.
+            m_transform = m_transform_sequence.evaluate(0.0f);
+
+            // Bake the sky into a table if requested and if this environment EDF is the active one.
+            m_sky_table.reset();
+            const Environment* environment = project.get_scene()->get_environment();
+            if (m_bake_sky && environment->get_uncached_environment_edf() == this)
+                bake_sky_table(*project.get_scene(), abort_switch);
+
             return true;
         }
 
@@ -164,12 +182,18 @@ namespace
             Spectrum&               value,
             float&                  probability) const APPLESEED_OVERRIDE
         {
+            if (m_sky_table.get())
+            {
+                Vector3f local_outgoing;
+                m_sky_table->sample(s, local_outgoing, value, probability);
+                outgoing = m_transform.vector_to_parent(local_outgoing);
+                return;
+            }
+
             const Vector3f local_outgoing = sample_hemisphere_cosine(s);
             probability = local_outgoing.y * RcpPi<float>();
 
-            Transformd scratch;
-            const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
-            outgoing = transform.vector_to_parent(local_outgoing);
+            outgoing = m_transform.vector_to_parent(local_outgoing);
 
             const Vector3f shifted_outgoing = shift(local_outgoing);
             if (shifted_outgoing.y > 0.0f)
@@ -185,9 +209,13 @@ namespace
         {
             assert(is_normalized(outgoing));
 
-            Transformd scratch;
-            const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
-            const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+            const Vector3f local_outgoing = m_transform.vector_to_local(outgoing);
+
+            if (m_sky_table.get())
+            {
+                m_sky_table->evaluate(local_outgoing, value);
+                return;
+            }
 
             const Vector3f shifted_outgoing = shift(local_outgoing);
             if (shifted_outgoing.y > 0.0f)
@@ -204,9 +232,14 @@ namespace
         {
             assert(is_normalized(outgoing));
 
-            Transformd scratch;
-            const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
-            const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+            const Vector3f local_outgoing = m_transform.vector_to_local(outgoing);
+
+            if (m_sky_table.get())
+            {
+                m_sky_table->evaluate(local_outgoing, value);
+                probability = m_sky_table->evaluate_pdf(local_outgoing);
+                return;
+            }
 
             const Vector3f shifted_outgoing = shift(local_outgoing);
             if (shifted_outgoing.y > 0.0f)
@@ -222,9 +255,10 @@ namespace
         {
             assert(is_normalized(outgoing));
 
-            Transformd scratch;
-            const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
-            const Transformd::MatrixType& parent_to_local = transform.get_parent_to_local();
+            if (m_sky_table.get())
+                return m_sky_table->evaluate_pdf(m_transform.vector_to_local(outgoing));
+
+            const Transformd::MatrixType& parent_to_local = m_transform.get_parent_to_local();
             const float local_outgoing_y =
                 static_cast<float>(parent_to_local[ 4]) * outgoing.x +
                 static_cast<float>(parent_to_local[ 5]) * outgoing.y +
@@ -248,7 +282,12 @@ namespace
 
         const LightingConditions    m_lighting_conditions;
 
+        bool                        m_bake_sky;
+        size_t                      m_baked_sky_resolution;
+
         InputValues                 m_uniform_values;
+        Transformd                  m_transform;
+        auto_ptr<SkyTable>          m_sky_table;
 
         float                       m_sun_theta;    // sun zenith angle in radians, 0=zenith
         float                       m_sun_phi;      // radians
@@ -373,6 +412,31 @@ namespace
                 return;
             }
 
+            // Compute the sky chromaticity and luminance.
+            float ciex, ciey, luminance;
+            compute_sky_color(input_evaluator, outgoing, ciex, ciey, luminance);
+
+            // Convert the chromaticity to a spectrum.
+            RegularSpectrum31f spectrum;
+            daylight_ciexy_to_spectrum(ciex, ciey, spectrum);
+            value = spectrum;
+
+            // Compute the final sky radiance.
+            value *=
+                  luminance                                         // start with computed luminance
+                / sum_value(value * Spectrum(XYZCMFCIE19312Deg[1])) // normalize to unit luminance
+                * (1.0f / 683.0f)                                   // convert lumens to Watts
+                * RcpPi<float>();                                   // convert irradiance to radiance
+        }
+
+        // Compute the CIE xy chromaticity and the luminance of the sky along a given direction.
+        void compute_sky_color(
+            InputEvaluator&         input_evaluator,
+            const Vector3f&         outgoing,
+            float&                  ciex,
+            float&                  ciey,
+            float&                  luminance) const
+        {
             const float rcp_cos_theta = 1.0f / outgoing.y;
             const float cos_gamma = clamp(dot(outgoing, m_sun_dir), -1.0f, 1.0f);
             const float gamma = acos(cos_gamma);
@@ -434,22 +498,48 @@ namespace
             }
 
             // Split sky color into luminance and chromaticity.
-            float luminance = xyY[2];
-            RegularSpectrum31f spectrum;
-            daylight_ciexy_to_spectrum(xyY[0], xyY[1], spectrum);
-            value = spectrum;
+            ciex = xyY[0];
+            ciey = xyY[1];
+            luminance = xyY[2];
 
             // Apply luminance gamma and multiplier.
             if (m_uniform_values.m_luminance_gamma != 1.0f)
                 luminance = fast_pow(luminance, static_cast<float>(m_uniform_values.m_luminance_gamma));
             luminance *= static_cast<float>(m_uniform_values.m_luminance_multiplier);
+        }
 
-            // Compute the final sky radiance.
-            value *=
-                  luminance                                         // start with computed luminance
-                / sum_value(value * Spectrum(XYZCMFCIE19312Deg[1])) // normalize to unit luminance
-                * (1.0f / 683.0f)                                   // convert lumens to Watts
-                * RcpPi<float>();                                   // convert irradiance to radiance
+        // Bake the sky into a latitude-longitude table.
+        void bake_sky_table(const Scene& scene, IAbortSwitch* abort_switch)
+        {
+            auto_ptr<SkyTable> sky_table(
+                new SkyTable(m_baked_sky_resolution, m_baked_sky_resolution / 2));
+
+            if (m_uniform_values.m_luminance_multiplier != 0.0f)
+            {
+                TextureStore texture_store(scene);
+                TextureCache texture_cache(texture_store);
+                InputEvaluator input_evaluator(texture_cache);
+
+                for (size_t y = 0; y < sky_table->get_height(); ++y)
+                {
+                    if (is_aborted(abort_switch))
+                        return;
+
+                    for (size_t x = 0; x < sky_table->get_width(); ++x)
+                    {
+                        const Vector3f shifted_outgoing = shift(sky_table->get_texel_direction(x, y));
+                        if (shifted_outgoing.y > 0.0f)
+                        {
+                            float ciex, ciey, luminance;
+                            compute_sky_color(input_evaluator, shifted_outgoing, ciex, ciey, luminance);
+                            sky_table->set_texel(x, y, ciex, ciey, luminance);
+                        }
+                    }
+                }
+            }
+
+            sky_table->prepare();
+            m_sky_table = sky_table;
         }
 
         Vector3f shift(Vector3f v) const
@@ -0,0 +1,250 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "skytable.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/environmentedf/sphericalcoordinates.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/colorspace.h"
+#include "foundation/image/regularspectrum.h"
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SkyTable class implementation.
+//
+
+// Importance of a texel: its luminance weighted by the solid angle it subtends.
+class SkyTable::TexelSampler
+{
+  public:
+    explicit TexelSampler(const SkyTable& table)
+      : m_table(table)
+    {
+    }
+
+    void sample(const size_t x, const size_t y, Color3f& payload, float& importance) const
+    {
+        const size_t index = y * m_table.m_width + x;
+        payload = m_table.m_weights[index];
+        importance = m_table.m_importances[index];
+    }
+
+  private:
+    const SkyTable& m_table;
+};
+
+SkyTable::SkyTable(
+    const size_t    width,
+    const size_t    height)
+  : m_width(width)
+  , m_height(height)
+  , m_rcp_width(1.0f / width)
+  , m_rcp_height(1.0f / height)
+  , m_probability_scale((width * height) / (2.0f * PiSquare<float>()))
+  , m_weights(width * height, Color3f(0.0f))
+  , m_importances(width * height, 0.0f)
+{
+    assert(width > 0);
+    assert(height > 0);
+}
+
+Vector3f SkyTable::get_texel_direction(
+    const size_t    x,
+    const size_t    y) const
+{
+    assert(x < m_width);
+    assert(y < m_height);
+
+    float theta, phi;
+    unit_square_to_angles(
+        (x + 0.5f) * m_rcp_width,
+        (y + 0.5f) * m_rcp_height,
+        theta,
+        phi);
+
+    return Vector3f::make_unit_vector(cos(theta), sin(theta), cos(phi), sin(phi));
+}
+
+void SkyTable::set_texel(
+    const size_t    x,
+    const size_t    y,
+    const float     ciex,
+    const float     ciey,
+    const float     luminance)
+{
+    assert(x < m_width);
+    assert(y < m_height);
+
+    const size_t index = y * m_width + x;
+
+    if (!(luminance > 0.0f))
+    {
+        m_weights[index].set(0.0f);
+        m_importances[index] = 0.0f;
+        return;
+    }
+
+    // Same normalization as the analytic sky models.
+    RegularSpectrum31f spectrum;
+    daylight_ciexy_to_spectrum(ciex, ciey, spectrum);
+    const float scale =
+          luminance                                         // start with computed luminance
+        / sum_value(spectrum * XYZCMFCIE19312Deg[1])        // normalize to unit luminance
+        * (1.0f / 683.0f)                                   // convert lumens to Watts
+        * RcpPi<float>();                                   // convert irradiance to radiance
+
+    float m1, m2;
+    daylight_ciexy_to_basis_weights(ciex, ciey, m1, m2);
+
+    m_weights[index] = Color3f(scale, scale * m1, scale * m2);
+    m_importances[index] = luminance * sin(Pi<float>() * (y + 0.5f) * m_rcp_height);
+}
+
+void SkyTable::prepare()
+{
+    m_importance_sampler.reset(new ImportanceSamplerType(m_width, m_height));
+
+    TexelSampler sampler(*this);
+    m_importance_sampler->rebuild(sampler);
+
+    // Importance values are no longer needed.
+    vector<float>().swap(m_importances);
+}
+
+void SkyTable::evaluate(
+    const Vector3f& outgoing,
+    Spectrum&       value) const
+{
+    assert(is_normalized(outgoing));
+
+    float theta, phi, u, v;
+    unit_vector_to_angles(outgoing, theta, phi);
+    angles_to_unit_square(theta, phi, u, v);
+
+    // Bilinear interpolation, wrapping horizontally and clamping vertically.
+    const float fx = u * m_width - 0.5f;
+    const float fy = clamp(v * m_height - 0.5f, 0.0f, static_cast<float>(m_height - 1));
+    const float floor_fx = floor(fx);
+    const float floor_fy = floor(fy);
+    const float wx = fx - floor_fx;
+    const float wy = fy - floor_fy;
+
+    const int ix = static_cast<int>(floor_fx);
+    const size_t x0 = static_cast<size_t>(ix < 0 ? ix + static_cast<int>(m_width) : ix) % m_width;
+    const size_t x1 = x0 + 1 < m_width ? x0 + 1 : 0;
+    const size_t y0 = static_cast<size_t>(floor_fy);
+    const size_t y1 = min(y0 + 1, m_height - 1);
+
+    const Color3f& c00 = m_weights[y0 * m_width + x0];
+    const Color3f& c10 = m_weights[y0 * m_width + x1];
+    const Color3f& c01 = m_weights[y1 * m_width + x0];
+    const Color3f& c11 = m_weights[y1 * m_width + x1];
+
+    const Color3f weights =
+        (1.0f - wy) * ((1.0f - wx) * c00 + wx * c10) +
+                wy  * ((1.0f - wx) * c01 + wx * c11);
+
+    weights_to_spectrum(weights, value);
+}
+
+void SkyTable::sample(
+    const Vector2f& s,
+    Vector3f&       outgoing,
+    Spectrum&       value,
+    float&          probability) const
+{
+    assert(m_importance_sampler.get());
+
+    // Sample the importance map.
+    size_t x, y;
+    Color3f weights;
+    float prob_xy;
+    m_importance_sampler->sample(s, x, y, weights, prob_xy);
+
+    // Compute the direction through the center of the texel.
+    float theta, phi;
+    unit_square_to_angles(
+        (x + 0.5f) * m_rcp_width,
+        (y + 0.5f) * m_rcp_height,
+        theta,
+        phi);
+
+    const float sin_theta = sin(theta);
+    outgoing = Vector3f::make_unit_vector(cos(theta), sin_theta, cos(phi), sin(phi));
+
+    // Return the radiance at the center of the texel.
+    weights_to_spectrum(weights, value);
+
+    // Compute the probability density of this direction.
+    probability = prob_xy * m_probability_scale / sin_theta;
+}
+
+float SkyTable::evaluate_pdf(const Vector3f& outgoing) const
+{
+    assert(is_normalized(outgoing));
+    assert(m_importance_sampler.get());
+
+    float theta, phi, u, v;
+    unit_vector_to_angles(outgoing, theta, phi);
+    angles_to_unit_square(theta, phi, u, v);
+
+    const size_t x = min(truncate<size_t>(u * m_width), m_width - 1);
+    const size_t y = min(truncate<size_t>(v * m_height), m_height - 1);
+    const float prob_xy = m_importance_sampler->get_pdf(x, y);
+
+    if (prob_xy == 0.0f)
+        return 0.0f;
+
+    return prob_xy * m_probability_scale / sin(theta);
+}
+
+void SkyTable::weights_to_spectrum(
+    const Color3f&  weights,
+    Spectrum&       value)
+{
+    RegularSpectrum31f spectrum = DaylightS0 * weights[0];
+    spectrum += DaylightS1 * weights[1];
+    spectrum += DaylightS2 * weights[2];
+    value = spectrum;
+}
+
+}   // namespace renderer
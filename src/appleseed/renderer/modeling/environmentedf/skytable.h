@@ -0,0 +1,143 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_MODELING_ENVIRONMENTEDF_SKYTABLE_H
+#define APPLESEED_RENDERER_MODELING_ENVIRONMENTEDF_SKYTABLE_H
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/color.h"
+#include "foundation/math/sampling/imageimportancesampler.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A latitude-longitude table of sky radiance values, baked once per frame by the
+// analytic sky models so that lookups and importance sampling are cheap.
+//
+// The table covers the whole sphere of directions, in the local space of the
+// environment EDF, with the parameterization of sphericalcoordinates.h. Each texel
+// holds the weights of the three daylight basis spectra: since daylight spectra are
+// linear combinations of these, bilinear interpolation of the weights is exactly
+// bilinear interpolation of the spectra.
+//
+
+class SkyTable
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. All texels are initially black.
+    SkyTable(
+        const size_t                width,
+        const size_t                height);
+
+    // Return the dimensions of the table.
+    size_t get_width() const;
+    size_t get_height() const;
+
+    // Return the direction at the center of a given texel.
+    foundation::Vector3f get_texel_direction(
+        const size_t                x,
+        const size_t                y) const;
+
+    // Set the radiance of a given texel from the CIE xy chromaticity of a daylight
+    // illuminant and a luminance in cd.m^-2.
+    void set_texel(
+        const size_t                x,
+        const size_t                y,
+        const float                 ciex,
+        const float                 ciey,
+        const float                 luminance);
+
+    // Build the importance map. Must be called once all texels are set.
+    void prepare();
+
+    // Evaluate the radiance along a given direction.
+    void evaluate(
+        const foundation::Vector3f& outgoing,
+        Spectrum&                   value) const;
+
+    // Sample a direction proportionally to radiance and return the radiance along
+    // this direction and the probability density with respect to solid angle.
+    void sample(
+        const foundation::Vector2f& s,
+        foundation::Vector3f&       outgoing,
+        Spectrum&                   value,
+        float&                      probability) const;
+
+    // Return the probability density with respect to solid angle of a given direction.
+    float evaluate_pdf(const foundation::Vector3f& outgoing) const;
+
+  private:
+    typedef foundation::ImageImportanceSampler<foundation::Color3f, float> ImportanceSamplerType;
+
+    class TexelSampler;
+
+    const size_t                            m_width;
+    const size_t                            m_height;
+    const float                             m_rcp_width;
+    const float                             m_rcp_height;
+    const float                             m_probability_scale;
+
+    std::vector<foundation::Color3f>        m_weights;
+    std::vector<float>                      m_importances;
+    std::auto_ptr<ImportanceSamplerType>    m_importance_sampler;
+
+    static void weights_to_spectrum(
+        const foundation::Color3f&  weights,
+        Spectrum&                   value);
+};
+
+
+//
+// SkyTable class implementation.
+//
+
+inline size_t SkyTable::get_width() const
+{
+    return m_width;
+}
+
+inline size_t SkyTable::get_height() const
+{
+    return m_height;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_MODELING_ENVIRONMENTEDF_SKYTABLE_H
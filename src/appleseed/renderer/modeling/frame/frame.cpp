@@ -39,7 +39,9 @@
 #include "foundation/core/exceptions/exception.h"
 #include "foundation/core/exceptions/exceptionioerror.h"
 #include "foundation/core/exceptions/exceptionunsupportedfileformat.h"
+#include "foundation/image/canvasproperties.h"
 #include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
 #include "foundation/image/exceptionunsupportedimageformat.h"
 #include "foundation/image/exrimagefilewriter.h"
 #include "foundation/image/genericimagefilewriter.h"
@@ -56,14 +58,17 @@
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/iostreamop.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/otherwise.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
 // Boost headers.
 #include "boost/filesystem/path.hpp"
+#include "boost/scoped_array.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <string>
@@ -255,93 +260,41 @@ size_t Frame::get_pixel_count() const
 
 namespace
 {
+#ifdef APPLESEED_USE_SSE
+
     template <
         int  ColorSpace,
         bool Clamp,
         bool GammaCorrect
     >
-    void transform_generic_tile(Tile& tile, const float rcp_target_gamma)
+    void transform_float_tile(Tile& tile, const float rcp_target_gamma)
     {
         assert(tile.get_channel_count() == 4);
 
-        const size_t pixel_count = tile.get_pixel_count();
+        float* pixel_ptr = reinterpret_cast<float*>(tile.pixel(0));
+        float* pixel_end = pixel_ptr + tile.get_pixel_count() * 4;
 
-        for (size_t i = 0; i < pixel_count; ++i)
+        for (; pixel_ptr < pixel_end; pixel_ptr += 4)
         {
             // Load the pixel color.
-#ifdef APPLESEED_USE_SSE
-            APPLESEED_SIMD4_ALIGN Color4f color;
-#else
-            Color4f color;
-#endif
-            tile.get_pixel(i, color);
+            __m128 color = _mm_load_ps(pixel_ptr);
+            __m128 original_color = color;
 
             // Apply color space conversion.
             switch (ColorSpace)
             {
               case ColorSpaceSRGB:
-#ifdef APPLESEED_USE_SSE
-                {
-                    const float old_alpha = color[3];
-                    _mm_store_ps(&color[0], fast_linear_rgb_to_srgb(_mm_load_ps(&color[0])));
-                    color[3] = old_alpha;
-                }
-#else
-                color.rgb() = fast_linear_rgb_to_srgb(color.rgb());
-#endif
+                color = fast_linear_rgb_to_srgb(color);
                 break;
 
               case ColorSpaceCIEXYZ:
-                color.rgb() = linear_rgb_to_ciexyz(color.rgb());
+                color = linear_rgb_to_ciexyz(color);
                 break;
 
               default:
                 break;
             }
 
-            // Apply clamping.
-            // todo: mark clamped pixels in the diagnostic map.
-            if (Clamp)
-                color = saturate(color);
-
-            // Apply gamma correction.
-            if (GammaCorrect)
-            {
-                const float old_alpha = color[3];
-                fast_pow(&color[0], rcp_target_gamma);
-                color[3] = old_alpha;
-            }
-
-            // Store the pixel color.
-            tile.set_pixel(i, color);
-        }
-    }
-
-#ifdef APPLESEED_USE_SSE
-
-    template <
-        int  ColorSpace,
-        bool Clamp,
-        bool GammaCorrect
-    >
-    void transform_float_tile(Tile& tile, const float rcp_target_gamma)
-    {
-        assert(ColorSpace == ColorSpaceLinearRGB || ColorSpace == ColorSpaceSRGB);
-        assert(tile.get_channel_count() == 4);
-
-        float* pixel_ptr = reinterpret_cast<float*>(tile.pixel(0));
-        float* pixel_end = pixel_ptr + tile.get_pixel_count() * 4;
-
-        for (; pixel_ptr < pixel_end; pixel_ptr += 4)
-        {
-            // Load the pixel color.
-            __m128 color = _mm_load_ps(pixel_ptr);
-            __m128 original_color = color;
-
-            // Apply color space conversion.
-            if (ColorSpace == ColorSpaceSRGB)
-                color = fast_linear_rgb_to_srgb(color);
-
             // Apply clamping.
             // todo: mark clamped pixels in the diagnostic map.
             if (Clamp)
@@ -365,7 +318,6 @@ namespace
     >
     void transform_float_tile(Tile& tile, const float rcp_target_gamma)
     {
-        assert(ColorSpace == ColorSpaceLinearRGB || ColorSpace == ColorSpaceSRGB);
         assert(tile.get_channel_count() == 4);
 
         Color4f* pixel_ptr = reinterpret_cast<Color4f*>(tile.pixel(0));
@@ -377,8 +329,19 @@ namespace
             Color4f color(*pixel_ptr);
 
             // Apply color space conversion.
-            if (ColorSpace == ColorSpaceSRGB)
+            switch (ColorSpace)
+            {
+              case ColorSpaceSRGB:
                 color.rgb() = fast_linear_rgb_to_srgb(color.rgb());
+                break;
+
+              case ColorSpaceCIEXYZ:
+                color.rgb() = linear_rgb_to_ciexyz(color.rgb());
+                break;
+
+              default:
+                break;
+            }
 
             // Apply clamping.
             // todo: mark clamped pixels in the diagnostic map.
@@ -403,19 +366,15 @@ namespace
 
 void Frame::transform_to_output_color_space(Tile& tile) const
 {
-    #define TRANSFORM_GENERIC_TILE(ColorSpace)                                                      \
-        if (impl->m_clamp)                                                                          \
-        {                                                                                           \
-            if (impl->m_target_gamma != 1.0f)                                                       \
-                transform_generic_tile<ColorSpace, true, true>(tile, impl->m_rcp_target_gamma);     \
-            else transform_generic_tile<ColorSpace, true, false>(tile, impl->m_rcp_target_gamma);   \
-        }                                                                                           \
-        else                                                                                        \
-        {                                                                                           \
-            if (impl->m_target_gamma != 1.0f)                                                       \
-                transform_generic_tile<ColorSpace, false, true>(tile, impl->m_rcp_target_gamma);    \
-            else transform_generic_tile<ColorSpace, false, false>(tile, impl->m_rcp_target_gamma);  \
-        }
+    if (tile.get_pixel_format() != PixelFormatFloat)
+    {
+        // Transform a floating-point copy of the tile so that the vectorized code path
+        // is used for all pixel formats, then convert it back in a single pass.
+        Tile float_tile(tile, PixelFormatFloat);
+        transform_to_output_color_space(float_tile);
+        tile.copy(float_tile);
+        return;
+    }
 
     #define TRANSFORM_FLOAT_TILE(ColorSpace)                                                        \
         if (impl->m_clamp)                                                                          \
@@ -431,71 +390,192 @@ void Frame::transform_to_output_color_space(Tile& tile) const
             else transform_float_tile<ColorSpace, false, false>(tile, impl->m_rcp_target_gamma);    \
         }
 
-    if (tile.get_pixel_format() == PixelFormatFloat)
+    switch (m_color_space)
     {
-        switch (m_color_space)
-        {
-          case ColorSpaceLinearRGB:
-            TRANSFORM_FLOAT_TILE(ColorSpaceLinearRGB);
-            break;
+      case ColorSpaceLinearRGB:
+        TRANSFORM_FLOAT_TILE(ColorSpaceLinearRGB);
+        break;
 
-          case ColorSpaceSRGB:
-            TRANSFORM_FLOAT_TILE(ColorSpaceSRGB);
-            break;
+      case ColorSpaceSRGB:
+        TRANSFORM_FLOAT_TILE(ColorSpaceSRGB);
+        break;
 
-          case ColorSpaceCIEXYZ:
-            TRANSFORM_GENERIC_TILE(ColorSpaceCIEXYZ);
-            break;
+      case ColorSpaceCIEXYZ:
+        TRANSFORM_FLOAT_TILE(ColorSpaceCIEXYZ);
+        break;
 
-          assert_otherwise;
-        }
+      assert_otherwise;
     }
-    else
+
+    #undef TRANSFORM_FLOAT_TILE
+}
+
+namespace
+{
+    //
+    // Transform a row of tiles of an image to the output color space of a frame,
+    // optionally copying the tiles from a source image with the same layout first.
+    //
+
+    class TransformTileRowJob
+      : public IJob
     {
-        switch (m_color_space)
+      public:
+        TransformTileRowJob(
+            const Frame&    frame,
+            const Image*    source,
+            Image&          image,
+            const size_t    tile_y)
+          : m_frame(frame)
+          , m_source(source)
+          , m_image(image)
+          , m_tile_y(tile_y)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
         {
-          case ColorSpaceLinearRGB:
-            TRANSFORM_GENERIC_TILE(ColorSpaceLinearRGB);
-            break;
+            const size_t tile_count_x = m_image.properties().m_tile_count_x;
 
-          case ColorSpaceSRGB:
-            TRANSFORM_GENERIC_TILE(ColorSpaceSRGB);
-            break;
+            for (size_t tx = 0; tx < tile_count_x; ++tx)
+            {
+                Tile& tile = m_image.tile(tx, m_tile_y);
 
-          case ColorSpaceCIEXYZ:
-            TRANSFORM_GENERIC_TILE(ColorSpaceCIEXYZ);
-            break;
+                if (m_source)
+                    tile.copy(m_source->tile(tx, m_tile_y));
 
-          assert_otherwise;
+                m_frame.transform_to_output_color_space(tile);
+            }
         }
-    }
 
-    #undef TRANSFORM_FLOAT_TILE
-    #undef TRANSFORM_GENERIC_TILE
-}
+      private:
+        const Frame&        m_frame;
+        const Image*        m_source;
+        Image&              m_image;
+        const size_t        m_tile_y;
+    };
+
+    void transform_image(
+        const Frame&        frame,
+        const Image*        source,
+        Image&              image,
+        const size_t        thread_count)
+    {
+        const size_t tile_count_y = image.properties().m_tile_count_y;
 
-void Frame::transform_to_output_color_space(Image& image) const
-{
-    const CanvasProperties& image_props = image.properties();
+        if (thread_count <= 1)
+        {
+            // Don't spawn any thread when we don't have the budget for it.
+            for (size_t ty = 0; ty < tile_count_y; ++ty)
+                TransformTileRowJob(frame, source, image, ty).execute(0);
+            return;
+        }
 
-    for (size_t ty = 0; ty < image_props.m_tile_count_y; ++ty)
-    {
-        for (size_t tx = 0; tx < image_props.m_tile_count_x; ++tx)
-            transform_to_output_color_space(image.tile(tx, ty));
+        JobQueue job_queue;
+
+        for (size_t ty = 0; ty < tile_count_y; ++ty)
+            job_queue.schedule(new TransformTileRowJob(frame, source, image, ty));
+
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            min(thread_count, tile_count_y));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
     }
 }
 
+void Frame::transform_to_output_color_space(
+    Image&              image,
+    const size_t        thread_count) const
+{
+    transform_image(*this, 0, image, thread_count);
+}
+
 void Frame::clear_main_image()
 {
     impl->m_image->clear(Color4f(0.0));
 }
 
-bool Frame::write_main_image(const char* file_path) const
+namespace
+{
+    // Write an image to disk. Return true if successful, false otherwise.
+    bool write_image(
+        const char*             file_path,
+        const Image&            image,
+        const ImageAttributes&  image_attributes)
+    {
+        assert(file_path);
+
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        stopwatch.start();
+
+        try
+        {
+            try
+            {
+                GenericImageFileWriter writer;
+                writer.write(file_path, image, image_attributes);
+            }
+            catch (const ExceptionUnsupportedFileFormat&)
+            {
+                const string extension = lower_case(bf::path(file_path).extension().string());
+
+                RENDERER_LOG_ERROR(
+                    "file format '%s' not supported, writing the image in OpenEXR format "
+                    "(but keeping the filename unmodified).",
+                    extension.c_str());
+
+                EXRImageFileWriter writer;
+                writer.write(file_path, image, image_attributes);
+            }
+        }
+        catch (const ExceptionUnsupportedImageFormat&)
+        {
+            RENDERER_LOG_ERROR(
+                "failed to write image file %s: unsupported image format.",
+                file_path);
+
+            return false;
+        }
+        catch (const ExceptionIOError&)
+        {
+            RENDERER_LOG_ERROR(
+                "failed to write image file %s: i/o error.",
+                file_path);
+
+            return false;
+        }
+        catch (const Exception& e)
+        {
+            RENDERER_LOG_ERROR(
+                "failed to write image file %s: %s.",
+                file_path,
+                e.what());
+
+            return false;
+        }
+
+        stopwatch.measure();
+
+        RENDERER_LOG_INFO(
+            "wrote image file %s in %s.",
+            file_path,
+            pretty_time(stopwatch.get_seconds()).c_str());
+
+        return true;
+    }
+}
+
+bool Frame::write_main_image(
+    const char*         file_path,
+    const size_t        thread_count) const
 {
     assert(file_path);
 
-    Image transformed_image(*impl->m_image);
-    transform_to_output_color_space(transformed_image);
+    Image transformed_image(impl->m_image->properties());
+    transform_image(*this, impl->m_image.get(), transformed_image, thread_count);
 
     const ImageAttributes image_attributes =
         ImageAttributes::create_default_attributes();
@@ -503,7 +583,48 @@ bool Frame::write_main_image(const char* file_path) const
     return write_image(file_path, transformed_image, image_attributes);
 }
 
-bool Frame::write_aov_images(const char* file_path) const
+namespace
+{
+    //
+    // Write an AOV image to disk.
+    //
+
+    class WriteAOVImageJob
+      : public IJob
+    {
+      public:
+        WriteAOVImageJob(
+            const string&           file_path,
+            const Image&            image,
+            const ImageAttributes&  image_attributes,
+            bool&                   result)
+          : m_file_path(file_path)
+          , m_image(image)
+          , m_image_attributes(image_attributes)
+          , m_result(result)
+        {
+        }
+
+        virtual void execute(const size_t thread_index) APPLESEED_OVERRIDE
+        {
+            m_result =
+                write_image(
+                    m_file_path.c_str(),
+                    m_image,
+                    m_image_attributes);
+        }
+
+      private:
+        const string            m_file_path;
+        const Image&            m_image;
+        const ImageAttributes&  m_image_attributes;
+        bool&                   m_result;
+    };
+}
+
+bool Frame::write_aov_images(
+    const char*         file_path,
+    const size_t        thread_count) const
 {
     assert(file_path);
 
@@ -519,7 +640,15 @@ bool Frame::write_aov_images(const char* file_path) const
         const string base_file_name = boost_file_path.stem().string();
         const string extension = boost_file_path.extension().string();
 
-        for (size_t i = 0; i < impl->m_aov_images->size(); ++i)
+        const size_t aov_count = impl->m_aov_images->size();
+
+        // Write AOV images in parallel, one job per image, unless we only have one thread
+        // or one image. Using a plain array of bool since job results are written concurrently.
+        const boost::scoped_array<bool> aov_results(new bool[aov_count]);
+        const bool parallel = thread_count > 1 && aov_count > 1;
+        JobQueue job_queue;
+
+        for (size_t i = 0; i < aov_count; ++i)
         {
             const string aov_name = impl->m_aov_images->get_name(i);
             const string safe_aov_name = make_safe_filename(aov_name);
@@ -527,10 +656,36 @@ bool Frame::write_aov_images(const char* file_path) const
             const string aov_file_path = (directory / aov_file_name).string();
 
             // Note: AOVs are always in the linear color space.
-            if (!write_image(
-                    aov_file_path.c_str(),
+            WriteAOVImageJob* job =
+                new WriteAOVImageJob(
+                    aov_file_path,
                     impl->m_aov_images->get_image(i),
-                    image_attributes))
+                    image_attributes,
+                    aov_results[i]);
+
+            if (parallel)
+                job_queue.schedule(job);
+            else
+            {
+                job->execute(0);
+                delete job;
+            }
+        }
+
+        if (parallel)
+        {
+            JobManager job_manager(
+                global_logger(),
+                job_queue,
+                min(thread_count, aov_count));
+
+            job_manager.start();
+            job_queue.wait_until_completion();
+        }
+
+        for (size_t i = 0; i < aov_count; ++i)
+        {
+            if (!aov_results[i])
                 result = false;
         }
     }
@@ -540,7 +695,8 @@ bool Frame::write_aov_images(const char* file_path) const
 
 bool Frame::archive(
     const char*         directory,
-    char**              output_path) const
+    char**              output_path,
+    const size_t        thread_count) const
 {
     assert(directory);
 
@@ -555,8 +711,8 @@ bool Frame::archive(
     if (output_path)
         *output_path = duplicate_string(file_path.c_str());
 
-    Image transformed_image(*impl->m_image);
-    transform_to_output_color_space(transformed_image);
+    Image transformed_image(impl->m_image->properties());
+    transform_image(*this, impl->m_image.get(), transformed_image, thread_count);
 
     return
         write_image(
@@ -709,72 +865,6 @@ void Frame::extract_parameters()
     impl->m_crop_window = m_params.get_optional<AABB2u>("crop_window", default_crop_window);
 }
 
-bool Frame::write_image(
-    const char*             file_path,
-    const Image&            image,
-    const ImageAttributes&  image_attributes) const
-{
-    assert(file_path);
-
-    Stopwatch<DefaultWallclockTimer> stopwatch;
-    stopwatch.start();
-
-    try
-    {
-        try
-        {
-            GenericImageFileWriter writer;
-            writer.write(file_path, image, image_attributes);
-        }
-        catch (const ExceptionUnsupportedFileFormat&)
-        {
-            const string extension = lower_case(bf::path(file_path).extension().string());
-
-            RENDERER_LOG_ERROR(
-                "file format '%s' not supported, writing the image in OpenEXR format "
-                "(but keeping the filename unmodified).",
-                extension.c_str());
-
-            EXRImageFileWriter writer;
-            writer.write(file_path, image, image_attributes);
-        }
-    }
-    catch (const ExceptionUnsupportedImageFormat&)
-    {
-        RENDERER_LOG_ERROR(
-            "failed to write image file %s: unsupported image format.",
-            file_path);
-
-        return false;
-    }
-    catch (const ExceptionIOError&)
-    {
-        RENDERER_LOG_ERROR(
-            "failed to write image file %s: i/o error.",
-            file_path);
-
-        return false;
-    }
-    catch (const Exception& e)
-    {
-        RENDERER_LOG_ERROR(
-            "failed to write image file %s: %s.",
-            file_path,
-            e.what());
-
-        return false;
-    }
-
-    stopwatch.measure();
-
-    RENDERER_LOG_INFO(
-        "wrote image file %s in %s.",
-        file_path,
-        pretty_time(stopwatch.get_seconds()).c_str());
-
-    return true;
-}
-
 
 //
 // FrameFactory class implementation.
@@ -112,8 +112,12 @@ class APPLESEED_DLLSYMBOL Frame
     size_t get_pixel_count() const;
 
     // Convert a tile or an image from linear RGB to the output color space.
+    // Images are converted using thread_count threads; the default of a single
+    // thread is appropriate while rendering threads are running.
     void transform_to_output_color_space(foundation::Tile& tile) const;
-    void transform_to_output_color_space(foundation::Image& image) const;
+    void transform_to_output_color_space(
+        foundation::Image&  image,
+        const size_t        thread_count = 1) const;
 
     // Return the normalized device coordinates of a given sample.
     foundation::Vector2d get_sample_position(
@@ -135,18 +139,23 @@ class APPLESEED_DLLSYMBOL Frame
     // Clear the main image to transparent black.
     void clear_main_image();
 
-    // Write the main image / the AOV images to disk.
+    // Write the main image / the AOV images to disk, using up to thread_count threads.
     // Return true if successful, false otherwise.
-    bool write_main_image(const char* file_path) const;
-    bool write_aov_images(const char* file_path) const;
-
-    // Archive the frame to a given directory on disk. If output_path is provided,
-    // the full path to the output file will be returned. The returned string must
-    // be freed using foundation::free_string().
+    bool write_main_image(
+        const char*     file_path,
+        const size_t    thread_count = 1) const;
+    bool write_aov_images(
+        const char*     file_path,
+        const size_t    thread_count = 1) const;
+
+    // Archive the frame to a given directory on disk, using up to thread_count threads.
+    // If output_path is provided, the full path to the output file will be returned.
+    // The returned string must be freed using foundation::free_string().
     // Return true if successful, false otherwise.
     bool archive(
         const char*     directory,
-        char**          output_path = 0) const;
+        char**          output_path = 0,
+        const size_t    thread_count = 1) const;
 
   private:
     friend class FrameFactory;
@@ -167,13 +176,6 @@ class APPLESEED_DLLSYMBOL Frame
     ~Frame();
 
     void extract_parameters();
-
-    // Write an image to disk after transformation to the frame's color space.
-    // Return true if successful, false otherwise.
-    bool write_image(
-        const char*                         file_path,
-        const foundation::Image&            image,
-        const foundation::ImageAttributes&  image_attributes) const;
 };
 
 
@@ -36,10 +36,16 @@
 #include "renderer/modeling/texture/texture.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
 #include "foundation/math/hash.h"
 #include "foundation/math/scalar.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
 #include "foundation/platform/types.h"
+#include "foundation/utility/otherwise.h"
 
 // Standard headers.
 #include <cassert>
@@ -136,11 +142,198 @@ namespace
                 static_cast<size_t>(iy));
     }
 
+    //
+    // Texel readers.
+    //
+    // Tiles are kept in the texture store in their native pixel format, and 8-bit
+    // sRGB tiles are kept encoded. Texel readers convert texels to linear RGBA on
+    // the fly; they are selected once per tile lookup so that the conversion code
+    // is specialized for the pixel format of the tile.
+    //
+
+    template <PixelFormat Format>
+    struct LinearTexelReader
+    {
+        static void read(
+            const Tile&             tile,
+            const size_t            pixel_x,
+            const size_t            pixel_y,
+            Color4f&                texel)
+        {
+            Pixel::read_rgba<Format>(
+                tile.pixel(pixel_x, pixel_y),
+                tile.get_channel_count(),
+                &texel[0]);
+        }
+    };
+
+    struct SRGBUInt8TexelReader
+    {
+        static void read(
+            const Tile&             tile,
+            const size_t            pixel_x,
+            const size_t            pixel_y,
+            Color4f&                texel)
+        {
+            const uint8* src = tile.pixel(pixel_x, pixel_y);
+
+            switch (tile.get_channel_count())
+            {
+              case 1:
+                texel[0] = texel[1] = texel[2] = SRGBUInt8ToLinearRGB[src[0]];
+                texel[3] = 1.0f;
+                break;
+
+              case 3:
+                texel[0] = SRGBUInt8ToLinearRGB[src[0]];
+                texel[1] = SRGBUInt8ToLinearRGB[src[1]];
+                texel[2] = SRGBUInt8ToLinearRGB[src[2]];
+                texel[3] = 1.0f;
+                break;
+
+              case 4:
+                texel[0] = SRGBUInt8ToLinearRGB[src[0]];
+                texel[1] = SRGBUInt8ToLinearRGB[src[1]];
+                texel[2] = SRGBUInt8ToLinearRGB[src[2]];
+                texel[3] = PixelFormatTraits<PixelFormatUInt8>::to_float(src[3]);   // alpha is never encoded
+                break;
+
+              assert_otherwise;
+            }
+        }
+    };
+
+    // Read a single texel from a tile.
+    template <typename TexelReader>
+    inline void read_texel(
+        const Tile&                 tile,
+        const size_t                pixel_x,
+        const size_t                pixel_y,
+        Color4f&                    texel)
+    {
+        TexelReader::read(tile, pixel_x, pixel_y, texel);
+    }
+
+    inline void read_texel(
+        const Tile&                 tile,
+        const bool                  srgb_encoded,
+        const size_t                pixel_x,
+        const size_t                pixel_y,
+        Color4f&                    texel)
+    {
+        switch (tile.get_pixel_format())
+        {
+          case PixelFormatUInt8:
+            if (srgb_encoded)
+                read_texel<SRGBUInt8TexelReader>(tile, pixel_x, pixel_y, texel);
+            else read_texel<LinearTexelReader<PixelFormatUInt8> >(tile, pixel_x, pixel_y, texel);
+            break;
+
+          case PixelFormatUInt16:
+            read_texel<LinearTexelReader<PixelFormatUInt16> >(tile, pixel_x, pixel_y, texel);
+            break;
+
+          case PixelFormatUInt32:
+            read_texel<LinearTexelReader<PixelFormatUInt32> >(tile, pixel_x, pixel_y, texel);
+            break;
+
+          case PixelFormatHalf:
+            read_texel<LinearTexelReader<PixelFormatHalf> >(tile, pixel_x, pixel_y, texel);
+            break;
+
+          case PixelFormatFloat:
+            read_texel<LinearTexelReader<PixelFormatFloat> >(tile, pixel_x, pixel_y, texel);
+            break;
+
+          case PixelFormatDouble:
+            read_texel<LinearTexelReader<PixelFormatDouble> >(tile, pixel_x, pixel_y, texel);
+            break;
+
+          assert_otherwise;
+        }
+    }
+
+    // Read a 2x2 block of texels from a single tile.
+    template <typename TexelReader>
+    inline void read_texels_2x2(
+        const Tile&                 tile,
+        const size_t                pixel_x_00,
+        const size_t                pixel_y_00,
+        const size_t                pixel_x_11,
+        const size_t                pixel_y_11,
+        Color4f&                    t00,
+        Color4f&                    t10,
+        Color4f&                    t01,
+        Color4f&                    t11)
+    {
+        TexelReader::read(tile, pixel_x_00, pixel_y_00, t00);
+        TexelReader::read(tile, pixel_x_11, pixel_y_00, t10);
+        TexelReader::read(tile, pixel_x_00, pixel_y_11, t01);
+        TexelReader::read(tile, pixel_x_11, pixel_y_11, t11);
+    }
+
+    inline void read_texels_2x2(
+        const Tile&                 tile,
+        const bool                  srgb_encoded,
+        const size_t                pixel_x_00,
+        const size_t                pixel_y_00,
+        const size_t                pixel_x_11,
+        const size_t                pixel_y_11,
+        Color4f&                    t00,
+        Color4f&                    t10,
+        Color4f&                    t01,
+        Color4f&                    t11)
+    {
+        switch (tile.get_pixel_format())
+        {
+          case PixelFormatUInt8:
+            if (srgb_encoded)
+            {
+                read_texels_2x2<SRGBUInt8TexelReader>(
+                    tile, pixel_x_00, pixel_y_00, pixel_x_11, pixel_y_11, t00, t10, t01, t11);
+            }
+            else
+            {
+                read_texels_2x2<LinearTexelReader<PixelFormatUInt8> >(
+                    tile, pixel_x_00, pixel_y_00, pixel_x_11, pixel_y_11, t00, t10, t01, t11);
+            }
+            break;
+
+          case PixelFormatUInt16:
+            read_texels_2x2<LinearTexelReader<PixelFormatUInt16> >(
+                tile, pixel_x_00, pixel_y_00, pixel_x_11, pixel_y_11, t00, t10, t01, t11);
+            break;
+
+          case PixelFormatUInt32:
+            read_texels_2x2<LinearTexelReader<PixelFormatUInt32> >(
+                tile, pixel_x_00, pixel_y_00, pixel_x_11, pixel_y_11, t00, t10, t01, t11);
+            break;
+
+          case PixelFormatHalf:
+            read_texels_2x2<LinearTexelReader<PixelFormatHalf> >(
+                tile, pixel_x_00, pixel_y_00, pixel_x_11, pixel_y_11, t00, t10, t01, t11);
+            break;
+
+          case PixelFormatFloat:
+            read_texels_2x2<LinearTexelReader<PixelFormatFloat> >(
+                tile, pixel_x_00, pixel_y_00, pixel_x_11, pixel_y_11, t00, t10, t01, t11);
+            break;
+
+          case PixelFormatDouble:
+            read_texels_2x2<LinearTexelReader<PixelFormatDouble> >(
+                tile, pixel_x_00, pixel_y_00, pixel_x_11, pixel_y_11, t00, t10, t01, t11);
+            break;
+
+          assert_otherwise;
+        }
+    }
+
     // Utility function to sample a tile.
     inline void sample_tile(
         TextureCache&               texture_cache,
         const UniqueID              assembly_uid,
         const UniqueID              texture_uid,
+        const bool                  srgb_encoded,
         const size_t                tile_x,
         const size_t                tile_y,
         const size_t                pixel_x,
@@ -156,16 +349,7 @@ namespace
                 tile_y);
 
         // Sample the tile.
-        if (tile.get_channel_count() == 3)
-        {
-            Color3f rgb;
-            tile.get_pixel(pixel_x, pixel_y, rgb);
-            sample[0] = rgb[0];
-            sample[1] = rgb[1];
-            sample[2] = rgb[2];
-            sample[3] = 1.0f;
-        }
-        else tile.get_pixel(pixel_x, pixel_y, sample);
+        read_texel(tile, srgb_encoded, pixel_x, pixel_y, sample);
     }
 }
 
@@ -182,6 +366,7 @@ TextureSource::TextureSource(
   , m_scalar_canvas_height(static_cast<float>(m_texture_props.m_canvas_height))
   , m_max_x(static_cast<float>(m_texture_props.m_canvas_width - 1))
   , m_max_y(static_cast<float>(m_texture_props.m_canvas_height - 1))
+  , m_srgb_encoded(texture_instance.get_texture().get_color_space() == ColorSpaceSRGB)
 {
 }
 
@@ -240,6 +425,7 @@ Color4f TextureSource::get_texel(
         texture_cache,
         m_assembly_uid,
         m_texture_uid,
+        m_srgb_encoded,
         tile_x,
         tile_y,
         pixel_x,
@@ -296,10 +482,10 @@ void TextureSource::get_texels_2x2(
         const size_t pixel_y_11 = p11.y - tile_y_11 * m_texture_props.m_tile_height;
 
         // Sample the tile.
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_00, tile_y_00, pixel_x_00, pixel_y_00, t00);
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_11, tile_y_00, pixel_x_11, pixel_y_00, t10);
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_00, tile_y_11, pixel_x_00, pixel_y_11, t01);
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_11, tile_y_11, pixel_x_11, pixel_y_11, t11);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, m_srgb_encoded, tile_x_00, tile_y_00, pixel_x_00, pixel_y_00, t00);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, m_srgb_encoded, tile_x_11, tile_y_00, pixel_x_11, pixel_y_00, t10);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, m_srgb_encoded, tile_x_00, tile_y_11, pixel_x_00, pixel_y_11, t01);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, m_srgb_encoded, tile_x_11, tile_y_11, pixel_x_11, pixel_y_11, t11);
     }
     else
     {
@@ -320,41 +506,12 @@ void TextureSource::get_texels_2x2(
                 tile_y_00);
 
         // Sample the tile.
-        if (tile.get_channel_count() == 3)
-        {
-            Color3f rgb;
-
-            tile.get_pixel(pixel_x_00, pixel_y_00, rgb);
-            t00[0] = rgb[0];
-            t00[1] = rgb[1];
-            t00[2] = rgb[2];
-            t00[3] = 1.0f;
-
-            tile.get_pixel(pixel_x_11, pixel_y_00, rgb);
-            t10[0] = rgb[0];
-            t10[1] = rgb[1];
-            t10[2] = rgb[2];
-            t10[3] = 1.0f;
-
-            tile.get_pixel(pixel_x_00, pixel_y_11, rgb);
-            t01[0] = rgb[0];
-            t01[1] = rgb[1];
-            t01[2] = rgb[2];
-            t01[3] = 1.0f;
-
-            tile.get_pixel(pixel_x_11, pixel_y_11, rgb);
-            t11[0] = rgb[0];
-            t11[1] = rgb[1];
-            t11[2] = rgb[2];
-            t11[3] = 1.0f;
-        }
-        else
-        {
-            tile.get_pixel(pixel_x_00, pixel_y_00, t00);
-            tile.get_pixel(pixel_x_11, pixel_y_00, t10);
-            tile.get_pixel(pixel_x_00, pixel_y_11, t01);
-            tile.get_pixel(pixel_x_11, pixel_y_11, t11);
-        }
+        read_texels_2x2(
+            tile,
+            m_srgb_encoded,
+            pixel_x_00, pixel_y_00,
+            pixel_x_11, pixel_y_11,
+            t00, t10, t01, t11);
     }
 }
 
@@ -391,7 +548,11 @@ Color4f TextureSource::sample_texture(
             const int iy = truncate<int>(p.y);
 
             // Retrieve the four surrounding texels.
+#ifdef APPLESEED_USE_SSE
+            APPLESEED_SIMD4_ALIGN Color4f t00, t10, t01, t11;
+#else
             Color4f t00, t10, t01, t11;
+#endif
             get_texels_2x2(
                 texture_cache,
                 ix, iy,
@@ -403,6 +564,17 @@ Color4f TextureSource::sample_texture(
             const float wx0 = 1.0f - wx1;
             const float wy0 = 1.0f - wy1;
 
+#ifdef APPLESEED_USE_SSE
+
+            // Apply weights and accumulate.
+            __m128 result = _mm_mul_ps(_mm_load_ps(&t00[0]), _mm_set1_ps(wx0 * wy0));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&t10[0]), _mm_set1_ps(wx1 * wy0)));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&t01[0]), _mm_set1_ps(wx0 * wy1)));
+            result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&t11[0]), _mm_set1_ps(wx1 * wy1)));
+            _mm_store_ps(&t00[0], result);
+
+#else
+
             // Apply weights.
             t00 *= wx0 * wy0;
             t10 *= wx1 * wy0;
@@ -414,6 +586,8 @@ Color4f TextureSource::sample_texture(
             t00 += t01;
             t00 += t11;
 
+#endif
+
             return t00;
         }
 
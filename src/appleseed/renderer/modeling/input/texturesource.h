@@ -110,6 +110,7 @@ class TextureSource
     const float                             m_scalar_canvas_height;
     const float                             m_max_x;
     const float                             m_max_y;
+    const bool                              m_srgb_encoded;
 
     // Apply the texture instance transform to UV coordinates.
     foundation::Vector2f apply_transform(
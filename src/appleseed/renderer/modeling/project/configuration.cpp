@@ -31,12 +31,14 @@
 #include "configuration.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/lighting/bdpt/bdptlightingengine.h"
 #include "renderer/kernel/lighting/drt/drtlightingengine.h"
 #include "renderer/kernel/lighting/pt/ptlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmlightingengine.h"
 #include "renderer/kernel/rendering/final/adaptivepixelrenderer.h"
 #include "renderer/kernel/rendering/final/uniformpixelrenderer.h"
 #include "renderer/kernel/rendering/generic/genericframerenderer.h"
+#include "renderer/kernel/rendering/generic/genericsamplegenerator.h"
 #include "renderer/kernel/rendering/progressive/progressiveframerenderer.h"
 #include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/utility/paramarray.h"
@@ -112,7 +114,7 @@ Dictionary Configuration::get_metadata()
         "sampling_mode",
         Dictionary()
             .insert("type", "enum")
-            .insert("values", "rng|qmc")
+            .insert("values", "rng|qmc|sobol|bluenoise")
             .insert("default", "rng")
             .insert("label", "Sampler")
             .insert("help", "Sampler to use when generating samples")
@@ -128,19 +130,34 @@ Dictionary Configuration::get_metadata()
                         "qmc",
                         Dictionary()
                             .insert("label", "QMC")
-                            .insert("help", "Quasi Monte Carlo sampler"))));
+                            .insert("help", "Quasi Monte Carlo sampler"))
+                    .insert(
+                        "sobol",
+                        Dictionary()
+                            .insert("label", "Sobol")
+                            .insert("help", "Owen-scrambled Sobol sampler"))
+                    .insert(
+                        "bluenoise",
+                        Dictionary()
+                            .insert("label", "Blue Noise")
+                            .insert("help", "Sobol sampler with blue-noise error distribution, best for previews at low sample counts"))));
 
     metadata.insert(
         "lighting_engine",
         Dictionary()
             .insert("type", "enum")
-            .insert("values", "drt|pt|sppm")
+            .insert("values", "bdpt|drt|pt|sppm")
             .insert("default", "pt")
             .insert("label", "Lighting Engine")
             .insert("help", "Lighting engine used when rendering")
             .insert(
                 "options",
                 Dictionary()
+                    .insert(
+                        "bdpt",
+                        Dictionary()
+                            .insert("label", "Bidirectional Path Tracer")
+                            .insert("help", "Bidirectional path tracing"))
                     .insert(
                         "drt",
                         Dictionary()
@@ -176,6 +193,10 @@ Dictionary Configuration::get_metadata()
         "adaptive_pixel_renderer",
         AdaptivePixelRendererFactory::get_params_metadata());
 
+    metadata.dictionaries().insert(
+        "generic_sample_generator",
+        GenericSampleGeneratorFactory::get_params_metadata());
+
     metadata.dictionaries().insert(
         "generic_frame_renderer",
         GenericFrameRendererFactory::get_params_metadata());
@@ -184,6 +205,7 @@ Dictionary Configuration::get_metadata()
         "progressive_frame_renderer",
         ProgressiveFrameRendererFactory::get_params_metadata());
 
+    metadata.dictionaries().insert("bdpt", BDPTLightingEngineFactory::get_params_metadata());
     metadata.dictionaries().insert("drt", DRTLightingEngineFactory::get_params_metadata());
     metadata.dictionaries().insert("pt", PTLightingEngineFactory::get_params_metadata());
     metadata.dictionaries().insert("sppm", SPPMLightingEngineFactory::get_params_metadata());
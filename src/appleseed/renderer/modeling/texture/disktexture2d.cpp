@@ -40,19 +40,30 @@
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/genericprogressiveimagefilereader.h"
+#include "foundation/image/imageattributes.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/preprocessedtexture.h"
 #include "foundation/image/tile.h"
 #include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/searchpaths.h"
 
+// Boost headers.
+#include "boost/cstdint.hpp"
+#include "boost/filesystem/operations.hpp"
+
 // Standard headers.
 #include <cstddef>
+#include <ctime>
+#include <exception>
 #include <string>
 
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
@@ -75,6 +86,7 @@ namespace
             const SearchPaths&  search_paths)
           : Texture(name, params)
           , m_reader(&global_logger())
+          , m_source_hash_valid(false)
         {
             const EntityDefMessageContext message_context("texture", this);
 
@@ -161,18 +173,96 @@ namespace
         GenericProgressiveImageFileReader   m_reader;
         CanvasProperties                    m_props;
 
+        bool                                m_source_hash_valid;
+        uint64                              m_source_hash;
+        boost::uintmax_t                    m_source_size;
+        time_t                              m_source_mtime;
+
         void open_image_file()
         {
             if (!m_reader.is_open())
             {
-                RENDERER_LOG_INFO(
-                    "opening texture file %s and reading metadata...",
-                    m_filepath.c_str());
+                if (!open_preprocessed_image_file())
+                {
+                    RENDERER_LOG_INFO(
+                        "opening texture file %s and reading metadata...",
+                        m_filepath.c_str());
+
+                    m_reader.open(m_filepath.c_str());
+                }
 
-                m_reader.open(m_filepath.c_str());
                 m_reader.read_canvas_properties(m_props);
             }
         }
+
+        // Open the preprocessed version of the texture file if it exists and if it is
+        // up-to-date with respect to the texture file. Return true on success.
+        bool open_preprocessed_image_file()
+        {
+            return
+                open_preprocessed_image_file(get_preprocessed_texture_path(m_filepath, PixelFormatUInt8)) ||
+                open_preprocessed_image_file(get_preprocessed_texture_path(m_filepath, PixelFormatFloat));
+        }
+
+        bool open_preprocessed_image_file(const string& preprocessed_filepath)
+        {
+            if (!bf::exists(preprocessed_filepath))
+                return false;
+
+            try
+            {
+                m_reader.open(preprocessed_filepath.c_str());
+
+                ImageAttributes attributes;
+                m_reader.read_image_attributes(attributes);
+
+                uint64 source_hash;
+                if (get_preprocessed_texture_source_hash(attributes, source_hash) &&
+                    source_hash == get_source_hash())
+                {
+                    RENDERER_LOG_INFO(
+                        "opening preprocessed texture file %s and reading metadata...",
+                        preprocessed_filepath.c_str());
+
+                    return true;
+                }
+
+                RENDERER_LOG_WARNING(
+                    "ignoring preprocessed texture file %s since it is out-of-date.",
+                    preprocessed_filepath.c_str());
+            }
+            catch (const exception& e)
+            {
+                RENDERER_LOG_WARNING(
+                    "ignoring preprocessed texture file %s since it could not be read (%s).",
+                    preprocessed_filepath.c_str(),
+                    e.what());
+            }
+
+            if (m_reader.is_open())
+                m_reader.close();
+
+            return false;
+        }
+
+        // Return the content hash of the texture file. Since the texture file is reopened
+        // at every frame, the hash is only recomputed when the size or the modification
+        // time of the file has changed since it was last computed.
+        uint64 get_source_hash()
+        {
+            const boost::uintmax_t size = bf::file_size(m_filepath);
+            const time_t mtime = bf::last_write_time(m_filepath);
+
+            if (!m_source_hash_valid || size != m_source_size || mtime != m_source_mtime)
+            {
+                m_source_hash = compute_file_content_hash(m_filepath.c_str());
+                m_source_size = size;
+                m_source_mtime = mtime;
+                m_source_hash_valid = true;
+            }
+
+            return m_source_hash;
+        }
     };
 }
 
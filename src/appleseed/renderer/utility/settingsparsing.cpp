@@ -53,12 +53,13 @@ SamplingContext::Mode get_sampling_context_mode(const ParamArray& params)
         params.get_required<string>(
             "sampling_mode",
             "rng",
-            make_vector("rng", "qmc"));
+            make_vector("rng", "qmc", "sobol", "bluenoise"));
 
     return
-        sampling_mode == "rng"
-            ? SamplingContext::RNGMode
-            : SamplingContext::QMCMode;
+        sampling_mode == "rng" ? SamplingContext::RNGMode :
+        sampling_mode == "qmc" ? SamplingContext::QMCMode :
+        sampling_mode == "sobol" ? SamplingContext::SobolMode :
+        SamplingContext::BlueNoiseMode;
 }
 
 string get_sampling_context_mode_name(const SamplingContext::Mode mode)
@@ -67,6 +68,8 @@ string get_sampling_context_mode_name(const SamplingContext::Mode mode)
     {
       case SamplingContext::RNGMode: return "rng";
       case SamplingContext::QMCMode: return "qmc";
+      case SamplingContext::SobolMode: return "sobol";
+      case SamplingContext::BlueNoiseMode: return "bluenoise";
       default: return "unknown";
     }
 }
@@ -0,0 +1,233 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2017 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Project headers.
+#include "commandlinehandler.h"
+
+// appleseed.shared headers.
+#include "application/application.h"
+#include "application/superlogger.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/genericimagefilereader.h"
+#include "foundation/image/genericimagefilewriter.h"
+#include "foundation/image/image.h"
+#include "foundation/image/imageattributes.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/preprocessedtexture.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+
+using namespace appleseed::maketexture;
+using namespace appleseed::shared;
+using namespace foundation;
+using namespace std;
+
+namespace
+{
+    // Return the pixel format of the output file given the pixel format of the input file.
+    // 8-bit and 16-bit textures are kept as is and written to TIFF files, other textures
+    // are written to OpenEXR files which only support 32-bit unsigned integer, half and
+    // float channels.
+    PixelFormat get_default_output_pixel_format(const PixelFormat input_pixel_format)
+    {
+        switch (input_pixel_format)
+        {
+          case PixelFormatUInt8:
+            return PixelFormatUInt8;
+
+          case PixelFormatUInt16:
+            return PixelFormatUInt16;
+
+          case PixelFormatHalf:
+            return PixelFormatHalf;
+
+          case PixelFormatUInt32:
+            return PixelFormatUInt32;
+
+          case PixelFormatFloat:
+          case PixelFormatDouble:
+          default:
+            return PixelFormatFloat;
+        }
+    }
+
+    bool parse_pixel_format(const string& s, PixelFormat& pixel_format)
+    {
+        if (s == "uint8")
+            pixel_format = PixelFormatUInt8;
+        else if (s == "uint16")
+            pixel_format = PixelFormatUInt16;
+        else if (s == "uint32")
+            pixel_format = PixelFormatUInt32;
+        else if (s == "half")
+            pixel_format = PixelFormatHalf;
+        else if (s == "float")
+            pixel_format = PixelFormatFloat;
+        else return false;
+
+        return true;
+    }
+}
+
+
+//
+// Entry point of maketexture.
+//
+
+int main(int argc, const char* argv[])
+{
+    // Initialize the logger that will be used throughout the program.
+    SuperLogger logger;
+
+    // Make sure appleseed is correctly installed.
+    Application::check_installation(logger);
+
+    // Parse the command line.
+    CommandLineHandler cl;
+    cl.parse(argc, argv, logger);
+
+    // Load an apply settings from the settings file.
+    Dictionary settings;
+    Application::load_settings("appleseed.tools.xml", settings, logger);
+    logger.configure_from_settings(settings);
+
+    // Apply command line arguments.
+    cl.apply(logger);
+
+    // Retrieve the input file path.
+    const string& input_filepath = cl.m_filenames.values()[0];
+
+    // Retrieve the tile size.
+    const size_t tile_size = cl.m_tile_size.value();
+    if (tile_size == 0)
+    {
+        LOG_ERROR(logger, "invalid tile size.");
+        return 1;
+    }
+
+    // Read the input image file and compute the hash of its content.
+    auto_ptr<Image> input_image;
+    uint64 source_hash;
+    try
+    {
+        GenericImageFileReader reader;
+        input_image.reset(reader.read(input_filepath.c_str()));
+        source_hash = compute_file_content_hash(input_filepath.c_str());
+    }
+    catch (const exception& e)
+    {
+        LOG_ERROR(
+            logger,
+            "could not read image file %s (%s).",
+            input_filepath.c_str(),
+            e.what());
+        return 1;
+    }
+
+    const CanvasProperties& input_props = input_image->properties();
+
+    if (input_props.m_channel_count > 4)
+    {
+        LOG_ERROR(
+            logger,
+            "image file %s has " FMT_SIZE_T " channels, at most 4 are supported.",
+            input_filepath.c_str(),
+            input_props.m_channel_count);
+        return 1;
+    }
+
+    // Determine the pixel format of the output file.
+    PixelFormat output_pixel_format = get_default_output_pixel_format(input_props.m_pixel_format);
+    if (cl.m_pixel_format.is_set() &&
+        !parse_pixel_format(cl.m_pixel_format.value(), output_pixel_format))
+    {
+        LOG_ERROR(logger, "invalid pixel format \"%s\".", cl.m_pixel_format.value().c_str());
+        return 1;
+    }
+
+    // Determine the path to the output file.
+    const string output_filepath =
+        cl.m_filenames.values().size() > 1
+            ? cl.m_filenames.values()[1]
+            : get_preprocessed_texture_path(input_filepath, output_pixel_format);
+
+    LOG_INFO(
+        logger,
+        "converting %s (" FMT_SIZE_T "x" FMT_SIZE_T ", " FMT_SIZE_T " channel%s, %s) to %s (" FMT_SIZE_T "x" FMT_SIZE_T " tiles, %s)...",
+        input_filepath.c_str(),
+        input_props.m_canvas_width,
+        input_props.m_canvas_height,
+        input_props.m_channel_count,
+        input_props.m_channel_count > 1 ? "s" : "",
+        pixel_format_name(input_props.m_pixel_format),
+        output_filepath.c_str(),
+        tile_size,
+        tile_size,
+        pixel_format_name(output_pixel_format));
+
+    // Retile the image and convert it to the output pixel format.
+    const Image output_image(
+        *input_image,
+        tile_size,
+        tile_size,
+        output_pixel_format);
+    input_image.reset();
+
+    // Record the hash of the source file so that the renderer can check that
+    // the preprocessed texture is up-to-date.
+    ImageAttributes attributes;
+    set_preprocessed_texture_source_hash(attributes, source_hash);
+
+    // Write the output image file.
+    try
+    {
+        GenericImageFileWriter writer;
+        writer.write(output_filepath.c_str(), output_image, attributes);
+    }
+    catch (const exception& e)
+    {
+        LOG_ERROR(
+            logger,
+            "could not write image file %s (%s).",
+            output_filepath.c_str(),
+            e.what());
+        return 1;
+    }
+
+    return 0;
+}